@@ -132,6 +132,21 @@ public:
   bool remove(const Key& key);
   T *take(const Key& key);
 
+  // Returns the object without marking it as recently used
+  T *peek(const Key& key) const
+  {
+    auto i = hash.find(key);
+    return i == hash.end() ? nullptr : i->second.t;
+  }
+  // Changes the cost of an object, e.g. after its representation changed
+  bool setCost(const Key& key, size_t cost);
+  // Calls visit(key, object, cost) for all objects, from the most to the least recently used
+  template <class F>
+  void forEach(F visit) const
+  {
+    for (const Node *n = f; n; n = n->n) visit(*n->keyPtr, *n->t, n->c);
+  }
+
 private:
   void trim(size_t m);
 };
@@ -161,6 +176,18 @@ inline T *Cache<Key, T>::take(const Key& key)
   return t;
 }
 
+template <class Key, class T>
+bool Cache<Key, T>::setCost(const Key& key, size_t cost)
+{
+  auto i = hash.find(key);
+  if (i == hash.end()) return false;
+  Node& n = i->second;
+  total = total - n.c + cost;
+  n.c = cost;
+  trim(mx);
+  return true;
+}
+
 template <class Key, class T>
 bool Cache<Key, T>::insert(const Key& akey, T *aobject, size_t acost)
 {
@@ -30,6 +30,7 @@
 #include <boost/range/algorithm/find.hpp>
 #include <cassert>
 #include <chrono>
+#include <cstddef>
 #include <fstream>
 #include <iostream>
 #include <memory>
@@ -65,6 +66,7 @@ struct StatisticVisitor : public GeometryVisitor {
   virtual void printCamera(const Camera& camera) = 0;
   virtual void printCacheStatistic() = 0;
   virtual void printRenderingTime(std::chrono::milliseconds) = 0;
+  virtual void printCullingStatistic(size_t culled) = 0;
   virtual void finish() = 0;
 
 protected:
@@ -92,6 +94,7 @@ struct LogVisitor : public StatisticVisitor {
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printCullingStatistic(size_t culled) override;
   void finish() override;
 
 private:
@@ -123,6 +126,7 @@ struct StreamVisitor : public StatisticVisitor {
   void printCamera(const Camera& camera) override;
   void printCacheStatistic() override;
   void printRenderingTime(std::chrono::milliseconds) override;
+  void printCullingStatistic(size_t culled) override;
   void finish() override;
 
 private:
@@ -177,6 +181,7 @@ RenderStatistic::RenderStatistic() : begin(std::chrono::steady_clock::now())
 void RenderStatistic::start()
 {
   begin = std::chrono::steady_clock::now();
+  culled_operands = 0;
 }
 
 std::chrono::milliseconds RenderStatistic::ms()
@@ -214,6 +219,7 @@ void RenderStatistic::printAll(const std::shared_ptr<const Geometry>& geom, cons
 
   visitor->printCacheStatistic();
   visitor->printRenderingTime(ms());
+  visitor->printCullingStatistic(culled_operands);
   if (geom && !geom->isEmpty()) {
     geom->accept(*visitor);
   }
@@ -332,6 +338,13 @@ void LogVisitor::printRenderingTime(const std::chrono::milliseconds ms)
       (ms.count() / 1000 / 60 % 60), (ms.count() / 1000 % 60), (ms.count() % 1000));
 }
 
+void LogVisitor::printCullingStatistic(size_t culled)
+{
+  if (is_enabled(RenderStatistic::CULLING)) {
+    LOG("Culled boolean operands: %1$d", culled);
+  }
+}
+
 void LogVisitor::finish()
 {
 }
@@ -450,6 +463,15 @@ void StreamVisitor::printRenderingTime(const std::chrono::milliseconds ms)
   }
 }
 
+void StreamVisitor::printCullingStatistic(size_t culled)
+{
+  if (is_enabled(RenderStatistic::CULLING)) {
+    nlohmann::json cullingJson;
+    cullingJson["operands"] = culled;
+    json["culling"] = cullingJson;
+  }
+}
+
 void StreamVisitor::finish()
 {
   stream << json;
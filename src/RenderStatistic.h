@@ -26,6 +26,7 @@
 #pragma once
 
 #include <chrono>
+#include <cstddef>
 #include <memory>
 #include <string>
 #include <vector>
@@ -46,6 +47,7 @@ public:
   constexpr static auto GEOMETRY = "geometry";
   constexpr static auto BOUNDING_BOX = "bounding-box";
   constexpr static auto AREA = "area";
+  constexpr static auto CULLING = "culling";
 
   /**
    * Construct a statistic printer for the given geometry with current
@@ -69,6 +71,13 @@ public:
    */
   void printCacheStatistic();
 
+  /**
+   * Set the number of boolean operands which were skipped because their
+   * bounding box showed they cannot affect the result, as counted by the
+   * GeometryEvaluator. The count is reset by start().
+   */
+  void setCulledOperands(size_t count) { culled_operands = count; }
+
   /**
    * Format and print time elapsed by rendering.
    */
@@ -82,4 +91,5 @@ public:
 
 private:
   std::chrono::steady_clock::time_point begin;
+  size_t culled_operands{0};
 };
@@ -62,6 +62,8 @@ private:
                const std::shared_ptr<CSGNode>& right);
   OpenSCADOperator type;
   std::vector<std::shared_ptr<CSGNode>> children;
+
+  friend class CSGTreeNormalizer;
 };
 
 // very large lists of children can overflow stack due to recursive destruction of shared_ptr,
@@ -78,6 +78,21 @@ void DrawingCallback::add_glyph_advance(double advance_x, double advance_y)
   advance += Vector2d(advance_x, advance_y);
 }
 
+// Adds a complete glyph, previously rendered by a DrawingCallback at unit size and
+// without offset, at the current offset and advance.
+void DrawingCallback::add_glyph(const Polygon2d& glyph)
+{
+  start_glyph();
+  for (const auto& o : glyph.outlines()) {
+    for (const auto& v : o.vertices) {
+      add_vertex(v);
+    }
+    this->polygon->addOutline(this->outline);
+    this->outline.vertices.clear();
+  }
+  finish_glyph();
+}
+
 void DrawingCallback::add_vertex(const Vector2d& v)
 {
   this->outline.vertices.push_back(size * (v + offset + advance));
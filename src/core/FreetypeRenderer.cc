@@ -30,18 +30,24 @@
 
 #include <algorithm>
 #include <cmath>
+#include <cstddef>
 #include <cstdint>
 #include <cstdio>
 #include <iterator>
 #include <limits>
 #include <memory>
+#include <mutex>
+#include <optional>
 #include <ostream>
+#include <string>
 #include <vector>
 
+#include "Cache.h"
 #include "FontCache.h"
 #include "core/CurveDiscretizer.h"
 #include "core/DrawingCallback.h"
 #include "core/Value.h"
+#include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
 #include "utils/calc.h"
 #include "utils/printutils.h"
@@ -368,16 +374,79 @@ FreetypeRenderer::Params::Params(const ParamsOptions& opts)
   set_valign(opts.valign.value_or("default"));
 }
 
-FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& params)
+namespace {
+
+constexpr size_t SHAPING_CACHE_SIZE = 1024 * 1024;
+constexpr size_t GLYPH_CACHE_SIZE = 16 * 1024 * 1024;
+
+}  // namespace
+
+std::mutex FreetypeRenderer::cache_mutex;
+Cache<std::string, FreetypeRenderer::FaceCacheEntry<std::shared_ptr<const FreetypeRenderer::ShapedText>>>
+  FreetypeRenderer::shaping_cache(SHAPING_CACHE_SIZE);
+Cache<std::string, FreetypeRenderer::FaceCacheEntry<std::shared_ptr<const Polygon2d>>>
+  FreetypeRenderer::glyph_cache(GLYPH_CACHE_SIZE);
+
+// Returns a copy of the cached value, since the entry may be evicted as soon as the lock is released
+template <typename T>
+std::optional<T> FreetypeRenderer::lookup(Cache<std::string, FaceCacheEntry<T>>& cache,
+                                          const std::string& key)
 {
-  const FontFacePtr face = params.get_font_face();
-  if (!face) {
-    return;
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  auto *entry = cache[key];
+  if (!entry) return {};
+  if (entry->face.expired()) {
+    cache.remove(key);
+    return {};
   }
+  return entry->value;
+}
 
-  hb_ft_font = hb_ft_font_create(face->face_, nullptr);
+template <typename T>
+void FreetypeRenderer::insert(Cache<std::string, FaceCacheEntry<T>>& cache, const std::string& key,
+                              const FontFacePtr& face, const T& value, size_t cost)
+{
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  cache.insert(key, new FaceCacheEntry<T>{face, value}, cost);
+}
+
+void FreetypeRenderer::clear_caches()
+{
+  std::lock_guard<std::mutex> lock(cache_mutex);
+  shaping_cache.clear();
+  glyph_cache.clear();
+}
 
-  hb_buf = hb_buffer_create();
+/*!
+   Reports the warnings raised while shaping, at the location of the text() or textmetrics() call
+   using the result. Warnings are kept with the cached result so that they are reported each time.
+ */
+void FreetypeRenderer::report_warnings(const ShapedText& shaped, const Params& params)
+{
+  for (const auto& warning : shaped.warnings) {
+    LOG(message_group::Warning, params.loc, params.documentPath, "%1$s", warning);
+  }
+}
+
+/*!
+   Shapes params.text using HarfBuzz. The result only depends on the font face, text,
+   direction, script and language, so it is cached across calls.
+ */
+std::shared_ptr<const FreetypeRenderer::ShapedText> FreetypeRenderer::shape(
+  const FontFacePtr& face, const FreetypeRenderer::Params& params)
+{
+  const std::string key = STR(face.get(), '\n', params.direction, '\n', params.script, '\n',
+                              params.language, '\n', params.text);
+  if (const auto shaped = lookup(shaping_cache, key)) {
+    report_warnings(**shaped, params);
+    return *shaped;
+  }
+
+  auto result = std::make_shared<ShapedText>();
+
+  hb_font_t *hb_ft_font = hb_ft_font_create(face->face_, nullptr);
+
+  hb_buffer_t *hb_buf = hb_buffer_create();
   hb_buffer_set_direction(hb_buf, hb_direction_from_string(params.direction.c_str(), -1));
   hb_buffer_set_script(hb_buf, hb_script_from_string(params.script.c_str(), -1));
   hb_buffer_set_language(hb_buf, hb_language_from_string(params.language.c_str(), -1));
@@ -398,8 +467,8 @@ FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& par
         hb_buffer_add_utf32(hb_buf, &c, 1, 0, 1);
       }
     } else {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Ignoring text with invalid UTF-8 encoding: \"%1$s\"", params.text.c_str());
+      result->warnings.push_back(
+        STR("Ignoring text with invalid UTF-8 encoding: \"", params.text, "\""));
     }
   } else {
     hb_buffer_add_utf8(hb_buf, params.text.c_str(), strlen(params.text.c_str()), 0,
@@ -425,31 +494,84 @@ FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& par
   hb_glyph_info_t *glyph_info = hb_buffer_get_glyph_infos(hb_buf, &glyph_count);
   hb_glyph_position_t *glyph_pos = hb_buffer_get_glyph_positions(hb_buf, &glyph_count);
 
-  glyph_array.reserve(glyph_count);
+  result->glyphs.reserve(glyph_count);
   for (unsigned int idx = 0; idx < glyph_count; ++idx) {
     FT_Error error;
     FT_UInt glyph_index = glyph_info[idx].codepoint;
     error = FT_Load_Glyph(face->face_, glyph_index, FT_LOAD_DEFAULT);
     if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not load glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
+      result->warnings.push_back(STR("Could not load glyph ", glyph_index, " for char at index ", idx,
+                                     " in text '", params.text, "'"));
       continue;
     }
 
     FT_Glyph glyph;
     error = FT_Get_Glyph(face->face_->glyph, &glyph);
     if (error) {
-      LOG(message_group::Warning, params.loc, params.documentPath,
-          "Could not get glyph %1$u"
-          " for char at index %2$u in text '%3$s'",
-          glyph_index, idx, params.text);
+      result->warnings.push_back(STR("Could not get glyph ", glyph_index, " for char at index ", idx,
+                                     " in text '", params.text, "'"));
       continue;
     }
 
-    glyph_array.emplace_back(glyph, idx, &glyph_pos[idx]);
+    FT_BBox cbox;
+    FT_Glyph_Get_CBox(glyph, FT_GLYPH_BBOX_GRIDFIT, &cbox);
+    FT_Done_Glyph(glyph);
+
+    result->glyphs.emplace_back(glyph_index, cbox, glyph_pos[idx]);
   }
+  result->direction = hb_buffer_get_direction(hb_buf);
+
+  hb_buffer_destroy(hb_buf);
+  hb_font_destroy(hb_ft_font);
+
+  size_t cost = sizeof(ShapedText) + key.size() + result->glyphs.size() * sizeof(GlyphData);
+  for (const auto& warning : result->warnings) cost += warning.size();
+  insert<std::shared_ptr<const ShapedText>>(shaping_cache, key, face, result, cost);
+  report_warnings(*result, params);
+  return result;
+}
+
+/*!
+   Returns the outline of the given glyph at unit size and without any offset, with curves
+   discretized into the given number of segments. Outlines are cached, so rendering repeated
+   glyphs only needs to translate and scale them.
+   Returns nullptr for glyphs without an outline, e.g. space.
+ */
+std::shared_ptr<const Polygon2d> FreetypeRenderer::glyph_outline(const FontFacePtr& face,
+                                                                 unsigned int glyph_index,
+                                                                 unsigned int segments) const
+{
+  const std::string key = STR(face.get(), '\n', glyph_index, '\n', segments);
+  if (const auto outline = lookup(glyph_cache, key)) {
+    return *outline;
+  }
+
+  std::shared_ptr<const Polygon2d> result;
+  if (!FT_Load_Glyph(face->face_, glyph_index, FT_LOAD_DEFAULT) &&
+      face->face_->glyph->format == FT_GLYPH_FORMAT_OUTLINE) {
+    DrawingCallback callback(segments, 1.0);
+    callback.start_glyph();
+    FT_Outline_Decompose(&face->face_->glyph->outline, &funcs, &callback);
+    callback.finish_glyph();
+    auto polygons = callback.get_result();
+    if (!polygons.empty()) result = polygons.front();
+  }
+
+  size_t cost = sizeof(Polygon2d) + key.size();
+  if (result) {
+    for (const auto& o : result->outlines()) cost += o.vertices.size() * sizeof(Vector2d);
+  }
+  insert(glyph_cache, key, face, result, cost);
+  return result;
+}
+
+FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& params)
+{
+  face = params.get_font_face();
+  if (!face) {
+    return;
+  }
+  shaped = shape(face, params);
 
   ascent = std::numeric_limits<double>::lowest();
   descent = std::numeric_limits<double>::max();
@@ -460,9 +582,8 @@ FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& par
   bottom = std::numeric_limits<double>::max();
   top = std::numeric_limits<double>::lowest();
 
-  for (const auto& glyph : glyph_array) {
-    FT_BBox bbox;
-    FT_Glyph_Get_CBox(glyph.get_glyph(), FT_GLYPH_BBOX_GRIDFIT, &bbox);
+  for (const auto& glyph : shaped->glyphs) {
+    const FT_BBox& bbox = glyph.get_cbox();
 
     // Note that glyphs can extend left of their origin
     // and right of their advance-width, into the next
@@ -495,7 +616,7 @@ FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& par
   // contributed they will flip.  If they're still reversed,
   // there was no ink.
   if (right >= left) {
-    if (HB_DIRECTION_IS_HORIZONTAL(hb_buffer_get_direction(hb_buf))) {
+    if (HB_DIRECTION_IS_HORIZONTAL(shaped->direction)) {
       calc_offsets_horiz(params);
     } else {
       calc_offsets_vert(params);
@@ -514,18 +635,6 @@ FreetypeRenderer::ShapeResults::ShapeResults(const FreetypeRenderer::Params& par
   ok = true;
 }
 
-FreetypeRenderer::ShapeResults::~ShapeResults()
-{
-  if (hb_buf != nullptr) {
-    hb_buffer_destroy(hb_buf);
-    hb_buf = nullptr;
-  }
-  if (hb_ft_font != nullptr) {
-    hb_font_destroy(hb_ft_font);
-    hb_ft_font = nullptr;
-  }
-}
-
 FreetypeRenderer::FontMetrics::FontMetrics(const FreetypeRenderer::Params& params)
 {
   ok = false;
@@ -602,16 +711,15 @@ std::vector<std::shared_ptr<const Polygon2d>> FreetypeRenderer::render(
   }
 
   DrawingCallback callback(params.segments, params.size);
-  for (const auto& glyph : sr.glyph_array) {
-    callback.start_glyph();
+  for (const auto& glyph : sr.shaped->glyphs) {
     callback.set_glyph_offset(sr.x_offset + glyph.get_x_offset(), sr.y_offset + glyph.get_y_offset());
-    FT_Outline outline = reinterpret_cast<FT_OutlineGlyph>(glyph.get_glyph())->outline;
-    FT_Outline_Decompose(&outline, &funcs, &callback);
+    if (const auto outline = glyph_outline(sr.face, glyph.get_glyph_index(), params.segments)) {
+      callback.add_glyph(*outline);
+    }
 
     double adv_x = glyph.get_x_advance() * params.spacing;
     double adv_y = glyph.get_y_advance() * params.spacing;
     callback.add_glyph_advance(adv_x, adv_y);
-    callback.finish_glyph();
   }
 
   // FIXME: The returned Polygon2d currently contains only outlines with the 'positive' flag set to true,
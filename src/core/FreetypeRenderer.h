@@ -29,11 +29,13 @@
 #include <hb.h>
 
 #include <memory>
+#include <mutex>
 #include <optional>
 #include <ostream>
 #include <string>
 #include <vector>
 
+#include "Cache.h"
 #include "FontCache.h"
 #include "core/AST.h"
 #include "core/CurveDiscretizer.h"
@@ -142,44 +144,54 @@ public:
   [[nodiscard]] std::vector<std::shared_ptr<const class Polygon2d>> render(
     const FreetypeRenderer::Params& params) const;
 
+  // Drops the cached shaping results and glyph outlines
+  static void clear_caches();
+
 private:
   const static double scale;
   FT_Outline_Funcs funcs;
 
-  // The GlyphData assumes responsibility for "glyph" and will ensure
-  // that it is freed when the GlyphData is destroyed.
-  // However, glyph_pos points to data that the caller must ensure
-  // remains valid until the GlyphData is destroyed.
+  // A single shaped glyph: its index in the font, its control box, and the
+  // positioning computed by HarfBuzz.
   class GlyphData
   {
   public:
-    GlyphData(FT_Glyph glyph, unsigned int idx, hb_glyph_position_t *glyph_pos)
-      : glyph(glyph), idx(idx), glyph_pos(glyph_pos)
+    GlyphData(unsigned int glyph_index, const FT_BBox& cbox, const hb_glyph_position_t& glyph_pos)
+      : glyph_index(glyph_index), cbox(cbox), glyph_pos(glyph_pos)
     {
     }
-    [[nodiscard]] unsigned int get_idx() const { return idx; }
-    [[nodiscard]] FT_Glyph get_glyph() const { return glyph; }
-    [[nodiscard]] double get_x_offset() const { return glyph_pos->x_offset / scale; }
-    [[nodiscard]] double get_y_offset() const { return glyph_pos->y_offset / scale; }
-    [[nodiscard]] double get_x_advance() const { return glyph_pos->x_advance / scale; }
-    [[nodiscard]] double get_y_advance() const { return glyph_pos->y_advance / scale; }
-    ~GlyphData() { FT_Done_Glyph(glyph); }
+    [[nodiscard]] unsigned int get_glyph_index() const { return glyph_index; }
+    [[nodiscard]] const FT_BBox& get_cbox() const { return cbox; }
+    [[nodiscard]] double get_x_offset() const { return glyph_pos.x_offset / scale; }
+    [[nodiscard]] double get_y_offset() const { return glyph_pos.y_offset / scale; }
+    [[nodiscard]] double get_x_advance() const { return glyph_pos.x_advance / scale; }
+    [[nodiscard]] double get_y_advance() const { return glyph_pos.y_advance / scale; }
 
   private:
-    FT_Glyph glyph;
-    unsigned int idx;
-    hb_glyph_position_t *glyph_pos;
+    unsigned int glyph_index;
+    FT_BBox cbox;
+    hb_glyph_position_t glyph_pos;
+  };
+
+  // Output of HarfBuzz shaping for a given font face and text, which is independent of
+  // size, spacing and alignment. Cached by shape().
+  struct ShapedText {
+    std::vector<GlyphData> glyphs;
+    hb_direction_t direction{HB_DIRECTION_INVALID};
+    // Raised while shaping, reported again whenever the cached result is used
+    std::vector<std::string> warnings;
   };
 
   class ShapeResults
   {
   public:
     bool ok{false};  // true if object is valid
+    FontFacePtr face;
+    std::shared_ptr<const ShapedText> shaped;
     // The values here are all in fractions of the specified size.
     // They have been downscaled from the 1e+5 unit size used for
     // when rendering from Freetype, and have not yet been scaled
     // back up to the desired font size.
-    std::vector<GlyphData> glyph_array;
     double x_offset{0.0};
     double y_offset{0.0};
     double left{0.0};
@@ -191,15 +203,39 @@ private:
     double ascent{0.0};
     double descent{0.0};
     ShapeResults(const FreetypeRenderer::Params& params);
-    virtual ~ShapeResults();
+    virtual ~ShapeResults() = default;
 
   private:
     void calc_offsets_horiz(const FreetypeRenderer::Params& params);
     void calc_offsets_vert(const FreetypeRenderer::Params& params);
-    hb_font_t *hb_ft_font{nullptr};
-    hb_buffer_t *hb_buf{nullptr};
   };
 
+  static std::shared_ptr<const ShapedText> shape(const FontFacePtr& face,
+                                                 const FreetypeRenderer::Params& params);
+  static void report_warnings(const ShapedText& shaped, const FreetypeRenderer::Params& params);
+  [[nodiscard]] std::shared_ptr<const class Polygon2d> glyph_outline(const FontFacePtr& face,
+                                                                     unsigned int glyph_index,
+                                                                     unsigned int segments) const;
+
+  // Cache entries are keyed by the address of the font face, so they also hold a weak reference
+  // to it. If the face has since been evicted from the FontCache, the entry is stale, even if a
+  // new face happens to have been allocated at the same address.
+  template <typename T>
+  struct FaceCacheEntry {
+    std::weak_ptr<const FontFace> face;
+    T value;
+  };
+  template <typename T>
+  static std::optional<T> lookup(Cache<std::string, FaceCacheEntry<T>>& cache, const std::string& key);
+  template <typename T>
+  static void insert(Cache<std::string, FaceCacheEntry<T>>& cache, const std::string& key,
+                     const FontFacePtr& face, const T& value, size_t cost);
+
+  // Both caches are used by the render thread and cleared from the GUI thread
+  static std::mutex cache_mutex;
+  static Cache<std::string, FaceCacheEntry<std::shared_ptr<const ShapedText>>> shaping_cache;
+  static Cache<std::string, FaceCacheEntry<std::shared_ptr<const class Polygon2d>>> glyph_cache;
+
   static int outline_move_to_func(const FT_Vector *to, void *user);
   static int outline_line_to_func(const FT_Vector *to, void *user);
   static int outline_conic_to_func(const FT_Vector *c1, const FT_Vector *to, void *user);
@@ -36,6 +36,7 @@
 #include <sys/types.h>
 
 #ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/manifoldutils.h"
 #include "glview/RenderSettings.h"
 #endif
 
@@ -56,6 +57,7 @@
 #include "geometry/Polygon2d.h"
 #include "handle_dep.h"
 #include "io/DxfData.h"
+#include "io/ImportCache.h"
 #include "io/fileutils.h"
 #include "utils/printutils.h"
 namespace fs = std::filesystem;
@@ -97,6 +99,7 @@ static std::shared_ptr<AbstractNode> do_import(const ModuleInstantiation *inst,
     else if (ext == ".amf") actualtype = ImportType::AMF;
     else if (ext == ".svg") actualtype = ImportType::SVG;
     else if (ext == ".obj") actualtype = ImportType::OBJ;
+    else if (ext == ".ply") actualtype = ImportType::PLY;
   }
 
   auto node =
@@ -193,6 +196,42 @@ static std::unique_ptr<T> optionally_center(std::unique_ptr<T> g, bool center)
   return g;
 }
 
+/*!
+   Imports a mesh through the ImportCache, so the file is only parsed again if it changed.
+   Returns a copy which the caller can modify.
+ */
+template <typename Import>
+static std::unique_ptr<PolySet> import_mesh(const std::string& filename, const std::string& format,
+                                            Import import)
+{
+  // Failed imports aren't cached, so their errors are reported again
+  auto parse = [&]() -> std::shared_ptr<const PolySet> {
+    std::shared_ptr<const PolySet> ps = import();
+    return ps->isEmpty() ? nullptr : ps;
+  };
+  auto ps = ImportCache::instance()->get<PolySet>(filename, format, parse);
+  return ps ? std::make_unique<PolySet>(*ps) : PolySet::createEmpty();
+}
+
+/*!
+   Imports the file of a node with a mesh format, or returns nullptr for other formats.
+ */
+static std::unique_ptr<PolySet> import_mesh_file(const ImportNode& node)
+{
+  const std::string& filename = node.filename;
+  const auto loc = node.modinst->location();
+  switch (node.type) {
+  case ImportType::STL: return import_mesh(filename, "stl", [&]() { return import_stl(filename, loc); });
+  case ImportType::AMF: return import_mesh(filename, "amf", [&]() { return import_amf(filename, loc); });
+  case ImportType::_3MF:
+    return import_mesh(filename, "3mf", [&]() { return import_3mf(filename, loc); });
+  case ImportType::OFF: return import_mesh(filename, "off", [&]() { return import_off(filename, loc); });
+  case ImportType::OBJ: return import_mesh(filename, "obj", [&]() { return import_obj(filename, loc); });
+  case ImportType::PLY: return import_mesh(filename, "ply", [&]() { return import_ply(filename, loc); });
+  default:              return nullptr;
+  }
+}
+
 /*!
    Will return an empty geometry if the import failed, but not nullptr
  */
@@ -202,26 +241,14 @@ std::unique_ptr<const Geometry> ImportNode::createGeometry() const
   auto loc = this->modinst->location();
 
   switch (this->type) {
-  case ImportType::STL: {
-    g = optionally_center(import_stl(this->filename, loc), this->center);
+  case ImportType::STL:
+  case ImportType::AMF:
+  case ImportType::_3MF:
+  case ImportType::OFF:
+  case ImportType::OBJ:
+  case ImportType::PLY:
+    g = optionally_center(import_mesh_file(*this), this->center);
     break;
-  }
-  case ImportType::AMF: {
-    g = optionally_center(import_amf(this->filename, loc), this->center);
-    break;
-  }
-  case ImportType::_3MF: {
-    g = optionally_center(import_3mf(this->filename, loc), this->center);
-    break;
-  }
-  case ImportType::OFF: {
-    g = optionally_center(import_off(this->filename, loc), this->center);
-    break;
-  }
-  case ImportType::OBJ: {
-    g = optionally_center(import_obj(this->filename, loc), this->center);
-    break;
-  }
   case ImportType::SVG: {
     g =
       import_svg(this->discretizer, this->filename, this->id, this->layer, this->dpi, this->center, loc);
@@ -267,6 +294,54 @@ std::unique_ptr<const Geometry> ImportNode::createGeometry() const
   return g;
 }
 
+/*!
+   With the Manifold backend, direct CSG operands get imported meshes as ManifoldGeometry. The
+   conversion is cached with the import, keyed by the backend, so operations don't convert the mesh
+   every time. Other imports, e.g. top-level or transformed ones, only use createGeometry(), so
+   their meshes are output as they were read, and warnings about the file are only printed once.
+   Meshes which aren't manifold are kept as they are, to be repaired when they are used.
+ */
+std::unique_ptr<const Geometry> ImportNode::createNativeGeometry() const
+{
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D != RenderBackend3D::ManifoldBackend) return nullptr;
+  const char *format = nullptr;
+  switch (this->type) {
+  case ImportType::STL:  format = "stl"; break;
+  case ImportType::AMF:  format = "amf"; break;
+  case ImportType::_3MF: format = "3mf"; break;
+  case ImportType::OFF:  format = "off"; break;
+  case ImportType::OBJ:  format = "obj"; break;
+  case ImportType::PLY:  format = "ply"; break;
+  default:               return nullptr;
+  }
+  const std::string parser = std::string(format) + (this->center ? "-centered" : "") + "-" +
+                             renderBackend3DToString(RenderBackend3D::ManifoldBackend);
+
+  // Set if the mesh was imported here but couldn't be converted, so it isn't imported again
+  std::unique_ptr<PolySet> ps;
+  auto mani = ImportCache::instance()->get<ManifoldGeometry>(
+    this->filename, parser, [&]() -> std::shared_ptr<const ManifoldGeometry> {
+      ps = optionally_center(import_mesh_file(*this), this->center);
+      if (ps->isEmpty()) return nullptr;
+      auto mani = ManifoldUtils::createManifoldFromPolySetWithoutRepair(*ps);
+      return mani->isValid() ? mani : nullptr;
+    });
+  std::unique_ptr<Geometry> g;
+  if (mani) {
+    g = std::make_unique<ManifoldGeometry>(*mani);
+  } else if (ps) {
+    g = std::move(ps);
+  } else {
+    return nullptr;
+  }
+  g->setConvexity(this->convexity);
+  return g;
+#else
+  return nullptr;
+#endif
+}
+
 std::string ImportNode::toString() const
 {
   std::ostringstream stream;
@@ -19,6 +19,7 @@ enum class ImportType {
   DXF,
   NEF3,
   OBJ,
+  PLY,
 };
 
 class ImportNode : public LeafNode
@@ -45,4 +46,5 @@ public:
   double origin_x, origin_y, scale;
   double width, height;
   std::unique_ptr<const class Geometry> createGeometry() const override;
+  std::unique_ptr<const class Geometry> createNativeGeometry() const override;
 };
@@ -456,6 +456,7 @@ SettingsEntryEnum<Export3mfMaterialType> SettingsExport3mf::export3mfMaterialTyp
   Export3mfMaterialType::basematerial);
 SettingsEntryInt SettingsExport3mf::export3mfDecimalPrecision(SECTION_EXPORT_3MF, "decimal-precision", 1,
                                                               16, 6);
+SettingsEntryBool SettingsExport3mf::export3mfStreaming(SECTION_EXPORT_3MF, "streaming", false);
 SettingsEntryBool SettingsExport3mf::export3mfAddMetaData(SECTION_EXPORT_3MF, "add-meta-data", true);
 SettingsEntryBool SettingsExport3mf::export3mfAddMetaDataDesigner(SECTION_EXPORT_3MF,
                                                                   "add-meta-data-designer", false);
@@ -489,6 +490,10 @@ SettingsEntryString SettingsExportSvg::exportSvgStrokeColor(SECTION_EXPORT_SVG,
 SettingsEntryDouble SettingsExportSvg::exportSvgStrokeWidth(SECTION_EXPORT_SVG, "stroke-width", 0, 0.01,
                                                             999, 0.35);
 
+SettingsEntryBool SettingsExportGlb::exportGlbAlwaysShowDialog(SECTION_EXPORT_GLB, "always-show-dialog",
+                                                               true);
+SettingsEntryBool SettingsExportGlb::exportGlbQuantize(SECTION_EXPORT_GLB, "quantize", false);
+
 SettingsEntryEnum<ColorListFilterType> SettingsColorList::colorListFilterType(
   SECTION_COLOR_LIST, "filter-type",
   {
@@ -29,6 +29,7 @@ constexpr inline auto SECTION_PYTHON = "python";
 constexpr inline auto SECTION_EXPORT_PDF = "export-pdf";
 constexpr inline auto SECTION_EXPORT_3MF = "export-3mf";
 constexpr inline auto SECTION_EXPORT_SVG = "export-svg";
+constexpr inline auto SECTION_EXPORT_GLB = "export-glb";
 constexpr inline auto SECTION_COLOR_LIST = "color-list";
 
 class SettingsEntryBase
@@ -570,6 +571,7 @@ public:
   static SettingsEntryString export3mfColor;
   static SettingsEntryEnum<Export3mfMaterialType> export3mfMaterialType;
   static SettingsEntryInt export3mfDecimalPrecision;
+  static SettingsEntryBool export3mfStreaming;
   static SettingsEntryBool export3mfAddMetaData;
   static SettingsEntryBool export3mfAddMetaDataDesigner;
   static SettingsEntryBool export3mfAddMetaDataDescription;
@@ -583,12 +585,13 @@ public:
   static SettingsEntryString export3mfMetaDataLicenseTerms;
   static SettingsEntryString export3mfMetaDataRating;
 
-  static constexpr std::array<const SettingsEntryBase *, 12> cmdline{
+  static constexpr std::array<const SettingsEntryBase *, 13> cmdline{
     &export3mfColorMode,
     &export3mfUnit,
     &export3mfColor,
     &export3mfMaterialType,
     &export3mfDecimalPrecision,
+    &export3mfStreaming,
     &export3mfAddMetaData,
     &export3mfMetaDataTitle,
     &export3mfMetaDataDesigner,
@@ -614,6 +617,17 @@ public:
   };
 };
 
+class SettingsExportGlb
+{
+public:
+  static SettingsEntryBool exportGlbAlwaysShowDialog;
+  static SettingsEntryBool exportGlbQuantize;
+
+  static constexpr std::array<const SettingsEntryBase *, 1> cmdline{
+    &exportGlbQuantize,
+  };
+};
+
 class SettingsColorList
 {
 public:
@@ -27,21 +27,18 @@
 #include "core/SurfaceNode.h"
 
 #include <algorithm>
-#include <boost/algorithm/string.hpp>
 #include <boost/assign/std/vector.hpp>
-#include <boost/functional/hash.hpp>
-#include <boost/lexical_cast.hpp>
-#include <boost/tokenizer.hpp>
+#include <charconv>
 #include <cstddef>
 #include <cstdint>
+#include <cstdio>
 #include <cstring>
-#include <fstream>
+#include <locale>
 #include <memory>
 #include <new>
 #include <sstream>
 #include <string>
-#include <unordered_map>
-#include <utility>
+#include <system_error>
 #include <vector>
 
 #include "core/Builtins.h"
@@ -51,11 +48,18 @@
 #include "core/module.h"
 #include "core/node.h"
 #include "geometry/PolySet.h"
-#include "geometry/PolySetBuilder.h"
+#include "geometry/linalg.h"
 #include "handle_dep.h"
+#include "io/ImportCache.h"
+#include "io/MappedFile.h"
 #include "io/fileutils.h"
 #include "lodepng/lodepng.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/manifoldutils.h"
+#include "glview/RenderSettings.h"
+#endif
 using namespace boost::assign;  // bring 'operator+=()' into scope
 
 #include <filesystem>
@@ -152,149 +156,247 @@ img_data_t SurfaceNode::read_png_or_dat(std::string filename) const
   return data;
 }
 
+namespace {
+
+// Parses one number of a DAT file, which has to span [begin, end)
+bool parse_value(const char *begin, const char *end, double& value)
+{
+  // from_chars doesn't accept a leading plus sign
+  if (begin != end && *begin == '+') ++begin;
+#ifdef __cpp_lib_to_chars
+  const auto result = std::from_chars(begin, end, value);
+  return result.ec == std::errc{} && result.ptr == end;
+#else
+  std::istringstream istr(std::string(begin, end));
+  istr.imbue(std::locale::classic());
+  istr >> value;
+  return !istr.fail() && istr.peek() == EOF;
+#endif
+}
+
+bool is_space(char c) { return c == ' ' || c == '\t' || c == '\r' || c == '\v' || c == '\f'; }
+
+}  // namespace
+
 img_data_t SurfaceNode::read_dat(std::string filename) const
 {
   img_data_t data;
-  std::ifstream stream(fs::u8path(filename));
+  const MappedFile file(filename);
 
-  if (!stream.good()) {
+  if (!file.isOpen()) {
     LOG(message_group::Warning, "Can't open DAT file '%1$s'.", filename);
     return data;
   }
 
-  int lines = 0, columns = 0;
+  size_t columns = 0;
   double min_val =
     1;  // this balances out with the (min_val-1) inside createGeometry, to match old behavior
 
-  using tokenizer = boost::tokenizer<boost::char_separator<char>>;
-  boost::char_separator<char> sep(" \t");
-
-  // We use an unordered map because the data file may not be rectangular,
-  // and we may need to fill in some bits.
-  using unordered_image_data_t =
-    std::unordered_map<std::pair<int, int>, double, boost::hash<std::pair<int, int>>>;
-  unordered_image_data_t unordered_data;
-
-  while (!stream.eof()) {
-    std::string line;
-    while (!stream.eof() && (line.size() == 0 || line[0] == '#')) {
-      std::getline(stream, line);
-      boost::trim(line);
+  // The rows may have different lengths, so they're collected first and padded afterwards
+  std::vector<double> values;
+  std::vector<size_t> row_start;
+
+  const char *p = file.data();
+  const char *const end = p + file.size();
+  while (p < end) {
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    const char *line_end = eol ? eol : end;
+    const char *next = eol ? eol + 1 : end;
+    while (p < line_end && is_space(*p)) ++p;
+    while (line_end > p && is_space(line_end[-1])) --line_end;
+    if (p == line_end || *p == '#') {
+      p = next;
+      continue;
     }
-    if (line.size() == 0 && stream.eof()) break;
-
-    int col = 0;
-    tokenizer tokens(line, sep);
-    try {
-      for (const auto& token : tokens) {
-        auto v = boost::lexical_cast<double>(token);
-        unordered_data[std::make_pair(lines, col++)] = v;
-        if (col > columns) columns = col;
-        min_val = std::min(v, min_val);
-      }
-    } catch (const boost::bad_lexical_cast& blc) {
-      if (!stream.eof()) {
-        LOG(message_group::Warning, "Illegal value in '%1$s': %2$s", filename, blc.what());
+
+    row_start.push_back(values.size());
+    while (p < line_end) {
+      const char *token_end = p;
+      while (token_end < line_end && *token_end != ' ' && *token_end != '\t') ++token_end;
+      double v;
+      if (!parse_value(p, token_end, v)) {
+        // An incomplete last line is ignored silently
+        if (eol) {
+          LOG(message_group::Warning, "Illegal value in '%1$s': %2$s", filename,
+              std::string(p, token_end));
+        }
+        return data;
       }
-      return data;
+      values.push_back(v);
+      min_val = std::min(v, min_val);
+      p = token_end;
+      while (p < line_end && (*p == ' ' || *p == '\t')) ++p;
     }
-
-    lines++;
+    columns = std::max(columns, values.size() - row_start.back());
+    p = next;
   }
 
+  const size_t lines = row_start.size();
   data.width = columns;
   data.height = lines;
   data.min_val = min_val;
 
-  // Now convert the unordered, possibly non-rectangular data into a well ordered vector
-  // for faster access and reduced memory usage.
-  data.resize((size_t)lines * columns);
-  for (int i = 0; i < lines; ++i)
-    for (int j = 0; j < columns; ++j) data[i * columns + j] = unordered_data[std::make_pair(i, j)];
+  // Copy the possibly non-rectangular rows into a well ordered vector, filling in zeros
+  data.resize(lines * columns);
+  for (size_t i = 0; i < lines; ++i) {
+    const size_t row_end = i + 1 < lines ? row_start[i + 1] : values.size();
+    std::copy(values.begin() + row_start[i], values.begin() + row_end,
+              data.storage.begin() + i * columns);
+  }
 
   return data;
 }
 
-// FIXME: Look for faster way to generate PolySet directly
-std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
-{
-  auto data = read_png_or_dat(filename);
-
-  int lines = data.height;
-  int columns = data.width;
-  double min_val = data.min_value() - 1;  // make the bottom solid, and match old code
+namespace {
 
-  // reserve the polygon vector size so we don't have to reallocate as often
-
-  double ox = center ? -(columns - 1) / 2.0 : 0;
-  double oy = center ? -(lines - 1) / 2.0 : 0;
-
-  int num_indices = (lines - 1) * (columns - 1) * 4 + (lines - 1) * 2 + (columns - 1) * 2 + 1;
-  PolySetBuilder builder(0, num_indices);
-  builder.setConvexity(convexity);
-  // the bulk of the heightmap
-  for (int i = 1; i < lines; ++i)
+/*!
+   Builds the mesh of a heightmap directly, without looking up vertices. Every value is a vertex
+   at its grid point, and every cell has a vertex at its center, both with implicit indices.
+   Each cell is four triangles around its center. The sides and the bottom, which is one unit
+   below the lowest value, close the mesh.
+ */
+std::unique_ptr<PolySet> create_heightmap(const img_data_t& data, bool center, int convexity)
+{
+  const int lines = data.height;
+  const int columns = data.width;
+  if (lines * columns <= 1) return PolySet::createEmpty();
+  const double min_val = data.min_value() - 1;  // make the bottom solid, and match old code
+
+  const double ox = center ? -(columns - 1) / 2.0 : 0;
+  const double oy = center ? -(lines - 1) / 2.0 : 0;
+  const auto height = [&](int x, int y) { return data[x + y * columns]; };
+  const auto top = [&](int x, int y) { return x + y * columns; };
+
+  auto ps = PolySet::createEmpty();
+  ps->setConvexity(convexity);
+  const int cells = (lines - 1) * (columns - 1);
+  const int first_center = lines * columns;
+  ps->vertices.resize(first_center + cells);
+
+  // The bulk of the heightmap, row by row
+  std::vector<int> indices(size_t(cells) * 12);
+  parallelizable_for(0, lines, [&](size_t row) {
+    const int i = static_cast<int>(row);
+    for (int j = 0; j < columns; ++j) {
+      ps->vertices[top(j, i)] = Vector3d(ox + j, oy + i, height(j, i));
+    }
+    if (i == 0) return;
     for (int j = 1; j < columns; ++j) {
-      double v1 = data[(j - 1) + (i - 1) * columns];
-      double v2 = data[(j) + (i - 1) * columns];
-      double v3 = data[(j - 1) + (i)*columns];
-      double v4 = data[(j) + (i)*columns];
-
-      double vx = (v1 + v2 + v3 + v4) / 4;
-
-      builder.appendPolygon({Vector3d(ox + j - 1, oy + i - 1, v1), Vector3d(ox + j, oy + i - 1, v2),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j, oy + i - 1, v2), Vector3d(ox + j, oy + i, v4),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j, oy + i, v4), Vector3d(ox + j - 1, oy + i, v3),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
-
-      builder.appendPolygon({Vector3d(ox + j - 1, oy + i, v3), Vector3d(ox + j - 1, oy + i - 1, v1),
-                             Vector3d(ox + j - 0.5, oy + i - 0.5, vx)});
+      const int cell = (i - 1) * (columns - 1) + (j - 1);
+      const int c = first_center + cell;
+      const double vx = (height(j - 1, i - 1) + height(j, i - 1) + height(j - 1, i) + height(j, i)) / 4;
+      ps->vertices[c] = Vector3d(ox + j - 0.5, oy + i - 0.5, vx);
+
+      const int v1 = top(j - 1, i - 1), v2 = top(j, i - 1), v3 = top(j - 1, i), v4 = top(j, i);
+      int *tri = &indices[size_t(cell) * 12];
+      for (const int v : {v1, v2, c, v2, v4, c, v4, v3, c, v3, v1, c}) *tri++ = v;
+    }
+  });
+
+  // Vertices of the bottom are created along the perimeter as they're used. A value which
+  // equals the bottom height shares its vertex, as the vertex lookup used to do.
+  const bool has_bottom = lines > 1 && columns > 1;
+  const auto perimeter_position = [&](int x, int y) {
+    if (!has_bottom) return x + y;
+    if (x == 0) return y;
+    if (y == lines - 1) return (lines - 1) + x;
+    if (x == columns - 1) return (lines - 1) + (columns - 1) + (lines - 1 - y);
+    return 2 * (lines - 1) + (columns - 1) + (columns - 1 - x);
+  };
+  std::vector<int> bottom_vertices(has_bottom ? 2 * (lines - 1) + 2 * (columns - 1) : lines + columns,
+                                   -1);
+  const auto bottom = [&](int x, int y) {
+    if (height(x, y) == min_val) return top(x, y);
+    int& index = bottom_vertices[perimeter_position(x, y)];
+    if (index < 0) {
+      index = static_cast<int>(ps->vertices.size());
+      ps->vertices.emplace_back(ox + x, oy + y, min_val);
     }
+    return index;
+  };
+  // Side quads are split in two triangles. Where a corner is shared, only one of them remains.
+  const auto add_triangle = [&](int a, int b, int c) {
+    if (a != b && b != c && c != a) indices.insert(indices.end(), {a, b, c});
+  };
+  const auto add_quad = [&](int a, int b, int c, int d) {
+    add_triangle(a, b, c);
+    add_triangle(a, c, d);
+  };
 
   // edges along Y
   for (int i = 1; i < lines; ++i) {
-    double v1 = data[(0) + (i - 1) * columns];
-    double v2 = data[(0) + (i)*columns];
-    double v3 = data[(columns - 1) + (i - 1) * columns];
-    double v4 = data[(columns - 1) + (i)*columns];
-
-    builder.appendPolygon({Vector3d(ox + 0, oy + i - 1, min_val), Vector3d(ox + 0, oy + i - 1, v1),
-                           Vector3d(ox + 0, oy + i, v2), Vector3d(ox + 0, oy + i, min_val)});
-
-    builder.appendPolygon(
-      {Vector3d(ox + columns - 1, oy + i, min_val), Vector3d(ox + columns - 1, oy + i, v4),
-       Vector3d(ox + columns - 1, oy + i - 1, v3), Vector3d(ox + columns - 1, oy + i - 1, min_val)});
+    add_quad(bottom(0, i - 1), top(0, i - 1), top(0, i), bottom(0, i));
+    add_quad(bottom(columns - 1, i), top(columns - 1, i), top(columns - 1, i - 1),
+             bottom(columns - 1, i - 1));
   }
 
   // edges along X
   for (int i = 1; i < columns; ++i) {
-    double v1 = data[(i - 1) + (0) * columns];
-    double v2 = data[(i) + (0) * columns];
-    double v3 = data[(i - 1) + (lines - 1) * columns];
-    double v4 = data[(i) + (lines - 1) * columns];
-
-    builder.appendPolygon({Vector3d(ox + i, oy + 0, min_val), Vector3d(ox + i, oy + 0, v2),
-                           Vector3d(ox + i - 1, oy + 0, v1), Vector3d(ox + i - 1, oy + 0, min_val)});
-
-    builder.appendPolygon(
-      {Vector3d(ox + i - 1, oy + lines - 1, min_val), Vector3d(ox + i - 1, oy + lines - 1, v3),
-       Vector3d(ox + i, oy + lines - 1, v4), Vector3d(ox + i, oy + lines - 1, min_val)});
+    add_quad(bottom(i, 0), top(i, 0), top(i - 1, 0), bottom(i - 1, 0));
+    add_quad(bottom(i - 1, lines - 1), top(i - 1, lines - 1), top(i, lines - 1),
+             bottom(i, lines - 1));
   }
 
-  // the bottom of the shape (one less than the real minimum value), making it a solid volume
-  if (columns > 1 && lines > 1) {
-    builder.beginPolygon(2 * (columns - 1) + 2 * (lines - 1));
-    for (int i = 0; i < lines - 1; ++i) builder.addVertex(Vector3d(ox + 0, oy + i, min_val));
-    for (int i = 0; i < columns - 1; ++i) builder.addVertex(Vector3d(ox + i, oy + lines - 1, min_val));
-    for (int i = lines - 1; i > 0; i--) builder.addVertex(Vector3d(ox + columns - 1, oy + i, min_val));
-    for (int i = columns - 1; i > 0; i--) builder.addVertex(Vector3d(ox + i, oy + 0, min_val));
+  // The bottom of the shape, making it a solid volume. The points on its edges are
+  // triangulated without degenerate triangles: the left and right edges are fans from a point
+  // on the opposite side, and a strip connects the front and back edges in between.
+  if (has_bottom) {
+    for (int i = 0; i < lines - 1; ++i) {
+      add_triangle(bottom(1, 0), bottom(0, i), bottom(0, i + 1));
+      add_triangle(bottom(columns - 2, lines - 1), bottom(columns - 1, i + 1), bottom(columns - 1, i));
+    }
+    for (int i = 1; i < columns - 1; ++i) {
+      add_triangle(bottom(i, 0), bottom(i - 1, lines - 1), bottom(i, lines - 1));
+      add_triangle(bottom(i, 0), bottom(i, lines - 1), bottom(i + 1, 0));
+    }
   }
 
-  return builder.build();
+  ps->indices.appendTriangles(indices.begin(), indices.end());
+  ps->setTriangular(true);
+  return ps;
+}
+
+}  // namespace
+
+std::unique_ptr<PolySet> SurfaceNode::createPolySet() const
+{
+  // The image is cached, so surface() calls of the same file only read it once
+  auto read = [this]() -> std::shared_ptr<const img_data_t> {
+    auto data = std::make_shared<img_data_t>(read_png_or_dat(filename));
+    return data->storage.empty() ? nullptr : data;
+  };
+  const auto cached =
+    ImportCache::instance()->get<img_data_t>(filename, invert ? "surface-inverted" : "surface", read);
+  static const img_data_t no_data;
+  const img_data_t& data = cached ? *cached : no_data;
+
+  return create_heightmap(data, center, convexity);
+}
+
+std::unique_ptr<const Geometry> SurfaceNode::createGeometry() const
+{
+  return createPolySet();
+}
+
+/*!
+   With the Manifold backend, CSG operands get the heightmap as a ManifoldGeometry, built directly
+   from its triangles. If that fails, the PolySet is returned, so it isn't built again.
+ */
+std::unique_ptr<const Geometry> SurfaceNode::createNativeGeometry() const
+{
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D != RenderBackend3D::ManifoldBackend) return nullptr;
+  auto ps = createPolySet();
+  if (!ps->isEmpty()) {
+    if (auto mani = ManifoldUtils::createManifoldFromTriangles(ps->vertices, ps->indices)) {
+      mani->setConvexity(convexity);
+      return mani;
+    }
+  }
+  return ps;
+#else
+  return nullptr;
+#endif
 }
 
 std::string SurfaceNode::toString() const
@@ -56,8 +56,12 @@ public:
   void resize(size_t x) { storage.resize(x); }
 
   storage_type& operator[](int x) { return storage[x]; }
+  const storage_type& operator[](int x) const { return storage[x]; }
 
-  storage_type min_value() { return min_val; }  // *std::min_element(storage.begin(), storage.end());
+  // *std::min_element(storage.begin(), storage.end());
+  storage_type min_value() const { return min_val; }
+
+  size_t memsize() const { return storage.capacity() * sizeof(storage_type) + sizeof(img_data_t); }
 
 public:
   unsigned int height;  // rows
@@ -80,8 +84,10 @@ public:
   int convexity{1};
 
   std::unique_ptr<const Geometry> createGeometry() const override;
+  std::unique_ptr<const Geometry> createNativeGeometry() const override;
 
 private:
+  std::unique_ptr<class PolySet> createPolySet() const;
   void convert_image(img_data_t& data, std::vector<uint8_t>& img, unsigned int width,
                      unsigned int height) const;
   bool is_png(std::vector<uint8_t>& img) const;
@@ -38,6 +38,7 @@
 #include "core/AST.h"
 #include "core/ModuleInstantiation.h"
 #include "core/progress.h"
+#include "geometry/Geometry.h"
 
 size_t AbstractNode::idx_counter;
 
@@ -157,16 +158,20 @@ std::string AbstractIntersectionNode::name() const
   return "intersection";
 }
 
-void AbstractNode::progress_prepare()
+void AbstractNode::progress_prepare(int& count)
 {
-  std::for_each(this->children.begin(), this->children.end(),
-                std::mem_fn(&AbstractNode::progress_prepare));
-  this->progress_mark = ++progress_report_count;
+  for (const auto& child : this->children) child->progress_prepare(count);
+  this->progress_mark = ++count;
 }
 
-void AbstractNode::progress_report() const
+void AbstractNode::progress_report(ProgressSink *sink) const
 {
-  progress_update(shared_from_this(), this->progress_mark);
+  progress_update(shared_from_this(), this->progress_mark, sink);
+}
+
+std::unique_ptr<const Geometry> LeafNode::createNativeGeometry() const
+{
+  return nullptr;
 }
 
 std::ostream& operator<<(std::ostream& stream, const AbstractNode& node)
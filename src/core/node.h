@@ -12,14 +12,7 @@
 #include "core/BaseVisitable.h"
 #include "core/ModuleInstantiation.h"
 
-extern int progress_report_count;
-extern void (*progress_report_f)(const std::shared_ptr<const AbstractNode>&, void *, int);
-extern void *progress_report_vp;
-
-void progress_report_prep(const std::shared_ptr<AbstractNode>& root,
-                          void (*f)(const std::shared_ptr<const AbstractNode>& node, void *vp, int mark),
-                          void *vp);
-void progress_report_fin();
+class ProgressSink;
 
 /*!
 
@@ -60,8 +53,10 @@ public:
   // progress_mark is a running number used for progress indication
   // FIXME: Make all progress handling external, put it in the traverser class?
   int progress_mark{0};
-  void progress_prepare();
-  void progress_report() const;
+  // Numbers this node and its descendants in post-order, continuing from count
+  void progress_prepare(int& count);
+  // Reports to the given sink, or to the current one of the calling thread
+  void progress_report(ProgressSink *sink = nullptr) const;
 
   int idx;  // Node index (unique per tree)
 
@@ -147,6 +142,9 @@ public:
   VISITABLE();
   LeafNode(const ModuleInstantiation *mi) : AbstractPolyNode(mi) {}
   virtual std::unique_ptr<const class Geometry> createGeometry() const = 0;
+  // Returns the geometry in the native representation of the active 3D backend, for use as a
+  // direct CSG operand. Returns nullptr if the node can't do better than converting createGeometry().
+  virtual std::unique_ptr<const class Geometry> createNativeGeometry() const;
 };
 
 std::ostream& operator<<(std::ostream& stream, const AbstractNode& node);
@@ -33,8 +33,10 @@
 #include <cstddef>
 #include <iterator>
 #include <memory>
+#include <mutex>
 #include <sstream>
 #include <string>
+#include <unordered_map>
 #include <utility>
 #include <vector>
 
@@ -49,19 +51,224 @@
 #include "geometry/PolySet.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
+#include "glview/RenderSettings.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
 #include "utils/printutils.h"
+#ifdef ENABLE_MANIFOLD
+#include <cstdint>
+#include <set>
+
+#include "geometry/manifold/ManifoldGeometry.h"
+#include "geometry/manifold/manifoldutils.h"
+#endif
 
 using namespace boost::assign;  // bring 'operator+=()' into scope
 
-template <class InsertIterator>
-static void generate_circle(InsertIterator iter, double r, double z, int fragments)
+namespace {
+
+/**
+ * Returns the unit circle (cos(phi), sin(phi)) for the given number of fragments.
+ * Circles, cylinders and spheres scale these, so the trigonometry is only evaluated
+ * once per fragment count.
+ */
+// Nodes are evaluated from worker threads as well, so the template caches are locked. Templates
+// are built outside the lock; a thread losing the race to insert just uses the stored one.
+std::mutex template_cache_mutex;
+std::unordered_map<int, std::shared_ptr<const VectorOfVector2d>> circle_cache;
+
+std::shared_ptr<const VectorOfVector2d> unit_circle(int fragments)
 {
+  {
+    const std::lock_guard<std::mutex> lock(template_cache_mutex);
+    auto it = circle_cache.find(fragments);
+    if (it != circle_cache.end()) return it->second;
+  }
+  auto vertices = std::make_shared<VectorOfVector2d>();
+  vertices->reserve(fragments);
   for (int i = 0; i < fragments; ++i) {
     double phi = (360.0 * i) / fragments;
-    *(iter++) = {r * cos_degrees(phi), r * sin_degrees(phi), z};
+    vertices->emplace_back(cos_degrees(phi), sin_degrees(phi));
+  }
+  const std::lock_guard<std::mutex> lock(template_cache_mutex);
+  return circle_cache.emplace(fragments, std::move(vertices)).first->second;
+}
+
+// Sphere topology and ring placement, which only depend on the number of fragments
+struct UnitSphere {
+  VectorOfVector2d rings;  // (sin(phi), cos(phi)) for each ring
+  PolygonIndices indices;
+};
+
+std::unordered_map<int, std::shared_ptr<const UnitSphere>> sphere_cache;
+
+std::shared_ptr<const UnitSphere> unit_sphere(int num_fragments)
+{
+  {
+    const std::lock_guard<std::mutex> lock(template_cache_mutex);
+    auto it = sphere_cache.find(num_fragments);
+    if (it != sphere_cache.end()) return it->second;
+  }
+
+  auto sphere = std::make_shared<UnitSphere>();
+  auto num_rings = (num_fragments + 1) / 2;
+  // Uncomment the following three lines to enable experimental sphere
+  // tessellation
+  //  if (num_rings % 2 == 0) num_rings++; // To ensure that the middle ring is at
+  //  phi == 0 degrees
+
+  // double offset = 0.5 * ((fragments / 2) % 2);
+  for (auto i = 0; i < num_rings; ++i) {
+    //                double phi = (180.0 * (i + offset)) / (fragments/2);
+    const double phi = (180.0 * (i + 0.5)) / num_rings;
+    sphere->rings.emplace_back(sin_degrees(phi), cos_degrees(phi));
+  }
+
+  auto& indices = sphere->indices;
+  IndexedFace cap;
+  for (int i = 0; i < num_fragments; ++i) {
+    cap.push_back(i);
+  }
+  indices.push_back(cap);
+
+  for (auto i = 0; i < num_rings - 1; ++i) {
+    for (auto r = 0; r < num_fragments; ++r) {
+      indices.push_back({
+        i * num_fragments + (r + 1) % num_fragments,
+        i * num_fragments + r,
+        (i + 1) * num_fragments + r,
+        (i + 1) * num_fragments + (r + 1) % num_fragments,
+      });
+    }
+  }
+
+  cap.clear();
+  for (int i = 0; i < num_fragments; ++i) {
+    cap.push_back(num_rings * num_fragments - i - 1);
+  }
+  indices.push_back(cap);
+
+  const std::lock_guard<std::mutex> lock(template_cache_mutex);
+  return sphere_cache.emplace(num_fragments, std::move(sphere)).first->second;
+}
+
+template <class InsertIterator>
+void generate_circle(InsertIterator iter, double r, double z, const VectorOfVector2d& circle)
+{
+  for (const auto& v : circle) {
+    *(iter++) = {r * v[0], r * v[1], z};
+  }
+}
+
+std::unique_ptr<PolySet> create_sphere(double r, int num_fragments)
+{
+  const auto sphere = unit_sphere(num_fragments);
+  const auto circle = unit_circle(num_fragments);
+
+  auto polyset = std::make_unique<PolySet>(3, /*convex*/ true);
+  polyset->vertices.reserve(sphere->rings.size() * num_fragments);
+  for (const auto& ring : sphere->rings) {
+    // Scales the unit sphere, like instances of the native unit sphere, so both have the same vertices
+    for (const auto& v : *circle) {
+      polyset->vertices.emplace_back(r * (ring[0] * v[0]), r * (ring[0] * v[1]), r * ring[1]);
+    }
+  }
+  polyset->indices = sphere->indices;
+  return polyset;
+}
+
+std::unique_ptr<PolySet> create_cylinder(double r1, double r2, double z1, double z2, int num_fragments)
+{
+  const auto circle = unit_circle(num_fragments);
+  bool cone = (r2 == 0.0);
+  bool inverted_cone = (r1 == 0.0);
+
+  auto polyset = std::make_unique<PolySet>(3, /*convex*/ true);
+  polyset->vertices.reserve((cone || inverted_cone) ? num_fragments + 1 : 2 * num_fragments);
+
+  if (inverted_cone) {
+    polyset->vertices.emplace_back(0.0, 0.0, z1);
+  } else {
+    generate_circle(std::back_inserter(polyset->vertices), r1, z1, *circle);
+  }
+  if (cone) {
+    polyset->vertices.emplace_back(0.0, 0.0, z2);
+  } else {
+    generate_circle(std::back_inserter(polyset->vertices), r2, z2, *circle);
+  }
+
+  for (int i = 0; i < num_fragments; ++i) {
+    int j = (i + 1) % num_fragments;
+    if (cone) polyset->indices.push_back({i, j, num_fragments});
+    else if (inverted_cone) polyset->indices.push_back({0, j + 1, i + 1});
+    else polyset->indices.push_back({i, j, j + num_fragments, i + num_fragments});
+  }
+
+  IndexedFace cap;
+  if (!inverted_cone) {
+    for (int i = 0; i < num_fragments; ++i) {
+      cap.push_back(num_fragments - i - 1);
+    }
+    polyset->indices.push_back(cap);
+  }
+  if (!cone) {
+    cap.clear();
+    int offset = inverted_cone ? 1 : num_fragments;
+    for (int i = 0; i < num_fragments; ++i) {
+      cap.push_back(offset + i);
+    }
+    polyset->indices.push_back(cap);
   }
+
+  return polyset;
+}
+
+#ifdef ENABLE_MANIFOLD
+/**
+ * Returns a shared Manifold for the unit sphere, or the unit cylinder (r = 1, z from 0 to 1),
+ * with the given number of fragments. Instances are created by transforming these, which
+ * avoids repeatedly tessellating and validating identical meshes.
+ */
+std::unordered_map<int, manifold::Manifold> sphere_manifold_cache;
+std::unordered_map<int, manifold::Manifold> cylinder_manifold_cache;
+
+manifold::Manifold unit_manifold(bool sphere, int fragments)
+{
+  auto& cache = sphere ? sphere_manifold_cache : cylinder_manifold_cache;
+  {
+    const std::lock_guard<std::mutex> lock(template_cache_mutex);
+    auto it = cache.find(fragments);
+    if (it != cache.end()) return it->second;
+  }
+  const auto ps =
+    sphere ? create_sphere(1.0, fragments) : create_cylinder(1.0, 1.0, 0.0, 1.0, fragments);
+  auto mani = ManifoldUtils::createManifoldFromPolySet(*ps)->getManifold();
+  const std::lock_guard<std::mutex> lock(template_cache_mutex);
+  return cache.emplace(fragments, std::move(mani)).first->second;
+}
+
+// Each instance needs its own original ID, so it can be colored independently.
+std::unique_ptr<const Geometry> instantiate_manifold(const manifold::Manifold& unit,
+                                                     const manifold::vec3& scale,
+                                                     const manifold::vec3& translation)
+{
+  auto mani = unit.Scale(scale).Translate(translation).AsOriginal();
+  const auto id = static_cast<uint32_t>(mani.OriginalID());
+  return std::make_unique<ManifoldGeometry>(mani, std::set<uint32_t>{id});
+}
+#endif  // ENABLE_MANIFOLD
+
+}  // namespace
+
+void clearPrimitiveCaches()
+{
+  const std::lock_guard<std::mutex> lock(template_cache_mutex);
+  circle_cache.clear();
+  sphere_cache.clear();
+#ifdef ENABLE_MANIFOLD
+  sphere_manifold_cache.clear();
+  cylinder_manifold_cache.clear();
+#endif
 }
 
 /**
@@ -181,45 +388,19 @@ std::unique_ptr<const Geometry> SphereNode::createGeometry() const
   }
 
   int num_fragments = discretizer.getCircularSegmentCount(r).value_or(3);
-  auto num_rings = (num_fragments + 1) / 2;
-  // Uncomment the following three lines to enable experimental sphere
-  // tessellation
-  //  if (num_rings % 2 == 0) num_rings++; // To ensure that the middle ring is at
-  //  phi == 0 degrees
-
-  auto polyset = std::make_unique<PolySet>(3, /*convex*/ true);
-  polyset->vertices.reserve(num_rings * num_fragments);
-
-  // double offset = 0.5 * ((fragments / 2) % 2);
-  for (auto i = 0; i < num_rings; ++i) {
-    //                double phi = (180.0 * (i + offset)) / (fragments/2);
-    const double phi = (180.0 * (i + 0.5)) / num_rings;
-    const double radius = r * sin_degrees(phi);
-    generate_circle(std::back_inserter(polyset->vertices), radius, r * cos_degrees(phi), num_fragments);
-  }
-
-  polyset->indices.push_back({});
-  for (int i = 0; i < num_fragments; ++i) {
-    polyset->indices.back().push_back(i);
-  }
-
-  for (auto i = 0; i < num_rings - 1; ++i) {
-    for (auto r = 0; r < num_fragments; ++r) {
-      polyset->indices.push_back({
-        i * num_fragments + (r + 1) % num_fragments,
-        i * num_fragments + r,
-        (i + 1) * num_fragments + r,
-        (i + 1) * num_fragments + (r + 1) % num_fragments,
-      });
-    }
-  }
-
-  polyset->indices.push_back({});
-  for (int i = 0; i < num_fragments; ++i) {
-    polyset->indices.back().push_back(num_rings * num_fragments - i - 1);
-  }
+  return create_sphere(r, num_fragments);
+}
 
-  return polyset;
+std::unique_ptr<const Geometry> SphereNode::createNativeGeometry() const
+{
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend && this->r > 0 &&
+      std::isfinite(this->r)) {
+    int num_fragments = discretizer.getCircularSegmentCount(r).value_or(3);
+    return instantiate_manifold(unit_manifold(true, num_fragments), {r, r, r}, {0, 0, 0});
+  }
+#endif
+  return nullptr;
 }
 
 static std::shared_ptr<AbstractNode> builtin_sphere(const ModuleInstantiation *inst, Arguments arguments)
@@ -266,45 +447,21 @@ std::unique_ptr<const Geometry> CylinderNode::createGeometry() const
     z2 = this->h;
   }
 
-  bool cone = (r2 == 0.0);
-  bool inverted_cone = (r1 == 0.0);
-
-  auto polyset = std::make_unique<PolySet>(3, /*convex*/ true);
-  polyset->vertices.reserve((cone || inverted_cone) ? num_fragments + 1 : 2 * num_fragments);
-
-  if (inverted_cone) {
-    polyset->vertices.emplace_back(0.0, 0.0, z1);
-  } else {
-    generate_circle(std::back_inserter(polyset->vertices), r1, z1, num_fragments);
-  }
-  if (cone) {
-    polyset->vertices.emplace_back(0.0, 0.0, z2);
-  } else {
-    generate_circle(std::back_inserter(polyset->vertices), r2, z2, num_fragments);
-  }
-
-  for (int i = 0; i < num_fragments; ++i) {
-    int j = (i + 1) % num_fragments;
-    if (cone) polyset->indices.push_back({i, j, num_fragments});
-    else if (inverted_cone) polyset->indices.push_back({0, j + 1, i + 1});
-    else polyset->indices.push_back({i, j, j + num_fragments, i + num_fragments});
-  }
-
-  if (!inverted_cone) {
-    polyset->indices.push_back({});
-    for (int i = 0; i < num_fragments; ++i) {
-      polyset->indices.back().push_back(num_fragments - i - 1);
-    }
-  }
-  if (!cone) {
-    polyset->indices.push_back({});
-    int offset = inverted_cone ? 1 : num_fragments;
-    for (int i = 0; i < num_fragments; ++i) {
-      polyset->indices.back().push_back(offset + i);
-    }
-  }
+  return create_cylinder(r1, r2, z1, z2, num_fragments);
+}
 
-  return polyset;
+std::unique_ptr<const Geometry> CylinderNode::createNativeGeometry() const
+{
+#ifdef ENABLE_MANIFOLD
+  // Only straight cylinders are a scaled version of the unit cylinder
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend && this->r1 == this->r2 &&
+      this->r1 > 0 && std::isfinite(this->r1) && this->h > 0 && std::isfinite(this->h)) {
+    int num_fragments = discretizer.getCircularSegmentCount(this->r1).value_or(3);
+    return instantiate_manifold(unit_manifold(false, num_fragments), {r1, r1, h},
+                                {0, 0, this->center ? -this->h / 2 : 0});
+  }
+#endif
+  return nullptr;
 }
 
 static std::shared_ptr<AbstractNode> builtin_cylinder(const ModuleInstantiation *inst,
@@ -402,14 +559,10 @@ std::unique_ptr<const Geometry> PolyhedronNode::createGeometry() const
   p->setConvexity(this->convexity);
   p->vertices = this->points;
   p->indices = this->faces;
-  bool is_triangular = true;
-  for (auto& poly : p->indices) {
+  for (auto&& poly : p->indices) {
     std::reverse(poly.begin(), poly.end());
-    if (is_triangular && poly.size() > 3) {
-      is_triangular = false;
-    }
   }
-  p->setTriangular(is_triangular);
+  p->setTriangular(p->indices.allTriangles());
   return p;
 }
 
@@ -554,11 +707,11 @@ std::unique_ptr<const Geometry> CircleNode::createGeometry() const
   }
 
   int num_fragments = discretizer.getCircularSegmentCount(this->r).value_or(3);
+  const auto circle = unit_circle(num_fragments);
   Outline2d o;
-  o.vertices.resize(num_fragments);
-  for (int i = 0; i < num_fragments; ++i) {
-    double phi = (360.0 * i) / num_fragments;
-    o.vertices[i] = {this->r * cos_degrees(phi), this->r * sin_degrees(phi)};
+  o.vertices.reserve(num_fragments);
+  for (const auto& v : *circle) {
+    o.vertices.emplace_back(this->r * v[0], this->r * v[1]);
   }
   return std::make_unique<Polygon2d>(o);
 }
@@ -66,6 +66,7 @@ public:
   std::string toString() const override;
   std::string name() const override { return "sphere"; }
   std::unique_ptr<const Geometry> createGeometry() const override;
+  std::unique_ptr<const Geometry> createNativeGeometry() const override;
 
   CurveDiscretizer discretizer;
   double r = 1;
@@ -81,6 +82,7 @@ public:
   std::string toString() const override;
   std::string name() const override { return "cylinder"; }
   std::unique_ptr<const Geometry> createGeometry() const override;
+  std::unique_ptr<const Geometry> createNativeGeometry() const override;
 
   CurveDiscretizer discretizer;
   double r1 = 1, r2 = 1, h = 1;
@@ -145,3 +147,6 @@ public:
   std::vector<std::vector<size_t>> paths;
   int convexity = 1;
 };
+
+// Drops the unit circle, sphere and cylinder templates shared by the primitives
+void clearPrimitiveCaches();
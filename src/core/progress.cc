@@ -1,42 +1,87 @@
 #include "core/progress.h"
 
+#include <chrono>
 #include <memory>
 
 #include "core/node.h"
 
-int progress_report_count;
-int progress_mark_;
-void (*progress_report_f)(const std::shared_ptr<const AbstractNode>&, void *, int);
-void *progress_report_userdata;
+namespace {
 
-void progress_report_prep(const std::shared_ptr<AbstractNode>& root,
-                          void (*f)(const std::shared_ptr<const AbstractNode>& node, void *userdata,
-                                    int mark),
-                          void *userdata)
+thread_local ProgressSink *current_sink = nullptr;
+
+}  // namespace
+
+void ProgressSink::prepare(const std::shared_ptr<AbstractNode>& root)
 {
-  progress_report_count = 0;
-  progress_report_f = f;
-  progress_report_userdata = userdata;
-  root->progress_prepare();
+  int count = 0;
+  root->progress_prepare(count);
+  this->total_count = count;
+  this->mark = 0;
 }
 
-void progress_report_fin()
+void ProgressSink::report(const std::shared_ptr<const AbstractNode>& node, int mark)
 {
-  progress_report_count = 0;
-  progress_report_f = nullptr;
-  progress_report_userdata = nullptr;
+  this->mark = mark;
+  if (this->report_f) this->report_f(node, mark);
+  checkCancelled();
 }
 
-void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark)
+void ProgressSink::tick()
 {
-  if (progress_report_f) {
-    progress_mark_ = mark;
-    progress_report_f(node, progress_report_userdata, progress_mark_);
+  const int mark = ++this->mark;
+  if (this->report_f) this->report_f(std::shared_ptr<const AbstractNode>(), mark);
+  checkCancelled();
+}
+
+void ProgressSink::setTimeLimit(std::chrono::milliseconds limit)
+{
+  if (limit.count() <= 0) {
+    this->deadline = 0;
+  } else {
+    this->deadline = (std::chrono::steady_clock::now() + limit).time_since_epoch().count();
   }
 }
 
-void progress_tick()
+bool ProgressSink::timedOut() const
+{
+  const auto deadline = this->deadline.load();
+  return deadline != 0 && std::chrono::steady_clock::now().time_since_epoch().count() >= deadline;
+}
+
+void ProgressSink::checkCancelled() const
+{
+  if (isCancelled()) throw ProgressCancelException();
+}
+
+ProgressSink *ProgressSink::current()
+{
+  return current_sink;
+}
+
+ProgressSink::Scope::Scope(ProgressSink *sink) : previous(current_sink)
+{
+  current_sink = sink;
+}
+
+ProgressSink::Scope::~Scope()
+{
+  current_sink = this->previous;
+}
+
+void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark, ProgressSink *sink)
+{
+  if (!sink) sink = ProgressSink::current();
+  if (sink) sink->report(node, mark);
+}
+
+void progress_tick(ProgressSink *sink)
+{
+  if (!sink) sink = ProgressSink::current();
+  if (sink) sink->tick();
+}
+
+void progress_check_cancel(ProgressSink *sink)
 {
-  if (progress_report_f)
-    progress_report_f(std::shared_ptr<const AbstractNode>(), progress_report_userdata, ++progress_mark_);
+  if (!sink) sink = ProgressSink::current();
+  if (sink) sink->checkCancelled();
 }
@@ -1,24 +1,86 @@
 #pragma once
 
+#include <atomic>
+#include <chrono>
+#include <functional>
 #include <memory>
+#include <utility>
 
 class AbstractNode;
 
-// Reset to 0 in _prep() and increased for each Node instance in progress_prepare()
-extern int progress_report_count;
-
-extern void (*progress_report_f)(const std::shared_ptr<const AbstractNode>&, void *, int);
-extern void *progress_report_userdata;
-
-void progress_report_prep(const std::shared_ptr<AbstractNode>& root,
-                          void (*f)(const std::shared_ptr<const AbstractNode>& node, void *userdata,
-                                    int mark),
-                          void *userdata);
-void progress_report_fin();
-void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark);
-// CGALUtils::applyUnion3D may process nodes out of order, so allow for an increment instead of tracking
-// exact node
-void progress_tick();
+/*!
+   Progress reporting and cancellation of one evaluation.
+
+   Evaluation code reports progress through AbstractNode::progress_report() and
+   progress_tick(), which go to the sink made current for the calling thread by a
+   ProgressSink::Scope. Evaluations on different threads can thus use separate sinks.
+   Code which may run on worker threads, like the CGAL and Manifold operations, is given the
+   sink explicitly and passes it on instead.
+
+   Cancellation is cooperative: cancel() or an expired time limit makes the next progress
+   report or progress_check_cancel() on the evaluating thread throw ProgressCancelException.
+ */
+class ProgressSink
+{
+public:
+  using ReportFunction = std::function<void(const std::shared_ptr<const AbstractNode>& node, int mark)>;
+
+  ProgressSink(ReportFunction report = nullptr) : report_f(std::move(report)) {}
+  // Not thread safe, set it before evaluation starts
+  void setReportFunction(ReportFunction report) { this->report_f = std::move(report); }
+
+  // Numbers the nodes of the tree for progress reporting
+  void prepare(const std::shared_ptr<AbstractNode>& root);
+  // Number of nodes numbered by prepare()
+  [[nodiscard]] int total() const { return this->total_count; }
+  // Progress mark of the last report
+  [[nodiscard]] int current_mark() const { return this->mark; }
+
+  void report(const std::shared_ptr<const AbstractNode>& node, int mark);
+  // CGALUtils::applyUnion3D may process nodes out of order, so allow for an increment instead of
+  // tracking exact node
+  void tick();
+
+  // May be called from any thread
+  void cancel() { this->cancelled = true; }
+  // Cancel once the given time has passed from now. 0 means no limit.
+  void setTimeLimit(std::chrono::milliseconds limit);
+  [[nodiscard]] bool timedOut() const;
+  [[nodiscard]] bool isCancelled() const { return this->cancelled || timedOut(); }
+  // Throws ProgressCancelException if cancelled or timed out
+  void checkCancelled() const;
+
+  // The sink of the evaluation running on the calling thread, if any
+  [[nodiscard]] static ProgressSink *current();
+
+  // Makes a sink current for the calling thread for its lifetime
+  class Scope
+  {
+  public:
+    Scope(ProgressSink *sink);
+    ~Scope();
+    Scope(const Scope&) = delete;
+    Scope& operator=(const Scope&) = delete;
+
+  private:
+    ProgressSink *previous;
+  };
+
+private:
+  ReportFunction report_f;
+  std::atomic<int> total_count{0};
+  std::atomic<int> mark{0};
+  std::atomic<bool> cancelled{false};
+  // steady_clock time in ticks, or 0 if there is no time limit
+  std::atomic<std::chrono::steady_clock::rep> deadline{0};
+};
+
+// These forward to the given sink, or to the current sink of the calling thread, if any
+void progress_update(const std::shared_ptr<const AbstractNode>& node, int mark,
+                     ProgressSink *sink = nullptr);
+void progress_tick(ProgressSink *sink = nullptr);
+// Lets long-running operations which don't report progress be cancelled
+void progress_check_cancel(ProgressSink *sink = nullptr);
 
 class ProgressCancelException
 {
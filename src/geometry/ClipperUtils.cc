@@ -6,13 +6,18 @@
 #include <cassert>
 #include <cmath>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
+#include <queue>
 #include <utility>
 #include <vector>
 
 #include "clipper2/clipper.h"
+#include "geometry/GeometryUtils.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 namespace ClipperUtils {
@@ -176,15 +181,11 @@ std::unique_ptr<Polygon2d> sanitize(const Polygon2d& poly)
   return toPolygon2d(*sanitize(paths), scale_bits);
 }
 
-/*!
-   We want to use a PolyTree to convert to Polygon2d, since only PolyTrees
-   have an explicit notion of holes.
-   We could use a Paths structure, but we'd have to check the orientation of each
-   path before adding it to the Polygon2d.
- */
-std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree, int scale_bits)
+namespace {
+
+// Adds the outline of the given PolyTree node and of all its descendants to result
+void appendPolyPath(const Clipper2Lib::PolyPath64& node, int scale_bits, Polygon2d& result)
 {
-  auto result = std::make_unique<Polygon2d>();
   const double scale = std::ldexp(1.0, -scale_bits);
   auto processChildren = [scale, &result](auto&& processChildren,
                                           const Clipper2Lib::PolyPath64& node) -> void {
@@ -201,19 +202,128 @@ std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree,
       for (const auto& ip : cleaned_path) {
         outline.vertices.emplace_back(scale * ip.x, scale * ip.y);
       }
-      result->addOutline(outline);
+      result.addOutline(outline);
     }
     for (const auto& child : node) {
       processChildren(processChildren, *child);
     }
   };
+  processChildren(processChildren, node);
+}
+
+}  // namespace
+
+/*!
+   We want to use a PolyTree to convert to Polygon2d, since only PolyTrees
+   have an explicit notion of holes.
+   We could use a Paths structure, but we'd have to check the orientation of each
+   path before adding it to the Polygon2d.
+ */
+std::unique_ptr<Polygon2d> toPolygon2d(const Clipper2Lib::PolyTree64& polytree, int scale_bits)
+{
+  auto result = std::make_unique<Polygon2d>();
   for (const auto& node : polytree) {
-    processChildren(processChildren, *node);
+    appendPolyPath(*node, scale_bits, *result);
+  }
+  result->setSanitized(true);
+  return result;
+}
+
+namespace {
+
+/*!
+   Where Clipper2 would put a top-level polygon in its output, relative to polygons elsewhere.
+
+   Clipper2 sweeps from the largest y coordinate downwards and numbers output polygons in the order
+   their first local minimum is reached, with ties at the same y broken by increasing x. When
+   polygons merge, the lower number survives. Top-level polygons are therefore ordered by their
+   largest y, then by the smallest x on that bottom line.
+ */
+struct SweepOrder {
+  int64_t bottom_y;
+  int64_t bottom_x;
+
+  explicit SweepOrder(const Clipper2Lib::Path64& path)
+    : bottom_y(std::numeric_limits<int64_t>::min()), bottom_x(std::numeric_limits<int64_t>::max())
+  {
+    for (const auto& pt : path) {
+      if (pt.y > bottom_y || (pt.y == bottom_y && pt.x < bottom_x)) {
+        bottom_y = pt.y;
+        bottom_x = pt.x;
+      }
+    }
+  }
+  bool operator<(const SweepOrder& other) const
+  {
+    return bottom_y > other.bottom_y || (bottom_y == other.bottom_y && bottom_x < other.bottom_x);
+  }
+};
+
+/*!
+   Union the given paths, splitting the work into independent sweeps where possible.
+
+   Operands are grouped into clusters of overlapping bounding rectangles. Each cluster is unioned
+   separately (concurrently if parallelism is available). Outlines from different clusters can
+   neither intersect nor contain each other, so no further sweep is needed: the top-level polygons
+   of all clusters are merged in the order a single sweep would have output them, which keeps the
+   result identical to the unclustered union.
+
+   Returns nullptr if all operands overlap, in which case a single sweep is needed anyway.
+ */
+std::unique_ptr<Polygon2d> applyClusteredUnion(const std::vector<Clipper2Lib::Paths64>& pathsvector,
+                                               int scale_bits)
+{
+  std::vector<const Clipper2Lib::Paths64 *> operands;
+  std::vector<BoundingBox> bounds;
+  for (const auto& paths : pathsvector) {
+    if (paths.empty()) continue;
+    const auto rect = Clipper2Lib::GetBounds(paths);
+    operands.push_back(&paths);
+    // Rounding to double is monotonic, so disjoint rectangles never become overlapping
+    bounds.emplace_back(Vector3d(rect.left, rect.top, 0), Vector3d(rect.right, rect.bottom, 0));
+  }
+  const auto clusters = GeometryUtils::clusterOverlappingBoundingBoxes(bounds);
+  if (clusters.size() <= 1) return nullptr;
+
+  std::vector<std::unique_ptr<Clipper2Lib::PolyTree64>> parts(clusters.size());
+  parallelizable_transform(clusters.begin(), clusters.end(), parts.begin(),
+                           [&](const std::vector<size_t>& cluster) {
+                             Clipper2Lib::Clipper64 clipper;
+                             clipper.PreserveCollinear(false);
+                             clipper.AddSubject(*operands[cluster.front()]);
+                             for (size_t i = 1; i < cluster.size(); ++i) {
+                               clipper.AddClip(*operands[cluster[i]]);
+                             }
+                             auto result = std::make_unique<Clipper2Lib::PolyTree64>();
+                             clipper.Execute(Clipper2Lib::ClipType::Union,
+                                             Clipper2Lib::FillRule::NonZero, *result);
+                             return result;
+                           });
+
+  // Merge the top-level polygons of all clusters. Each cluster's polygons are already in sweep
+  // order, so only the next polygon of each cluster has to be compared.
+  using Head = std::pair<SweepOrder, size_t>;  // order of the cluster's next polygon, cluster
+  auto later = [](const Head& a, const Head& b) {
+    return b.first < a.first || (!(a.first < b.first) && a.second > b.second);
+  };
+  std::priority_queue<Head, std::vector<Head>, decltype(later)> heads(later);
+  std::vector<size_t> next(parts.size(), 0);
+  for (size_t i = 0; i < parts.size(); ++i) {
+    if (parts[i]->Count() > 0) heads.emplace(SweepOrder((*parts[i])[0]->Polygon()), i);
+  }
+  auto result = std::make_unique<Polygon2d>();
+  while (!heads.empty()) {
+    const size_t i = heads.top().second;
+    heads.pop();
+    appendPolyPath(*(*parts[i])[next[i]], scale_bits, *result);
+    if (++next[i] < parts[i]->Count()) heads.emplace(SweepOrder((*parts[i])[next[i]]->Polygon()), i);
   }
   result->setSanitized(true);
   return result;
 }
 
+}  // namespace
+
 /*!
    Apply the clipper operator to the given paths.
 
@@ -241,6 +351,10 @@ std::unique_ptr<Polygon2d> apply(const std::vector<Clipper2Lib::Paths64>& pathsv
     return ClipperUtils::toPolygon2d(result, scale_bits);
   }
 
+  if (clipType == Clipper2Lib::ClipType::Union && pathsvector.size() >= 2) {
+    if (auto result = applyClusteredUnion(pathsvector, scale_bits)) return result;
+  }
+
   bool first = true;
   for (const auto& paths : pathsvector) {
     if (first) {
@@ -0,0 +1,91 @@
+#include "geometry/ClipperUtils.h"
+
+#include <algorithm>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <initializer_list>
+#include <memory>
+#include <utility>
+#include <vector>
+
+#include "clipper2/clipper.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+using Polygons = std::vector<std::shared_ptr<const Polygon2d>>;
+
+// Unsanitized polygon, like the ones polygon() creates. Nested outlines are holes.
+std::shared_ptr<const Polygon2d> polygon(std::initializer_list<VectorOfVector2d> outlines)
+{
+  auto result = std::make_shared<Polygon2d>();
+  for (const auto& vertices : outlines) {
+    Outline2d outline;
+    outline.vertices = vertices;
+    result->addOutline(std::move(outline));
+  }
+  return result;
+}
+
+VectorOfVector2d square(double x, double y, double size)
+{
+  return {{x, y}, {x + size, y}, {x + size, y + size}, {x, y + size}};
+}
+
+// The union of all operands in one Clipper2 sweep, which is what the clustered union has to match
+std::unique_ptr<Polygon2d> singleSweepUnion(const Polygons& polygons)
+{
+  const int scale_bits = ClipperUtils::scaleBitsFromPrecision();
+  Clipper2Lib::Clipper64 clipper;
+  clipper.PreserveCollinear(false);
+  bool first = true;
+  for (const auto& polygon : polygons) {
+    const auto paths = Clipper2Lib::PolyTreeToPaths64(
+      *ClipperUtils::sanitize(ClipperUtils::fromPolygon2d(*polygon, scale_bits)));
+    if (first) clipper.AddSubject(paths);
+    else clipper.AddClip(paths);
+    first = false;
+  }
+  Clipper2Lib::PolyTree64 result;
+  clipper.Execute(Clipper2Lib::ClipType::Union, Clipper2Lib::FillRule::NonZero, result);
+  return ClipperUtils::toPolygon2d(result, scale_bits);
+}
+
+void requireSameOutlines(const Polygon2d& actual, const Polygon2d& expected)
+{
+  REQUIRE(actual.outlines().size() == expected.outlines().size());
+  for (size_t i = 0; i < actual.outlines().size(); ++i) {
+    CHECK(actual.outlines()[i].positive == expected.outlines()[i].positive);
+    CHECK(actual.outlines()[i].vertices == expected.outlines()[i].vertices);
+  }
+}
+
+}  // namespace
+
+TEST_CASE("Clustered 2D union matches a single sweep", "[ClipperUtils]")
+{
+  // Operands of different clusters are interleaved
+  Polygons polygons = {
+    // Two overlapping squares
+    polygon({square(0, 0, 10)}),
+    // A square with a hole, and an island in the hole
+    polygon({square(30, 0, 20), square(35, 5, 10)}),
+    polygon({square(5, 5, 10)}),
+    polygon({square(38, 8, 4)}),
+    // Lone squares level with the first cluster, and a triangle above it
+    polygon({square(100, 0, 10)}),
+    polygon({square(70, 0, 10)}),
+    polygon({{{0, 40}, {10, 40}, {5, 45}}}),
+    // Two triangles which only touch in a point
+    polygon({{{60, 40}, {70, 40}, {65, 45}}}),
+    polygon({{{70, 40}, {80, 40}, {75, 45}}}),
+  };
+
+  for (size_t i = 0; i < polygons.size(); ++i) {
+    const auto clustered = ClipperUtils::apply(polygons, Clipper2Lib::ClipType::Union);
+    const auto expected = singleSweepUnion(polygons);
+    requireSameOutlines(*clustered, *expected);
+    std::rotate(polygons.begin(), polygons.begin() + 1, polygons.end());
+  }
+}
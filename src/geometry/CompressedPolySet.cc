@@ -0,0 +1,286 @@
+#include "geometry/CompressedPolySet.h"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <memory>
+#include <vector>
+
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+void putVarint(std::vector<uint8_t>& out, uint64_t v)
+{
+  while (v >= 0x80) {
+    out.push_back(static_cast<uint8_t>(v) | 0x80);
+    v >>= 7;
+  }
+  out.push_back(static_cast<uint8_t>(v));
+}
+
+// Maps small negative deltas to small varints
+void putSignedVarint(std::vector<uint8_t>& out, int64_t v)
+{
+  putVarint(out, (static_cast<uint64_t>(v) << 1) ^ static_cast<uint64_t>(v >> 63));
+}
+
+uint64_t doubleBits(double d)
+{
+  uint64_t b;
+  std::memcpy(&b, &d, sizeof(b));
+  return b;
+}
+
+/*
+   Stores the XOR of a coordinate with the previous one. Nearby or repeated coordinates share
+   their high bytes, and coordinates with short binary fractions have zero low bytes, so only
+   the bytes in between are written, preceded by a byte holding the number of zero high bytes
+   and zero low bytes.
+ */
+void putXoredDouble(std::vector<uint8_t>& out, uint64_t x)
+{
+  int high = 0, low = 0;
+  if (x == 0) {
+    high = 8;
+  } else {
+    while (!(x >> (56 - 8 * high) & 0xff)) high++;
+    while (!(x >> (8 * low) & 0xff)) low++;
+  }
+  out.push_back(static_cast<uint8_t>(high << 4 | low));
+  for (int i = low; i < 8 - high; ++i) out.push_back(static_cast<uint8_t>(x >> (8 * i)));
+}
+
+class ByteReader
+{
+public:
+  ByteReader(const std::vector<uint8_t>& data) : p(data.data()), end(data.data() + data.size()) {}
+
+  uint8_t byte()
+  {
+    assert(p < end);
+    return *p++;
+  }
+  uint64_t varint()
+  {
+    uint64_t v = 0;
+    for (int shift = 0;; shift += 7) {
+      const uint8_t b = byte();
+      v |= static_cast<uint64_t>(b & 0x7f) << shift;
+      if (!(b & 0x80)) return v;
+    }
+  }
+  int64_t signedVarint()
+  {
+    const uint64_t v = varint();
+    return static_cast<int64_t>(v >> 1) ^ -static_cast<int64_t>(v & 1);
+  }
+  uint64_t xoredDouble()
+  {
+    const uint8_t header = byte();
+    const int high = header >> 4, low = header & 0xf;
+    uint64_t x = 0;
+    for (int i = low; i < 8 - high; ++i) x |= static_cast<uint64_t>(byte()) << (8 * i);
+    return x;
+  }
+  void bytes(void *dest, size_t n)
+  {
+    assert(p + n <= end);
+    std::memcpy(dest, p, n);
+    p += n;
+  }
+
+private:
+  const uint8_t *p;
+  const uint8_t *end;
+};
+
+/*
+   LZ77 compression of a byte buffer. The output is a sequence of literal runs, each followed
+   by a back reference (length, distance) into the already decompressed data. Matches are found
+   through a hash table of the most recent position of each 4 byte sequence.
+ */
+std::vector<uint8_t> lzCompress(const std::vector<uint8_t>& in)
+{
+  constexpr int hash_bits = 14;
+  constexpr size_t min_match = 4;
+  constexpr uint32_t no_pos = UINT32_MAX;
+  std::vector<uint32_t> table(size_t(1) << hash_bits, no_pos);
+  std::vector<uint8_t> out;
+  out.reserve(in.size() / 2);
+
+  const size_t n = in.size();
+  size_t anchor = 0;
+  size_t i = 0;
+  while (i + min_match <= n) {
+    uint32_t seq;
+    std::memcpy(&seq, &in[i], sizeof(seq));
+    const uint32_t h = (seq * 2654435761u) >> (32 - hash_bits);
+    const uint32_t candidate = table[h];
+    table[h] = static_cast<uint32_t>(i);
+    if (candidate == no_pos || std::memcmp(&in[candidate], &in[i], min_match) != 0) {
+      ++i;
+      continue;
+    }
+    size_t len = min_match;
+    while (i + len < n && in[candidate + len] == in[i + len]) ++len;
+    putVarint(out, i - anchor);
+    out.insert(out.end(), in.begin() + anchor, in.begin() + i);
+    putVarint(out, len);
+    putVarint(out, i - candidate);
+    i += len;
+    anchor = i;
+  }
+  // Trailing literals, terminated by an empty match
+  putVarint(out, n - anchor);
+  out.insert(out.end(), in.begin() + anchor, in.end());
+  putVarint(out, 0);
+  out.shrink_to_fit();
+  return out;
+}
+
+std::vector<uint8_t> lzDecompress(const std::vector<uint8_t>& in, size_t raw_size)
+{
+  std::vector<uint8_t> out(raw_size);
+  ByteReader reader(in);
+  size_t pos = 0;
+  while (pos < raw_size) {
+    const size_t literals = reader.varint();
+    assert(pos + literals <= raw_size);
+    reader.bytes(&out[pos], literals);
+    pos += literals;
+    const size_t len = reader.varint();
+    if (len == 0) break;
+    const size_t distance = reader.varint();
+    assert(distance <= pos && pos + len <= raw_size);
+    // Byte by byte, as the match may overlap the bytes it produces
+    for (size_t i = 0; i < len; ++i, ++pos) out[pos] = out[pos - distance];
+  }
+  assert(pos == raw_size);
+  return out;
+}
+
+uint8_t encodeTribool(boost::tribool b)
+{
+  return b ? 1 : !b ? 0 : 2;
+}
+
+boost::tribool decodeTribool(uint8_t b)
+{
+  return b == 2 ? boost::tribool(boost::indeterminate) : boost::tribool(b == 1);
+}
+
+}  // namespace
+
+std::unique_ptr<CompressedPolySet> CompressedPolySet::compress(const PolySet& ps)
+{
+  std::vector<uint8_t> raw;
+  raw.reserve(ps.vertices.size() * 12 + ps.indices.numIndices() * 2 + 64);
+
+  putVarint(raw, ps.getDimension());
+  putVarint(raw, ps.getConvexity());
+  raw.push_back(encodeTribool(ps.convexValue()));
+  raw.push_back(static_cast<uint8_t>(ps.isTriangular() | ps.isManifold() << 1));
+
+  putVarint(raw, ps.vertices.size());
+  uint64_t prev[3] = {0, 0, 0};
+  for (const auto& v : ps.vertices) {
+    for (int i = 0; i < 3; ++i) {
+      const uint64_t bits = doubleBits(v[i]);
+      putXoredDouble(raw, bits ^ prev[i]);
+      prev[i] = bits;
+    }
+  }
+
+  putVarint(raw, ps.indices.size());
+  putVarint(raw, ps.indices.numIndices());
+  raw.push_back(ps.indices.allTriangles());
+  if (!ps.indices.allTriangles()) {
+    for (const auto& face : ps.indices) putVarint(raw, face.size());
+  }
+  int prev_index = 0;
+  for (const int index : ps.indices.indexData()) {
+    putSignedVarint(raw, int64_t(index) - prev_index);
+    prev_index = index;
+  }
+
+  putVarint(raw, ps.colors.size());
+  for (const auto& color : ps.colors) {
+    const Vector4f rgba = color.toVector4f();
+    const auto *bytes = reinterpret_cast<const uint8_t *>(rgba.data());
+    raw.insert(raw.end(), bytes, bytes + sizeof(float) * 4);
+  }
+  putVarint(raw, ps.color_indices.size());
+  int32_t prev_color = 0;
+  for (const int32_t color_index : ps.color_indices) {
+    putSignedVarint(raw, int64_t(color_index) - prev_color);
+    prev_color = color_index;
+  }
+
+  auto compressed = std::make_unique<CompressedPolySet>();
+  compressed->data = lzCompress(raw);
+  compressed->raw_size = raw.size();
+  return compressed;
+}
+
+std::unique_ptr<PolySet> CompressedPolySet::decompress() const
+{
+  const std::vector<uint8_t> raw = lzDecompress(this->data, this->raw_size);
+  ByteReader reader(raw);
+
+  const auto dim = static_cast<unsigned int>(reader.varint());
+  const auto convexity = static_cast<int>(reader.varint());
+  const boost::tribool convex = decodeTribool(reader.byte());
+  const uint8_t flags = reader.byte();
+  auto ps = std::make_unique<PolySet>(dim, convex);
+  ps->setConvexity(convexity);
+  ps->setTriangular(flags & 1);
+  ps->setManifold(flags & 2);
+
+  ps->vertices.resize(reader.varint());
+  uint64_t prev[3] = {0, 0, 0};
+  for (auto& v : ps->vertices) {
+    for (int i = 0; i < 3; ++i) {
+      prev[i] ^= reader.xoredDouble();
+      std::memcpy(&v[i], &prev[i], sizeof(double));
+    }
+  }
+
+  const size_t num_faces = reader.varint();
+  const size_t num_indices = reader.varint();
+  const bool all_triangles = reader.byte();
+  std::vector<size_t> face_sizes;
+  if (!all_triangles) {
+    face_sizes.resize(num_faces);
+    for (auto& size : face_sizes) size = reader.varint();
+  }
+  std::vector<int> indices(num_indices);
+  int prev_index = 0;
+  for (auto& index : indices) {
+    index = static_cast<int>(prev_index + reader.signedVarint());
+    prev_index = index;
+  }
+  ps->indices.reserve(num_faces, num_indices);
+  auto face_begin = indices.begin();
+  for (size_t i = 0; i < num_faces; ++i) {
+    const size_t size = all_triangles ? 3 : face_sizes[i];
+    ps->indices.append(face_begin, face_begin + size);
+    face_begin += size;
+  }
+
+  ps->colors.resize(reader.varint());
+  for (auto& color : ps->colors) {
+    Vector4f rgba;
+    reader.bytes(rgba.data(), sizeof(float) * 4);
+    color = Color4f(rgba);
+  }
+  ps->color_indices.resize(reader.varint());
+  int32_t prev_color = 0;
+  for (auto& color_index : ps->color_indices) {
+    color_index = static_cast<int32_t>(prev_color + reader.signedVarint());
+    prev_color = color_index;
+  }
+  return ps;
+}
@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+class PolySet;
+
+/*!
+   A PolySet packed into a compact byte buffer, for keeping geometry around which isn't
+   currently in use.
+
+   The encoding is lossless: vertex coordinates are XORed with the previous vertex and only
+   their significant bytes are stored, face indices are delta and varint encoded, and the
+   result is compressed with a simple LZ77 scheme. Decompressing gives a PolySet identical
+   to the original.
+ */
+class CompressedPolySet
+{
+public:
+  static std::unique_ptr<CompressedPolySet> compress(const PolySet& ps);
+  [[nodiscard]] std::unique_ptr<PolySet> decompress() const;
+
+  [[nodiscard]] size_t memsize() const { return data.capacity() + sizeof(CompressedPolySet); }
+
+private:
+  std::vector<uint8_t> data;
+  size_t raw_size{0};
+};
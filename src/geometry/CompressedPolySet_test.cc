@@ -0,0 +1,128 @@
+#include "geometry/CompressedPolySet.h"
+
+#include <boost/logic/tribool.hpp>
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <memory>
+#include <vector>
+
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+// Compares coordinates bit for bit, so -0.0 doesn't pass for 0.0
+std::vector<uint64_t> vertexBits(const PolySet& ps)
+{
+  std::vector<uint64_t> bits;
+  for (const auto& v : ps.vertices) {
+    for (int i = 0; i < 3; ++i) {
+      uint64_t b;
+      std::memcpy(&b, &v[i], sizeof(b));
+      bits.push_back(b);
+    }
+  }
+  return bits;
+}
+
+std::vector<IndexedFace> faces(const PolySet& ps) { return {ps.indices.begin(), ps.indices.end()}; }
+
+std::unique_ptr<PolySet> roundTrip(const PolySet& ps)
+{
+  auto decompressed = CompressedPolySet::compress(ps)->decompress();
+  REQUIRE(decompressed);
+  CHECK(decompressed->getDimension() == ps.getDimension());
+  CHECK(decompressed->getConvexity() == ps.getConvexity());
+  CHECK(decompressed->isTriangular() == ps.isTriangular());
+  CHECK(decompressed->isManifold() == ps.isManifold());
+  CHECK(vertexBits(*decompressed) == vertexBits(ps));
+  CHECK(decompressed->indices.allTriangles() == ps.indices.allTriangles());
+  CHECK(faces(*decompressed) == faces(ps));
+  CHECK(decompressed->colors == ps.colors);
+  CHECK(decompressed->color_indices == ps.color_indices);
+  return decompressed;
+}
+
+}  // namespace
+
+TEST_CASE("CompressedPolySet round trip of an empty mesh", "[CompressedPolySet]")
+{
+  SECTION("3D")
+  {
+    PolySet ps(3);
+    const auto decompressed = roundTrip(ps);
+    CHECK(decompressed->isEmpty());
+  }
+  SECTION("2D, convex")
+  {
+    PolySet ps(2, true);
+    const auto decompressed = roundTrip(ps);
+    CHECK(bool(decompressed->convexValue()));
+  }
+}
+
+TEST_CASE("CompressedPolySet round trip of triangles", "[CompressedPolySet]")
+{
+  PolySet ps(3, boost::indeterminate);
+  ps.setConvexity(7);
+  ps.vertices = {{0, 0, 0}, {1, 0, 0}, {0, 1, 0}, {0, 0, 1}};
+  ps.indices = {{0, 2, 1}, {0, 1, 3}, {0, 3, 2}, {1, 2, 3}};
+  ps.setTriangular(true);
+  ps.setManifold(true);
+  const auto decompressed = roundTrip(ps);
+  CHECK(boost::indeterminate(decompressed->convexValue()));
+}
+
+TEST_CASE("CompressedPolySet round trip of mixed faces and colors", "[CompressedPolySet]")
+{
+  PolySet ps(3);
+  ps.vertices = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0}, {0.5, 0.5, 1}};
+  ps.indices = {{0, 3, 2, 1}, {0, 1, 4}, {1, 2, 4}, {2, 3, 4}, {3, 0, 4}, {4, 4}};
+  ps.colors = {Color4f(1.0f, 0.0f, 0.0f, 1.0f), Color4f(0.25f, 0.5f, 0.75f, 0.125f), Color4f()};
+  ps.color_indices = {0, -1, 1, 2, 1, -1};
+  roundTrip(ps);
+}
+
+TEST_CASE("CompressedPolySet round trip of extreme values", "[CompressedPolySet]")
+{
+  using limits = std::numeric_limits<double>;
+  PolySet ps(3);
+  ps.vertices = {
+    {-0.0, 0.0, -0.0},
+    {limits::max(), limits::lowest(), limits::min()},
+    {limits::denorm_min(), -limits::denorm_min(), limits::epsilon()},
+    {limits::infinity(), -limits::infinity(), 1e-300},
+    {0.1, -0.1, 1.0 / 3.0},
+  };
+  // Large jumps between indices, as the indices are delta encoded
+  constexpr int max_int = std::numeric_limits<int>::max();
+  ps.indices = {{0, max_int, 1}, {max_int, 0, max_int - 1}};
+  using float_limits = std::numeric_limits<float>;
+  ps.colors = {Color4f(-0.0f, float_limits::max(), float_limits::denorm_min(), float_limits::lowest())};
+  ps.color_indices = {std::numeric_limits<int32_t>::max(), std::numeric_limits<int32_t>::min()};
+  roundTrip(ps);
+}
+
+TEST_CASE("CompressedPolySet round trip of a large mesh", "[CompressedPolySet]")
+{
+  // A grid of quads repeats most bytes, so this covers long and overlapping back references
+  constexpr int n = 100;
+  PolySet ps(3);
+  for (int y = 0; y <= n; ++y) {
+    for (int x = 0; x <= n; ++x) ps.vertices.emplace_back(x * 0.1, y * 0.1, (x + y) % 3);
+  }
+  for (int y = 0; y < n; ++y) {
+    for (int x = 0; x < n; ++x) {
+      const int i = y * (n + 1) + x;
+      ps.indices.push_back({i, i + 1, i + n + 2, i + n + 1});
+    }
+  }
+  ps.colors = {Color4f(1.0f, 1.0f, 0.0f, 1.0f)};
+  ps.color_indices.assign(ps.indices.size(), 0);
+
+  const auto compressed = CompressedPolySet::compress(ps);
+  CHECK(compressed->memsize() < ps.memsize());
+  roundTrip(ps);
+}
@@ -2,64 +2,217 @@
 
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <utility>
+#include <vector>
 
+#include "geometry/CompressedPolySet.h"
 #include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
 #include "utils/printutils.h"
 
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/CGALNefGeometry.h"
 #endif
 
-GeometryCache *GeometryCache::inst = nullptr;
+namespace {
 
-std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id) const
+// Smaller entries aren't worth compacting
+constexpr size_t min_compaction_size = 16 * 1024;
+
+}  // namespace
+
+GeometryCache::~GeometryCache()
+{
+  {
+    std::lock_guard<std::mutex> lock(this->mutex);
+    this->stopping = true;
+  }
+  this->compaction_cv.notify_all();
+  if (this->compaction_thread.joinable()) this->compaction_thread.join();
+}
+
+bool GeometryCache::contains(const std::string& id) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->cache.contains(id);
+}
+
+std::shared_ptr<const Geometry> GeometryCache::get(const std::string& id)
 {
-  const auto& geom = this->cache[id]->geom;
+  std::unique_lock<std::mutex> lock(this->mutex);
+  auto *entry = this->cache[id];
+  if (!entry) return nullptr;
+  std::shared_ptr<const Geometry> geom = entry->geom;
+  if (!geom && entry->compressed) {
+    // Decompress without holding the mutex, as compact() compresses, so other lookups and the
+    // compaction thread aren't blocked meanwhile
+    const std::shared_ptr<const CompressedPolySet> compressed = entry->compressed;
+    lock.unlock();
+    geom = compressed->decompress();
+    lock.lock();
+
+    auto *current = this->cache.peek(id);
+    if (current && current->compressed == compressed) {
+      current->geom = geom;
+      current->compressed.reset();
+      // May trim the cache, so current must not be used after this
+      this->cache.setCost(id, geom->memsize());
+      requestCompaction();
+    } else if (current && current->geom) {
+      // Decompressed by another lookup or replaced in the meantime, so share that geometry
+      geom = current->geom;
+    }
+  } else if (geom) {
+    // Geometry may have grown since it was cached, e.g. by the PolySet ManifoldGeometry keeps
+    this->cache.setCost(id, geom->memsize());
+  }
 #ifdef DEBUG
   PRINTDB("Geometry Cache hit: %s (%d bytes)", id.substr(0, 40) % (geom ? geom->memsize() : 0));
 #endif
   return geom;
 }
 
-bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
+bool GeometryCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+                           size_t culled_operands)
 {
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom ? geom->memsize() : 0);
+  std::lock_guard<std::mutex> lock(this->mutex);
+  auto inserted =
+    this->cache.insert(id, new cache_entry(geom, culled_operands), geom ? geom->memsize() : 0);
 #if defined(ENABLE_CGAL) && defined(DEBUG)
   assert(!dynamic_cast<const CGALNefGeometry *>(geom.get()));
   LOG("Geometry Cache %1$s: %2$s (%3$d bytes)", inserted ? "inserted" : "insert failed",
       id.substr(0, 40), geom ? geom->memsize() : 0);
 #endif
+  if (inserted) requestCompaction();
   return inserted;
 }
 
+size_t GeometryCache::culledOperands(const std::string& id) const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  const auto *entry = this->cache.peek(id);
+  return entry ? entry->culled_operands : 0;
+}
+
 size_t GeometryCache::size() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.size();
 }
 
 size_t GeometryCache::totalCost() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return cache.totalCost();
 }
 
 size_t GeometryCache::maxSizeMB() const
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   return this->cache.maxCost() / (1024ul * 1024ul);
 }
 
 void GeometryCache::setMaxSizeMB(size_t limit)
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   this->cache.setMaxCost(limit * 1024ul * 1024ul);
 }
 
+void GeometryCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->cache.clear();
+}
+
 void GeometryCache::print()
 {
+  std::lock_guard<std::mutex> lock(this->mutex);
   LOG("Geometries in cache: %1$d", this->cache.size());
   LOG("Geometry cache size in bytes: %1$d", this->cache.totalCost());
 }
 
-GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom) : geom(geom)
+// Must be called with the mutex locked
+void GeometryCache::requestCompaction()
+{
+  if (this->cache.totalCost() <= this->cache.maxCost() / 2) return;
+  this->compaction_requested = true;
+  if (!this->compaction_thread.joinable()) {
+    this->compaction_thread = std::thread([this]() { compactionLoop(); });
+  }
+  this->compaction_cv.notify_one();
+}
+
+void GeometryCache::compactionLoop()
+{
+  std::unique_lock<std::mutex> lock(this->mutex);
+  while (true) {
+    this->compaction_cv.wait(lock, [this]() { return this->stopping || this->compaction_requested; });
+    if (this->stopping) return;
+    this->compaction_requested = false;
+    for (const auto& id : compactionCandidates()) {
+      compact(id, lock);
+      if (this->stopping) return;
+    }
+  }
+}
+
+/*!
+   Returns the ids of the PolySets to compact, least recently used first. The most recently used
+   entries, up to half of the memory limit, are kept as they are. Entries which are also
+   referenced outside of the cache are skipped, as compacting them wouldn't free any memory.
+ */
+std::vector<std::string> GeometryCache::compactionCandidates() const
+{
+  std::vector<std::string> ids;
+  size_t recent_cost = 0;
+  this->cache.forEach([&](const std::string& id, const cache_entry& entry, size_t cost) {
+    if (recent_cost <= this->cache.maxCost() / 2) {
+      recent_cost += cost;
+      return;
+    }
+    if (entry.geom && !entry.incompressible && cost >= min_compaction_size &&
+        entry.geom.use_count() == 1 && dynamic_cast<const PolySet *>(entry.geom.get())) {
+      ids.push_back(id);
+    }
+  });
+  return {ids.rbegin(), ids.rend()};
+}
+
+// Must be called with the mutex locked. The mutex is released while compressing, so the cache
+// stays usable. The result is dropped if the entry was used or replaced in the meantime.
+void GeometryCache::compact(const std::string& id, std::unique_lock<std::mutex>& lock)
+{
+  const auto *entry = this->cache.peek(id);
+  if (!entry || !entry->geom || entry->geom.use_count() != 1) return;
+  const auto geom = std::dynamic_pointer_cast<const PolySet>(entry->geom);
+  if (!geom) return;
+
+  lock.unlock();
+  auto compressed = CompressedPolySet::compress(*geom);
+  lock.lock();
+
+  auto *current = this->cache.peek(id);
+  // Held by the entry and by geom only, so nobody got it from the cache while compressing
+  if (!current || current->geom != geom || geom.use_count() != 2) return;
+  if (compressed->memsize() >= geom->memsize()) {
+    current->incompressible = true;
+    return;
+  }
+  const size_t cost = compressed->memsize();
+  current->compressed = std::move(compressed);
+  current->geom.reset();
+  // May trim the cache, so current must not be used after this
+  this->cache.setCost(id, cost);
+}
+
+GeometryCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& geom,
+                                        size_t culled_operands)
+  : geom(geom), culled_operands(culled_operands)
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
+
+GeometryCache::cache_entry::~cache_entry() = default;
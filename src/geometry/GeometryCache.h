@@ -1,41 +1,74 @@
 #pragma once
 
+#include <condition_variable>
 #include <cstddef>
 #include <memory>
+#include <mutex>
 #include <string>
+#include <thread>
+#include <vector>
 
 #include "Cache.h"
 #include "geometry/Geometry.h"
 
+class CompressedPolySet;
+
+/*!
+   Caches evaluated geometry by node id, up to a memory limit.
+
+   PolySets which haven't been used recently are compacted into a CompressedPolySet by a
+   background thread, so that the memory limit holds more geometry before anything is evicted.
+   They are transparently decompressed when requested again. Other geometry, like Manifold
+   results, is kept as it is.
+ */
 class GeometryCache
 {
 public:
   GeometryCache(size_t memorylimit = 100ul * 1024ul * 1024ul) : cache(memorylimit) {}
+  ~GeometryCache();
 
+  // Static storage, so the compaction thread is stopped and joined at exit
   static GeometryCache *instance()
   {
-    if (!inst) inst = new GeometryCache;
-    return inst;
+    static GeometryCache inst;
+    return &inst;
   }
 
-  bool contains(const std::string& id) const { return this->cache.contains(id); }
-  std::shared_ptr<const class Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom);
+  bool contains(const std::string& id) const;
+  std::shared_ptr<const class Geometry> get(const std::string& id);
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+              size_t culled_operands = 0);
+  size_t culledOperands(const std::string& id) const;
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
   void setMaxSizeMB(size_t limit);
-  void clear() { cache.clear(); }
+  void clear();
   void print();
 
 private:
-  static GeometryCache *inst;
-
   struct cache_entry {
     std::shared_ptr<const class Geometry> geom;
+    // Set instead of geom once the entry has been compacted. Shared, so get() can decompress it
+    // without holding the mutex.
+    std::shared_ptr<const CompressedPolySet> compressed;
+    bool incompressible{false};
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& geom);
+    // Boolean operands culled while evaluating the subtree, for the render statistics
+    size_t culled_operands;
+    cache_entry(const std::shared_ptr<const Geometry>& geom, size_t culled_operands);
+    ~cache_entry();
   };
 
+  void requestCompaction();
+  void compactionLoop();
+  std::vector<std::string> compactionCandidates() const;
+  void compact(const std::string& id, std::unique_lock<std::mutex>& lock);
+
   Cache<std::string, cache_entry> cache;
+  mutable std::mutex mutex;
+  std::condition_variable compaction_cv;
+  bool compaction_requested{false};
+  bool stopping{false};
+  std::thread compaction_thread;
 };
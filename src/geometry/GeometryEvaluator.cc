@@ -27,6 +27,7 @@
 #include "core/Tree.h"
 #include "core/enums.h"
 #include "core/node.h"
+#include "core/progress.h"
 #include "geometry/ClipperUtils.h"
 #include "geometry/Geometry.h"
 #include "geometry/GeometryCache.h"
@@ -78,8 +79,17 @@ GeometryEvaluator::GeometryEvaluator(const Tree& tree) : tree(tree)
 std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const AbstractNode& node,
                                                                     bool allownef)
 {
+  if (!this->progress) this->progress = ProgressSink::current();
+  const ProgressSink::Scope progress_scope(this->progress);
+  this->culled_operands.clear();
+  this->total_culled_operands = 0;
   auto result = smartCacheGet(node, allownef);
   if (!result) {
+    if (this->partial_result_observer) {
+      this->top_level_parents.clear();
+      this->reported_nodes.clear();
+      findTopLevelParents(node);
+    }
     // If not found in any caches, we need to evaluate the geometry
     // traverse() will set this->root to a geometry, which can be any geometry
     // (including GeometryList if the lazyunions feature is enabled)
@@ -112,6 +122,18 @@ std::shared_ptr<const Geometry> GeometryEvaluator::evaluateGeometry(const Abstra
   return result;
 }
 
+void GeometryEvaluator::findTopLevelParents(const AbstractNode& node)
+{
+  const AbstractNode *parent = &node;
+  while (dynamic_cast<const GroupNode *>(parent) && parent->getChildren().size() == 1) {
+    parent = parent->getChildren().front().get();
+  }
+  this->top_level_parents.insert(parent);
+  for (const auto& child : parent->getChildren()) {
+    if (dynamic_cast<const ListNode *>(child.get())) findTopLevelParents(*child);
+  }
+}
+
 bool GeometryEvaluator::isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const
 {
   if (!item.first->modinst->isBackground() && item.second) {
@@ -159,7 +181,7 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
   }
 
   // Only one child -> this is a noop
-  if (children.size() == 1) return ResultObject::constResult(children.front().second);
+  if (children.size() == 1) return ResultObject::constResult(passThroughGeometry(children.front()));
 
   switch (op) {
   case OpenSCADOperator::MINKOWSKI: {
@@ -168,8 +190,10 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
       if (item.second && !item.second->isEmpty()) actualchildren.push_back(item);
     }
     if (actualchildren.empty()) return {};
-    if (actualchildren.size() == 1) return ResultObject::constResult(actualchildren.front().second);
-    return ResultObject::constResult(applyMinkowski(actualchildren));
+    if (actualchildren.size() == 1) {
+      return ResultObject::constResult(passThroughGeometry(actualchildren.front()));
+    }
+    return ResultObject::constResult(applyMinkowski(actualchildren, this->progress));
     break;
   }
   case OpenSCADOperator::UNION: {
@@ -178,28 +202,38 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
       if (item.second && !item.second->isEmpty()) actualchildren.push_back(item);
     }
     if (actualchildren.empty()) return {};
-    if (actualchildren.size() == 1) return ResultObject::constResult(actualchildren.front().second);
+    if (actualchildren.size() == 1) {
+      return ResultObject::constResult(passThroughGeometry(actualchildren.front()));
+    }
 #ifdef ENABLE_MANIFOLD
     if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
-      return ResultObject::mutableResult(ManifoldUtils::applyOperator3DManifold(actualchildren, op));
+      return ResultObject::mutableResult(
+        ManifoldUtils::applyOperator3DManifold(actualchildren, op, this->progress));
     }
 #endif
 #ifdef ENABLE_CGAL
     return ResultObject::constResult(std::shared_ptr<const Geometry>(
-      CGALUtils::applyUnion3D(actualchildren.begin(), actualchildren.end())));
+      CGALUtils::applyUnion3D(actualchildren.begin(), actualchildren.end(), this->progress)));
 #else
     assert(false && "No boolean backend available");
 #endif
     break;
   }
   default: {
+    if (op == OpenSCADOperator::DIFFERENCE || op == OpenSCADOperator::INTERSECTION) {
+      if (cullOperands3D(node, children, op)) return {};
+      if (children.size() == 1) {
+        return ResultObject::constResult(passThroughGeometry(children.front()));
+      }
+    }
 #ifdef ENABLE_MANIFOLD
     if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
-      return ResultObject::mutableResult(ManifoldUtils::applyOperator3DManifold(children, op));
+      return ResultObject::mutableResult(
+        ManifoldUtils::applyOperator3DManifold(children, op, this->progress));
     }
 #endif
 #ifdef ENABLE_CGAL
-    return ResultObject::constResult(CGALUtils::applyOperator3D(children, op));
+    return ResultObject::constResult(CGALUtils::applyOperator3D(children, op, this->progress));
 #else
     assert(false && "No boolean backend available");
 #endif
@@ -208,12 +242,60 @@ GeometryEvaluator::ResultObject GeometryEvaluator::applyToChildren3D(const Abstr
   }
 }
 
+/*!
+   Removes difference/intersection operands which cannot contribute to the result, judging by their
+   bounding boxes alone:
+   * A subtrahend whose bounding box doesn't touch the minuend's bounding box is dropped.
+   * If the bounding boxes of all intersection operands have no common point, the result is empty.
+
+   Returns true if the result is known to be empty. Culled operands are counted for the render
+   statistics.
+ */
+bool GeometryEvaluator::cullOperands3D(const AbstractNode& node, Geometry::Geometries& children,
+                                       OpenSCADOperator op)
+{
+  const auto& first = children.front().second;
+  if (!first || first->isEmpty()) return false;
+
+  size_t culled = 0;
+  if (op == OpenSCADOperator::DIFFERENCE) {
+    const BoundingBox minuendBox = first->getBoundingBox();
+    for (auto it = std::next(children.begin()); it != children.end();) {
+      if (it->second && !it->second->isEmpty() &&
+          !minuendBox.intersects(it->second->getBoundingBox())) {
+        if (it->first) it->first->progress_report();
+        it = children.erase(it);
+        ++culled;
+      } else {
+        ++it;
+      }
+    }
+  } else if (op == OpenSCADOperator::INTERSECTION) {
+    BoundingBox commonBox = first->getBoundingBox();
+    for (const auto& item : children) {
+      // Empty operands are handled by the boolean backends
+      if (!item.second || item.second->isEmpty()) return false;
+      commonBox = commonBox.intersection(item.second->getBoundingBox());
+    }
+    if (commonBox.isEmpty()) culled = children.size();
+  }
+  addCulledOperands(node, culled);
+  return op == OpenSCADOperator::INTERSECTION && culled > 0;
+}
+
+void GeometryEvaluator::addCulledOperands(const AbstractNode& node, size_t count)
+{
+  if (count == 0) return;
+  this->culled_operands[node.index()] += count;
+  this->total_culled_operands += count;
+}
+
 GeometryEvaluator::ResultObject GeometryEvaluator::applyHull3D(const Geometry::Geometries& children)
 {
 #if ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
     return ResultObject::mutableResult(
-      ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::HULL));
+      ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::HULL, this->progress));
   }
 #endif  // ENABLE_MANIFOLD
 #if ENABLE_CGAL
@@ -344,10 +426,12 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
                                          const std::shared_ptr<const Geometry>& geom)
 {
   const std::string& key = this->tree.getIdString(node);
+  const auto culled = this->culled_operands.find(node.index());
+  const size_t culled_operands = culled != this->culled_operands.end() ? culled->second : 0;
 
   if (CGALCache::acceptsGeometry(geom)) {
     if (!CGALCache::instance()->contains(key)) {
-      CGALCache::instance()->insert(key, geom);
+      CGALCache::instance()->insert(key, geom, culled_operands);
     }
   } else if (!GeometryCache::instance()->contains(key)) {
     // FIXME: Sanity-check Polygon2d as well?
@@ -356,7 +440,7 @@ void GeometryEvaluator::smartCacheInsert(const AbstractNode& node,
     // }
 
     // Perhaps add acceptsGeometry() to GeometryCache as well?
-    if (!GeometryCache::instance()->insert(key, geom)) {
+    if (!GeometryCache::instance()->insert(key, geom, culled_operands)) {
       LOG(message_group::Warning, "GeometryEvaluator: Node didn't fit into cache.");
     }
   }
@@ -374,8 +458,15 @@ std::shared_ptr<const Geometry> GeometryEvaluator::smartCacheGet(const AbstractN
   const std::string& key = this->tree.getIdString(node);
   const bool hasgeom = GeometryCache::instance()->contains(key);
   const bool hascgal = CGALCache::instance()->contains(key);
-  if (hascgal && (preferNef || !hasgeom)) return CGALCache::instance()->get(key);
-  if (hasgeom) return GeometryCache::instance()->get(key);
+  // The subtree isn't evaluated again, so count the operands culled when it was
+  if (hascgal && (preferNef || !hasgeom)) {
+    addCulledOperands(node, CGALCache::instance()->culledOperands(key));
+    return CGALCache::instance()->get(key);
+  }
+  if (hasgeom) {
+    addCulledOperands(node, GeometryCache::instance()->culledOperands(key));
+    return GeometryCache::instance()->get(key);
+  }
   return {};
 }
 
@@ -410,6 +501,27 @@ Geometry::Geometries GeometryEvaluator::collectChildren3D(const AbstractNode& no
   return children;
 }
 
+/*!
+   Leaves only create backend-native geometry as direct operands of CSG operations. Where it's still
+   passed on unchanged, e.g. by an operation with a single child, or where a cached leaf is used
+   elsewhere, it's replaced by the leaf's PolySet, so the output is the same as without native geometry.
+ */
+std::shared_ptr<const Geometry> GeometryEvaluator::passThroughGeometry(
+  const Geometry::GeometryItem& item)
+{
+  const auto& geom = item.second;
+  if (!geom || geom->getDimension() != 3 || std::dynamic_pointer_cast<const PolySet>(geom)) {
+    return geom;
+  }
+  const auto leaf = std::dynamic_pointer_cast<const LeafNode>(item.first);
+  if (!leaf) return geom;
+  const std::string& key = this->tree.getIdString(*leaf);
+  if (GeometryCache::instance()->contains(key)) return GeometryCache::instance()->get(key);
+  std::shared_ptr<const Geometry> ps = leaf->createGeometry();
+  GeometryCache::instance()->insert(key, ps);
+  return ps;
+}
+
 /*!
 
  */
@@ -467,8 +579,18 @@ void GeometryEvaluator::addToParent(const State& state, const AbstractNode& node
 {
   this->visitedchildren.erase(node.index());
   if (state.parent()) {
+    const auto culled = this->culled_operands.find(node.index());
+    if (culled != this->culled_operands.end()) {
+      const size_t count = culled->second;
+      this->culled_operands[state.parent()->index()] += count;
+    }
     this->visitedchildren[state.parent()->index()].push_back(
       std::make_pair(node.shared_from_this(), geom));
+    if (this->partial_result_observer && geom && !geom->isEmpty() &&
+        !node.modinst->isBackground() && this->top_level_parents.count(state.parent().get()) &&
+        this->reported_nodes.insert(node.index()).second) {
+      this->partial_result_observer(node.shared_from_this(), geom);
+    }
   } else {
     // Root node
     this->root = geom;
@@ -581,7 +703,7 @@ Response GeometryEvaluator::lazyEvaluateRootNode(State& state, const AbstractNod
       // sibling object.
       smartCacheInsert(*chnode, chgeom);
       // Only use valid geometries
-      if (chgeom && !chgeom->isEmpty()) geometries.push_back(item);
+      if (chgeom && !chgeom->isEmpty()) geometries.emplace_back(chnode, passThroughGeometry(item));
     }
     if (geometries.size() == 1) geom = geometries.front().second;
     else if (geometries.size() > 1) geom = std::make_shared<GeometryList>(geometries);
@@ -660,14 +782,19 @@ Response GeometryEvaluator::visit(State& state, const RenderNode& node)
    Leaf nodes can create their own geometry, so let them do that
 
    input: None
-   output: PolySet or Polygon2d
+   output: PolySet or Polygon2d, or native geometry for CSG operands (see passThroughGeometry())
  */
 Response GeometryEvaluator::visit(State& state, const LeafNode& node)
 {
   if (state.isPrefix()) {
+    // Only direct operands of CSG operations skip the conversion to the backend's native
+    // representation. Elsewhere, e.g. below a transform, the native geometry would be passed on
+    // and replaced by the PolySet, so the leaf would be created twice.
+    const bool csgOperand = std::dynamic_pointer_cast<const CsgOpNode>(state.parent()) != nullptr;
     std::shared_ptr<const Geometry> geom;
     if (!isSmartCached(node)) {
-      geom = node.createGeometry();
+      if (csgOperand) geom = node.createNativeGeometry();
+      if (!geom) geom = node.createGeometry();
       assert(geom);
       if (const auto polygon = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
         if (!polygon->isSanitized()) {
@@ -677,7 +804,7 @@ Response GeometryEvaluator::visit(State& state, const LeafNode& node)
         //        assert(!ps->hasDegeneratePolygons());
       }
     } else {
-      geom = smartCacheGet(node, state.preferNef());
+      geom = smartCacheGet(node, csgOperand);
     }
     addToParent(state, node, geom);
     node.progress_report();
@@ -1,8 +1,12 @@
 #pragma once
 
 #include <cassert>
+#include <cstddef>
+#include <functional>
 #include <map>
 #include <memory>
+#include <unordered_map>
+#include <unordered_set>
 #include <utility>
 #include <vector>
 
@@ -15,6 +19,7 @@
 
 class CGALNefGeometry;
 class Polygon2d;
+class ProgressSink;
 class Tree;
 
 // This evaluates a node tree into concrete geometry usign an underlying geometry engine
@@ -25,8 +30,27 @@ class GeometryEvaluator : public NodeVisitor
 public:
   GeometryEvaluator(const Tree& tree);
 
+  // Receives the geometry of each top-level object as soon as it has been evaluated, while
+  // evaluateGeometry() is still working on the rest. Top-level objects are the children of the
+  // evaluated node, looking through groups with a single child and through lists (e.g. for loops).
+  // Called on the evaluating thread. Background objects and empty geometry are not reported.
+  using PartialResultObserver = std::function<void(const std::shared_ptr<const AbstractNode>&,
+                                                   const std::shared_ptr<const Geometry>&)>;
+  void setPartialResultObserver(PartialResultObserver observer)
+  {
+    this->partial_result_observer = std::move(observer);
+  }
+
+  // Progress is reported to, and cancellation requested through, the given sink while
+  // evaluateGeometry() runs. Without a sink, the one current for the calling thread is used.
+  void setProgressSink(ProgressSink *progress) { this->progress = progress; }
+
   std::shared_ptr<const Geometry> evaluateGeometry(const AbstractNode& node, bool allownef);
 
+  // Number of boolean operands culled by bounding box in the last evaluateGeometry() call,
+  // including those culled in cached subtrees which didn't have to be evaluated again.
+  [[nodiscard]] size_t culledOperands() const { return this->total_culled_operands; }
+
   Response visit(State& state, const AbstractNode& node) override;
   Response visit(State& state, const ColorNode& node) override;
   Response visit(State& state, const AbstractIntersectionNode& node) override;
@@ -110,6 +134,7 @@ private:
   bool isValidDim(const Geometry::GeometryItem& item, unsigned int& dim) const;
   std::vector<std::shared_ptr<const Polygon2d>> collectChildren2D(const AbstractNode& node);
   Geometry::Geometries collectChildren3D(const AbstractNode& node);
+  std::shared_ptr<const Geometry> passThroughGeometry(const Geometry::GeometryItem& item);
   std::unique_ptr<Polygon2d> applyMinkowski2D(const AbstractNode& node);
   std::unique_ptr<Polygon2d> applyHull2D(const AbstractNode& node);
   ResultObject applyHull3D(const Geometry::Geometries& children);
@@ -118,17 +143,30 @@ private:
                      const Eigen::Matrix<bool, 3, 1>& autosize);
   std::unique_ptr<Polygon2d> applyToChildren2D(const AbstractNode& node, OpenSCADOperator op);
   ResultObject applyToChildren3D(const AbstractNode& node, OpenSCADOperator op);
+  bool cullOperands3D(const AbstractNode& node, Geometry::Geometries& children, OpenSCADOperator op);
+  void addCulledOperands(const AbstractNode& node, size_t count);
   ResultObject applyToChildren(const AbstractNode& node, OpenSCADOperator op);
   std::shared_ptr<const Geometry> projectionCut(const ProjectionNode& node);
   std::shared_ptr<const Geometry> projectionNoCut(const ProjectionNode& node);
 
   void addToParent(const State& state, const AbstractNode& node,
                    const std::shared_ptr<const Geometry>& geom);
+  void findTopLevelParents(const AbstractNode& node);
   Response lazyEvaluateRootNode(State& state, const AbstractNode& node);
 
   std::map<int, Geometry::Geometries> visitedchildren;
   const Tree& tree;
   std::shared_ptr<const Geometry> root;
 
+  ProgressSink *progress{nullptr};
+  PartialResultObserver partial_result_observer;
+  // Nodes whose children are reported to partial_result_observer, and children already reported
+  std::unordered_set<const AbstractNode *> top_level_parents;
+  std::unordered_set<int> reported_nodes;
+  // Culled boolean operands by node index, including those in the node's subtree, so that they
+  // can be stored with the node's cache entry
+  std::unordered_map<int, size_t> culled_operands;
+  size_t total_culled_operands{0};
+
 public:
 };
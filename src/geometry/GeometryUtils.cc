@@ -555,3 +555,80 @@ std::shared_ptr<const Geometry> GeometryUtils::getBackendSpecificGeometry(
 #endif
   return nullptr;
 }
+
+namespace {
+
+// Minimal union-find with path halving, used for clustering
+class DisjointSets
+{
+public:
+  explicit DisjointSets(size_t n) : parent_(n)
+  {
+    for (size_t i = 0; i < n; ++i) parent_[i] = i;
+  }
+
+  size_t find(size_t i)
+  {
+    while (parent_[i] != i) {
+      parent_[i] = parent_[parent_[i]];
+      i = parent_[i];
+    }
+    return i;
+  }
+
+  void merge(size_t a, size_t b)
+  {
+    a = find(a);
+    b = find(b);
+    // Keep the lowest index as the root so that clusters are ordered deterministically
+    if (a < b) parent_[b] = a;
+    else if (b < a) parent_[a] = b;
+  }
+
+private:
+  std::vector<size_t> parent_;
+};
+
+}  // namespace
+
+/*!
+   Sweep-and-prune along the X axis: boxes are sorted by their minimum X, and each box is only tested
+   against the boxes whose X interval is still open. This is O(n log n + k) for k overlapping pairs.
+ */
+std::vector<std::vector<size_t>> GeometryUtils::clusterOverlappingBoundingBoxes(
+  const std::vector<BoundingBox>& boxes)
+{
+  const size_t n = boxes.size();
+  DisjointSets sets(n);
+
+  std::vector<size_t> order;
+  order.reserve(n);
+  for (size_t i = 0; i < n; ++i) {
+    if (!boxes[i].isEmpty()) order.push_back(i);
+  }
+  std::sort(order.begin(), order.end(), [&](size_t a, size_t b) {
+    return boxes[a].min().x() < boxes[b].min().x() || (boxes[a].min().x() == boxes[b].min().x() && a < b);
+  });
+
+  std::vector<size_t> active;
+  for (const auto i : order) {
+    const auto& box = boxes[i];
+    // Drop boxes which end before this one starts; they cannot overlap any later box either
+    active.erase(std::remove_if(active.begin(), active.end(),
+                                [&](size_t j) { return boxes[j].max().x() < box.min().x(); }),
+                 active.end());
+    for (const auto j : active) {
+      if (box.intersects(boxes[j])) sets.merge(i, j);
+    }
+    active.push_back(i);
+  }
+
+  std::vector<std::vector<size_t>> clusters;
+  std::unordered_map<size_t, size_t> rootToCluster;
+  for (size_t i = 0; i < n; ++i) {
+    const auto [it, inserted] = rootToCluster.emplace(sets.find(i), clusters.size());
+    if (inserted) clusters.emplace_back();
+    clusters[it->second].push_back(i);
+  }
+  return clusters;
+}
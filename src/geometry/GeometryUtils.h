@@ -1,19 +1,16 @@
 #pragma once
 
-#include <boost/container/small_vector.hpp>
 #include <memory>
 #include <vector>
 
 #include "geometry/Geometry.h"
+#include "geometry/PolygonIndices.h"
 #include "geometry/linalg.h"
 
 using Polygon = std::vector<Vector3d>;
 using Polygons = std::vector<Polygon>;
 
-// faces are usually triangles or quads
-using IndexedFace = boost::container::small_vector<int, 4>;
 using IndexedTriangle = Vector3i;
-using PolygonIndices = std::vector<IndexedFace>;
 
 struct IndexedPolygons {
   std::vector<Vector3f> vertices;
@@ -57,4 +54,9 @@ Transform3d getResizeTransform(const BoundingBox& bbox, const Vector3d& newsize,
                                const Eigen::Matrix<bool, 3, 1>& autosize);
 std::shared_ptr<const Geometry> getBackendSpecificGeometry(const std::shared_ptr<const Geometry>& geom);
 
+// Partitions boxes into clusters whose members overlap (or touch), directly or transitively.
+// Boxes from different clusters are guaranteed to be disjoint. Empty boxes form singleton clusters.
+// Each cluster lists indices into boxes in ascending order; clusters are ordered by their first index.
+std::vector<std::vector<size_t>> clusterOverlappingBoundingBoxes(const std::vector<BoundingBox>& boxes);
+
 }  // namespace GeometryUtils
@@ -1,12 +1,14 @@
 #pragma once
 
-#include <boost/functional/hash.hpp>
 #include <cmath>
 #include <cstdint>  // int64_t
-#include <unordered_map>
-#include <utility>
+#include <cstdlib>
+#include <vector>
+
+#include <Eigen/Core>
 
 #include "geometry/linalg.h"
+#include "utils/flat_hash.h"
 #include "utils/hash.h"
 
 // const double GRID_COARSE = 0.001;
@@ -19,12 +21,17 @@
 const double GRID_COARSE = 0.0009765625;
 const double GRID_FINE = 0.00000095367431640625;
 
+/*!
+   Snaps 2D points to a grid, merging points in neighboring cells.
+   Each cell holds a value of type T.
+ */
 template <typename T>
 class Grid2d
 {
 public:
+  using Key = Eigen::Matrix<int64_t, 2, 1>;
+
   double res;
-  std::unordered_map<std::pair<int64_t, int64_t>, T, boost::hash<std::pair<int64_t, int64_t>>> db;
 
   Grid2d(double resolution) { res = resolution; }
   /*!
@@ -36,32 +43,38 @@ public:
   {
     auto ix = (int64_t)std::round(x / res);
     auto iy = (int64_t)std::round(y / res);
-    if (db.find(std::make_pair(ix, iy)) == db.end()) {
+    auto index = db.find(Key(ix, iy));
+    if (index == FlatHashIndex<Key>::npos) {
       int dist = 10;
       for (int64_t jx = ix - 1; jx <= ix + 1; ++jx) {
         for (int64_t jy = iy - 1; jy <= iy + 1; ++jy) {
-          if (db.find(std::make_pair(jx, jy)) == db.end()) continue;
+          auto j = db.find(Key(jx, jy));
+          if (j == FlatHashIndex<Key>::npos) continue;
           int d = abs(int(ix - jx)) + abs(int(iy - jy));
           if (d < dist) {
             dist = d;
             ix = jx;
             iy = jy;
+            index = j;
           }
         }
       }
     }
+    if (index == FlatHashIndex<Key>::npos) {
+      index = db.insert(Key(ix, iy)).first;
+      values.emplace_back();
+    }
     x = ix * res, y = iy * res;
-    return db[std::make_pair(ix, iy)];
+    return values[index];
   }
 
   [[nodiscard]] bool has(double x, double y) const
   {
     auto ix = (int64_t)std::round(x / res);
     auto iy = (int64_t)std::round(y / res);
-    if (db.find(std::make_pair(ix, iy)) != db.end()) return true;
     for (int64_t jx = ix - 1; jx <= ix + 1; ++jx)
       for (int64_t jy = iy - 1; jy <= iy + 1; ++jy) {
-        if (db.find(std::make_pair(jx, jy)) != db.end()) return true;
+        if (db.find(Key(jx, jy)) != FlatHashIndex<Key>::npos) return true;
       }
     return false;
   }
@@ -75,88 +88,110 @@ public:
   }
   T& data(double x, double y) { return align(x, y); }
   T& operator()(double x, double y) { return align(x, y); }
+
+  // Number of occupied cells
+  [[nodiscard]] size_t size() const { return db.size(); }
+
+private:
+  FlatHashIndex<Key> db;
+  std::vector<T> values;  // by cell index in db
 };
 
+/*!
+   Snaps 3D vertices to a grid, merging vertices in neighboring cells.
+   Cells are numbered in order of creation, and align() returns the number as a T.
+ */
 template <typename T>
 class Grid3d
 {
 public:
-  double res;
   using Key = Vector3l;
-  using GridContainer = std::unordered_map<Key, T>;
-  GridContainer db;
+
+  double res;
 
   Grid3d(double resolution) { res = resolution; }
 
-  inline void createGridVertex(const Vector3d& v, Vector3l& i)
+  [[nodiscard]] Key createGridVertex(const Vector3d& v) const
   {
-    i[0] = int64_t(v[0] / this->res);
-    i[1] = int64_t(v[1] / this->res);
-    i[2] = int64_t(v[2] / this->res);
+    return (v / this->res).template cast<int64_t>();
   }
 
   // Aligns vertex to the grid. Returns index of the vertex.
   // Will automatically increase the index as new unique vertices are added.
-  T align(Vector3d& v)
+  T align(Vector3d& v) { return alignKey(v, createGridVertex(v)); }
+
+  /*!
+     Aligns a range of vertices to the grid, and writes their indices to out.
+     Equivalent to calling align() on each, but grid keys are computed for all
+     vertices up front.
+   */
+  template <typename OutputIterator>
+  OutputIterator align(std::vector<Vector3d>& vertices, OutputIterator out)
   {
-    Vector3l key;
-    createGridVertex(v, key);
-    auto iter = db.find(key);
-    if (iter == db.end()) {
-      float dist = 10.0f;  // > max possible distance
-      for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx) {
-        for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy) {
-          for (int64_t jz = key[2] - 1; jz <= key[2] + 1; ++jz) {
-            Vector3l k(jx, jy, jz);
-            auto tmpiter = db.find(k);
-            if (tmpiter == db.end()) continue;
-            float d = sqrt((key - k).squaredNorm());
-            if (d < dist) {
-              dist = d;
-              iter = tmpiter;
-            }
-          }
+    std::vector<Key> keys(vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) keys[i] = createGridVertex(vertices[i]);
+    db.reserve(db.size() + vertices.size());
+    for (size_t i = 0; i < vertices.size(); ++i) *out++ = alignKey(vertices[i], keys[i]);
+    return out;
+  }
+
+  // Returns true if the cell of v or a neighboring cell is occupied. Unlike align(), which picks
+  // the closest neighbor, data is set to the first occupied neighbor in x, y, z order.
+  bool has(const Vector3d& v, T *data = nullptr) const
+  {
+    const Key key = createGridVertex(v);
+    auto index = db.find(key);
+    for (int64_t jx = key[0] - 1; jx <= key[0] + 1 && index == FlatHashIndex<Key>::npos; ++jx) {
+      for (int64_t jy = key[1] - 1; jy <= key[1] + 1 && index == FlatHashIndex<Key>::npos; ++jy) {
+        for (int64_t jz = key[2] - 1; jz <= key[2] + 1 && index == FlatHashIndex<Key>::npos; ++jz) {
+          index = db.find(Key(jx, jy, jz));
         }
       }
     }
+    if (index == FlatHashIndex<Key>::npos) return false;
+    if (data) *data = T(index);
+    return true;
+  }
 
-    T data;
-    if (iter == db.end()) {  // Not found: insert using key
-      data = db.size();
-      db[key] = data;
-    } else {
-      // If found return existing data
-      key = iter->first;
-      data = iter->second;
-    }
-
-    // Align vertex
-    v[0] = key[0] * this->res;
-    v[1] = key[1] * this->res;
-    v[2] = key[2] * this->res;
+  T data(Vector3d v) { return align(v); }
 
-    return data;
-  }
+  // Number of occupied cells
+  [[nodiscard]] size_t size() const { return db.size(); }
 
-  bool has(const Vector3d& v, T *data = nullptr)
+private:
+  // Returns the index of the cell of key, or of the closest occupied neighbor cell
+  [[nodiscard]] uint32_t findNear(const Key& key) const
   {
-    Vector3l key = createGridVertex(v);
-    typename GridContainer::iterator pos = db.find(key);
-    if (pos != db.end()) {
-      if (data) *data = pos->second;
-      return true;
-    }
-    for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx)
-      for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy)
+    auto index = db.find(key);
+    if (index != FlatHashIndex<Key>::npos) return index;
+    int64_t dist = 4;  // > max possible squared distance
+    for (int64_t jx = key[0] - 1; jx <= key[0] + 1; ++jx) {
+      for (int64_t jy = key[1] - 1; jy <= key[1] + 1; ++jy) {
         for (int64_t jz = key[2] - 1; jz <= key[2] + 1; ++jz) {
-          pos = db.find(Vector3l(jx, jy, jz));
-          if (pos != db.end()) {
-            if (data) *data = pos->second;
-            return true;
+          const Key k(jx, jy, jz);
+          const auto j = db.find(k);
+          if (j == FlatHashIndex<Key>::npos) continue;
+          const int64_t d = (key - k).squaredNorm();
+          if (d < dist) {
+            dist = d;
+            index = j;
           }
         }
-    return false;
+      }
+    }
+    return index;
   }
 
-  T data(Vector3d v) { return align(v); }
+  T alignKey(Vector3d& v, const Key& key)
+  {
+    auto index = findNear(key);
+    if (index == FlatHashIndex<Key>::npos) index = db.insert(key).first;
+    const Key& aligned = db.key(index);
+    v[0] = aligned[0] * this->res;
+    v[1] = aligned[1] * this->res;
+    v[2] = aligned[2] * this->res;
+    return T(index);
+  }
+
+  FlatHashIndex<Key> db;
 };
@@ -29,9 +29,12 @@
 #include <Eigen/LU>
 #include <algorithm>
 #include <cstddef>
+#include <cstdint>
+#include <limits>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <utility>
 #include <vector>
 
 #include "geometry/Geometry.h"
@@ -92,7 +95,7 @@ BoundingBox PolySet::getBoundingBox() const
 size_t PolySet::memsize() const
 {
   size_t mem = 0;
-  for (const auto& p : this->indices) mem += p.size() * sizeof(int);
+  mem += this->indices.memsize();
   for (const auto& p : this->vertices) mem += p.size() * sizeof(Vector3d);
   mem += sizeof(PolySet);
   return mem;
@@ -105,7 +108,7 @@ void PolySet::transform(const Transform3d& mat)
   for (auto& v : this->vertices) v = mat * v;
 
   if (mirrored)
-    for (auto& p : this->indices) {
+    for (auto&& p : this->indices) {
       std::reverse(p.begin(), p.end());
     }
   bbox_.setNull();
@@ -140,31 +143,43 @@ void PolySet::quantizeVertices(std::vector<Vector3d> *pPointsOut)
 {
   const bool has_colors = !this->color_indices.empty();
   Grid3d<unsigned int> grid(GRID_FINE);
+  // Grid index of each vertex once aligned. Aligning an aligned vertex again would
+  // find its own cell, so each vertex only needs to be looked up once.
+  constexpr auto unaligned = std::numeric_limits<unsigned int>::max();
+  std::vector<unsigned int> vertex_cells(this->vertices.size(), unaligned);
   std::vector<unsigned int> polygon_indices;  // Vertex indices in one polygon
-  for (size_t i = 0; i < this->indices.size();) {
-    IndexedFace& ind_f = this->indices[i];
+  PolygonIndices quantized;
+  quantized.reserve(this->indices.size(), this->indices.numIndices());
+  std::vector<int32_t> quantized_color_indices;
+  IndexedFace face;
+  for (size_t i = 0; i < this->indices.size(); ++i) {
+    const auto ind_f = std::as_const(this->indices)[i];
     polygon_indices.resize(ind_f.size());
     // Quantize all vertices. Build index list
-    for (unsigned int i = 0; i < ind_f.size(); ++i) {
-      polygon_indices[i] = grid.align(this->vertices[ind_f[i]]);
-      if (pPointsOut && pPointsOut->size() < grid.db.size()) {
-        pPointsOut->push_back(this->vertices[ind_f[i]]);
+    for (unsigned int j = 0; j < ind_f.size(); ++j) {
+      auto& cell = vertex_cells[ind_f[j]];
+      if (cell == unaligned) {
+        cell = grid.align(this->vertices[ind_f[j]]);
+        if (pPointsOut && pPointsOut->size() < grid.size()) {
+          pPointsOut->push_back(this->vertices[ind_f[j]]);
+        }
       }
+      polygon_indices[j] = cell;
     }
     // Remove consecutive duplicate vertices
-    auto currp = ind_f.begin();
-    for (unsigned int i = 0; i < polygon_indices.size(); ++i) {
-      if (polygon_indices[i] != polygon_indices[(i + 1) % polygon_indices.size()]) {
-        (*currp++) = ind_f[i];
+    face.clear();
+    for (unsigned int j = 0; j < polygon_indices.size(); ++j) {
+      if (polygon_indices[j] != polygon_indices[(j + 1) % polygon_indices.size()]) {
+        face.push_back(ind_f[j]);
       }
     }
-    ind_f.erase(currp, ind_f.end());
-    if (ind_f.size() < 3) {
+    if (face.size() < 3) {
       PRINTD("Removing collapsed polygon due to quantizing");
-      this->indices.erase(this->indices.begin() + i);
-      if (has_colors) this->color_indices.erase(this->color_indices.begin() + i);
     } else {
-      i++;
+      quantized.push_back(face);
+      if (has_colors) quantized_color_indices.push_back(this->color_indices[i]);
     }
   }
+  this->indices = std::move(quantized);
+  if (has_colors) this->color_indices = std::move(quantized_color_indices);
 }
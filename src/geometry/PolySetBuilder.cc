@@ -211,10 +211,13 @@ void PolySetBuilder::appendPolySet(const PolySet& ps)
   }
 
   reserve(numVertices() + ps.vertices.size(), numPolygons() + ps.indices.size());
+  // Look up each vertex once, in order of first use to keep the resulting vertex order
+  std::vector<int> vertex_map(ps.vertices.size(), -1);
   for (const auto& poly : ps.indices) {
     beginPolygon(poly.size());
     for (const auto& ind : poly) {
-      addVertex(ps.vertices[ind]);
+      if (vertex_map[ind] < 0) vertex_map[ind] = vertexIndex(ps.vertices[ind]);
+      addVertex(vertex_map[ind]);
     }
     endPolygon();
   }
@@ -225,18 +228,15 @@ std::unique_ptr<PolySet> PolySetBuilder::build()
   endPolygon();
   std::unique_ptr<PolySet> polyset;
   polyset = std::make_unique<PolySet>(dim_, convex_);
-  vertices_.copy(std::back_inserter(polyset->vertices));
+  polyset->vertices = vertices_.takeArray();
   polyset->indices = std::move(indices_);
   polyset->color_indices = std::move(color_indices_);
   polyset->colors = std::move(colors_);
   polyset->setConvexity(convexity_);
-  bool is_triangular = true;
-  for (const auto& face : polyset->indices) {
-    if (face.size() > 3) {
-      is_triangular = false;
-      break;
-    }
-  }
-  polyset->setTriangular(is_triangular);
+  // Degenerate faces with fewer than 3 vertices don't count against a triangular mesh
+  const auto& indices = polyset->indices;
+  polyset->setTriangular(indices.allTriangles() ||
+                         std::none_of(indices.begin(), indices.end(),
+                                      [](const FaceView& face) { return face.size() > 3; }));
   return polyset;
 }
@@ -1,12 +1,16 @@
 #include "geometry/PolySetUtils.h"
 
 #include <boost/range/adaptor/reversed.hpp>
+#include <algorithm>
+#include <atomic>
 #include <cassert>
 #include <cstddef>
 #include <cstdint>
+#include <iterator>
 #include <memory>
 #include <sstream>
 #include <string>
+#include <unordered_set>
 #include <vector>
 
 #include "geometry/Geometry.h"
@@ -15,6 +19,8 @@
 #include "geometry/PolySetBuilder.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
+#include "utils/flat_hash.h"
+#include "utils/hash.h"
 #include "utils/printutils.h"
 #ifdef ENABLE_CGAL
 #include "geometry/cgal/cgalutils.h"
@@ -173,6 +179,66 @@ bool is_approximately_convex(const PolySet& ps)
 #endif
 }
 
+std::unique_ptr<PolySet> simplify_by_clustering(const PolySet& ps, double cell_size,
+                                                const std::atomic<bool> *cancel)
+{
+  assert(cell_size > 0);
+  // Checked every few thousand items, so that cancelling a huge mesh doesn't have to wait
+  constexpr size_t CANCEL_CHECK_INTERVAL = 1 << 14;
+  const auto cancelled = [cancel](size_t i) {
+    return cancel && i % CANCEL_CHECK_INTERVAL == 0 && cancel->load();
+  };
+
+  auto result = std::make_unique<PolySet>(ps.getDimension());
+  result->setConvexity(ps.getConvexity());
+  result->setTriangular(ps.isTriangular());
+  result->colors = ps.colors;
+
+  // Vertices in the same grid cell become one vertex at their average position
+  std::vector<Vector3l> cells(ps.vertices.size());
+  for (size_t i = 0; i < ps.vertices.size(); ++i) {
+    if (cancelled(i)) return nullptr;
+    cells[i] = (ps.vertices[i] / cell_size).array().floor().cast<int64_t>();
+  }
+  FlatHashIndex<Vector3l> cell_index;
+  std::vector<int> cluster;
+  cluster.reserve(ps.vertices.size());
+  cell_index.insert(cells.begin(), cells.end(), std::back_inserter(cluster));
+  if (cancelled(0)) return nullptr;
+  result->vertices.assign(cell_index.size(), Vector3d::Zero());
+  std::vector<size_t> cluster_sizes(cell_index.size());
+  for (size_t i = 0; i < ps.vertices.size(); ++i) {
+    result->vertices[cluster[i]] += ps.vertices[i];
+    ++cluster_sizes[cluster[i]];
+  }
+  for (size_t i = 0; i < result->vertices.size(); ++i) {
+    result->vertices[i] /= static_cast<double>(cluster_sizes[i]);
+  }
+
+  // Drop faces which collapse to a line or a point, and triangles which duplicate another one
+  std::unordered_set<Vector3l> triangles;
+  const bool has_colors = !ps.color_indices.empty();
+  IndexedFace face;
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    if (cancelled(i)) return nullptr;
+    face.clear();
+    for (const auto idx : ps.indices[i]) {
+      if (face.empty() || face.back() != cluster[idx]) face.push_back(cluster[idx]);
+    }
+    while (face.size() > 1 && face.front() == face.back()) face.pop_back();
+    if (face.size() < 3) continue;
+    if (face.size() == 3) {
+      // Rotate the smallest index first, so equal triangles with the same winding match
+      const auto first = std::min_element(face.begin(), face.end()) - face.begin();
+      const Vector3l key(face[first], face[(first + 1) % 3], face[(first + 2) % 3]);
+      if (!triangles.insert(key).second) continue;
+    }
+    result->indices.push_back(face);
+    if (has_colors) result->color_indices.push_back(ps.color_indices[i]);
+  }
+  return result;
+}
+
 // Get as or convert the geometry to a PolySet.
 std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const Geometry>& geom)
 {
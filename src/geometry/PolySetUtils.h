@@ -1,5 +1,6 @@
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <string>
 
@@ -13,6 +14,10 @@ namespace PolySetUtils {
 std::unique_ptr<Polygon2d> project(const PolySet& ps);
 std::unique_ptr<PolySet> tessellate_faces(const PolySet& inps);
 bool is_approximately_convex(const PolySet& ps);
+// Reduce detail by merging all vertices within each grid cell of the given size, for preview
+// only. The result is not guaranteed to be manifold. Returns nullptr once cancel is set.
+std::unique_ptr<PolySet> simplify_by_clustering(const PolySet& ps, double cell_size,
+                                                const std::atomic<bool> *cancel = nullptr);
 
 std::shared_ptr<const PolySet> getGeometryAsPolySet(const std::shared_ptr<const class Geometry>&);
 
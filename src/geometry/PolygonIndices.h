@@ -0,0 +1,293 @@
+#pragma once
+
+#include <algorithm>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <initializer_list>
+#include <iterator>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+#include <boost/container/small_vector.hpp>
+
+// faces are usually triangles or quads
+using IndexedFace = boost::container::small_vector<int, 4>;
+
+/*!
+   A view of the vertex indices of one face in PolygonIndices.
+   T is int for a mutable view, or const int for a read-only one. The indices can be
+   changed through a mutable view, but not their number.
+ */
+template <typename T>
+class BasicFaceView
+{
+public:
+  using value_type = int;
+  using size_type = size_t;
+  using iterator = T *;
+  using const_iterator = const int *;
+  using reverse_iterator = std::reverse_iterator<iterator>;
+  using const_reverse_iterator = std::reverse_iterator<const_iterator>;
+
+  BasicFaceView(T *begin, T *end) : begin_(begin), end_(end) {}
+  // A mutable view converts to a read-only one
+  template <typename U, typename = std::enable_if_t<std::is_same_v<T, const U>>>
+  BasicFaceView(const BasicFaceView<U>& other) : begin_(other.begin()), end_(other.end())
+  {
+  }
+
+  [[nodiscard]] size_t size() const { return end_ - begin_; }
+  [[nodiscard]] bool empty() const { return begin_ == end_; }
+  T& operator[](size_t i) const { return begin_[i]; }
+  T& at(size_t i) const
+  {
+    if (i >= size()) throw std::out_of_range("face index out of range");
+    return begin_[i];
+  }
+  T& front() const { return *begin_; }
+  T& back() const { return *(end_ - 1); }
+  T *begin() const { return begin_; }
+  T *end() const { return end_; }
+  reverse_iterator rbegin() const { return reverse_iterator(end_); }
+  reverse_iterator rend() const { return reverse_iterator(begin_); }
+
+  // For code which needs a face it can modify or keep
+  operator IndexedFace() const { return IndexedFace(begin_, end_); }
+
+  template <typename Range>
+  bool operator==(const Range& other) const
+  {
+    return std::equal(begin(), end(), std::begin(other), std::end(other));
+  }
+  template <typename Range>
+  bool operator!=(const Range& other) const
+  {
+    return !(*this == other);
+  }
+
+private:
+  T *begin_;
+  T *end_;
+};
+
+using FaceView = BasicFaceView<const int>;
+using MutableFaceView = BasicFaceView<int>;
+
+/*!
+   The faces of a PolySet, as vertex indices.
+
+   Faces are stored in compressed sparse row layout: the indices of all faces in one
+   flat array, and the offset of each face into that array. As long as all faces are
+   triangles, no offsets are stored at all. This takes less than half the memory of a
+   vector of small vectors and keeps all index data in one place.
+
+   The interface follows std::vector<IndexedFace> where possible, so code can iterate
+   and index faces as before. Elements are views (FaceView, MutableFaceView) into the
+   shared array rather than separate objects; faces can be appended but not resized.
+ */
+class PolygonIndices
+{
+public:
+  using value_type = IndexedFace;  // allows std::back_inserter
+  using size_type = size_t;
+
+  template <typename Container, typename View>
+  class Iterator
+  {
+  public:
+    using iterator_category = std::random_access_iterator_tag;
+    using value_type = View;
+    using difference_type = std::ptrdiff_t;
+    using pointer = void;
+    using reference = View;
+
+    Iterator() = default;
+    Iterator(Container *faces, size_t i) : faces(faces), i(i) {}
+    // iterator converts to const_iterator
+    template <typename C, typename V, typename = std::enable_if_t<std::is_same_v<Container, const C>>>
+    Iterator(const Iterator<C, V>& other) : faces(other.container()), i(other.index())
+    {
+    }
+
+    View operator*() const { return (*faces)[i]; }
+    View operator[](difference_type n) const { return (*faces)[i + n]; }
+    Iterator& operator++() { ++i; return *this; }
+    Iterator operator++(int) { return Iterator(faces, i++); }
+    Iterator& operator--() { --i; return *this; }
+    Iterator operator--(int) { return Iterator(faces, i--); }
+    Iterator& operator+=(difference_type n) { i += n; return *this; }
+    Iterator& operator-=(difference_type n) { i -= n; return *this; }
+    Iterator operator+(difference_type n) const { return Iterator(faces, i + n); }
+    Iterator operator-(difference_type n) const { return Iterator(faces, i - n); }
+    difference_type operator-(const Iterator& other) const
+    {
+      return difference_type(i) - difference_type(other.i);
+    }
+    bool operator==(const Iterator& other) const { return i == other.i; }
+    bool operator!=(const Iterator& other) const { return i != other.i; }
+    bool operator<(const Iterator& other) const { return i < other.i; }
+    bool operator>(const Iterator& other) const { return i > other.i; }
+    bool operator<=(const Iterator& other) const { return i <= other.i; }
+    bool operator>=(const Iterator& other) const { return i >= other.i; }
+
+    [[nodiscard]] Container *container() const { return faces; }
+    [[nodiscard]] size_t index() const { return i; }
+
+  private:
+    Container *faces{nullptr};
+    size_t i{0};
+  };
+
+  using iterator = Iterator<PolygonIndices, MutableFaceView>;
+  using const_iterator = Iterator<const PolygonIndices, FaceView>;
+
+  PolygonIndices() = default;
+  PolygonIndices(std::initializer_list<IndexedFace> faces)
+  {
+    for (const auto& face : faces) push_back(face);
+  }
+  PolygonIndices(const std::vector<IndexedFace>& faces)
+  {
+    reserve(faces.size());
+    for (const auto& face : faces) push_back(face);
+  }
+
+  [[nodiscard]] size_t size() const
+  {
+    return offsets_.empty() ? indices_.size() / 3 : offsets_.size() - 1;
+  }
+  [[nodiscard]] bool empty() const { return indices_.empty() && offsets_.empty(); }
+  // True if all faces are triangles, in which case no offsets are stored
+  [[nodiscard]] bool allTriangles() const { return offsets_.empty(); }
+
+  FaceView operator[](size_t i) const
+  {
+    return {indices_.data() + start(i), indices_.data() + start(i + 1)};
+  }
+  MutableFaceView operator[](size_t i)
+  {
+    return {indices_.data() + start(i), indices_.data() + start(i + 1)};
+  }
+  FaceView front() const { return (*this)[0]; }
+  MutableFaceView front() { return (*this)[0]; }
+  FaceView back() const { return (*this)[size() - 1]; }
+  MutableFaceView back() { return (*this)[size() - 1]; }
+
+  iterator begin() { return {this, 0}; }
+  iterator end() { return {this, size()}; }
+  const_iterator begin() const { return {this, 0}; }
+  const_iterator end() const { return {this, size()}; }
+  const_iterator cbegin() const { return begin(); }
+  const_iterator cend() const { return end(); }
+
+  // Reserves space for the given number of faces, and of indices if known
+  void reserve(size_t faces, size_t indices = 0)
+  {
+    indices_.reserve(indices ? indices : faces * 3);
+    if (!offsets_.empty()) offsets_.reserve(faces + 1);
+  }
+
+  void clear()
+  {
+    indices_.clear();
+    offsets_.clear();
+    non_triangles_ = 0;
+  }
+
+  template <typename Range>
+  void push_back(const Range& face)
+  {
+    append(std::begin(face), std::end(face));
+  }
+  void push_back(std::initializer_list<int> face) { append(face.begin(), face.end()); }
+  template <typename Range>
+  void emplace_back(const Range& face)
+  {
+    append(std::begin(face), std::end(face));
+  }
+
+  // Appends a face with the indices in [begin, end)
+  template <typename InputIterator>
+  void append(InputIterator begin, InputIterator end)
+  {
+    const size_t first = indices_.size();
+    indices_.insert(indices_.end(), begin, end);
+    const size_t n = indices_.size() - first;
+    if (n != 3) ++non_triangles_;
+    if (offsets_.empty()) {
+      if (n == 3) return;
+      // First face which isn't a triangle: store offsets from now on
+      offsets_.reserve(indices_.capacity() / 3 + 1);
+      for (size_t i = 0; i <= first; i += 3) offsets_.push_back(i);
+    }
+    offsets_.push_back(indices_.size());
+  }
+
+  // Appends triangles, given as consecutive triples of indices in [begin, end)
+  template <typename ForwardIterator>
+  void appendTriangles(ForwardIterator begin, ForwardIterator end)
+  {
+    const size_t first = indices_.size();
+    indices_.insert(indices_.end(), begin, end);
+    assert((indices_.size() - first) % 3 == 0);
+    if (offsets_.empty()) return;
+    for (size_t i = first + 3; i <= indices_.size(); i += 3) offsets_.push_back(i);
+  }
+
+  void pop_back()
+  {
+    assert(!empty());
+    const size_t last = size() - 1;
+    if (start(last + 1) - start(last) != 3) --non_triangles_;
+    indices_.resize(start(last));
+    if (!offsets_.empty()) offsets_.pop_back();
+    // Only triangles left: drop the offsets, as if the other faces had never been added
+    if (non_triangles_ == 0) offsets_.clear();
+  }
+
+  /*!
+     Removes faces for which pred(FaceView) returns true, keeping the order of the others.
+     Returns the number of removed faces.
+   */
+  template <typename Predicate>
+  size_t remove_if(Predicate pred)
+  {
+    PolygonIndices kept;
+    kept.reserve(size(), indices_.size());
+    for (const auto& face : std::as_const(*this)) {
+      if (!pred(face)) kept.push_back(face);
+    }
+    const size_t removed = size() - kept.size();
+    *this = std::move(kept);
+    return removed;
+  }
+
+  // The indices of all faces, face after face
+  [[nodiscard]] const std::vector<int>& indexData() const { return indices_; }
+  // Number of indices of all faces
+  [[nodiscard]] size_t numIndices() const { return indices_.size(); }
+  [[nodiscard]] size_t memsize() const
+  {
+    return indices_.capacity() * sizeof(int) + offsets_.capacity() * sizeof(uint32_t) +
+           sizeof(PolygonIndices);
+  }
+
+  bool operator==(const PolygonIndices& other) const
+  {
+    if (allTriangles() && other.allTriangles()) return indices_ == other.indices_;
+    return size() == other.size() && std::equal(begin(), end(), other.begin());
+  }
+  bool operator!=(const PolygonIndices& other) const { return !(*this == other); }
+
+private:
+  [[nodiscard]] size_t start(size_t i) const { return offsets_.empty() ? i * 3 : offsets_[i]; }
+
+  std::vector<int> indices_;
+  // Start of each face in indices_, followed by the end of the last. Empty if all faces are triangles.
+  std::vector<uint32_t> offsets_;
+  // Number of faces which aren't triangles
+  size_t non_triangles_{0};
+};
@@ -2,9 +2,9 @@
 
 #include <algorithm>
 #include <cstddef>
-#include <unordered_map>
 #include <vector>
 
+#include "utils/flat_hash.h"
 #include "utils/hash.h"  // IWYU pragma: keep
 
 /*!
@@ -21,49 +21,47 @@ public:
   /*!
      Looks up a value. Will insert the value if it doesn't already exist.
      Returns the new index. */
-  int lookup(const T& val)
+  int lookup(const T& val) { return this->index.insert(val).first; }
+
+  /*!
+     Looks up a range of values, inserting those that don't already exist.
+     Writes the new index of each value to dest.
+   */
+  template <class InputIterator, class OutputIterator>
+  OutputIterator lookup(InputIterator begin, InputIterator end, OutputIterator dest)
   {
-    auto iter = this->map.find(val);
-    if (iter != this->map.end()) return iter->second;
-    else {
-      this->map.insert(std::make_pair(val, this->map.size()));
-      return this->map.size() - 1;
-    }
+    return this->index.insert(begin, end, dest);
   }
 
   /*!
      Returns the current size of the new element array
    */
-  [[nodiscard]] std::size_t size() const { return this->map.size(); }
+  [[nodiscard]] std::size_t size() const { return this->index.size(); }
 
   /*!
      Reserve the requested size for the new element map
    */
-  void reserve(std::size_t n) { return this->map.reserve(n); }
+  void reserve(std::size_t n) { return this->index.reserve(n); }
 
   /*!
-     Return a copy of the new element array
+     Return the new element array
    */
-  const std::vector<T>& getArray()
-  {
-    this->vec.resize(this->map.size());
-    for (const auto& entry : map) {
-      this->vec[entry.second] = entry.first;
-    }
-    return this->vec;
-  }
+  const std::vector<T>& getArray() const { return this->index.keys(); }
+
+  /*!
+     Moves the new element array out, leaving the reindexer empty
+   */
+  std::vector<T> takeArray() { return this->index.release(); }
 
   /*!
-     Copies the internal vector to the given destination
+     Copies the new element array to the given destination
    */
   template <class OutputIterator>
-  void copy(OutputIterator dest)
+  void copy(OutputIterator dest) const
   {
-    this->getArray();
-    std::copy(this->vec.begin(), this->vec.end(), dest);
+    std::copy(this->index.keys().begin(), this->index.keys().end(), dest);
   }
 
 private:
-  std::unordered_map<T, int> map;
-  std::vector<T> vec;
+  FlatHashIndex<T> index;
 };
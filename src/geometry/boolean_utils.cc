@@ -29,18 +29,19 @@
 
   FIXME: This shouldn't return const, but it does due to internal implementation details
  */
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children)
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children,
+                                               ProgressSink *progress)
 {
 #if ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
 #if defined(USE_MANIFOLD_MINKOWSKI)
-    return ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::MINKOWSKI);
+    return ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::MINKOWSKI, progress);
 #else
-    return ManifoldUtils::applyMinkowski(children);
+    return ManifoldUtils::applyMinkowski(children, progress);
 #endif
   }
 #endif  // ENABLE_MANIFOLD
-  return CGALUtils::applyMinkowski3D(children);
+  return CGALUtils::applyMinkowski3D(children, progress);
 }
 #else   // ENABLE_CGAL
 std::shared_ptr<const Geometry> applyHull(const Geometry::Geometries& children)
@@ -48,7 +49,8 @@ std::shared_ptr<const Geometry> applyHull(const Geometry::Geometries& children)
   return std::make_shared<PolySet>(3, true);
 }
 
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children)
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children,
+                                               ProgressSink *progress)
 {
   return std::make_shared<PolySet>(3);
 }
@@ -4,4 +4,7 @@
 
 #include "geometry/Geometry.h"
 
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children);
+class ProgressSink;
+
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children,
+                                               ProgressSink *progress = nullptr);
@@ -41,10 +41,11 @@ bool CGALCache::acceptsGeometry(const std::shared_ptr<const Geometry>& geom)
     ;
 }
 
-bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom)
+bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geometry>& geom,
+                       size_t culled_operands)
 {
   assert(acceptsGeometry(geom));
-  auto inserted = this->cache.insert(id, new cache_entry(geom), geom->memsize());
+  auto inserted = this->cache.insert(id, new cache_entry(geom, culled_operands), geom->memsize());
 #ifdef DEBUG
   LOG("CGAL Cache %1$s: %2$s (%3$d bytes)", inserted ? "inserted" : "insert failed", id.substr(0, 40),
       geom->memsize());
@@ -52,6 +53,12 @@ bool CGALCache::insert(const std::string& id, const std::shared_ptr<const Geomet
   return inserted;
 }
 
+size_t CGALCache::culledOperands(const std::string& id) const
+{
+  const auto *entry = this->cache.peek(id);
+  return entry ? entry->culled_operands : 0;
+}
+
 size_t CGALCache::size() const
 {
   return cache.size();
@@ -83,7 +90,8 @@ void CGALCache::print()
   LOG("CGAL cache size in bytes: %1$d", this->cache.totalCost());
 }
 
-CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N) : N(N)
+CGALCache::cache_entry::cache_entry(const std::shared_ptr<const Geometry>& N, size_t culled_operands)
+  : N(N), culled_operands(culled_operands)
 {
   if (print_messages_stack.size() > 0) this->msg = print_messages_stack.back();
 }
@@ -21,7 +21,9 @@ public:
 
   bool contains(const std::string& id) const { return this->cache.contains(id); }
   std::shared_ptr<const Geometry> get(const std::string& id) const;
-  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N);
+  bool insert(const std::string& id, const std::shared_ptr<const Geometry>& N,
+              size_t culled_operands = 0);
+  size_t culledOperands(const std::string& id) const;
   size_t size() const;
   size_t totalCost() const;
   size_t maxSizeMB() const;
@@ -35,7 +37,9 @@ private:
   struct cache_entry {
     std::shared_ptr<const Geometry> N;
     std::string msg;
-    cache_entry(const std::shared_ptr<const Geometry>& N);
+    // Boolean operands culled while evaluating the subtree, for the render statistics
+    size_t culled_operands;
+    cache_entry(const std::shared_ptr<const Geometry>& N, size_t culled_operands);
   };
 
   Cache<std::string, cache_entry> cache;
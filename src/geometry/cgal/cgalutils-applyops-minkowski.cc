@@ -1,22 +1,230 @@
 #include <CGAL/Timer.h>
 #include <CGAL/convex_hull_3.h>
 
+#include <algorithm>
 #include <cassert>
 #include <cstddef>
+#include <cstdint>
 #include <iterator>
 #include <list>
 #include <memory>
+#include <mutex>
 #include <utility>
 #include <vector>
 
+#include "Cache.h"
 #include "core/enums.h"
 #include "core/node.h"
+#include "core/progress.h"
+#include "geometry/PolySet.h"
 #include "geometry/cgal/cgalutils.h"
+#include "geometry/linalg.h"
+#include "utils/flat_hash.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 namespace CGALUtils {
 
-std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children)
+namespace {
+
+using Hull_kernel = CGAL::Epick;
+// Vertices of each convex part of a (possibly decomposed) minkowski operand
+using ConvexParts = std::vector<std::vector<Hull_kernel::Point_3>>;
+
+// Convex decompositions of PolySet minkowski operands, keyed by a hash of the mesh, so that
+// repeated minkowski() calls with the same operand (e.g. the same rounding tool) only decompose it
+// once. Entries keep the mesh, which is compared on lookup to rule out hash collisions. Nef
+// operands are intermediate results without a cheap stable key, and aren't cached.
+struct DecompositionCacheEntry {
+  std::shared_ptr<const PolySet> ps;
+  std::shared_ptr<const ConvexParts> parts;
+};
+Cache<uint64_t, DecompositionCacheEntry> decomposition_cache(64ul * 1024ul * 1024ul);
+std::mutex decomposition_cache_mutex;
+
+uint64_t hash_polyset(const PolySet& ps)
+{
+  const FlatHash<Vector3d> hash_vertex;
+  uint64_t h = hash_mix(ps.vertices.size());
+  for (const auto& v : ps.vertices) h = hash_mix(h ^ hash_vertex(v));
+  for (const auto& face : ps.indices) {
+    h = hash_mix(h ^ face.size());
+    for (const auto index : face) h = hash_mix(h ^ static_cast<uint64_t>(index));
+  }
+  return h;
+}
+
+std::shared_ptr<const ConvexParts> findDecomposition(uint64_t key, const PolySet& ps)
+{
+  const std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+  const auto *entry = decomposition_cache[key];
+  if (!entry) return nullptr;
+  if (entry->ps.get() != &ps &&
+      (entry->ps->vertices != ps.vertices || entry->ps->indices != ps.indices)) {
+    return nullptr;
+  }
+  return entry->parts;
+}
+
+void insertDecomposition(uint64_t key, const std::shared_ptr<const PolySet>& ps,
+                         const std::shared_ptr<const ConvexParts>& parts)
+{
+  size_t cost = ps->memsize();
+  for (const auto& points : *parts) cost += points.size() * sizeof(Hull_kernel::Point_3);
+  const std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+  decomposition_cache.insert(key, new DecompositionCacheEntry{ps, parts}, cost);
+}
+
+/*!
+   Splits the operand into convex parts.
+   Throws if the operand cannot be decomposed; the caller then falls back to Nef minkowski.
+ */
+std::shared_ptr<const ConvexParts> decomposeConvex(const std::shared_ptr<const Geometry>& operand,
+                                                   size_t i)
+{
+  auto ps = std::dynamic_pointer_cast<const PolySet>(operand);
+  const uint64_t key = ps ? hash_polyset(*ps) : 0;
+  if (ps) {
+    if (auto parts = findDecomposition(key, *ps)) {
+      PRINTDB("Minkowski: child %d found in decomposition cache", i);
+      return parts;
+    }
+  }
+
+  std::list<CGAL_Polyhedron> P;
+  CGAL_Polyhedron poly;
+
+  auto nef = std::dynamic_pointer_cast<const CGALNefGeometry>(operand);
+
+  if (!nef) {
+    nef = CGALUtils::getNefPolyhedronFromGeometry(operand);
+  }
+
+  if (ps) CGALUtils::createPolyhedronFromPolySet(*ps, poly);
+  else if (nef && nef->p3->is_simple()) CGALUtils::convertNefToPolyhedron(*nef->p3, poly);
+  else throw 0;
+
+  if ((ps && ps->isConvex()) || (!ps && CGALUtils::is_weakly_convex(poly))) {
+    PRINTDB("Minkowski: child %d is convex and %s", i % (ps ? "PolySet" : "Nef"));
+    P.push_back(poly);
+  } else {
+    CGAL_Nef_polyhedron3 decomposed_nef;
+
+    if (ps) {
+      PRINTDB("Minkowski: child %d is nonconvex PolySet, transforming to Nef and decomposing...", i);
+      auto p = CGALUtils::getNefPolyhedronFromGeometry(ps);
+      if (p && !p->isEmpty()) decomposed_nef = *p->p3;
+    } else {
+      PRINTDB("Minkowski: child %d is nonconvex Nef, decomposing...", i);
+      decomposed_nef = *nef->p3;
+    }
+
+    CGAL::Timer t;
+    t.start();
+    CGAL::convex_decomposition_3(decomposed_nef);
+
+    // the first volume is the outer volume, which ignored in the decomposition
+    for (auto ci = ++decomposed_nef.volumes_begin(); ci != decomposed_nef.volumes_end(); ++ci) {
+      if (ci->mark()) {
+        CGAL_Polyhedron poly;
+        decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
+        P.push_back(poly);
+      }
+    }
+
+    PRINTDB("Minkowski: decomposed into %d convex parts", P.size());
+    t.stop();
+    PRINTDB("Minkowski: decomposition took %f s", t.time());
+  }
+
+  // Convert to the inexact hull kernel up front: exact CGAL numbers are not thread-safe, so this
+  // must not happen in the parallel hull computation below.
+  CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
+  auto parts = std::make_shared<ConvexParts>();
+  parts->reserve(P.size());
+  for (const auto& poly : P) {
+    auto& points = parts->emplace_back();
+    points.reserve(poly.size_of_vertices());
+    for (auto pi = poly.vertices_begin(); pi != poly.vertices_end(); ++pi) {
+      points.push_back(conv(pi->point()));
+    }
+  }
+
+  if (ps) insertDecomposition(key, ps, parts);
+  return parts;
+}
+
+/*!
+   Returns the convex hull of the minkowski sum of two convex parts, or nullptr if it is degenerate.
+   Only uses the inexact hull kernel, so it is safe to call concurrently.
+ */
+std::shared_ptr<const Geometry> minkowskiHull(const std::vector<Hull_kernel::Point_3>& points0,
+                                              const std::vector<Hull_kernel::Point_3>& points1)
+{
+  std::vector<Hull_kernel::Point_3> minkowski_points;
+  minkowski_points.reserve(points0.size() * points1.size());
+  for (const auto& p0 : points0) {
+    for (const auto& p1 : points1) {
+      minkowski_points.push_back(p0 + (p1 - CGAL::ORIGIN));
+    }
+  }
+
+  if (minkowski_points.size() <= 3) return nullptr;
+
+  CGAL::Polyhedron_3<Hull_kernel> result;
+  CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
+
+  std::vector<Hull_kernel::Point_3> strict_points;
+  strict_points.reserve(minkowski_points.size());
+
+  for (CGAL::Polyhedron_3<Hull_kernel>::Vertex_iterator i = result.vertices_begin();
+       i != result.vertices_end(); ++i) {
+    Hull_kernel::Point_3 const& p = i->point();
+
+    CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle h, e;
+    h = i->halfedge();
+    e = h;
+    bool collinear = false;
+    bool coplanar = true;
+
+    do {
+      Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
+      if (coplanar &&
+          !CGAL::coplanar(p, q, h->next_on_vertex()->opposite()->vertex()->point(),
+                          h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
+        coplanar = false;
+      }
+
+      for (CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle j = h->next_on_vertex();
+           j != h && !collinear && !coplanar; j = j->next_on_vertex()) {
+        Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
+        if (CGAL::collinear(p, q, r)) {
+          collinear = true;
+        }
+      }
+
+      h = h->next_on_vertex();
+    } while (h != e && !collinear);
+
+    if (!collinear && !coplanar) strict_points.push_back(p);
+  }
+
+  result.clear();
+  CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
+
+  return CGALUtils::createPolySetFromPolyhedron(result);
+}
+
+}  // namespace
+
+void clearMinkowskiCache()
+{
+  const std::lock_guard<std::mutex> lock(decomposition_cache_mutex);
+  decomposition_cache.clear();
+}
+
+std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children,
+                                                 ProgressSink *progress)
 {
   assert(children.size() >= 2);
 
@@ -28,171 +236,42 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
   std::shared_ptr<const Geometry> operands[2] = {it->second, std::shared_ptr<const Geometry>()};
   try {
     while (++it != children.end()) {
+      progress_check_cancel(progress);
       operands[1] = it->second;
 
-      using Hull_kernel = CGAL::Epick;
-
-      std::list<CGAL_Polyhedron> P[2];
-      std::list<CGAL::Polyhedron_3<Hull_kernel>> result_parts;
-
+      std::shared_ptr<const ConvexParts> P[2];
       for (size_t i = 0; i < 2; ++i) {
-        CGAL_Polyhedron poly;
-
-        auto ps = std::dynamic_pointer_cast<const PolySet>(operands[i]);
-        auto nef = std::dynamic_pointer_cast<const CGALNefGeometry>(operands[i]);
-
-        if (!nef) {
-          nef = CGALUtils::getNefPolyhedronFromGeometry(operands[i]);
-        }
-
-        if (ps) CGALUtils::createPolyhedronFromPolySet(*ps, poly);
-        else if (nef && nef->p3->is_simple()) CGALUtils::convertNefToPolyhedron(*nef->p3, poly);
-        else throw 0;
-
-        if ((ps && ps->isConvex()) || (!ps && CGALUtils::is_weakly_convex(poly))) {
-          PRINTDB("Minkowski: child %d is convex and %s", i % (ps ? "PolySet" : "Nef"));
-          P[i].push_back(poly);
-        } else {
-          CGAL_Nef_polyhedron3 decomposed_nef;
-
-          if (ps) {
-            PRINTDB("Minkowski: child %d is nonconvex PolySet, transforming to Nef and decomposing...",
-                    i);
-            auto p = CGALUtils::getNefPolyhedronFromGeometry(ps);
-            if (p && !p->isEmpty()) decomposed_nef = *p->p3;
-          } else {
-            PRINTDB("Minkowski: child %d is nonconvex Nef, decomposing...", i);
-            decomposed_nef = *nef->p3;
-          }
-
-          t.start();
-          CGAL::convex_decomposition_3(decomposed_nef);
-
-          // the first volume is the outer volume, which ignored in the decomposition
-          for (auto ci = ++decomposed_nef.volumes_begin(); ci != decomposed_nef.volumes_end(); ++ci) {
-            if (ci->mark()) {
-              CGAL_Polyhedron poly;
-              decomposed_nef.convert_inner_shell_to_polyhedron(ci->shells_begin(), poly);
-              P[i].push_back(poly);
-            }
-          }
-
-          PRINTDB("Minkowski: decomposed into %d convex parts", P[i].size());
-          t.stop();
-          PRINTDB("Minkowski: decomposition took %f s", t.time());
-        }
+        P[i] = decomposeConvex(operands[i], i);
       }
 
-      std::vector<Hull_kernel::Point_3> points[2];
-      std::vector<Hull_kernel::Point_3> minkowski_points;
-
-      CGAL::Cartesian_converter<CGAL_Kernel3, Hull_kernel> conv;
-
-      for (size_t i = 0; i < P[0].size(); ++i) {
-        for (size_t j = 0; j < P[1].size(); ++j) {
-          t.start();
-          points[0].clear();
-          points[1].clear();
-
-          for (int k = 0; k < 2; ++k) {
-            auto it = P[k].begin();
-            std::advance(it, k == 0 ? i : j);
-
-            CGAL_Polyhedron const& poly = *it;
-            points[k].reserve(poly.size_of_vertices());
-
-            for (CGAL_Polyhedron::Vertex_const_iterator pi = poly.vertices_begin();
-                 pi != poly.vertices_end(); ++pi) {
-              CGAL_Polyhedron::Point_3 const& p = pi->point();
-              points[k].push_back(conv(p));
-            }
-          }
-
-          minkowski_points.clear();
-          minkowski_points.reserve(points[0].size() * points[1].size());
-          for (size_t i = 0; i < points[0].size(); ++i) {
-            for (size_t j = 0; j < points[1].size(); ++j) {
-              minkowski_points.push_back(points[0][i] + (points[1][j] - CGAL::ORIGIN));
-            }
-          }
-
-          if (minkowski_points.size() <= 3) {
-            t.stop();
-            continue;
-          }
-
-          CGAL::Polyhedron_3<Hull_kernel> result;
-          t.stop();
-          PRINTDB("Minkowski: Point cloud creation (%d ⨉ %d -> %d) took %f ms",
-                  points[0].size() % points[1].size() % minkowski_points.size() % (t.time() * 1000));
-          t.reset();
-
-          t.start();
-
-          CGAL::convex_hull_3(minkowski_points.begin(), minkowski_points.end(), result);
-
-          std::vector<Hull_kernel::Point_3> strict_points;
-          strict_points.reserve(minkowski_points.size());
-
-          for (CGAL::Polyhedron_3<Hull_kernel>::Vertex_iterator i = result.vertices_begin();
-               i != result.vertices_end(); ++i) {
-            Hull_kernel::Point_3 const& p = i->point();
-
-            CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle h, e;
-            h = i->halfedge();
-            e = h;
-            bool collinear = false;
-            bool coplanar = true;
-
-            do {
-              Hull_kernel::Point_3 const& q = h->opposite()->vertex()->point();
-              if (coplanar && !CGAL::coplanar(
-                                p, q, h->next_on_vertex()->opposite()->vertex()->point(),
-                                h->next_on_vertex()->next_on_vertex()->opposite()->vertex()->point())) {
-                coplanar = false;
-              }
-
-              for (CGAL::Polyhedron_3<Hull_kernel>::Vertex::Halfedge_handle j = h->next_on_vertex();
-                   j != h && !collinear && !coplanar; j = j->next_on_vertex()) {
-                Hull_kernel::Point_3 const& r = j->opposite()->vertex()->point();
-                if (CGAL::collinear(p, q, r)) {
-                  collinear = true;
-                }
-              }
-
-              h = h->next_on_vertex();
-            } while (h != e && !collinear);
-
-            if (!collinear && !coplanar) strict_points.push_back(p);
-          }
-
-          result.clear();
-          CGAL::convex_hull_3(strict_points.begin(), strict_points.end(), result);
-
-          t.stop();
-          PRINTDB("Minkowski: Computing convex hull took %f s", t.time());
-          t.reset();
-
-          result_parts.push_back(result);
-        }
-      }
+      // Hulls of all pairs of convex parts are independent of each other
+      t.start();
+      std::vector<std::shared_ptr<const Geometry>> hulls(P[0]->size() * P[1]->size());
+      parallelizable_cross_product_transform(
+        *P[0], *P[1], hulls.begin(), [](const auto& points0, const auto& points1) {
+          return minkowskiHull(points0, points1);
+        });
+      std::vector<std::shared_ptr<const Geometry>> result_parts;
+      std::copy_if(hulls.begin(), hulls.end(), std::back_inserter(result_parts),
+                   [](const auto& hull) { return hull != nullptr; });
+      t.stop();
+      PRINTDB("Minkowski: Computing %d convex hulls took %f s", result_parts.size() % t.time());
+      t.reset();
 
       if (it != std::next(children.begin())) operands[0].reset();
 
-      auto partToGeom = [&](auto& poly) -> std::shared_ptr<const Geometry> {
-        return CGALUtils::createPolySetFromPolyhedron(poly);
-      };
-
       if (result_parts.size() == 1) {
-        operands[0] = partToGeom(*result_parts.begin());
+        operands[0] = result_parts.front();
       } else if (!result_parts.empty()) {
         t.start();
         PRINTDB("Minkowski: Computing union of %d parts", result_parts.size());
+        // This is applyUnion3D()'s usual smallest-first union, with no reduction of its own.
+        // Nef booleans aren't thread-safe, so the union can't be split up in parallel.
         Geometry::Geometries fake_children;
         for (const auto& part : result_parts) {
-          fake_children.emplace_back(std::shared_ptr<const AbstractNode>(), partToGeom(part));
+          fake_children.emplace_back(std::shared_ptr<const AbstractNode>(), part);
         }
-        auto N = CGALUtils::applyUnion3D(fake_children.begin(), fake_children.end());
+        auto N = CGALUtils::applyUnion3D(fake_children.begin(), fake_children.end(), progress);
         // FIXME: This should really never throw.
         // Assert once we figured out what went wrong with issue #1069?
         if (!N) throw 0;
@@ -209,12 +288,14 @@ std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& chi
     PRINTDB("Minkowski: Total execution time %f s", t_tot.time());
     t_tot.reset();
     return operands[0];
+  } catch (const ProgressCancelException&) {
+    throw;
   } catch (...) {
     // If anything throws we simply fall back to Nef Minkowski
     PRINTD("Minkowski: Falling back to Nef Minkowski");
 
-    auto N =
-      std::shared_ptr<const Geometry>(CGALUtils::applyOperator3D(children, OpenSCADOperator::MINKOWSKI));
+    auto N = std::shared_ptr<const Geometry>(
+      CGALUtils::applyOperator3D(children, OpenSCADOperator::MINKOWSKI, progress));
     return N;
   }
 }
@@ -31,13 +31,18 @@
 #include "core/node.h"
 #include "geometry/GeometryUtils.h"
 #include "geometry/Reindexer.h"
+#include "geometry/linalg.h"
 
 namespace CGALUtils {
 
-std::unique_ptr<const Geometry> applyUnion3D(Geometry::Geometries::iterator chbegin,
-                                             Geometry::Geometries::iterator chend)
+namespace {
+
+using QueueConstItem = std::pair<std::shared_ptr<const CGALNefGeometry>, int>;
+
+// Unions the given Nef polyhedra, always merging the two smallest ones first
+std::shared_ptr<const CGALNefGeometry> unionNefPolyhedra(std::vector<QueueConstItem> items,
+                                                         ProgressSink *progress)
 {
-  using QueueConstItem = std::pair<std::shared_ptr<const CGALNefGeometry>, int>;
   struct QueueItemGreater {
     // stable sort for priority_queue by facets, then progress mark
     bool operator()(const QueueConstItem& lhs, const QueueConstItem& rhs) const
@@ -47,36 +52,69 @@ std::unique_ptr<const Geometry> applyUnion3D(Geometry::Geometries::iterator chbe
       return (l > r) || (l == r && lhs.second > rhs.second);
     }
   };
-  std::priority_queue<QueueConstItem, std::vector<QueueConstItem>, QueueItemGreater> q;
+  std::priority_queue<QueueConstItem, std::vector<QueueConstItem>, QueueItemGreater> q(
+    QueueItemGreater(), std::move(items));
+
+  while (q.size() > 1) {
+    auto p1 = q.top();
+    q.pop();
+    auto p2 = q.top();
+    q.pop();
+    q.emplace(std::make_unique<const CGALNefGeometry>(*p1.first + *p2.first), -1);
+    progress_tick(progress);
+  }
+  if (q.empty()) return nullptr;
+  return q.top().first;
+}
+
+}  // namespace
+
+/*!
+   Unions all children.
 
+   Children are first grouped into clusters of overlapping bounding boxes, and Nef unions are
+   performed within each cluster. The cluster results are disjoint, so the final union of them
+   doesn't have to intersect any facets.
+ */
+std::unique_ptr<const Geometry> applyUnion3D(Geometry::Geometries::iterator chbegin,
+                                             Geometry::Geometries::iterator chend,
+                                             ProgressSink *progress)
+{
   try {
-    // sort children by fewest faces
+    std::vector<Geometry::GeometryItem> operands;
+    std::vector<BoundingBox> bounds;
     for (auto it = chbegin; it != chend; ++it) {
-      auto curChild = getNefPolyhedronFromGeometry(it->second);
-      if (curChild && !curChild->isEmpty()) {
-        int node_mark = -1;
-        if (it->first) {
-          node_mark = it->first->progress_mark;
-        }
-        q.emplace(curChild, node_mark);
+      if (it->second && !it->second->isEmpty()) {
+        operands.push_back(*it);
+        bounds.push_back(it->second->getBoundingBox());
       }
     }
 
-    progress_tick();
-    while (q.size() > 1) {
-      auto p1 = q.top();
-      q.pop();
-      auto p2 = q.top();
-      q.pop();
-      q.emplace(std::make_unique<const CGALNefGeometry>(*p1.first + *p2.first), -1);
-      progress_tick();
+    const auto clusters = GeometryUtils::clusterOverlappingBoundingBoxes(bounds);
+    progress_tick(progress);
+
+    std::vector<QueueConstItem> parts;
+    for (const auto& cluster : clusters) {
+      // sort children by fewest faces
+      std::vector<QueueConstItem> items;
+      for (const auto i : cluster) {
+        progress_check_cancel(progress);
+        auto curChild = getNefPolyhedronFromGeometry(operands[i].second);
+        if (curChild && !curChild->isEmpty()) {
+          int node_mark = -1;
+          if (operands[i].first) {
+            node_mark = operands[i].first->progress_mark;
+          }
+          items.emplace_back(curChild, node_mark);
+        }
+      }
+      if (auto N = unionNefPolyhedra(std::move(items), progress)) parts.emplace_back(N, -1);
     }
 
-    if (q.size() == 1) {
-      return std::make_unique<CGALNefGeometry>(q.top().first->p3);
-    } else {
-      return nullptr;
+    if (auto N = unionNefPolyhedra(std::move(parts), progress)) {
+      return std::make_unique<CGALNefGeometry>(N->p3);
     }
+    return nullptr;
   } catch (const CGAL::Failure_exception& e) {
     LOG(message_group::Error, "CGAL error in CGALUtils::applyUnion3D: %1$s", e.what());
   }
@@ -88,7 +126,7 @@ std::unique_ptr<const Geometry> applyUnion3D(Geometry::Geometries::iterator chbe
    The child list should be guaranteed to contain non-NULL 3D or empty Geometry objects
  */
 std::shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& children,
-                                                OpenSCADOperator op)
+                                                OpenSCADOperator op, ProgressSink *progress)
 {
   std::shared_ptr<CGALNefGeometry> N;
 
@@ -97,6 +135,7 @@ std::shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& chil
 
   try {
     for (const auto& item : children) {
+      progress_check_cancel(progress);
       const std::shared_ptr<const Geometry>& chgeom = item.second;
       auto chN = getNefPolyhedronFromGeometry(chgeom);
 
@@ -129,7 +168,7 @@ std::shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& chil
       case OpenSCADOperator::MINKOWSKI:    N->minkowski(*chN); break;
       default:                             LOG(message_group::Error, "Unsupported CGAL operator: %1$d", static_cast<int>(op));
       }
-      if (item.first) item.first->progress_report();
+      if (item.first) item.first->progress_report(progress);
     }
   }
   // union && difference assert triggered by tests/data/scad/bugs/rotate-diff-nonmanifold-crash.scad and
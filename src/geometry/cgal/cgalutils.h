@@ -16,6 +16,8 @@
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
 
+class ProgressSink;
+
 namespace CGALUtils {
 
 #ifdef ENABLE_CGAL
@@ -32,11 +34,17 @@ bool is_weakly_convex(const CGAL::Polyhedron_3<K>& p);
 template <typename K>
 bool is_weakly_convex(const CGAL::Surface_mesh<CGAL::Point_3<K>>& m);
 
+// These report progress to, and can be cancelled through, the given sink. Without a sink, the
+// one current for the calling thread is used.
 std::shared_ptr<const Geometry> applyOperator3D(const Geometry::Geometries& children,
-                                                OpenSCADOperator op);
+                                                OpenSCADOperator op, ProgressSink *progress = nullptr);
 std::unique_ptr<const Geometry> applyUnion3D(Geometry::Geometries::iterator chbegin,
-                                             Geometry::Geometries::iterator chend);
-std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children);
+                                             Geometry::Geometries::iterator chend,
+                                             ProgressSink *progress = nullptr);
+std::shared_ptr<const Geometry> applyMinkowski3D(const Geometry::Geometries& children,
+                                                 ProgressSink *progress = nullptr);
+// Drops the convex decompositions cached by applyMinkowski3D()
+void clearMinkowskiCache();
 std::unique_ptr<PolySet> applyHull3D(const Geometry::Geometries& children);
 
 std::unique_ptr<Polygon2d> project(const CGALNefGeometry& N, bool cut);
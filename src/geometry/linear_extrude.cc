@@ -19,6 +19,9 @@
 #include "geometry/linalg.h"
 #include "glview/RenderSettings.h"
 #include "utils/degree_trig.h"
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/manifoldutils.h"
+#endif
 
 namespace LinearExtrudeInternals {
 
@@ -41,6 +44,34 @@ int sgn_vdiff(const Vector2d& v1, const Vector2d& v2)
   return diff > scale ? (l1 < l2 ? -1 : 1) : 0;
 }
 
+/**
+ * Appends triangulated top and bottom faces to indices.
+ * @param index_offset Index of the first top face vertex; bottom face vertices start at 0.
+ */
+void addCapIndices(const Polygon2d& polyref, PolygonIndices& indices, int index_offset)
+{
+  // Get valid top and bottom edges (as Indexed Face Sets aka Indices).
+  // If top is scaled it doesn't matter: we're only using the edges and not vertices.
+  auto ps_topbottom = polyref.tessellate();
+  // Manifold tessellating doesn't add vertices (at least in this case? ever? not sure), so the indices
+  // remain valid.
+
+  // Copy indices for the top face, with appropriate offset.
+  IndexedFace p_offset;
+  for (const auto& p_original : ps_topbottom->indices) {
+    p_offset.clear();
+    for (int index : p_original) {
+      p_offset.push_back(index + index_offset);
+    }
+    indices.push_back(p_offset);
+  }
+
+  // Flip vertex ordering for bottom polygon and append it.
+  for (const auto& p : ps_topbottom->indices) {
+    indices.append(p.rbegin(), p.rend());
+  }
+}
+
 /**
  *
  * @param vertices The first polyref.length() vertices must be in the same order as polyref and represent
@@ -59,34 +90,38 @@ std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& polyref,
   final_polyset->vertices = std::move(vertices);
   final_polyset->indices = std::move(indices);
 
-  // Get valid top and bottom edges (as Indexed Face Sets aka Indices).
-  // If top is scaled it doesn't matter: we're only using the edges and not vertices.
-  auto ps_topbottom = polyref.tessellate();
-  // Manifold tessellating doesn't add vertices (at least in this case? ever? not sure), so the indices
-  // remain valid.
+  addCapIndices(polyref, final_polyset->indices, index_offset);
 
-  // Copy indices for the top face, with appropriate offset.
-  for (const auto& p_original : ps_topbottom->indices) {
-    final_polyset->indices.emplace_back();
-    auto& p_offset = final_polyset->indices.back();
+  // LOG(PolySetUtils::polySetToPolyhedronSource(*final_polyset));
 
-    for (int index : p_original) {
-      p_offset.push_back(index + index_offset);
-    }
-  }
+  return final_polyset;
+}
 
-  // Flip vertex ordering for bottom polygon and move it.
-  for (auto& p : ps_topbottom->indices) {
-    std::reverse(p.begin(), p.end());
+#ifdef ENABLE_MANIFOLD
+/**
+ * Like assemblePolySetForManifold(), but builds the ManifoldGeometry directly since the extruded
+ * topology is known to be valid. Only falls back to returning a PolySet (to be repaired when
+ * converted) if Manifold rejects the mesh.
+ */
+std::unique_ptr<Geometry> assembleManifoldGeometry(const Polygon2d& polyref,
+                                                   std::vector<Vector3d>&& vertices,
+                                                   PolygonIndices&& indices, int convexity,
+                                                   boost::tribool isConvex, int index_offset)
+{
+  addCapIndices(polyref, indices, index_offset);
+  if (auto mani = ManifoldUtils::createManifoldFromTriangles(vertices, indices)) {
+    mani->setConvexity(convexity);
+    return mani;
   }
-  std::copy(std::make_move_iterator(ps_topbottom->indices.begin()),
-            std::make_move_iterator(ps_topbottom->indices.end()),
-            std::back_inserter(final_polyset->indices));
-
-  // LOG(PolySetUtils::polySetToPolyhedronSource(*final_polyset));
 
+  auto final_polyset = std::make_unique<PolySet>(3, isConvex);
+  final_polyset->setTriangular(true);
+  final_polyset->setConvexity(convexity);
+  final_polyset->vertices = std::move(vertices);
+  final_polyset->indices = std::move(indices);
   return final_polyset;
 }
+#endif
 
 std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
                                                 std::vector<Vector3d>& vertices, PolygonIndices& indices,
@@ -113,7 +148,7 @@ std::unique_ptr<PolySet> assemblePolySetForCGAL(const Polygon2d& polyref,
   // Create bottom face.
   auto ps_bottom = polyref.tessellate();  // bottom
   // Flip vertex ordering for bottom polygon
-  for (auto& p : ps_bottom->indices) {
+  for (auto&& p : ps_bottom->indices) {
     std::reverse(p.begin(), p.end());
   }
   translatePolySet(*ps_bottom, h1);
@@ -404,14 +439,15 @@ std::unique_ptr<Geometry> extrudePolygon(const LinearExtrudeNode& node, const Po
   prepareVerticesAndIndices(polyref, h1, h2, num_slices, node.scale_x, node.scale_y, node.twist,
                             vertices, indices, slice_stride);
 
-  // For Manifold, we can tesselate the endcaps using existing vertices to build a manifold mesh.
+  // For Manifold, we can tesselate the endcaps using existing vertices to build a manifold mesh,
+  // and construct the ManifoldGeometry right away.
   // Without Manifold, however, we don't have such a tessellator available, so we'll have to build
   // the polyset from vertices using PolySetBuilder
 
 #ifdef ENABLE_MANIFOLD
   if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
-    return assemblePolySetForManifold(polyref, std::move(vertices), std::move(indices), node.convexity,
-                                      isConvex, slice_stride * num_slices);
+    return assembleManifoldGeometry(polyref, std::move(vertices), std::move(indices), node.convexity,
+                                    isConvex, slice_stride * num_slices);
   } else
 #endif
     return assemblePolySetForCGAL(polyref, vertices, indices, node.convexity, isConvex, node.scale_x,
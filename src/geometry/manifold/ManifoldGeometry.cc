@@ -6,14 +6,17 @@
 
 #include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <exception>
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <sstream>
 #include <string>
 #include <utility>
+#include <vector>
 
 #include "geometry/Geometry.h"
 #include "geometry/PolySet.h"
@@ -91,6 +94,7 @@ bool ManifoldGeometry::isValid() const
 void ManifoldGeometry::clear()
 {
   manifold_ = manifold::Manifold();
+  polyset_.reset();
 }
 
 // Note: We promise to only call memsize if we've already evaluated the object.
@@ -103,7 +107,8 @@ size_t ManifoldGeometry::memsize() const
   // - Normals (vert + 2*face): 24 + 48 = 72 bytes
   // - Mesh Relation (2*face): 32 bytes
   // Total ~ 224 bytes + vector overhead + properties
-  return getManifold().NumVert() * 250;
+  // The PolySet from toPolySet() is kept alive by this object, so it counts as well.
+  return getManifold().NumVert() * 250 + polyset_.memsize();
 }
 
 std::string ManifoldGeometry::dump() const
@@ -126,23 +131,36 @@ std::string ManifoldGeometry::dump() const
   return out.str();
 }
 
-std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
+std::shared_ptr<const PolySet> ManifoldGeometry::toPolySet() const
+{
+  // The colors of uncolored and subtracted faces depend on the color scheme
+  return polyset_.get(RenderSettings::inst()->colorscheme, [this]() { return createPolySet(); });
+}
+
+std::shared_ptr<const PolySet> ManifoldGeometry::createPolySet() const
 {
   manifold::MeshGL64 mesh = getManifold().GetMeshGL64();
   auto ps = std::make_shared<PolySet>(3);
   ps->setTriangular(true);
-  ps->vertices.reserve(mesh.NumVert());
   ps->indices.reserve(mesh.NumTri());
   ps->setConvexity(convexity);
   ps->setManifold(true);
 
   // first 3 channels are xyz coordinate
-  for (size_t i = 0; i < mesh.vertProperties.size(); i += mesh.numProp)
-    ps->vertices.emplace_back(mesh.vertProperties[i], mesh.vertProperties[i + 1],
-                              mesh.vertProperties[i + 2]);
+  static_assert(sizeof(Vector3d) == 3 * sizeof(double));
+  if (mesh.numProp == 3) {
+    ps->vertices.resize(mesh.NumVert());
+    std::memcpy(ps->vertices.data(), mesh.vertProperties.data(),
+                mesh.vertProperties.size() * sizeof(double));
+  } else {
+    ps->vertices.reserve(mesh.NumVert());
+    for (size_t i = 0; i < mesh.vertProperties.size(); i += mesh.numProp)
+      ps->vertices.emplace_back(mesh.vertProperties[i], mesh.vertProperties[i + 1],
+                                mesh.vertProperties[i + 2]);
+  }
 
   ps->colors.reserve(originalIDToColor_.size());
-  ps->color_indices.reserve(ps->indices.size());
+  ps->color_indices.reserve(mesh.NumTri());
 
   auto colorScheme = ColorMap::instance().findColorScheme(RenderSettings::inst()->colorscheme);
   int32_t faceFrontColorIndex = -1;
@@ -199,16 +217,54 @@ std::shared_ptr<PolySet> ManifoldGeometry::toPolySet() const
     }
 
     auto colorIndex = getColorIndex(id);
-    for (size_t i = start; i < end; i += 3) {
-      ps->indices.push_back({static_cast<int>(mesh.triVerts[i]), static_cast<int>(mesh.triVerts[i + 1]),
-                             static_cast<int>(mesh.triVerts[i + 2])});
-      ps->color_indices.push_back(colorIndex);
-    }
+    ps->indices.appendTriangles(mesh.triVerts.begin() + start, mesh.triVerts.begin() + end);
+    ps->color_indices.insert(ps->color_indices.end(), numTri, colorIndex);
     start = end;
   }
   return ps;
 }
 
+ManifoldGeometry::PolySetView::PolySetView(const PolySetView& other)
+{
+  std::lock_guard<std::mutex> lock(other.mutex);
+  this->ps = other.ps;
+  this->colorscheme = other.colorscheme;
+}
+
+ManifoldGeometry::PolySetView& ManifoldGeometry::PolySetView::operator=(const PolySetView& other)
+{
+  if (this != &other) {
+    std::scoped_lock lock(this->mutex, other.mutex);
+    this->ps = other.ps;
+    this->colorscheme = other.colorscheme;
+  }
+  return *this;
+}
+
+std::shared_ptr<const PolySet> ManifoldGeometry::PolySetView::get(
+  const std::string& colorscheme, const std::function<std::shared_ptr<const PolySet>()>& create)
+{
+  // Held while creating, so concurrent callers wait for the same PolySet
+  std::lock_guard<std::mutex> lock(this->mutex);
+  if (!this->ps || this->colorscheme != colorscheme) {
+    this->ps = create();
+    this->colorscheme = colorscheme;
+  }
+  return this->ps;
+}
+
+void ManifoldGeometry::PolySetView::reset()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->ps.reset();
+}
+
+size_t ManifoldGeometry::PolySetView::memsize() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->ps ? this->ps->memsize() : 0;
+}
+
 #ifdef ENABLE_CGAL
 template <typename Polyhedron>
 class CGALPolyhedronBuilderFromManifold : public CGAL::Modifier_base<typename Polyhedron::HalfedgeDS>
@@ -347,6 +403,22 @@ ManifoldGeometry ManifoldGeometry::minkowski(const ManifoldGeometry& other) cons
 #endif
 }
 
+ManifoldGeometry ManifoldGeometry::compose(const std::vector<ManifoldGeometry>& parts)
+{
+  std::vector<manifold::Manifold> manifolds;
+  manifolds.reserve(parts.size());
+  std::set<uint32_t> originalIDs;
+  std::map<uint32_t, Color4f> originalIDToColor;
+  std::set<uint32_t> subtractedIDs;
+  for (const auto& part : parts) {
+    manifolds.push_back(part.manifold_);
+    originalIDs.insert(part.originalIDs_.begin(), part.originalIDs_.end());
+    originalIDToColor.insert(part.originalIDToColor_.begin(), part.originalIDToColor_.end());
+    subtractedIDs.insert(part.subtractedIDs_.begin(), part.subtractedIDs_.end());
+  }
+  return {manifold::Manifold::Compose(manifolds), originalIDs, originalIDToColor, subtractedIDs};
+}
+
 Polygon2d ManifoldGeometry::slice() const
 {
   auto cross_section = manifold::CrossSection(manifold_.Slice());
@@ -366,6 +438,7 @@ void ManifoldGeometry::transform(const Transform3d& mat)
     {mat(0, 0), mat(1, 0), mat(2, 0)}, {mat(0, 1), mat(1, 1), mat(2, 1)},
     {mat(0, 2), mat(1, 2), mat(2, 2)}, {mat(0, 3), mat(1, 3), mat(2, 3)});
   manifold_ = getManifold().Transform(glMat);
+  polyset_.reset();
 }
 
 void ManifoldGeometry::setColor(const Color4f& c)
@@ -378,6 +451,7 @@ void ManifoldGeometry::setColor(const Color4f& c)
   originalIDToColor_.clear();
   originalIDToColor_[manifold_.OriginalID()] = c;
   subtractedIDs_.clear();
+  polyset_.reset();
 }
 
 void ManifoldGeometry::toOriginal()
@@ -389,6 +463,7 @@ void ManifoldGeometry::toOriginal()
   originalIDs_.insert(manifold_.OriginalID());
   originalIDToColor_.clear();
   subtractedIDs_.clear();
+  polyset_.reset();
 }
 
 BoundingBox ManifoldGeometry::getBoundingBox() const
@@ -8,8 +8,10 @@
 #include <functional>
 #include <map>
 #include <memory>
+#include <mutex>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
@@ -45,7 +47,9 @@ public:
   [[nodiscard]] unsigned int getDimension() const override { return 3; }
   [[nodiscard]] std::unique_ptr<Geometry> copy() const override;
 
-  [[nodiscard]] std::shared_ptr<PolySet> toPolySet() const;
+  /*! The mesh as a PolySet. This is created on first use and shared by all callers until the
+      geometry is modified, so it must not be changed. */
+  [[nodiscard]] std::shared_ptr<const PolySet> toPolySet() const;
 
   template <class Polyhedron>
   [[nodiscard]] std::shared_ptr<Polyhedron> toPolyhedron() const;
@@ -58,6 +62,8 @@ public:
   ManifoldGeometry operator-(const ManifoldGeometry& other) const;
   /*! minkowksi operation. */
   ManifoldGeometry minkowski(const ManifoldGeometry& other) const;
+  /*! union of pairwise disjoint parts, by concatenation rather than a boolean operation. */
+  static ManifoldGeometry compose(const std::vector<ManifoldGeometry>& parts);
 
   Polygon2d slice() const;
   Polygon2d project() const;
@@ -73,6 +79,28 @@ public:
   const manifold::Manifold& getManifold() const;
 
 private:
+  // The PolySet returned by toPolySet(). Copies of a ManifoldGeometry share it.
+  class PolySetView
+  {
+  public:
+    PolySetView() = default;
+    PolySetView(const PolySetView& other);
+    PolySetView& operator=(const PolySetView& other);
+
+    // Returns the PolySet, calling create() if there is none for the given color scheme
+    std::shared_ptr<const PolySet> get(const std::string& colorscheme,
+                                       const std::function<std::shared_ptr<const PolySet>()>& create);
+    void reset();
+    // Memory used by the PolySet, if there is one
+    [[nodiscard]] size_t memsize() const;
+
+  private:
+    mutable std::mutex mutex;
+    std::shared_ptr<const PolySet> ps;
+    std::string colorscheme;
+  };
+
+  [[nodiscard]] std::shared_ptr<const PolySet> createPolySet() const;
   ManifoldGeometry binOp(const ManifoldGeometry& lhs, const ManifoldGeometry& rhs,
                          manifold::OpType opType) const;
 
@@ -80,4 +108,5 @@ private:
   std::set<uint32_t> originalIDs_;
   std::map<uint32_t, Color4f> originalIDToColor_;
   std::set<uint32_t> subtractedIDs_;
+  mutable PolySetView polyset_;
 };
@@ -13,6 +13,7 @@
 #include <vector>
 
 #include "core/enums.h"
+#include "core/progress.h"
 #include "geometry/Geometry.h"
 #include "geometry/PolySet.h"
 #include "geometry/cgal/cgal.h"
@@ -27,7 +28,8 @@ namespace ManifoldUtils {
 /*!
    children cannot contain nullptr objects
  */
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children)
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children,
+                                               ProgressSink *progress)
 {
   assert(children.size() >= 2);
 
@@ -81,6 +83,7 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
     // Note: we could parallelize more, e.g. compute all decompositions ahead of time instead of doing
     // them 2 by 2, but this could use substantially more memory.
     while (++it != children.end()) {
+      progress_check_cancel(progress);
       operands[1] = it->second;
 
       std::vector<std::list<Hull_Points>> part_points(2);
@@ -222,7 +225,7 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
       for (const auto& part : result_parts) {
         fake_children.push_back(std::make_pair(std::shared_ptr<const AbstractNode>(), part));
       }
-      auto N = ManifoldUtils::applyOperator3DManifold(fake_children, OpenSCADOperator::UNION);
+      auto N = ManifoldUtils::applyOperator3DManifold(fake_children, OpenSCADOperator::UNION, progress);
 
       // FIXME: This should really never throw.
       // Assert once we figured out what went wrong with issue #1069?
@@ -239,13 +242,15 @@ std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& child
     PRINTDB("Minkowski: Total execution time %f s", t_tot.time());
     t_tot.reset();
     return operands[0];
+  } catch (const ProgressCancelException&) {
+    throw;
   } catch (const std::exception& e) {
     LOG(message_group::Warning,
         "[manifold] Minkowski failed with error, falling back to Nef operation: %1$s\n", e.what());
   } catch (...) {
     LOG(message_group::Warning, "[manifold] Minkowski hard-crashed, falling back to Nef operation.");
   }
-  return ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::MINKOWSKI);
+  return ManifoldUtils::applyOperator3DManifold(children, OpenSCADOperator::MINKOWSKI, progress);
 }
 
 }  // namespace ManifoldUtils
@@ -3,14 +3,18 @@
 
 #ifdef ENABLE_MANIFOLD
 
+#include <cstddef>
 #include <memory>
+#include <vector>
 
 #include "core/AST.h"
 #include "core/enums.h"
 #include "core/node.h"
 #include "core/progress.h"
 #include "geometry/Geometry.h"
+#include "geometry/GeometryUtils.h"
 #include "geometry/PolySet.h"
+#include "geometry/linalg.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 #include "geometry/manifold/manifoldutils.h"
 #include "utils/printutils.h"
@@ -22,16 +26,52 @@ Location getLocation(const std::shared_ptr<const AbstractNode>& node)
   return node && node->modinst ? node->modinst->location() : Location::NONE;
 }
 
+/*!
+   Unions all children. Children are first grouped into clusters of overlapping bounding boxes;
+   booleans are only performed within a cluster, and the disjoint cluster results are then
+   concatenated without any further boolean operation.
+ */
+std::shared_ptr<ManifoldGeometry> applyUnion3DManifold(const Geometry::Geometries& children,
+                                                       ProgressSink *progress)
+{
+  std::vector<std::shared_ptr<const ManifoldGeometry>> operands;
+  std::vector<std::shared_ptr<const AbstractNode>> nodes;
+  std::vector<BoundingBox> bounds;
+  for (const auto& item : children) {
+    progress_check_cancel(progress);
+    auto chN = item.second ? createManifoldFromGeometry(item.second) : nullptr;
+    if (!chN || chN->isEmpty()) continue;
+    bounds.push_back(chN->getBoundingBox());
+    operands.push_back(chN);
+    nodes.push_back(item.first);
+  }
+  if (operands.empty()) return nullptr;
+
+  std::vector<ManifoldGeometry> parts;
+  for (const auto& cluster : GeometryUtils::clusterOverlappingBoundingBoxes(bounds)) {
+    ManifoldGeometry part(*operands[cluster.front()]);
+    for (size_t i = 0; i < cluster.size(); ++i) {
+      progress_check_cancel(progress);
+      if (i > 0) part = part + *operands[cluster[i]];
+      if (nodes[cluster[i]]) nodes[cluster[i]]->progress_report(progress);
+    }
+    parts.push_back(part);
+  }
+  if (parts.size() == 1) return std::make_shared<ManifoldGeometry>(parts.front());
+  return std::make_shared<ManifoldGeometry>(ManifoldGeometry::compose(parts));
+}
+
 /*!
    Applies op to all children and returns the result.
    The child list should be guaranteed to contain non-NULL 3D or empty Geometry objects
  */
 std::shared_ptr<ManifoldGeometry> applyOperator3DManifold(const Geometry::Geometries& children,
-                                                          OpenSCADOperator op)
+                                                          OpenSCADOperator op, ProgressSink *progress)
 {
   if (op == OpenSCADOperator::HULL) {
     std::vector<manifold::vec3> pts;
     for (const auto& item : children) {
+      progress_check_cancel(progress);
       if (!item.second) continue;
       auto& chgeom = item.second;
       if (const auto *mani = dynamic_cast<const ManifoldGeometry *>(chgeom.get())) {
@@ -57,17 +97,20 @@ std::shared_ptr<ManifoldGeometry> applyOperator3DManifold(const Geometry::Geomet
           });
         }
       }
-      if (item.first) item.first->progress_report();
+      if (item.first) item.first->progress_report(progress);
     }
     if (pts.empty()) return nullptr;
     return std::make_shared<ManifoldGeometry>(manifold::Manifold::Hull(pts));
   }
 
+  if (op == OpenSCADOperator::UNION) return applyUnion3DManifold(children, progress);
+
   std::shared_ptr<ManifoldGeometry> geom;
 
   bool foundFirst = false;
 
   for (const auto& item : children) {
+    progress_check_cancel(progress);
     auto chN = item.second ? createManifoldFromGeometry(item.second) : nullptr;
 
     // Intersecting something with nothing results in nothing
@@ -97,7 +140,7 @@ std::shared_ptr<ManifoldGeometry> applyOperator3DManifold(const Geometry::Geomet
     case OpenSCADOperator::MINKOWSKI:    *geom = geom->minkowski(*chN); break;
     default:                             LOG(message_group::Error, "Unsupported CGAL operator: %1$d", static_cast<int>(op));
     }
-    if (item.first) item.first->progress_report();
+    if (item.first) item.first->progress_report(progress);
   }
   return geom;
 }
@@ -33,51 +33,71 @@ using Error = manifold::Manifold::Error;
 
 namespace {
 
-std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const PolySet& ps)
+/*!
+   Builds a manifold from a triangle mesh with optional per triangle colors, as stored in a PolySet.
+   Vertices which are close together are merged if the first attempt fails. The result's status
+   tells whether the mesh was accepted.
+ */
+std::unique_ptr<ManifoldGeometry> createManifoldFromMesh(const std::vector<Vector3d>& vertices,
+                                                         const PolygonIndices& indices,
+                                                         const std::vector<Color4f>& colors,
+                                                         const std::vector<int32_t>& color_indices)
 {
-  assert(ps.isTriangular());
-
   manifold::MeshGL64 mesh;
 
+  // Vector3d is three packed doubles, so the vertices can be copied as a whole
+  static_assert(sizeof(Vector3d) == 3 * sizeof(double));
   mesh.numProp = 3;
-  mesh.vertProperties.reserve(ps.vertices.size() * 3);
-  for (const auto& v : ps.vertices) {
-    mesh.vertProperties.push_back(v.x());
-    mesh.vertProperties.push_back(v.y());
-    mesh.vertProperties.push_back(v.z());
+  const double *coords = vertices.empty() ? nullptr : vertices.front().data();
+  mesh.vertProperties.assign(coords, coords + vertices.size() * 3);
+
+  // The indices of triangles are stored without offsets, so they can be used as they are
+  std::vector<int> flattened;
+  if (!indices.allTriangles()) {
+    flattened.reserve(indices.size() * 3);
+    for (const auto& face : indices) {
+      assert(face.size() == 3);
+      flattened.insert(flattened.end(), face.begin(), face.begin() + 3);
+    }
   }
-
-  mesh.triVerts.reserve(ps.indices.size() * 3);
+  const auto& triangles = indices.allTriangles() ? indices.indexData() : flattened;
+  mesh.triVerts.reserve(triangles.size());
 
   std::set<uint32_t> originalIDs;
   std::map<uint32_t, Color4f> originalIDToColor;
 
-  std::map<std::optional<Color4f>, std::vector<size_t>> colorToFaceIndices;
-  for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
-    auto color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
-    std::optional<Color4f> color;
-    if (color_index >= 0) {
-      color = ps.colors[color_index];
-    }
-    colorToFaceIndices[color].push_back(i);
-  }
-  auto next_id = manifold::Manifold::ReserveIDs(colorToFaceIndices.size());
-  for (const auto& [color, faceIndices] : colorToFaceIndices) {
-    auto id = next_id++;
-    if (color.has_value()) {
-      originalIDToColor[id] = color.value();
-    }
-
-    mesh.runIndex.push_back(mesh.triVerts.size());
+  if (color_indices.empty() && !indices.empty()) {
+    // No colors: all faces form a single run, in their original order
+    const auto id = manifold::Manifold::ReserveIDs(1);
+    mesh.runIndex.push_back(0);
     mesh.runOriginalID.push_back(id);
     originalIDs.insert(id);
+    mesh.triVerts.assign(triangles.begin(), triangles.end());
+  } else {
+    std::map<std::optional<Color4f>, std::vector<size_t>> colorToFaceIndices;
+    for (size_t i = 0, n = indices.size(); i < n; i++) {
+      auto color_index = i < color_indices.size() ? color_indices[i] : -1;
+      std::optional<Color4f> color;
+      if (color_index >= 0) {
+        color = colors[color_index];
+      }
+      colorToFaceIndices[color].push_back(i);
+    }
+    auto next_id = manifold::Manifold::ReserveIDs(colorToFaceIndices.size());
+    for (const auto& [color, faceIndices] : colorToFaceIndices) {
+      auto id = next_id++;
+      if (color.has_value()) {
+        originalIDToColor[id] = color.value();
+      }
 
-    for (size_t faceIndex : faceIndices) {
-      auto& face = ps.indices[faceIndex];
-      assert(face.size() == 3);
-      mesh.triVerts.push_back(face[0]);
-      mesh.triVerts.push_back(face[1]);
-      mesh.triVerts.push_back(face[2]);
+      mesh.runIndex.push_back(mesh.triVerts.size());
+      mesh.runOriginalID.push_back(id);
+      originalIDs.insert(id);
+
+      for (size_t faceIndex : faceIndices) {
+        const auto tri = triangles.begin() + faceIndex * 3;
+        mesh.triVerts.insert(mesh.triVerts.end(), tri, tri + 3);
+      }
     }
   }
   mesh.runIndex.push_back(mesh.triVerts.size());
@@ -99,13 +119,32 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const Poly
     }
   }
 
-  return std::make_shared<ManifoldGeometry>(mani, originalIDs, originalIDToColor);
+  return std::make_unique<ManifoldGeometry>(mani, originalIDs, originalIDToColor);
+}
+
+std::shared_ptr<ManifoldGeometry> createManifoldFromTriangularPolySet(const PolySet& ps)
+{
+  assert(ps.isTriangular());
+  return createManifoldFromMesh(ps.vertices, ps.indices, ps.colors, ps.color_indices);
 }
 
 }  // namespace
 
 namespace ManifoldUtils {
 
+std::shared_ptr<ManifoldGeometry> createManifoldFromPolySetWithoutRepair(const PolySet& ps)
+{
+  // We need to make sure our PolySet is triangulated before building a Manifold object
+  std::unique_ptr<const PolySet> triangulated;
+  if (!ps.isTriangular()) {
+    triangulated = PolySetUtils::tessellate_faces(ps);
+  }
+  const PolySet& triangle_set = ps.isTriangular() ? ps : *triangulated;
+
+  // Note: This function also performs a merge if the first attempt fails.
+  return createManifoldFromTriangularPolySet(triangle_set);
+}
+
 const char *statusToString(Error status)
 {
   switch (status) {
@@ -128,17 +167,9 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
 {
   // 1. If the PolySet is already manifold, we should be able to build a Manifold object directly
   // (through using manifold::Mesh).
-  // We need to make sure our PolySet is triangulated before doing that.
   // Note: We currently don't have a way of directly checking if a PolySet is manifold,
   // so we just try converting to a Manifold object and check its status.
-  std::unique_ptr<const PolySet> triangulated;
-  if (!ps.isTriangular()) {
-    triangulated = PolySetUtils::tessellate_faces(ps);
-  }
-  const PolySet& triangle_set = ps.isTriangular() ? ps : *triangulated;
-
-  // Note: This function also performs a merge if the first attempt fails.
-  auto mani = createManifoldFromTriangularPolySet(triangle_set);
+  auto mani = createManifoldFromPolySetWithoutRepair(ps);
   if (mani->getManifold().Status() == Error::NoError) {
     return mani;
   }
@@ -194,6 +225,20 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps)
   return std::make_shared<ManifoldGeometry>();
 }
 
+/*!
+   Builds a manifold directly from triangles whose topology is already known to be valid, such as
+   the output of extrusions, without going through a PolySet.
+   Returns nullptr if Manifold still rejects the mesh after merging vertices; the caller should
+   then fall back to createManifoldFromPolySet(), which can attempt a repair.
+ */
+std::unique_ptr<ManifoldGeometry> createManifoldFromTriangles(const std::vector<Vector3d>& vertices,
+                                                              const PolygonIndices& triangles)
+{
+  auto mani = createManifoldFromMesh(vertices, triangles, {}, {});
+  if (mani->getManifold().Status() != Error::NoError) return nullptr;
+  return mani;
+}
+
 std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(
   const std::shared_ptr<const Geometry>& geom)
 {
@@ -3,17 +3,30 @@
 #include <CGAL/Surface_mesh/Surface_mesh.h>
 
 #include <memory>
+#include <vector>
 
 #include "core/enums.h"
 #include "geometry/Geometry.h"
+#include "geometry/GeometryUtils.h"
+#include "geometry/linalg.h"
 #include "geometry/manifold/ManifoldGeometry.h"
 #include "manifold/manifold.h"
 
+class ProgressSink;
+
 namespace ManifoldUtils {
 
 const char *statusToString(manifold::Manifold::Error status);
 
 std::shared_ptr<ManifoldGeometry> createManifoldFromPolySet(const PolySet& ps);
+/*!
+   Like createManifoldFromPolySet(), but doesn't try to repair the mesh if it isn't manifold.
+   Vertices which are close together are merged, and the result's status tells whether that was
+   enough.
+ */
+std::shared_ptr<ManifoldGeometry> createManifoldFromPolySetWithoutRepair(const PolySet& ps);
+std::unique_ptr<ManifoldGeometry> createManifoldFromTriangles(const std::vector<Vector3d>& vertices,
+                                                              const PolygonIndices& triangles);
 std::shared_ptr<const ManifoldGeometry> createManifoldFromGeometry(
   const std::shared_ptr<const Geometry>& geom);
 
@@ -22,14 +35,18 @@ std::shared_ptr<ManifoldGeometry> createManifoldFromSurfaceMesh(const SurfaceMes
 template <typename SurfaceMesh>
 std::shared_ptr<SurfaceMesh> createSurfaceMeshFromManifold(const manifold::Manifold& mani);
 
+// Reports progress to, and can be cancelled through, the given sink. Without a sink, the one
+// current for the calling thread is used.
 std::shared_ptr<ManifoldGeometry> applyOperator3DManifold(const Geometry::Geometries& children,
-                                                          OpenSCADOperator op);
+                                                          OpenSCADOperator op,
+                                                          ProgressSink *progress = nullptr);
 
 Polygon2d polygonsToPolygon2d(const manifold::Polygons& polygons);
 
 #ifdef ENABLE_CGAL
 // FIXME: This shouldn't return const, but it does due to internal implementation details.
-std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children);
+std::shared_ptr<const Geometry> applyMinkowski(const Geometry::Geometries& children,
+                                               ProgressSink *progress = nullptr);
 #endif
 
 std::unique_ptr<PolySet> createTriangulatedPolySetFromPolygon2d(const Polygon2d& polygon2d);
@@ -386,7 +386,7 @@ std::unique_ptr<PolySet> voronoi_diagram_roof(const Polygon2d& poly, const Curve
       outline.vertices.assign(face.begin(), face.end());
       face_poly.addOutline(outline);
       auto tess = face_poly.tessellate();
-      for (const IndexedFace& triangle : tess->indices) {
+      for (const auto& triangle : tess->indices) {
         std::vector<int> roof;
         for (int tvind : triangle) {
           Vector3d tv = tess->vertices[tvind];
@@ -415,7 +415,7 @@ std::unique_ptr<PolySet> voronoi_diagram_roof(const Polygon2d& poly, const Curve
         poly_floor.addOutline(o);
       }
       auto tess = poly_floor.tessellate();
-      for (const IndexedFace& triangle : tess->indices) {
+      for (const auto& triangle : tess->indices) {
         std::vector<int> floor;
         for (const int tv : triangle) {
           floor.push_back(hatbuilder.vertexIndex(tess->vertices[tv]));
@@ -18,9 +18,35 @@
 #include "geometry/PolySetUtils.h"
 #include "geometry/Polygon2d.h"
 #include "geometry/linalg.h"
+#include "glview/RenderSettings.h"
 #include "utils/calc.h"
 #include "utils/degree_trig.h"
 #include "utils/printutils.h"
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/manifoldutils.h"
+#endif
+
+static void addCapIndices(const Polygon2d& polyref, PolygonIndices& indices, int index_offset,
+                          bool flip_faces)
+{
+  // Create top and bottom face.
+  auto ps_bottom = polyref.tessellate();  // bottom
+  // Flip vertex ordering for bottom polygon unless flip_faces is true
+  if (!flip_faces) {
+    for (auto&& p : ps_bottom->indices) {
+      std::reverse(p.begin(), p.end());
+    }
+  }
+  std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(), std::back_inserter(indices));
+
+  for (auto&& p : ps_bottom->indices) {
+    std::reverse(p.begin(), p.end());
+    for (auto& i : p) {
+      i += index_offset;
+    }
+  }
+  std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(), std::back_inserter(indices));
+}
 
 static std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& polyref,
                                                            std::vector<Vector3d>& vertices,
@@ -35,25 +61,7 @@ static std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& poly
   final_polyset->indices = std::move(indices);
 
   if (!closed) {
-    // Create top and bottom face.
-    auto ps_bottom = polyref.tessellate();  // bottom
-    // Flip vertex ordering for bottom polygon unless flip_faces is true
-    if (!flip_faces) {
-      for (auto& p : ps_bottom->indices) {
-        std::reverse(p.begin(), p.end());
-      }
-    }
-    std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(),
-              std::back_inserter(final_polyset->indices));
-
-    for (auto& p : ps_bottom->indices) {
-      std::reverse(p.begin(), p.end());
-      for (auto& i : p) {
-        i += index_offset;
-      }
-    }
-    std::copy(ps_bottom->indices.begin(), ps_bottom->indices.end(),
-              std::back_inserter(final_polyset->indices));
+    addCapIndices(polyref, final_polyset->indices, index_offset, flip_faces);
   }
 
   //  LOG(PolySetUtils::polySetToPolyhedronSource(*final_polyset));
@@ -61,6 +69,28 @@ static std::unique_ptr<PolySet> assemblePolySetForManifold(const Polygon2d& poly
   return final_polyset;
 }
 
+#ifdef ENABLE_MANIFOLD
+// Builds the ManifoldGeometry directly, falling back to a PolySet (which will be repaired when
+// converted) if Manifold rejects the mesh, e.g. due to rings collapsing onto the Y axis.
+static std::unique_ptr<Geometry> assembleManifoldGeometry(const Polygon2d& polyref,
+                                                          std::vector<Vector3d>& vertices,
+                                                          PolygonIndices& indices, bool closed,
+                                                          int convexity, int index_offset,
+                                                          bool flip_faces)
+{
+  if (!closed) {
+    addCapIndices(polyref, indices, index_offset, flip_faces);
+  }
+  if (auto mani = ManifoldUtils::createManifoldFromTriangles(vertices, indices)) {
+    mani->setConvexity(convexity);
+    return mani;
+  }
+  // Caps have already been added
+  return assemblePolySetForManifold(polyref, vertices, indices, true, convexity, index_offset,
+                                    flip_faces);
+}
+#endif
+
 /*!
    Input to extrude should be clean. This means non-intersecting, correct winding order
    etc., the input coming from a library like Clipper.
@@ -172,6 +202,12 @@ std::unique_ptr<Geometry> rotatePolygon(const RotateExtrudeNode& node, const Pol
   // modify vertices, so we technically may end up with broken end caps if we build OpenSCAD without
   // ENABLE_MANIFOLD. Should be fixed, but it's low priority and it's not trivial to come up with a test
   // case for this.
+#ifdef ENABLE_MANIFOLD
+  if (RenderSettings::inst()->backend3D == RenderBackend3D::ManifoldBackend) {
+    return assembleManifoldGeometry(poly, vertices, indices, closed, node.convexity,
+                                    slice_stride * num_sections, flip_faces);
+  }
+#endif
   return assemblePolySetForManifold(poly, vertices, indices, closed, node.convexity,
                                     slice_stride * num_sections, flip_faces);
 }
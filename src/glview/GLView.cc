@@ -27,6 +27,7 @@ GLView::GLView()
   showaxes = false;
   showcrosshairs = false;
   showscale = false;
+  interactive = false;
   colorscheme = &ColorMap::instance().defaultColorScheme();
   cam = Camera();
   far_far_away = RenderSettings::inst()->far_gl_clip_limit;
@@ -209,6 +210,11 @@ void GLView::paintGL()
     // FIXME: This belongs in the OpenCSG renderer, but it doesn't know about this ID yet
     OpenCSG::setContext(this->opencsg_id);
 #endif
+    const double pixel_size =
+      interactive && cam.pixel_height > 0
+        ? 2 * cam.zoomValue() * tan_degrees(cam.fov / 2) / cam.pixel_height
+        : 0.0;
+    this->renderer->setDetailHint(pixel_size);
     this->renderer->prepare(edge_shader.get());
     this->renderer->draw(showedges, edge_shader.get());
   }
@@ -61,6 +61,8 @@ public:
   void setShowEdges(bool enabled) { this->showedges = enabled; }
   [[nodiscard]] bool showCrosshairs() const { return this->showcrosshairs; }
   void setShowCrosshairs(bool enabled) { this->showcrosshairs = enabled; }
+  // While interactive, the render view may draw a simplified model (see Renderer::setDetailHint())
+  void setInteractive(bool enabled) { this->interactive = enabled; }
 
   virtual bool save(const char *filename) const = 0;
   [[nodiscard]] virtual std::string getRendererInfo() const = 0;
@@ -76,6 +78,7 @@ public:
   bool showedges;
   bool showcrosshairs;
   bool showscale;
+  bool interactive;
   GLdouble modelview[16];
   GLdouble projection[16];
   std::vector<SelectedObject> selected_obj;
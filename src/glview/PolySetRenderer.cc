@@ -26,9 +26,13 @@
 
 #include "PolySetRenderer.h"
 
+#include <algorithm>
+#include <atomic>
 #include <cassert>
+#include <chrono>
 #include <cmath>
 #include <cstddef>
+#include <future>
 #include <utility>
 #include <memory>
 #include <vector>
@@ -60,29 +64,25 @@
 #include "geometry/manifold/ManifoldGeometry.h"
 #endif
 
-// This renderer is used in Manifold mode (F6 with Manifold as geometry engine)
-PolySetRenderer::PolySetRenderer(const std::shared_ptr<const class Geometry>& geom)
-{
-  this->addGeometry(geom);
-}
+namespace {
 
-void PolySetRenderer::addGeometry(const std::shared_ptr<const Geometry>& geom)
+// Meshes smaller than this are drawn at full resolution at all times
+constexpr size_t DETAIL_LEVEL_MIN_TRIANGLES = 200000;
+// Number of grid cells along the largest bounding box extent, from finest to coarsest level
+constexpr double DETAIL_LEVEL_RESOLUTIONS[] = {1024, 256, 64};
+
+// Triangulated PolySet of 3D geometry, or nullptr if it's not 3D geometry
+std::shared_ptr<const PolySet> triangulated(const std::shared_ptr<const Geometry>& geom)
 {
-  assert(geom != nullptr);
-  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
-    for (const auto& item : geomlist->getChildren()) {
-      this->addGeometry(item.second);
-    }
-  } else if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
+  if (const auto ps = std::dynamic_pointer_cast<const PolySet>(geom)) {
     assert(ps->getDimension() == 3);
     // We need to tessellate here, in case the generated PolySet contains concave polygons
     // See tests/data/scad/3D/features/polyhedron-concave-test.scad
-    this->polysets_.push_back(PolySetUtils::tessellate_faces(*ps));
-  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
-    this->polygons_.emplace_back(poly, std::shared_ptr<const PolySet>(poly->tessellate()));
+    if (ps->isTriangular()) return ps;
+    return PolySetUtils::tessellate_faces(*ps);
 #ifdef ENABLE_MANIFOLD
   } else if (const auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
-    this->polysets_.push_back(mani->toPolySet());
+    return mani->toPolySet();
 #endif
 #ifdef ENABLE_CGAL
   } else if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
@@ -92,10 +92,60 @@ void PolySetRenderer::addGeometry(const std::shared_ptr<const Geometry>& geom)
     if (!N->isEmpty()) {
       if (auto ps = CGALUtils::createPolySetFromNefPolyhedron3(*N->p3)) {
         ps->setConvexity(N->getConvexity());
-        this->polysets_.push_back(std::shared_ptr<PolySet>(std::move(ps)));
+        return ps;
       }
     }
+    return PolySet::createEmpty();
 #endif
+  }
+  return nullptr;
+}
+
+}  // namespace
+
+// This renderer is used in Manifold mode (F6 with Manifold as geometry engine)
+PolySetRenderer::PolySetRenderer(const std::shared_ptr<const class Geometry>& geom)
+  : cancel_detail_levels_(std::make_shared<std::atomic<bool>>(false))
+{
+  this->addGeometry(geom);
+}
+
+PolySetRenderer::~PolySetRenderer()
+{
+  // Pending futures block on destruction. The simplification checks this flag as it goes, so
+  // they finish shortly after.
+  *cancel_detail_levels_ = true;
+}
+
+std::shared_ptr<const Geometry> PolySetRenderer::triangulate(const std::shared_ptr<const Geometry>& geom)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    Geometry::Geometries children;
+    for (const auto& item : geomlist->getChildren()) {
+      children.emplace_back(item.first, triangulate(item.second));
+    }
+    return std::make_shared<GeometryList>(std::move(children));
+  }
+  if (auto ps = triangulated(geom)) return ps;
+  return geom;
+}
+
+void PolySetRenderer::append(const std::shared_ptr<const Geometry>& geom)
+{
+  this->addGeometry(geom);
+}
+
+void PolySetRenderer::addGeometry(const std::shared_ptr<const Geometry>& geom)
+{
+  assert(geom != nullptr);
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) {
+      this->addGeometry(item.second);
+    }
+  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    this->polygons_.emplace_back(poly, std::shared_ptr<const PolySet>(poly->tessellate()));
+  } else if (auto ps = triangulated(geom)) {
+    this->polysets_.push_back(std::move(ps));
   } else {
     const auto& geom_ref = *geom.get();
     LOG("Unsupported geom '%1$s' in PolySetRenderer", typeid(geom_ref).name());
@@ -111,9 +161,10 @@ void PolySetRenderer::setColorScheme(const ColorScheme& cs)
   colormap_[ColorMode::CGAL_EDGE_2D_COLOR] = ColorMap::getColor(cs, RenderColor::CGAL_EDGE_2D_COLOR);
 }
 
-void PolySetRenderer::createPolySetStates(const ShaderUtils::ShaderInfo *shaderinfo)
+void PolySetRenderer::createPolySetStates(const PolySets& polysets,
+                                          VertexStateContainer& vertex_state_container,
+                                          const ShaderUtils::ShaderInfo *shaderinfo)
 {
-  VertexStateContainer& vertex_state_container = polyset_vertex_state_containers_.emplace_back();
   VBOBuilder vbo_builder(std::make_unique<VertexStateFactory>(), vertex_state_container);
 
   vbo_builder.addSurfaceData();  // position, normal, color
@@ -121,12 +172,12 @@ void PolySetRenderer::createPolySetStates(const ShaderUtils::ShaderInfo *shaderi
   const bool enable_barycentric = true;
 
   size_t num_vertices = 0;
-  for (const auto& polyset : this->polysets_) {
+  for (const auto& polyset : polysets) {
     num_vertices += calcNumVertices(*polyset);
   }
   vbo_builder.allocateBuffers(num_vertices);
 
-  for (const auto& polyset : this->polysets_) {
+  for (const auto& polyset : polysets) {
     Color4f color;
     if (!polyset->colors.empty()) color = polyset->colors[0];
     getShaderColor(ColorMode::MATERIAL, color, color);
@@ -139,6 +190,46 @@ void PolySetRenderer::createPolySetStates(const ShaderUtils::ShaderInfo *shaderi
   vbo_builder.createInterleavedVBOs();
 }
 
+void PolySetRenderer::setDetailHint(double pixel_size)
+{
+  pixel_size_ = pixel_size;
+  if (pixel_size_ > 0 && !detail_levels_started_) startDetailLevels();
+}
+
+// Start simplifying polysets_ in the background. This only happens once the camera first
+// moves, so renderers which are never interacted with (e.g. for export) never pay for it.
+void PolySetRenderer::startDetailLevels()
+{
+  detail_levels_started_ = true;
+
+  size_t num_triangles = 0;
+  for (const auto& polyset : this->polysets_) num_triangles += polyset->indices.size();
+  if (num_triangles < DETAIL_LEVEL_MIN_TRIANGLES) return;
+
+  const auto extent = getBoundingBox().sizes().maxCoeff();
+  if (!(extent > 0)) return;
+
+  for (const auto resolution : DETAIL_LEVEL_RESOLUTIONS) {
+    const double cell_size = extent / resolution;
+    auto pending = std::async(
+      std::launch::async,
+      [polysets = this->polysets_, cell_size, num_triangles, cancel = cancel_detail_levels_]() {
+        PolySets result;
+        size_t result_triangles = 0;
+        for (const auto& polyset : polysets) {
+          auto simplified = PolySetUtils::simplify_by_clustering(*polyset, cell_size, cancel.get());
+          if (!simplified) return PolySets();
+          result_triangles += simplified->indices.size();
+          result.push_back(std::move(simplified));
+        }
+        // Not worth drawing if it doesn't save much
+        if (result_triangles > num_triangles / 2) return PolySets();
+        return result;
+      });
+    detail_levels_.push_back({cell_size, this->polysets_.size(), std::move(pending)});
+  }
+}
+
 void PolySetRenderer::createPolygonStates()
 {
   createPolygonSurfaceStates();
@@ -216,14 +307,31 @@ void PolySetRenderer::createPolygonEdgeStates()
 
 void PolySetRenderer::prepare(const ShaderUtils::ShaderInfo *shaderinfo)
 {
-  if (polyset_vertex_state_containers_.empty() && polygon_vertex_state_containers_.empty()) {
+  if (prepared_polysets_ < this->polysets_.size() || prepared_polygons_ < this->polygons_.size()) {
     if (!this->polysets_.empty() && !this->polygons_.empty()) {
       LOG(message_group::Error, "PolySetRenderer::prepare() called with both polysets and polygons");
     } else if (!this->polysets_.empty()) {
-      createPolySetStates(shaderinfo);
+      // Appended polysets get buffers of their own
+      const PolySets added(this->polysets_.begin() + prepared_polysets_, this->polysets_.end());
+      createPolySetStates(added, polyset_vertex_state_containers_.emplace_back(), shaderinfo);
     } else if (!this->polygons_.empty()) {
+      polygon_vertex_state_containers_.clear();
       createPolygonStates();
     }
+    prepared_polysets_ = this->polysets_.size();
+    prepared_polygons_ = this->polygons_.size();
+  }
+
+  for (auto& level : detail_levels_) {
+    if (!level.pending.valid() ||
+        level.pending.wait_for(std::chrono::seconds(0)) != std::future_status::ready) {
+      continue;
+    }
+    const auto polysets = level.pending.get();
+    if (!polysets.empty()) {
+      createPolySetStates(polysets, level.container, shaderinfo);
+      level.ready = true;
+    }
   }
 }
 
@@ -245,13 +353,29 @@ void PolySetRenderer::drawPolySets(bool showedges, const ShaderUtils::ShaderInfo
     VBOUtils::shader_attribs_enable(*shaderinfo);
   }
 
-  for (const auto& container : polyset_vertex_state_containers_) {
+  // While the camera moves, use the coarsest level whose cells are at most about two pixels wide
+  const VertexStateContainer *detail_container = nullptr;
+  if (pixel_size_ > 0) {
+    for (const auto& level : detail_levels_) {
+      if (level.ready && level.num_polysets == this->polysets_.size() &&
+          level.cell_size <= 2 * pixel_size_) {
+        detail_container = &level.container;
+      }
+    }
+  }
+
+  const auto draw_container = [showedges](const VertexStateContainer& container) {
     for (const auto& vertex_state : container.states()) {
       const auto shader_vs = std::dynamic_pointer_cast<VBOShaderVertexState>(vertex_state);
       if (!shader_vs || (shader_vs && showedges)) {
         vertex_state->draw();
       }
     }
+  };
+  if (detail_container) {
+    draw_container(*detail_container);
+  } else {
+    for (const auto& container : polyset_vertex_state_containers_) draw_container(container);
   }
 
   if (enable_shader) {
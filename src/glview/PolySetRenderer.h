@@ -1,5 +1,7 @@
 #pragma once
 
+#include <atomic>
+#include <future>
 #include <memory>
 #include <utility>
 #include <vector>
@@ -18,9 +20,18 @@ class PolySetRenderer : public VBORenderer
 {
 public:
   PolySetRenderer(const std::shared_ptr<const class Geometry>& geom);
-  ~PolySetRenderer() override = default;
+  ~PolySetRenderer() override;
+
+  // Converts 3D geometry to the triangulated PolySets this renderer draws. This is the expensive
+  // part of adding geometry, so it can be done up front on another thread.
+  static std::shared_ptr<const Geometry> triangulate(const std::shared_ptr<const Geometry>& geom);
+  // Adds geometry after construction, e.g. partial results arriving piece by piece. The next
+  // prepare() only builds buffers for the added geometry.
+  void append(const std::shared_ptr<const Geometry>& geom);
+
   void prepare(const ShaderUtils::ShaderInfo *shaderinfo) override;
   void draw(bool showedges, const ShaderUtils::ShaderInfo *shaderinfo) const override;
+  void setDetailHint(double pixel_size) override;
   void setColorScheme(const ColorScheme& cs) override;
   BoundingBox getBoundingBox() const override;
 
@@ -34,8 +45,23 @@ public:
                                               int mouse_x, int mouse_y, double tolerance) override;
 
 private:
+  using PolySets = std::vector<std::shared_ptr<const class PolySet>>;
+
+  // Simplified copy of polysets_, built in the background and drawn instead of the full
+  // resolution mesh while the camera moves.
+  struct DetailLevel {
+    double cell_size;
+    // Number of polysets_ covered. Levels aren't drawn once more geometry has been appended.
+    size_t num_polysets;
+    std::future<PolySets> pending;
+    VertexStateContainer container;
+    bool ready{false};
+  };
+
   void addGeometry(const std::shared_ptr<const class Geometry>& geom);
-  void createPolySetStates(const ShaderUtils::ShaderInfo *shaderinfo);
+  void startDetailLevels();
+  void createPolySetStates(const PolySets& polysets, VertexStateContainer& vertex_state_container,
+                           const ShaderUtils::ShaderInfo *shaderinfo);
   void createPolygonStates();
   void createPolygonSurfaceStates();
   void createPolygonEdgeStates();
@@ -43,9 +69,17 @@ private:
   void drawPolySets(bool showedges, const ShaderUtils::ShaderInfo *shaderinfo) const;
   void drawPolygons() const;
 
-  std::vector<std::shared_ptr<const class PolySet>> polysets_;
+  PolySets polysets_;
   std::vector<std::pair<std::shared_ptr<const Polygon2d>, std::shared_ptr<const PolySet>>> polygons_;
 
   std::vector<VertexStateContainer> polyset_vertex_state_containers_;
   std::vector<VertexStateContainer> polygon_vertex_state_containers_;
+  // Number of polysets_ and polygons_ which have buffers
+  size_t prepared_polysets_{0};
+  size_t prepared_polygons_{0};
+
+  std::vector<DetailLevel> detail_levels_;
+  bool detail_levels_started_{false};
+  std::shared_ptr<std::atomic<bool>> cancel_detail_levels_;
+  double pixel_size_{0.0};
 };
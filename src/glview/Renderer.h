@@ -38,6 +38,10 @@ public:
   virtual void prepare(const ShaderUtils::ShaderInfo *shaderinfo) = 0;
   virtual void draw(bool showedges, const ShaderUtils::ShaderInfo *shaderinfo) const = 0;
   [[nodiscard]] virtual BoundingBox getBoundingBox() const = 0;
+  // Called before prepare() with the size of a pixel in model units at the view center while the
+  // view is being interacted with, or 0 when the model should be drawn at full detail.
+  // Only PolySetRenderer draws simplified meshes; the preview renderers ignore the hint.
+  virtual void setDetailHint(double /*pixel_size*/) {}
 
   enum class ColorMode {
     NONE,
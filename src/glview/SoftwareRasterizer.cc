@@ -0,0 +1,579 @@
+#include "glview/SoftwareRasterizer.h"
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <Eigen/Core>
+#include <Eigen/Geometry>
+
+#include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "glview/Camera.h"
+#include "glview/ColorMap.h"
+#include "io/imageutils.h"
+#include "utils/degree_trig.h"
+#include "utils/parallel.h"
+
+namespace {
+
+constexpr int TILE_SIZE = 64;
+
+// Vertices per surface above which they are transformed in parallel
+constexpr size_t PARALLEL_TRANSFORM_SIZE = 16384;
+
+std::array<float, 4> toRGBA(const Color4f& color)
+{
+  return {color.r(), color.g(), color.b(), color.a()};
+}
+
+// Barycentric attribute of one triangle corner, as created by VBOBuilder::create_surface().
+// A component stays at 1 along edges internal to the source polygon, so they are not drawn.
+std::array<float, 3> barycentricFlags(size_t corner, size_t shape_size)
+{
+  std::array<float, 3> flags;
+  if (shape_size == 3) {
+    flags = {0, 0, 0};
+  } else if (shape_size == 4) {
+    flags = {1, 0, 0};
+  } else {
+    flags = {0, 1, 1};
+  }
+  flags[corner] = 1;
+  return flags;
+}
+
+// edgeFactor() from ViewEdges.frag, with fwidth() given per component
+float edgeFactor(const std::array<float, 3>& bc, const std::array<float, 3>& fw)
+{
+  constexpr float th = 1.414f;
+  float factor = 1.0f;
+  for (size_t k = 0; k < 3; ++k) {
+    const float t = fw[k] > 0.0f ? std::clamp(bc[k] / (th * fw[k]), 0.0f, 1.0f) : 1.0f;
+    factor = std::min(factor, t * t * (3.0f - 2.0f * t));
+  }
+  return factor;
+}
+
+// Clip a convex polygon against the plane where distance(clip) >= 0.
+// out must have room for count + 1 vertices. Returns the new vertex count.
+template <typename Vertex, typename Distance>
+size_t clipPolygon(const Vertex *in, size_t count, Vertex *out, const Distance& distance)
+{
+  size_t n = 0;
+  for (size_t i = 0; i < count; ++i) {
+    const Vertex& a = in[i];
+    const Vertex& b = in[(i + 1) % count];
+    const double da = distance(a.clip);
+    const double db = distance(b.clip);
+    if (da >= 0) out[n++] = a;
+    if ((da >= 0) != (db >= 0)) {
+      const double t = da / (da - db);
+      Vertex& v = out[n++];
+      v.clip = a.clip + t * (b.clip - a.clip);
+      for (size_t k = 0; k < 3; ++k) {
+        const float delta = b.barycentric[k] - a.barycentric[k];
+        v.barycentric[k] = a.barycentric[k] + static_cast<float>(t) * delta;
+      }
+    }
+  }
+  return n;
+}
+
+double nearDistance(const Eigen::Vector4d& clip) { return clip.w() + clip.z(); }
+double farDistance(const Eigen::Vector4d& clip) { return clip.w() - clip.z(); }
+
+}  // namespace
+
+SoftwareRasterizer::SoftwareRasterizer(const Camera& camera, const ColorScheme& colorscheme)
+  : width(static_cast<int>(std::max(camera.pixel_width, 1u))),
+    height(static_cast<int>(std::max(camera.pixel_height, 1u))),
+    tiles_x((width + TILE_SIZE - 1) / TILE_SIZE),
+    tiles_y((height + TILE_SIZE - 1) / TILE_SIZE),
+    perspective(camera.projection == Camera::ProjectionType::PERSPECTIVE),
+    distance(camera.zoomValue()),
+    light0(Eigen::Vector3d(-1.0, +1.0, +1.0).normalized()),
+    light1(Eigen::Vector3d(+1.0, -1.0, -1.0).normalized()),
+    object_trans(camera.object_trans),
+    colorscheme(colorscheme),
+    tile_triangles(static_cast<size_t>(tiles_x) * tiles_y)
+{
+  // Same matrices as GLView::setupCamera()
+  const double aspectratio = static_cast<double>(width) / height;
+  projection.setZero();
+  if (perspective) {
+    const double near = 0.1 * distance;
+    const double far = 100 * distance;
+    const double f = 1.0 / tan_degrees(camera.fov / 2);
+    projection(0, 0) = f / aspectratio;
+    projection(1, 1) = f;
+    projection(2, 2) = (far + near) / (near - far);
+    projection(2, 3) = 2 * far * near / (near - far);
+    projection(3, 2) = -1;
+  } else {
+    const double top = distance * tan_degrees(camera.fov / 2);
+    projection(0, 0) = 1 / (top * aspectratio);
+    projection(1, 1) = 1 / top;
+    projection(2, 2) = -1 / (100 * distance);
+    projection(3, 3) = 1;
+  }
+
+  Eigen::Affine3d view = Eigen::Affine3d::Identity();
+  // gluLookAt() from (0, -distance, 0) towards the origin, with z up
+  view.linear() << 1, 0, 0, 0, 0, 1, 0, -1, 0;
+  view.translate(Vector3d(0, distance, 0));
+  view.rotate(angle_axis_degrees(camera.object_rot.x(), Vector3d::UnitX()));
+  view.rotate(angle_axis_degrees(camera.object_rot.y(), Vector3d::UnitY()));
+  view.rotate(angle_axis_degrees(camera.object_rot.z(), Vector3d::UnitZ()));
+  view.translate(camera.object_trans);
+  modelview = view.matrix();
+
+  // Background gradient, see GLView::paintGL()
+  const auto bgcol = ColorMap::getColor(colorscheme, RenderColor::BACKGROUND_COLOR);
+  const auto bgstopcol = ColorMap::getColor(colorscheme, RenderColor::BACKGROUND_STOP_COLOR);
+  const size_t num_pixels = static_cast<size_t>(width) * height;
+  color_buffer.resize(3 * num_pixels);
+  depth_buffer.assign(num_pixels, 1.0f);
+  for (int y = 0; y < height; ++y) {
+    const float t = (static_cast<float>(y) + 0.5f) / static_cast<float>(height);
+    const float r = bgcol.r() + t * (bgstopcol.r() - bgcol.r());
+    const float g = bgcol.g() + t * (bgstopcol.g() - bgcol.g());
+    const float b = bgcol.b() + t * (bgstopcol.b() - bgcol.b());
+    float *row = &color_buffer[3 * static_cast<size_t>(y) * width];
+    for (int x = 0; x < width; ++x) {
+      row[3 * x + 0] = r;
+      row[3 * x + 1] = g;
+      row[3 * x + 2] = b;
+    }
+  }
+}
+
+void SoftwareRasterizer::addCrosshairs()
+{
+  // Fixed at the center of the viewport, i.e. not following the object translation
+  const auto color = ColorMap::getColor(colorscheme, RenderColor::CROSSHAIR_COLOR);
+  const double vd = distance / 8;
+  for (double xf : {-1.0, 1.0}) {
+    for (double yf : {-1.0, 1.0}) {
+      addLine(Vector3d(-xf * vd, -yf * vd, -vd) - object_trans,
+              Vector3d(+xf * vd, +yf * vd, +vd) - object_trans, color, 1.0);
+    }
+  }
+}
+
+void SoftwareRasterizer::addAxes()
+{
+  // GLView draws the axes out to infinity. Points far beyond the far plane do the same
+  // once the lines are clipped.
+  const auto color = ColorMap::getColor(colorscheme, RenderColor::AXES_COLOR);
+  const double far = 1000 * distance;
+  const std::array<Vector3d, 3> axes = {Vector3d::UnitX(), Vector3d::UnitY(), Vector3d::UnitZ()};
+  for (const auto& axis : axes) {
+    addLine(Vector3d::Zero(), far * axis, color, 1.0);
+  }
+  for (const auto& axis : axes) {
+    addLine(Vector3d::Zero(), -far * axis, color, 1.0, true, true);
+  }
+}
+
+void SoftwareRasterizer::addSurface(const PolySet& ps, const Transform3d& m,
+                                    const Color4f& default_color, bool force_default_color,
+                                    CullFace cull, bool lit)
+{
+  const bool mirrored = m.matrix().determinant() < 0;
+  const Eigen::Matrix4d mv = modelview * m.matrix();
+  const Eigen::Matrix4d mvp = projection * mv;
+
+  std::vector<Vector3d> eye(ps.vertices.size());
+  std::vector<Eigen::Vector4d> clip(ps.vertices.size());
+  const auto transform = [&](size_t i) {
+    const Eigen::Vector4d v = ps.vertices[i].homogeneous();
+    eye[i] = (mv * v).head<3>();
+    clip[i] = mvp * v;
+  };
+  if (ps.vertices.size() > PARALLEL_TRANSFORM_SIZE) {
+    parallelizable_for(0, ps.vertices.size(), transform);
+  } else {
+    for (size_t i = 0; i < ps.vertices.size(); ++i) transform(i);
+  }
+
+  const auto add_triangle = [&](const Color4f& color, const std::array<const Vector3d *, 3>& e,
+                                const std::array<const Eigen::Vector4d *, 3>& c, size_t shape_size) {
+    // Mirroring transforms flip the winding, the same as the vertex order swap in VBOBuilder
+    const std::array<size_t, 3> order = mirrored ? std::array<size_t, 3>{0, 2, 1}
+                                                 : std::array<size_t, 3>{0, 1, 2};
+    const Vector3d& p0 = *e[order[0]];
+    Vector3d n = (*e[order[1]] - p0).cross(*e[order[2]] - p0);
+    const double len = n.norm();
+    if (len == 0) return;
+    n /= len;
+
+    // Facing as seen from the camera, which is what glCullFace() decides from the winding
+    const bool front = perspective ? n.dot(p0) < 0 : n.z() > 0;
+    if ((cull == CullFace::BACK && !front) || (cull == CullFace::FRONT && front)) return;
+
+    RGBA rgba = toRGBA(color);
+    RGBA edge_rgba{};
+    const bool edges = lit && showedges;
+    if (edges) {
+      // ViewEdges shader
+      const float shading = 0.2f + static_cast<float>(std::abs(n.dot(light0)));
+      edge_rgba = {(rgba[0] + 1) / 2, (rgba[1] + 1) / 2, (rgba[2] + 1) / 2, 1.0f};
+      for (size_t k = 0; k < 3; ++k) rgba[k] *= shading;
+    } else if (lit) {
+      // Fixed function lighting set up in GLView::initializeGL(): default ambient
+      // and two white directional lights
+      const float shading = 0.2f + static_cast<float>(std::max(0.0, n.dot(light0)) +
+                                                      std::max(0.0, n.dot(light1)));
+      for (size_t k = 0; k < 3; ++k) rgba[k] = std::min(1.0f, rgba[k] * shading);
+    }
+
+    std::array<Vertex, 3> vertices;
+    for (size_t k = 0; k < 3; ++k) {
+      vertices[k].clip = *c[order[k]];
+      vertices[k].barycentric = barycentricFlags(order[k], shape_size);
+    }
+    addTriangle(vertices, rgba, edge_rgba, edges);
+  };
+
+  const bool has_colors = !ps.color_indices.empty();
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    const auto& poly = ps.indices[i];
+    const int32_t color_index = has_colors && i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+    const auto& color = !force_default_color && color_index >= 0 &&
+                            static_cast<size_t>(color_index) < ps.colors.size() &&
+                            ps.colors[color_index].isValid()
+                          ? ps.colors[color_index]
+                          : default_color;
+    // Same triangulation as VBOBuilder::create_surface()
+    if (poly.size() == 3) {
+      add_triangle(color, {&eye[poly[0]], &eye[poly[1]], &eye[poly[2]]},
+                   {&clip[poly[0]], &clip[poly[1]], &clip[poly[2]]}, 3);
+    } else if (poly.size() == 4) {
+      add_triangle(color, {&eye[poly[0]], &eye[poly[1]], &eye[poly[3]]},
+                   {&clip[poly[0]], &clip[poly[1]], &clip[poly[3]]}, 4);
+      add_triangle(color, {&eye[poly[2]], &eye[poly[3]], &eye[poly[1]]},
+                   {&clip[poly[2]], &clip[poly[3]], &clip[poly[1]]}, 4);
+    } else if (poly.size() > 4) {
+      Vector3d center = Vector3d::Zero();
+      for (const auto& idx : poly) {
+        center += ps.vertices[idx];
+      }
+      center /= poly.size();
+      const Vector3d center_eye = (mv * center.homogeneous()).head<3>();
+      const Eigen::Vector4d center_clip = mvp * center.homogeneous();
+      for (size_t j = 1; j <= poly.size(); ++j) {
+        const auto a = poly[j - 1];
+        const auto b = poly[j % poly.size()];
+        add_triangle(color, {&center_eye, &eye[a], &eye[b]}, {&center_clip, &clip[a], &clip[b]},
+                     poly.size());
+      }
+    }
+  }
+}
+
+void SoftwareRasterizer::addOutlines(const Polygon2d& poly, const Color4f& color)
+{
+  for (const auto& outline : poly.outlines()) {
+    const auto& vertices = outline.vertices;
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      const auto& p0 = vertices[i];
+      const auto& p1 = vertices[(i + 1) % vertices.size()];
+      addLine(Vector3d(p0.x(), p0.y(), 0), Vector3d(p1.x(), p1.y(), 0), color, 2.0, false);
+    }
+  }
+}
+
+void SoftwareRasterizer::addLine(const Vector3d& p0, const Vector3d& p1, const Color4f& color,
+                                 double line_width, bool depth_test, bool stipple)
+{
+  const Eigen::Matrix4d mvp = projection * modelview;
+  std::array<Vertex, 2> segment;
+  segment[0].clip = mvp * p0.homogeneous();
+  segment[1].clip = mvp * p1.homogeneous();
+  for (const auto& plane_distance : {nearDistance, farDistance}) {
+    const double d0 = plane_distance(segment[0].clip);
+    const double d1 = plane_distance(segment[1].clip);
+    if (d0 < 0 && d1 < 0) return;
+    if (d0 < 0) segment[0].clip += d0 / (d0 - d1) * (segment[1].clip - segment[0].clip);
+    if (d1 < 0) segment[1].clip += d1 / (d1 - d0) * (segment[0].clip - segment[1].clip);
+  }
+
+  const Vector3d s0 = toScreen(segment[0].clip);
+  const Vector3d s1 = toScreen(segment[1].clip);
+  const Vector3d delta = s1 - s0;
+  const double len = delta.head<2>().norm();
+  if (len == 0) return;
+
+  // Only the part of the line which is on screen matters
+  double t_min = 0.0, t_max = 1.0;
+  for (size_t axis = 0; axis < 2; ++axis) {
+    const double lo = -line_width;
+    const double hi = (axis == 0 ? width : height) + line_width;
+    if (delta[axis] == 0) {
+      if (s0[axis] < lo || s0[axis] > hi) return;
+      continue;
+    }
+    double t0 = (lo - s0[axis]) / delta[axis];
+    double t1 = (hi - s0[axis]) / delta[axis];
+    if (t0 > t1) std::swap(t0, t1);
+    t_min = std::max(t_min, t0);
+    t_max = std::min(t_max, t1);
+  }
+  if (t_min >= t_max) return;
+
+  const Eigen::Vector2d normal = Eigen::Vector2d(-delta.y(), delta.x()) * (line_width / 2 / len);
+  Triangle tri;
+  tri.color = toRGBA(color);
+  tri.barycentric = {};
+  tri.edge_color = {};
+  tri.depth_test = depth_test;
+  tri.edges = false;
+  const auto add_segment = [&](double t0, double t1) {
+    const Vector3d q0 = s0 + t0 * delta;
+    const Vector3d q1 = s0 + t1 * delta;
+    const std::array<Eigen::Vector2d, 4> corners = {q0.head<2>() - normal, q1.head<2>() - normal,
+                                                    q1.head<2>() + normal, q0.head<2>() + normal};
+    const std::array<double, 4> depths = {q0.z(), q1.z(), q1.z(), q0.z()};
+    for (const auto& quad_triangle : {std::array<size_t, 3>{0, 1, 2}, std::array<size_t, 3>{0, 2, 3}}) {
+      for (size_t k = 0; k < 3; ++k) {
+        tri.x[k] = static_cast<float>(corners[quad_triangle[k]].x());
+        tri.y[k] = static_cast<float>(corners[quad_triangle[k]].y());
+        tri.z[k] = static_cast<float>(depths[quad_triangle[k]]);
+      }
+      addScreenTriangle(tri);
+    }
+  };
+
+  if (stipple) {
+    // glLineStipple(3, 0xAAAA): dashes of 3 pixels
+    for (double s = std::floor(t_min * len / 6) * 6; s < t_max * len; s += 6) {
+      add_segment(std::max(s / len, t_min), std::min((s + 3) / len, t_max));
+    }
+  } else {
+    add_segment(t_min, t_max);
+  }
+}
+
+void SoftwareRasterizer::addTriangle(const std::array<Vertex, 3>& vertices, const RGBA& color,
+                                     const RGBA& edge_color, bool edges)
+{
+  // Clip against the near and far planes. The sides are handled by the screen bounds.
+  std::array<Vertex, 5> clipped;
+  size_t count = 3;
+  const Vertex *polygon = vertices.data();
+  const auto inside = [](const Vertex& v) {
+    return nearDistance(v.clip) >= 0 && farDistance(v.clip) >= 0;
+  };
+  if (!std::all_of(vertices.begin(), vertices.end(), inside)) {
+    std::array<Vertex, 4> near_clipped;
+    count = clipPolygon(vertices.data(), count, near_clipped.data(), nearDistance);
+    if (count < 3) return;
+    count = clipPolygon(near_clipped.data(), count, clipped.data(), farDistance);
+    if (count < 3) return;
+    polygon = clipped.data();
+  }
+
+  std::array<Vector3d, 5> screen;
+  for (size_t i = 0; i < count; ++i) screen[i] = toScreen(polygon[i].clip);
+
+  Triangle tri;
+  tri.color = color;
+  tri.edge_color = edge_color;
+  tri.depth_test = true;
+  tri.edges = edges;
+  for (size_t i = 1; i + 1 < count; ++i) {
+    const std::array<size_t, 3> fan = {0, i, i + 1};
+    for (size_t k = 0; k < 3; ++k) {
+      const size_t v = fan[k];
+      tri.x[k] = static_cast<float>(screen[v].x());
+      tri.y[k] = static_cast<float>(screen[v].y());
+      tri.z[k] = static_cast<float>(screen[v].z());
+      tri.barycentric[k] = polygon[v].barycentric;
+    }
+    addScreenTriangle(tri);
+  }
+}
+
+void SoftwareRasterizer::addScreenTriangle(Triangle tri)
+{
+  const float area = (tri.x[1] - tri.x[0]) * (tri.y[2] - tri.y[0]) -
+                     (tri.x[2] - tri.x[0]) * (tri.y[1] - tri.y[0]);
+  if (!(std::abs(area) > 0.0f)) return;
+  if (area < 0) {
+    std::swap(tri.x[1], tri.x[2]);
+    std::swap(tri.y[1], tri.y[2]);
+    std::swap(tri.z[1], tri.z[2]);
+    std::swap(tri.barycentric[1], tri.barycentric[2]);
+  }
+
+  const auto [min_x, max_x] = std::minmax({tri.x[0], tri.x[1], tri.x[2]});
+  const auto [min_y, max_y] = std::minmax({tri.y[0], tri.y[1], tri.y[2]});
+  // Written so that NaN coordinates are rejected as well
+  if (!(max_x >= 0 && max_y >= 0 && min_x < width && min_y < height)) return;
+  // Clamp before converting, the bounds of a triangle may be far outside the range of int
+  const int tx0 = static_cast<int>(std::max(min_x, 0.0f)) / TILE_SIZE;
+  const int ty0 = static_cast<int>(std::max(min_y, 0.0f)) / TILE_SIZE;
+  const int tx1 = static_cast<int>(std::min(max_x, static_cast<float>(width - 1))) / TILE_SIZE;
+  const int ty1 = static_cast<int>(std::min(max_y, static_cast<float>(height - 1))) / TILE_SIZE;
+
+  const auto index = static_cast<uint32_t>(triangles.size());
+  triangles.push_back(tri);
+  for (int ty = ty0; ty <= ty1; ++ty) {
+    for (int tx = tx0; tx <= tx1; ++tx) {
+      tile_triangles[static_cast<size_t>(ty) * tiles_x + tx].push_back(index);
+    }
+  }
+}
+
+Vector3d SoftwareRasterizer::toScreen(const Eigen::Vector4d& clip) const
+{
+  const Vector3d ndc = clip.head<3>() / clip.w();
+  return {(ndc.x() + 1) / 2 * width, (1 - ndc.y()) / 2 * height, (ndc.z() + 1) / 2};
+}
+
+void SoftwareRasterizer::render()
+{
+  parallelizable_for(0, tile_triangles.size(), [this](size_t tile) { rasterizeTile(tile); });
+  triangles.clear();
+  for (auto& tile : tile_triangles) tile.clear();
+}
+
+void SoftwareRasterizer::rasterizeTile(size_t tile_index)
+{
+  const int x0 = static_cast<int>(tile_index % tiles_x) * TILE_SIZE;
+  const int y0 = static_cast<int>(tile_index / tiles_x) * TILE_SIZE;
+  const int x1 = std::min(width, x0 + TILE_SIZE);
+  const int y1 = std::min(height, y0 + TILE_SIZE);
+  for (const auto index : tile_triangles[tile_index]) {
+    rasterizeTriangle(triangles[index], x0, y0, x1, y1);
+  }
+}
+
+void SoftwareRasterizer::rasterizeTriangle(const Triangle& tri, int x0, int y0, int x1, int y1)
+{
+  const auto [min_x, max_x] = std::minmax({tri.x[0], tri.x[1], tri.x[2]});
+  const auto [min_y, max_y] = std::minmax({tri.y[0], tri.y[1], tri.y[2]});
+  // The tile bounds are clamped before converting, like in addScreenTriangle()
+  x0 = static_cast<int>(std::floor(std::max(min_x, static_cast<float>(x0))));
+  y0 = static_cast<int>(std::floor(std::max(min_y, static_cast<float>(y0))));
+  x1 = static_cast<int>(std::min(std::ceil(max_x) + 1, static_cast<float>(x1)));
+  y1 = static_cast<int>(std::min(std::ceil(max_y) + 1, static_cast<float>(y1)));
+  if (x0 >= x1 || y0 >= y1) return;
+
+  // Edge functions e_k(x, y) = a_k * x + b_k * y + c_k for the edge opposite corner k,
+  // positive inside. Divided by the area they are the barycentric coordinates.
+  std::array<float, 3> a, b, c;
+  std::array<bool, 3> top_left;
+  float area = 0;
+  for (size_t k = 0; k < 3; ++k) {
+    const size_t i = (k + 1) % 3;
+    const size_t j = (k + 2) % 3;
+    a[k] = tri.y[i] - tri.y[j];
+    b[k] = tri.x[j] - tri.x[i];
+    c[k] = -a[k] * tri.x[i] - b[k] * tri.y[i];
+    // Pixel centers exactly on a shared edge belong to one of the two triangles only
+    top_left[k] = b[k] < 0 || (b[k] == 0 && a[k] < 0);
+    area += c[k];
+  }
+  const float inv_area = 1.0f / area;
+
+  // Attributes are interpolated linearly in screen space: f(x, y) = fx * x + fy * y + f0
+  const auto plane = [&](const std::array<float, 3>& f) {
+    std::array<float, 3> p{0, 0, 0};
+    for (size_t k = 0; k < 3; ++k) {
+      p[0] += f[k] * a[k] * inv_area;
+      p[1] += f[k] * b[k] * inv_area;
+      p[2] += f[k] * c[k] * inv_area;
+    }
+    return p;
+  };
+  const auto depth = plane(tri.z);
+  std::array<std::array<float, 3>, 3> bc_planes;
+  std::array<float, 3> bc_fwidth{};
+  if (tri.edges) {
+    for (size_t k = 0; k < 3; ++k) {
+      bc_planes[k] =
+        plane({tri.barycentric[0][k], tri.barycentric[1][k], tri.barycentric[2][k]});
+      bc_fwidth[k] = std::abs(bc_planes[k][0]) + std::abs(bc_planes[k][1]);
+    }
+  }
+
+  std::array<float, TILE_SIZE> z;
+  std::array<uint8_t, TILE_SIZE> covered;
+  const int n = x1 - x0;
+  const float px0 = static_cast<float>(x0) + 0.5f;
+  for (int y = y0; y < y1; ++y) {
+    const float py = static_cast<float>(y) + 0.5f;
+    const size_t row = static_cast<size_t>(y) * width;
+    float *depth_row = &depth_buffer[row + x0];
+    float *color_row = &color_buffer[3 * (row + x0)];
+
+    // Coverage and depth test, kept free of branches so the compiler can vectorize it
+    const float e0 = a[0] * px0 + b[0] * py + c[0];
+    const float e1 = a[1] * px0 + b[1] * py + c[1];
+    const float e2 = a[2] * px0 + b[2] * py + c[2];
+    const float z0 = depth[0] * px0 + depth[1] * py + depth[2];
+    for (int i = 0; i < n; ++i) {
+      const float fi = static_cast<float>(i);
+      const float w0 = e0 + a[0] * fi;
+      const float w1 = e1 + a[1] * fi;
+      const float w2 = e2 + a[2] * fi;
+      const bool inside = ((w0 > 0) | ((w0 == 0) & top_left[0])) &
+                          ((w1 > 0) | ((w1 == 0) & top_left[1])) &
+                          ((w2 > 0) | ((w2 == 0) & top_left[2]));
+      z[i] = z0 + depth[0] * fi;
+      covered[i] = inside & (!tri.depth_test | (z[i] <= depth_row[i]));
+    }
+
+    for (int i = 0; i < n; ++i) {
+      if (!covered[i]) continue;
+      // Without GL_DEPTH_TEST OpenGL doesn't update the depth buffer either
+      if (tri.depth_test) depth_row[i] = z[i];
+      RGBA src = tri.color;
+      if (tri.edges) {
+        const float px = px0 + static_cast<float>(i);
+        std::array<float, 3> bc;
+        for (size_t k = 0; k < 3; ++k) {
+          bc[k] = bc_planes[k][0] * px + bc_planes[k][1] * py + bc_planes[k][2];
+        }
+        const float f = edgeFactor(bc, bc_fwidth);
+        for (size_t k = 0; k < 4; ++k) {
+          src[k] = tri.edge_color[k] + f * (tri.color[k] - tri.edge_color[k]);
+        }
+      }
+      // glBlendFunc(GL_SRC_ALPHA, GL_ONE_MINUS_SRC_ALPHA)
+      const float alpha = std::clamp(src[3], 0.0f, 1.0f);
+      float *dst = &color_row[3 * i];
+      for (size_t k = 0; k < 3; ++k) {
+        dst[k] = std::clamp(src[k], 0.0f, 1.0f) * alpha + dst[k] * (1.0f - alpha);
+      }
+    }
+  }
+}
+
+Color4f SoftwareRasterizer::pixel(int x, int y) const
+{
+  const float *rgb = &color_buffer[3 * (static_cast<size_t>(y) * width + x)];
+  return {rgb[0], rgb[1], rgb[2], 1.0f};
+}
+
+bool SoftwareRasterizer::save(std::ostream& output) const
+{
+  const size_t num_pixels = static_cast<size_t>(width) * height;
+  std::vector<unsigned char> pixels(4 * num_pixels);
+  for (size_t i = 0; i < num_pixels; ++i) {
+    for (size_t k = 0; k < 3; ++k) {
+      const float value = std::clamp(color_buffer[3 * i + k], 0.0f, 1.0f);
+      pixels[4 * i + k] = static_cast<unsigned char>(std::lround(value * 255.0f));
+    }
+    // Like GLView, the image is always opaque
+    pixels[4 * i + 3] = 255;
+  }
+  return write_png(output, pixels.data(), width, height);
+}
@@ -0,0 +1,104 @@
+#pragma once
+
+/*
+
+   SoftwareRasterizer
+
+   Renders triangles and lines on the CPU, for PNG export when no OpenGL
+   context is available (headless servers, NULLGL builds).
+
+   The camera, lighting, colors and edge shading follow GLView and the
+   ViewEdges shader, so images match the OpenGL renderers closely.
+   Primitives are binned into screen tiles, and tiles are rasterized in
+   parallel. Each tile draws its primitives in submission order, which
+   keeps blending of transparent surfaces identical to OpenGL.
+
+ */
+
+#include <array>
+#include <cstdint>
+#include <ostream>
+#include <vector>
+
+#include <Eigen/Core>
+
+#include "geometry/linalg.h"
+#include "glview/Camera.h"
+#include "glview/ColorMap.h"
+
+class PolySet;
+class Polygon2d;
+
+class SoftwareRasterizer
+{
+public:
+  enum class CullFace { NONE, BACK, FRONT };
+
+  SoftwareRasterizer(const Camera& camera, const ColorScheme& colorscheme);
+
+  void setShowEdges(bool showedges) { this->showedges = showedges; }
+
+  // Like GLView, call these before adding any geometry
+  void addCrosshairs();
+  void addAxes();
+
+  // Add the faces of a PolySet. Per-face colors are used unless force_default_color is set.
+  // Unlit surfaces (e.g. 2D geometry) are drawn with their plain color.
+  void addSurface(const PolySet& ps, const Transform3d& m, const Color4f& default_color,
+                  bool force_default_color, CullFace cull = CullFace::NONE, bool lit = true);
+  // Add the outlines of a 2D polygon, drawn on top of everything added before.
+  void addOutlines(const Polygon2d& poly, const Color4f& color);
+  void addLine(const Vector3d& p0, const Vector3d& p1, const Color4f& color, double line_width,
+               bool depth_test = true, bool stipple = false);
+
+  // Rasterize everything added so far
+  void render();
+  // Color of a pixel of the image, counting rows from the top
+  [[nodiscard]] Color4f pixel(int x, int y) const;
+  bool save(std::ostream& output) const;
+
+private:
+  using RGBA = std::array<float, 4>;
+
+  struct Vertex {
+    Eigen::Vector4d clip;                        // clip space position
+    std::array<float, 3> barycentric{1, 1, 1};  // same as the ViewEdges barycentric attribute
+  };
+
+  // A triangle after setup: screen space with y pointing down, depth in [0, 1],
+  // counter-clockwise on screen.
+  struct Triangle {
+    std::array<float, 3> x, y, z;
+    std::array<std::array<float, 3>, 3> barycentric;
+    RGBA color;       // shaded face color
+    RGBA edge_color;  // only used if edges is set
+    bool depth_test;
+    bool edges;
+  };
+
+  void addTriangle(const std::array<Vertex, 3>& vertices, const RGBA& color, const RGBA& edge_color,
+                   bool edges);
+  void addScreenTriangle(Triangle tri);
+  void rasterizeTile(size_t tile_index);
+  void rasterizeTriangle(const Triangle& tri, int x0, int y0, int x1, int y1);
+
+  [[nodiscard]] Eigen::Vector3d toScreen(const Eigen::Vector4d& clip) const;
+
+  int width;
+  int height;
+  int tiles_x;
+  int tiles_y;
+  bool perspective;
+  double distance;
+  Eigen::Matrix4d projection;
+  Eigen::Matrix4d modelview;
+  Eigen::Vector3d light0, light1;  // in eye space
+  Eigen::Vector3d object_trans;
+  ColorScheme colorscheme;
+  bool showedges{false};
+
+  std::vector<Triangle> triangles;
+  std::vector<std::vector<uint32_t>> tile_triangles;
+  std::vector<float> color_buffer;  // RGB per pixel, top row first
+  std::vector<float> depth_buffer;
+};
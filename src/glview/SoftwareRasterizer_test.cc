@@ -0,0 +1,137 @@
+#include "glview/SoftwareRasterizer.h"
+
+#include <catch2/catch_all.hpp>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+#include "glview/Camera.h"
+#include "glview/ColorMap.h"
+
+namespace {
+
+constexpr int SIZE = 64;
+
+// Looks along +y with z up, so screen x is world x and screen up is world z
+Camera testCamera(Camera::ProjectionType projection = Camera::ProjectionType::ORTHOGONAL)
+{
+  Camera camera;
+  camera.setup({0, 0, 0, 0, 0, 0, 10});
+  camera.setProjection(projection);
+  camera.pixel_width = SIZE;
+  camera.pixel_height = SIZE;
+  return camera;
+}
+
+// A complete scheme, so nothing depends on the color schemes installed
+ColorScheme testColorScheme()
+{
+  return {
+    {RenderColor::BACKGROUND_COLOR, Color4f(0.0f, 0.0f, 0.0f, 1.0f)},
+    {RenderColor::BACKGROUND_STOP_COLOR, Color4f(0.0f, 0.0f, 0.0f, 1.0f)},
+    {RenderColor::CROSSHAIR_COLOR, Color4f(1.0f, 1.0f, 1.0f, 1.0f)},
+    {RenderColor::AXES_COLOR, Color4f(1.0f, 1.0f, 1.0f, 1.0f)},
+  };
+}
+
+// Square in the xz plane at the given y, from -half to half
+PolySet square(double y, double half)
+{
+  PolySet ps(3);
+  ps.vertices = {{-half, y, -half}, {half, y, -half}, {half, y, half}, {-half, y, half}};
+  ps.indices = {{0, 1, 2, 3}};
+  return ps;
+}
+
+void addFlat(SoftwareRasterizer& rasterizer, const PolySet& ps, const Color4f& color)
+{
+  rasterizer.addSurface(ps, Transform3d::Identity(), color, true, SoftwareRasterizer::CullFace::NONE,
+                        false);
+}
+
+void requireColor(const Color4f& actual, const Color4f& expected)
+{
+  REQUIRE_THAT(actual.r(), Catch::Matchers::WithinAbs(expected.r(), 1e-5));
+  REQUIRE_THAT(actual.g(), Catch::Matchers::WithinAbs(expected.g(), 1e-5));
+  REQUIRE_THAT(actual.b(), Catch::Matchers::WithinAbs(expected.b(), 1e-5));
+}
+
+const Color4f black(0.0f, 0.0f, 0.0f, 1.0f);
+const Color4f red(1.0f, 0.0f, 0.0f, 1.0f);
+const Color4f blue(0.0f, 0.0f, 1.0f, 1.0f);
+
+}  // namespace
+
+TEST_CASE("SoftwareRasterizer fills a square", "[SoftwareRasterizer]")
+{
+  for (const auto projection :
+       {Camera::ProjectionType::ORTHOGONAL, Camera::ProjectionType::PERSPECTIVE}) {
+    SoftwareRasterizer rasterizer(testCamera(projection), testColorScheme());
+    addFlat(rasterizer, square(0, 1), red);
+    rasterizer.render();
+
+    requireColor(rasterizer.pixel(SIZE / 2, SIZE / 2), red);
+    requireColor(rasterizer.pixel(0, 0), black);
+    requireColor(rasterizer.pixel(SIZE - 1, SIZE - 1), black);
+  }
+}
+
+TEST_CASE("SoftwareRasterizer keeps the nearest surface", "[SoftwareRasterizer]")
+{
+  SoftwareRasterizer rasterizer(testCamera(), testColorScheme());
+  // The camera is on the -y side, so the blue square is in front
+  addFlat(rasterizer, square(-1, 1), blue);
+  addFlat(rasterizer, square(0, 2), red);
+  rasterizer.render();
+
+  requireColor(rasterizer.pixel(SIZE / 2, SIZE / 2), blue);
+  // Only the larger red square covers this pixel
+  requireColor(rasterizer.pixel(SIZE / 2, SIZE / 8 + 2), red);
+}
+
+TEST_CASE("SoftwareRasterizer clips huge triangles", "[SoftwareRasterizer]")
+{
+  SoftwareRasterizer rasterizer(testCamera(), testColorScheme());
+  // Screen coordinates of the far corners are way out of the range of int
+  PolySet ps(3);
+  ps.vertices = {{0, 0, 0}, {1e10, 0, 0}, {0, 0, 1e10}};
+  ps.indices = {{0, 1, 2}};
+  addFlat(rasterizer, ps, red);
+  rasterizer.render();
+
+  // The triangle covers the upper right quarter of the image
+  requireColor(rasterizer.pixel(3 * SIZE / 4, SIZE / 4), red);
+  requireColor(rasterizer.pixel(SIZE - 1, 0), red);
+  requireColor(rasterizer.pixel(SIZE / 4, 3 * SIZE / 4), black);
+  requireColor(rasterizer.pixel(SIZE / 4, SIZE / 4), black);
+}
+
+TEST_CASE("SoftwareRasterizer draws crosshairs", "[SoftwareRasterizer]")
+{
+  SoftwareRasterizer rasterizer(testCamera(), testColorScheme());
+  rasterizer.addCrosshairs();
+  rasterizer.render();
+
+  bool drawn = false;
+  for (int y = SIZE / 2 - 1; y <= SIZE / 2; ++y) {
+    for (int x = SIZE / 2 - 1; x <= SIZE / 2; ++x) {
+      drawn |= rasterizer.pixel(x, y).r() > 0.5f;
+    }
+  }
+  REQUIRE(drawn);
+  requireColor(rasterizer.pixel(SIZE / 2, 0), black);
+}
+
+TEST_CASE("SoftwareRasterizer writes a PNG", "[SoftwareRasterizer]")
+{
+  SoftwareRasterizer rasterizer(testCamera(), testColorScheme());
+  addFlat(rasterizer, square(0, 1), red);
+  rasterizer.render();
+
+  std::ostringstream output;
+  REQUIRE(rasterizer.save(output));
+  const std::string png = output.str();
+  REQUIRE(png.substr(0, 8) == std::string("\x89PNG\r\n\x1a\n", 8));
+}
@@ -1,6 +1,8 @@
 #include "glview/VBOBuilder.h"
 
+#include <algorithm>
 #include <cmath>
+#include <cstdint>
 #include <unordered_map>
 #include <cstring>
 #include <cassert>
@@ -14,6 +16,7 @@
 #include "geometry/Polygon2d.h"
 #include "utils/printutils.h"
 #include "utils/hash.h"  // IWYU pragma: keep
+#include "utils/parallel.h"
 
 namespace {
 
@@ -31,8 +34,199 @@ Vector3d uniqueMultiply(std::unordered_map<Vector3d, Vector3d>& vert_mult_map, c
   return entry->second;
 }
 
+Vector3d triangleNormal(const Vector3d& p0, const Vector3d& p1, const Vector3d& p2)
+{
+  const double ax = p1[0] - p0[0], bx = p1[0] - p2[0];
+  const double ay = p1[1] - p0[1], by = p1[1] - p2[1];
+  const double az = p1[2] - p0[2], bz = p1[2] - p2[2];
+  const double nx = ay * bz - az * by;
+  const double ny = az * bx - ax * bz;
+  const double nz = ax * by - ay * bx;
+  const double nl = sqrt(nx * nx + ny * ny + nz * nz);
+  return {nx / nl, ny / nl, nz / nl};
+}
+
+// Barycentric attribute of one triangle corner. The flags mark which edges of the
+// triangle are internal to the source polygon and should not be drawn as edges.
+std::array<GLubyte, 4> barycentricFlags(size_t active_point_index, size_t primitive_index,
+                                        size_t shape_size, bool outlines)
+{
+  std::array<GLubyte, 4> barycentric_flags;
+
+  if (!outlines) {
+    // top / bottom or 3d object
+    if (shape_size == 3) {
+      // true, true, true
+      barycentric_flags = {0, 0, 0, 0};
+    } else if (shape_size == 4) {
+      // false, true, true
+      barycentric_flags = {1, 0, 0, 0};
+    } else {
+      // true, false, false
+      barycentric_flags = {0, 1, 1, 0};
+    }
+  } else {
+    // sides
+    if (primitive_index == 0) {
+      // true, false, true
+      barycentric_flags = {0, 1, 0, 0};
+    } else {
+      // true, true, false
+      barycentric_flags = {0, 0, 1, 0};
+    }
+  }
+
+  barycentric_flags[active_point_index] = 1;
+  return barycentric_flags;
+}
+
+size_t hashVertex(const GLbyte *vertex, size_t stride)
+{
+  uint64_t hash = 0xcbf29ce484222325ull;
+  size_t i = 0;
+  for (; i + sizeof(uint32_t) <= stride; i += sizeof(uint32_t)) {
+    uint32_t word;
+    std::memcpy(&word, vertex + i, sizeof(word));
+    hash = (hash ^ word) * 0x100000001b3ull;
+    hash ^= hash >> 29;
+  }
+  for (; i < stride; ++i) {
+    hash = (hash ^ static_cast<uint8_t>(vertex[i])) * 0x100000001b3ull;
+  }
+  return static_cast<size_t>(hash ^ (hash >> 32));
+}
+
+template <bool HasNormal, bool HasColor, bool HasBarycentric>
+VertexWriter layoutWriter(const VertexData& vertex_data)
+{
+  using Layout = InterleavedVertexLayout<HasNormal, HasColor, HasBarycentric>;
+  if (vertex_data.stride() != Layout::stride) return nullptr;
+  return &Layout::write;
+}
+
+// Find the compile-time layout matching the attributes of vertex_data.
+// Returns nullptr for layouts which have to be written attribute by attribute.
+VertexWriter selectVertexWriter(const VertexData& vertex_data)
+{
+  const auto& attributes = vertex_data.attributes();
+  if (!vertex_data.hasPositionData() || vertex_data.positionIndex() != 0 ||
+      vertex_data.positionData()->sizeofAttribute() != 3 * sizeof(GLfloat)) {
+    return nullptr;
+  }
+  size_t index = 1;
+  const bool has_normal = vertex_data.hasNormalData();
+  if (has_normal) {
+    if (vertex_data.normalIndex() != index++ ||
+        vertex_data.normalData()->sizeofAttribute() != 3 * sizeof(GLfloat)) {
+      return nullptr;
+    }
+  }
+  const bool has_color = vertex_data.hasColorData();
+  if (has_color) {
+    if (vertex_data.colorIndex() != index++ ||
+        vertex_data.colorData()->sizeofAttribute() != 4 * sizeof(GLfloat)) {
+      return nullptr;
+    }
+  }
+  // Anything after that can only be the barycentric attribute added by addShaderData()
+  const bool has_barycentric = attributes.size() == index + 1;
+  if (has_barycentric) {
+    if (attributes[index]->sizeofAttribute() != 4 * sizeof(GLubyte)) return nullptr;
+  } else if (attributes.size() != index) {
+    return nullptr;
+  }
+
+  if (has_normal) {
+    if (has_color) {
+      return has_barycentric ? layoutWriter<true, true, true>(vertex_data)
+                             : layoutWriter<true, true, false>(vertex_data);
+    }
+    return has_barycentric ? layoutWriter<true, false, true>(vertex_data)
+                           : layoutWriter<true, false, false>(vertex_data);
+  }
+  if (has_color) {
+    return has_barycentric ? layoutWriter<false, true, true>(vertex_data)
+                           : layoutWriter<false, true, false>(vertex_data);
+  }
+  return has_barycentric ? layoutWriter<false, false, true>(vertex_data)
+                         : layoutWriter<false, false, false>(vertex_data);
+}
+
+// Number of triangles VBOBuilder::create_surface() creates for a polygon
+size_t triangleCount(size_t polygon_size)
+{
+  if (polygon_size == 3) return 1;
+  if (polygon_size == 4) return 2;
+  return polygon_size;  // triangle fan from the centroid
+}
+
+// Write one triangle as three vertices, in the same order as VBOBuilder::create_triangle()
+void writeTriangle(GLbyte *dst, VertexWriter writer, size_t stride, const Color4f& color,
+                   const Vector3d& p0, const Vector3d& p1, const Vector3d& p2, size_t primitive_index,
+                   size_t shape_size, bool enable_barycentric, bool mirror)
+{
+  const std::array<const Vector3d *, 3> points = {&p0, &p1, &p2};
+  const Vector3d n = triangleNormal(p0, p1, p2);
+  const std::array<size_t, 3> order = mirror ? std::array<size_t, 3>{0, 2, 1}
+                                             : std::array<size_t, 3>{0, 1, 2};
+  for (const auto active_point_index : order) {
+    const auto barycentric = enable_barycentric
+                               ? barycentricFlags(active_point_index, primitive_index, shape_size, false)
+                               : std::array<GLubyte, 4>{0, 0, 0, 0};
+    writer(dst, *points[active_point_index], n, color, barycentric);
+    dst += stride;
+  }
+}
+
+// Polygons per chunk when filling a surface in parallel
+constexpr size_t FILL_CHUNK_SIZE = 16384;
+
 }  // namespace
 
+void ElementsMap::clear()
+{
+  // Only keep a table in proportion to what was stored, so clearing stays cheap
+  // when the map is reused for many small surfaces.
+  if (slots_.size() > 4 * std::max(size_, MIN_SLOTS)) {
+    slots_.assign(MIN_SLOTS, EMPTY_SLOT);
+  } else {
+    std::fill(slots_.begin(), slots_.end(), EMPTY_SLOT);
+  }
+  keys_.clear();
+  size_ = 0;
+}
+
+void ElementsMap::rehash(size_t num_slots)
+{
+  slots_.assign(num_slots, EMPTY_SLOT);
+  const size_t mask = num_slots - 1;
+  for (size_t index = 0; index < size_; ++index) {
+    size_t slot = hashVertex(keys_.data() + index * stride_, stride_) & mask;
+    while (slots_[slot] != EMPTY_SLOT) slot = (slot + 1) & mask;
+    slots_[slot] = index;
+  }
+}
+
+std::pair<GLuint, bool> ElementsMap::insert(const GLbyte *vertex, size_t stride)
+{
+  if (size_ == 0) stride_ = stride;
+  assert(stride == stride_);
+  // Keep the load factor at or below 1/2
+  if (2 * (size_ + 1) > slots_.size()) rehash(std::max(MIN_SLOTS, 2 * slots_.size()));
+
+  const size_t mask = slots_.size() - 1;
+  size_t slot = hashVertex(vertex, stride) & mask;
+  while (slots_[slot] != EMPTY_SLOT) {
+    const GLuint index = slots_[slot];
+    if (std::memcmp(keys_.data() + index * stride_, vertex, stride) == 0) return {index, false};
+    slot = (slot + 1) & mask;
+  }
+  const auto index = static_cast<GLuint>(size_++);
+  slots_[slot] = index;
+  keys_.insert(keys_.end(), vertex, vertex + stride);
+  return {index, true};
+}
+
 void addAttributeValues(IAttributeData&)
 {
 }
@@ -68,6 +262,17 @@ void VBOBuilder::addSurfaceData()
   vertices_.emplace_back(std::move(vertex_data));
 }
 
+// Adds attributes needed for instanced 3D polygon rendering, where the
+// color is specified per instance: position, normal
+void VBOBuilder::addInstancedSurfaceData()
+{
+  auto vertex_data = std::make_shared<VertexData>();
+  vertex_data->addPositionData(std::make_shared<AttributeData<GLfloat, 3, GL_FLOAT>>());
+  vertex_data->addNormalData(std::make_shared<AttributeData<GLfloat, 3, GL_FLOAT>>());
+  surface_index_ = vertices_.size();
+  vertices_.emplace_back(std::move(vertex_data));
+}
+
 void VBOBuilder::addEdgeData()
 {
   auto vertex_data = std::make_shared<VertexData>();
@@ -82,67 +287,61 @@ void VBOBuilder::createVertex(const std::array<Vector3d, 3>& points,
                               size_t active_point_index, size_t primitive_index, size_t shape_size,
                               bool outlines, bool /*mirror*/)
 {
-  addAttributeValues(*(data()->positionData()), points[active_point_index][0],
-                     points[active_point_index][1], points[active_point_index][2]);
-  if (data()->hasNormalData()) {
-    addAttributeValues(*(data()->normalData()), normals[active_point_index][0],
-                       normals[active_point_index][1], normals[active_point_index][2]);
-  }
-  if (data()->hasColorData()) {
-    addAttributeValues(*(data()->colorData()), color.r(), color.g(), color.b(), color.a());
+  const bool direct = directWrite();
+  const size_t stride = data()->stride();
+  if (direct) {
+    const auto writer = vertex_writers_[write_index_];
+    if (!useElements()) {
+      writer(interleaved_buffer_.data() + vertices_offset_, points[active_point_index],
+             normals[active_point_index], color, barycentric_);
+      vertices_offset_ += stride;
+      return;
+    }
+    vertex_scratch_.resize(stride);
+    writer(vertex_scratch_.data(), points[active_point_index], normals[active_point_index], color,
+           barycentric_);
+  } else {
+    addAttributeValues(*(data()->positionData()), points[active_point_index][0],
+                       points[active_point_index][1], points[active_point_index][2]);
+    if (data()->hasNormalData()) {
+      addAttributeValues(*(data()->normalData()), normals[active_point_index][0],
+                         normals[active_point_index][1], normals[active_point_index][2]);
+    }
+    if (data()->hasColorData()) {
+      addAttributeValues(*(data()->colorData()), color.r(), color.g(), color.b(), color.a());
+    }
+    if (hasBarycentricData()) {
+      addAttributeValues(*(data()->attributes()[shader_attributes_index_ + BARYCENTRIC_ATTRIB]),
+                         barycentric_[0], barycentric_[1], barycentric_[2], barycentric_[3]);
+    }
+    if (!useElements() && interleaved_buffer_.empty()) {
+      vertices_offset_ = sizeInBytes();
+      return;
+    }
+    vertex_scratch_.resize(stride);
+    data()->getLastVertex(vertex_scratch_);
   }
 
   if (useElements()) {
-    std::vector<GLbyte> interleaved_vertex;
-    interleaved_vertex.resize(data()->stride());
-    data()->getLastVertex(interleaved_vertex);
-    std::pair<ElementsMap::iterator, bool> entry;
-    entry.first = elements_map_.find(interleaved_vertex);
-    if (entry.first == elements_map_.end()) {
+    const auto [index, inserted] = elements_map_.insert(vertex_scratch_.data(), stride);
+    if (inserted) {
       // append vertex data if this is a new element
       if (!interleaved_buffer_.empty()) {
-        memcpy(interleaved_buffer_.data() + vertices_offset_, interleaved_vertex.data(),
-               interleaved_vertex.size());
-        data()->clear();
+        memcpy(interleaved_buffer_.data() + vertices_offset_, vertex_scratch_.data(), stride);
+        if (!direct) data()->clear();
       }
-      vertices_offset_ += interleaved_vertex.size();
-      entry = elements_map_.emplace(interleaved_vertex, elements_map_.size());
-    } else {
+      vertices_offset_ += stride;
+    } else if (!direct) {
       data()->remove();
-#if 0
-      if (OpenSCAD::debug != "") {
-        // in debug, check for bad hash matches
-        size_t i = 0;
-        if (interleaved_vertex.size() != entry.first->first.size()) {
-          PRINTDB("vertex index = %d", entry.first->second);
-          assert(false && "VBORenderer invalid vertex match size!!!");
-        }
-        for (const auto& b : interleaved_vertex) {
-          if (b != entry.first->first[i]) {
-            PRINTDB("vertex index = %d", entry.first->second);
-            assert(false && "VBORenderer invalid vertex value hash match!!!");
-          }
-          i++;
-        }
-      }
-#endif  // 0
     }
 
     // append element data
-    addAttributeValues(*elementsData(), entry.first->second);
+    addAttributeValues(*elementsData(), index);
     elements_offset_ += elementsData()->sizeofAttribute();
   } else {  // !useElements()
-    if (interleaved_buffer_.empty()) {
-      vertices_offset_ = sizeInBytes();
-    } else {
-      std::vector<GLbyte> interleaved_vertex;
-      interleaved_vertex.resize(data()->stride());
-      data()->getLastVertex(interleaved_vertex);
-      memcpy(interleaved_buffer_.data() + vertices_offset_, interleaved_vertex.data(),
-             interleaved_vertex.size());
-      vertices_offset_ += interleaved_vertex.size();
-      data()->clear();
-    }
+    memcpy(interleaved_buffer_.data() + vertices_offset_, vertex_scratch_.data(), stride);
+    vertices_offset_ += stride;
+    data()->clear();
   }
 }
 
@@ -241,6 +440,7 @@ void VBOBuilder::addAttributePointers(size_t start_offset)
   size_t offset = start_offset + vertex_data->interleavedOffset(vertex_data->positionIndex());
   // Note: Some code, like OpenCSGRenderer::createVBOPrimitive() relies on this order of
   // glBegin/glEnd functions for unlit/uncolored vertex rendering.
+  assert(vertex_state->glBegin().empty() && vertex_state->glEnd().empty());
   vertex_state->glBegin().emplace_back([]() {
     GL_TRACE0("glEnableClientState(GL_VERTEX_ARRAY)");
     GL_CHECKD(glEnableClientState(GL_VERTEX_ARRAY));
@@ -260,6 +460,8 @@ void VBOBuilder::addAttributePointers(size_t start_offset)
     GL_TRACE0("glDisableClientState(GL_VERTEX_ARRAY)");
     GL_CHECKD(glDisableClientState(GL_VERTEX_ARRAY));
   });
+  assert(vertex_state->glBegin().size() == POSITION_BEGIN_STATES &&
+         vertex_state->glEnd().size() == POSITION_END_STATES);
 
   if (vertex_data->hasNormalData()) {
     type = vertex_data->normalData()->glType();
@@ -315,6 +517,10 @@ void VBOBuilder::allocateBuffers(size_t num_vertices)
 {
   size_t vbo_buffer_size = num_vertices * stride();
   interleaved_buffer_.resize(vbo_buffer_size);
+  vertex_writers_.clear();
+  for (const auto& vertex_data : vertices_) {
+    vertex_writers_.push_back(selectVertexWriter(*vertex_data));
+  }
   GL_TRACE("glBindBuffer(GL_ARRAY_BUFFER, %d)", vertex_state_container_.verticesVBO());
   GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, vertex_state_container_.verticesVBO()));
   GL_TRACE("glBufferData(GL_ARRAY_BUFFER, %d, %p, GL_STATIC_DRAW)", vbo_buffer_size % (void *)nullptr);
@@ -352,55 +558,21 @@ void VBOBuilder::addShaderData()
 void VBOBuilder::add_barycentric_attribute(size_t active_point_index, size_t primitive_index,
                                            size_t shape_size, bool outlines)
 {
-  const std::shared_ptr<VertexData> vertex_data = data();
-
-  // Get edge states
-  std::array<GLubyte, 3> barycentric_flags;
-
-  if (!outlines) {
-    // top / bottom or 3d object
-    if (shape_size == 3) {
-      // true, true, true
-      barycentric_flags = {0, 0, 0};
-    } else if (shape_size == 4) {
-      // false, true, true
-      barycentric_flags = {1, 0, 0};
-    } else {
-      // true, false, false
-      barycentric_flags = {0, 1, 1};
-    }
-  } else {
-    // sides
-    if (primitive_index == 0) {
-      // true, false, true
-      barycentric_flags = {0, 1, 0};
-    } else {
-      // true, true, false
-      barycentric_flags = {0, 0, 1};
-    }
-  }
-
-  barycentric_flags[active_point_index] = 1;
-
-  addAttributeValues(*(vertex_data->attributes()[shader_attributes_index_ + BARYCENTRIC_ATTRIB]),
-                     barycentric_flags[0], barycentric_flags[1], barycentric_flags[2], 0);
+  barycentric_ = barycentricFlags(active_point_index, primitive_index, shape_size, outlines);
 }
 
 void VBOBuilder::create_triangle(const Color4f& color, const Vector3d& p0, const Vector3d& p1,
                                  const Vector3d& p2, size_t primitive_index, size_t shape_size,
                                  bool outlines, bool enable_barycentric, bool mirror)
 {
-  const double ax = p1[0] - p0[0], bx = p1[0] - p2[0];
-  const double ay = p1[1] - p0[1], by = p1[1] - p2[1];
-  const double az = p1[2] - p0[2], bz = p1[2] - p2[2];
-  const double nx = ay * bz - az * by;
-  const double ny = az * bx - ax * bz;
-  const double nz = ax * by - ay * bx;
-  const double nl = sqrt(nx * nx + ny * ny + nz * nz);
-  const Vector3d n = Vector3d(nx / nl, ny / nl, nz / nl);
+  const Vector3d n = triangleNormal(p0, p1, p2);
 
   if (!data()) return;
 
+  // Without barycentric flags, a layout with the barycentric attribute gets zero flags like in
+  // writeTriangle(), not the ones left over from the previous triangle
+  if (!enable_barycentric) barycentric_ = {0, 0, 0, 0};
+
   if (enable_barycentric) {
     add_barycentric_attribute(0, primitive_index, shape_size, outlines);
   }
@@ -439,7 +611,6 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m, const C
   const bool mirrored = m.matrix().determinant() < 0;
   size_t triangle_count = 0;
 
-  std::unordered_map<Vector3d, Vector3d> vert_mult_map;
   const auto last_size = verticesOffset();
 
   size_t elements_offset = 0;
@@ -448,9 +619,19 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m, const C
     elementsMap().clear();
   }
 
+  // Transform each vertex once up front, polygons index into the transformed vertices
+  std::vector<Vector3d> vertices(ps.vertices.size());
+  const auto transform = [&m](const Vector3d& v) -> Vector3d { return m * v; };
+  if (ps.vertices.size() > FILL_CHUNK_SIZE) {
+    parallelizable_transform(ps.vertices.begin(), ps.vertices.end(), vertices.begin(), transform);
+  } else {
+    std::transform(ps.vertices.begin(), ps.vertices.end(), vertices.begin(), transform);
+  }
+
   auto has_colors = !ps.color_indices.empty();
 
-  for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
+  // Calls triangle(color, p0, p1, p2, primitive_index, shape_size) for each triangle of polygon i
+  const auto for_each_triangle = [&](size_t i, const auto& triangle) {
     const auto& poly = ps.indices[i];
     const size_t color_index = has_colors && i < ps.color_indices.size() ? ps.color_indices[i] : -1;
     const auto& color = !force_default_color && color_index >= 0 && color_index < ps.colors.size() &&
@@ -458,35 +639,63 @@ void VBOBuilder::create_surface(const PolySet& ps, const Transform3d& m, const C
                           ? ps.colors[color_index]
                           : default_color;
     if (poly.size() == 3) {
-      const Vector3d p0 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(0)], m);
-      const Vector3d p1 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(1)], m);
-      const Vector3d p2 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(2)], m);
-
-      create_triangle(color, p0, p1, p2, 0, poly.size(), false, enable_barycentric, mirrored);
-      triangle_count++;
+      triangle(color, vertices[poly[0]], vertices[poly[1]], vertices[poly[2]], 0, poly.size());
     } else if (poly.size() == 4) {
-      const Vector3d p0 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(0)], m);
-      const Vector3d p1 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(1)], m);
-      const Vector3d p2 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(2)], m);
-      const Vector3d p3 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(3)], m);
-
-      create_triangle(color, p0, p1, p3, 0, poly.size(), false, enable_barycentric, mirrored);
-      create_triangle(color, p2, p3, p1, 1, poly.size(), false, enable_barycentric, mirrored);
-      triangle_count += 2;
+      const Vector3d& p0 = vertices[poly[0]];
+      const Vector3d& p1 = vertices[poly[1]];
+      const Vector3d& p2 = vertices[poly[2]];
+      const Vector3d& p3 = vertices[poly[3]];
+      triangle(color, p0, p1, p3, 0, poly.size());
+      triangle(color, p2, p3, p1, 1, poly.size());
     } else {
       Vector3d center = Vector3d::Zero();
       for (const auto& idx : poly) {
         center += ps.vertices[idx];
       }
       center /= poly.size();
-      for (size_t i = 1; i <= poly.size(); i++) {
-        const Vector3d p0 = uniqueMultiply(vert_mult_map, center, m);
-        const Vector3d p1 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(i % poly.size())], m);
-        const Vector3d p2 = uniqueMultiply(vert_mult_map, ps.vertices[poly.at(i - 1)], m);
-
-        create_triangle(color, p0, p2, p1, i - 1, poly.size(), false, enable_barycentric, mirrored);
-        triangle_count++;
+      const Vector3d p0 = m * center;
+      for (size_t j = 1; j <= poly.size(); j++) {
+        triangle(color, p0, vertices[poly[j - 1]], vertices[poly[j % poly.size()]], j - 1, poly.size());
+      }
+    }
+  };
+
+  if (directWrite() && !useElements()) {
+    // Write triangles straight into the interleaved buffer. Each chunk of polygons knows
+    // where its triangles start, so large meshes are filled in parallel.
+    const size_t num_chunks = (ps.indices.size() + FILL_CHUNK_SIZE - 1) / FILL_CHUNK_SIZE;
+    std::vector<size_t> chunk_offsets(num_chunks + 1, 0);
+    for (size_t i = 0; i < ps.indices.size(); ++i) {
+      chunk_offsets[i / FILL_CHUNK_SIZE + 1] += triangleCount(ps.indices[i].size());
+    }
+    for (size_t c = 0; c < num_chunks; ++c) chunk_offsets[c + 1] += chunk_offsets[c];
+    triangle_count = chunk_offsets.back();
+
+    const VertexWriter writer = vertex_writers_[write_index_];
+    const size_t stride = vertex_data->stride();
+    GLbyte *const dst = interleaved_buffer_.data() + vertices_offset_;
+    assert(vertices_offset_ + triangle_count * 3 * stride <= interleaved_buffer_.size());
+    parallelizable_for(0, num_chunks, [&](size_t c) {
+      GLbyte *chunk_dst = dst + chunk_offsets[c] * 3 * stride;
+      const size_t end = std::min(ps.indices.size(), (c + 1) * FILL_CHUNK_SIZE);
+      for (size_t i = c * FILL_CHUNK_SIZE; i < end; ++i) {
+        for_each_triangle(i, [&](const Color4f& color, const Vector3d& p0, const Vector3d& p1,
+                                 const Vector3d& p2, size_t primitive_index, size_t shape_size) {
+          writeTriangle(chunk_dst, writer, stride, color, p0, p1, p2, primitive_index, shape_size,
+                        enable_barycentric, mirrored);
+          chunk_dst += 3 * stride;
+        });
       }
+    });
+    vertices_offset_ += triangle_count * 3 * stride;
+  } else {
+    for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
+      for_each_triangle(i, [&](const Color4f& color, const Vector3d& p0, const Vector3d& p1,
+                               const Vector3d& p2, size_t primitive_index, size_t shape_size) {
+        create_triangle(color, p0, p1, p2, primitive_index, shape_size, false, enable_barycentric,
+                        mirrored);
+        triangle_count++;
+      });
     }
   }
 
@@ -4,8 +4,8 @@
 #include <functional>
 #include <memory>
 #include <cstddef>
-#include <unordered_map>
-#include <boost/functional/hash.hpp>
+#include <cstring>
+#include <limits>
 #include <utility>
 #include <vector>
 
@@ -20,18 +20,68 @@
 
 enum ShaderAttribIndex { BARYCENTRIC_ATTRIB };
 
-// Hash function for opengl vertex data.
-template <typename T>
-struct vertex_hash {
-  std::size_t operator()(T const& vertex) const
+// Flat open-addressing hash map from interleaved vertex bytes to element index, used to
+// deduplicate vertices for indexed rendering. All vertices stored between clear() calls
+// must have the same stride.
+class ElementsMap
+{
+public:
+  // Remove all vertices. Element indices restart from zero.
+  void clear();
+  // Return the number of unique vertices
+  [[nodiscard]] inline size_t size() const { return size_; }
+  // Look up the vertex. If not present, it is added with index size().
+  // Returns the element index and whether the vertex was added.
+  std::pair<GLuint, bool> insert(const GLbyte *vertex, size_t stride);
+
+private:
+  static constexpr GLuint EMPTY_SLOT = std::numeric_limits<GLuint>::max();
+  static constexpr size_t MIN_SLOTS = 64;
+
+  void rehash(size_t num_slots);
+
+  std::vector<GLuint> slots_;  // element index or EMPTY_SLOT, size is a power of two
+  std::vector<GLbyte> keys_;   // vertex bytes, stride_ bytes per element index
+  size_t stride_{0};
+  size_t size_{0};
+};
+
+// Compile-time interleaved vertex layout, in the attribute order used by addSurfaceData(),
+// addInstancedSurfaceData() and addEdgeData(), optionally followed by addShaderData().
+// Used to write vertices directly into a preallocated interleaved buffer.
+template <bool HasNormal, bool HasColor, bool HasBarycentric>
+struct InterleavedVertexLayout {
+  static constexpr size_t position_offset = 0;
+  static constexpr size_t normal_offset = position_offset + 3 * sizeof(GLfloat);
+  static constexpr size_t color_offset = normal_offset + (HasNormal ? 3 * sizeof(GLfloat) : 0);
+  static constexpr size_t barycentric_offset = color_offset + (HasColor ? 4 * sizeof(GLfloat) : 0);
+  static constexpr size_t stride = barycentric_offset + (HasBarycentric ? 4 * sizeof(GLubyte) : 0);
+
+  static void write(GLbyte *dst, const Vector3d& position, const Vector3d& normal, const Color4f& color,
+                    const std::array<GLubyte, 4>& barycentric)
   {
-    size_t seed = 0;
-    for (size_t i = 0; i < vertex.size(); ++i) boost::hash_combine(seed, vertex.data()[i]);
-    return seed;
+    const std::array<GLfloat, 3> p = {static_cast<GLfloat>(position[0]),
+                                      static_cast<GLfloat>(position[1]),
+                                      static_cast<GLfloat>(position[2])};
+    std::memcpy(dst + position_offset, p.data(), sizeof(p));
+    if constexpr (HasNormal) {
+      const std::array<GLfloat, 3> n = {static_cast<GLfloat>(normal[0]), static_cast<GLfloat>(normal[1]),
+                                        static_cast<GLfloat>(normal[2])};
+      std::memcpy(dst + normal_offset, n.data(), sizeof(n));
+    }
+    if constexpr (HasColor) {
+      const std::array<GLfloat, 4> c = {color.r(), color.g(), color.b(), color.a()};
+      std::memcpy(dst + color_offset, c.data(), sizeof(c));
+    }
+    if constexpr (HasBarycentric) {
+      std::memcpy(dst + barycentric_offset, barycentric.data(), sizeof(barycentric));
+    }
   }
 };
 
-using ElementsMap = std::unordered_map<std::vector<GLbyte>, GLuint, vertex_hash<std::vector<GLbyte>>>;
+// Writes one interleaved vertex, see InterleavedVertexLayout::write()
+using VertexWriter = void (*)(GLbyte *dst, const Vector3d& position, const Vector3d& normal,
+                              const Color4f& color, const std::array<GLubyte, 4>& barycentric);
 
 // Interface class for basic attribute data that will be loaded into VBO
 class IAttributeData
@@ -275,6 +325,8 @@ public:
 
   // Add common surface data vertex layout PNC
   void addSurfaceData();
+  // Add instanced surface data vertex layout PN, color is set per instance
+  void addInstancedSurfaceData();
   // Add common edge data vertex layout PC
   void addEdgeData();
   // Add elements data to VertexArray
@@ -353,6 +405,11 @@ public:
   // Create an interleaved VBO from the VertexData in the array.
   void createInterleavedVBOs();
 
+  // Number of begin and end states which addAttributePointers() adds first, and which only enable
+  // and point to vertex positions, e.g. for unlit/uncolored OpenCSG primitives
+  static constexpr size_t POSITION_BEGIN_STATES = 2;
+  static constexpr size_t POSITION_END_STATES = 1;
+
   // Method adds begin/end states that enable and point to the VertexData in the array
   void addAttributePointers(size_t start_offset = 0);
 
@@ -373,6 +430,18 @@ public:
 
   void add_barycentric_attribute(size_t active_point_index, size_t primitive_index, size_t shape_size,
                                  bool outlines);
+  // Return true if the current VertexData has the barycentric attribute added by addShaderData()
+  [[nodiscard]] inline bool hasBarycentricData()
+  {
+    return shader_attributes_index_ > 0 &&
+           data()->attributes().size() > shader_attributes_index_ + BARYCENTRIC_ATTRIB;
+  }
+  // Return true if vertices are written directly into the preallocated interleaved buffer
+  [[nodiscard]] inline bool directWrite() const
+  {
+    return write_index_ < vertex_writers_.size() && vertex_writers_[write_index_] &&
+           !interleaved_buffer_.empty();
+  }
   void create_triangle(const Color4f& color, const Vector3d& p0, const Vector3d& p1, const Vector3d& p2,
                        size_t primitive_index, size_t shape_size, bool outlines, bool enable_barycentric,
                        bool mirror);
@@ -391,6 +460,11 @@ private:
   size_t edge_index_{0};
   std::vector<std::shared_ptr<VertexData>> vertices_;
   std::vector<GLbyte> interleaved_buffer_;
+  // Typed writer per VertexData, or nullptr if the layout has no compile-time equivalent
+  std::vector<VertexWriter> vertex_writers_;
+  // Barycentric attribute of the next vertex, see add_barycentric_attribute()
+  std::array<GLubyte, 4> barycentric_{0, 0, 0, 0};
+  std::vector<GLbyte> vertex_scratch_;
 
   // Vertex VBO
   size_t vertices_offset_{0};
@@ -0,0 +1,75 @@
+#include "glview/VBOBuilder.h"
+
+#include <array>
+#include <catch2/catch_all.hpp>
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "geometry/linalg.h"
+#include "glview/ColorMap.h"
+#include "glview/OffscreenView.h"
+#include "glview/VertexState.h"
+#include "glview/system-gl.h"
+
+#ifndef NULLGL
+
+namespace {
+
+using Barycentric = std::array<GLubyte, 4>;
+
+// Builds a barycentric triangle followed by one without barycentric flags, and returns the
+// barycentric attribute of all six vertices as uploaded to the vertex VBO
+std::vector<Barycentric> buildTriangles(bool preallocate)
+{
+  VertexStateContainer container;
+  std::vector<GLubyte> vertices;
+  size_t barycentric_offset = 0;
+  size_t stride = 0;
+  {
+    VBOBuilder builder(std::make_unique<VertexStateFactory>(), container);
+    builder.addSurfaceData();
+    builder.addShaderData();
+    if (preallocate) builder.allocateBuffers(6);
+    builder.writeSurface();
+
+    const Color4f color(1.0f, 0.0f, 0.0f, 1.0f);
+    builder.create_triangle(color, {0, 0, 0}, {1, 0, 0}, {0, 1, 0}, 0, 3, false, true, false);
+    builder.create_triangle(color, {0, 0, 1}, {1, 0, 1}, {0, 1, 1}, 0, 3, false, false, false);
+    builder.createInterleavedVBOs();
+
+    const auto& data = *builder.data();
+    barycentric_offset = data.interleavedOffset(builder.shader_attributes_index_ + BARYCENTRIC_ATTRIB);
+    stride = builder.stride();
+    vertices.resize(6 * stride);
+    GL_CHECKD(glBindBuffer(GL_ARRAY_BUFFER, container.verticesVBO()));
+    GL_CHECKD(glGetBufferSubData(GL_ARRAY_BUFFER, 0, vertices.size(), vertices.data()));
+  }
+
+  std::vector<Barycentric> result;
+  for (size_t i = 0; i < 6; ++i) {
+    const GLubyte *src = vertices.data() + i * stride + barycentric_offset;
+    result.push_back({src[0], src[1], src[2], src[3]});
+  }
+  return result;
+}
+
+}  // namespace
+
+TEST_CASE("Triangles without barycentric flags don't reuse the previous flags", "[VBOBuilder]")
+{
+  std::unique_ptr<OffscreenView> view;
+  try {
+    view = std::make_unique<OffscreenView>(16, 16);
+  } catch (const OffscreenViewException& e) {
+    SKIP(e.what());
+  }
+
+  const std::vector<Barycentric> expected = {
+    {1, 0, 0, 0}, {0, 1, 0, 0}, {0, 0, 1, 0}, {0, 0, 0, 0}, {0, 0, 0, 0}, {0, 0, 0, 0},
+  };
+  SECTION("Written directly into the preallocated buffer") { CHECK(buildTriangles(true) == expected); }
+  SECTION("Written attribute by attribute") { CHECK(buildTriangles(false) == expected); }
+}
+
+#endif  // NULLGL
@@ -33,12 +33,14 @@
 #include "utils/printutils.h"
 #include "utils/hash.h"  // IWYU pragma: keep
 
+#include <algorithm>
 #include <cassert>
 #include <array>
 #include <unordered_map>
 #include <utility>
 #include <memory>
 #include <cstddef>
+#include <vector>
 
 namespace VBOUtils {
 
@@ -88,7 +90,8 @@ size_t VBORenderer::calcNumVertices(const CSGChainObject& csgobj, bool unique_ge
       this->geom_visit_mark_[std::make_pair(csgobj.leaf->polyset.get(), &csgobj.leaf->matrix)]++ > 0)
     return 0;
 
-  if (csgobj.leaf->polyset) {
+  // Instanced PolySets live in their own shared VBO
+  if (csgobj.leaf->polyset && !isInstanced(*csgobj.leaf->polyset)) {
     buffer_size += calcNumVertices(*csgobj.leaf->polyset);
   }
   return buffer_size;
@@ -169,3 +172,125 @@ void VBORenderer::add_shader_pointers(VBOBuilder& vbo_builder, const ShaderUtils
 
   vbo_builder.states().emplace_back(std::move(ss));
 }
+
+void VBORenderer::resetInstances()
+{
+  instance_counts_.clear();
+  instanced_surfaces_.clear();
+}
+
+void VBORenderer::countInstances(const CSGProducts& products)
+{
+  for (const auto& product : products.products) {
+    for (const auto& csgobj : product.intersections) {
+      if (csgobj.leaf->polyset) instance_counts_[csgobj.leaf->polyset.get()]++;
+    }
+    for (const auto& csgobj : product.subtractions) {
+      if (csgobj.leaf->polyset) instance_counts_[csgobj.leaf->polyset.get()]++;
+    }
+  }
+}
+
+bool VBORenderer::isInstanced(const PolySet& polyset) const
+{
+  // Per-face colors are baked into the vertices, and 2D geometry is never shared
+  // between leaves, so only instance plain 3D PolySets used more than once.
+  if (polyset.getDimension() != 3 || !polyset.color_indices.empty()) return false;
+  const auto it = instance_counts_.find(&polyset);
+  return it != instance_counts_.end() && it->second > 1;
+}
+
+const VBORenderer::InstancedSurface& VBORenderer::instancedSurface(
+  const PolySet& polyset, const ShaderUtils::ShaderInfo *shaderinfo)
+{
+  if (const auto it = instanced_surfaces_.find(&polyset); it != instanced_surfaces_.end()) {
+    return it->second;
+  }
+
+  InstancedSurface surface;
+  surface.container = std::make_unique<VertexStateContainer>();
+  {
+    VBOBuilder vbo_builder(std::make_unique<VertexStateFactory>(), *surface.container);
+    vbo_builder.addInstancedSurfaceData();
+    vbo_builder.writeSurface();
+    vbo_builder.addShaderData();
+    vbo_builder.allocateBuffers(calcNumVertices(polyset));
+
+    add_shader_pointers(vbo_builder, shaderinfo);
+    vbo_builder.create_surface(polyset, Transform3d::Identity(), Color4f(), true, true);
+    vbo_builder.createInterleavedVBOs();
+  }
+  surface.shader_state = surface.container->states().front();
+  surface.surface_state = surface.container->states().back();
+  // Instances drawing OpenCSG primitives only use the vertex positions, which
+  // VBOBuilder::addAttributePointers() sets up first
+  const auto& begin = surface.surface_state->glBegin();
+  const auto& end = surface.surface_state->glEnd();
+  assert(surface.container->states().size() == 2);
+  assert(begin.size() >= VBOBuilder::POSITION_BEGIN_STATES &&
+         end.size() >= VBOBuilder::POSITION_END_STATES);
+  surface.position_begin.assign(begin.begin(), begin.begin() + VBOBuilder::POSITION_BEGIN_STATES);
+  surface.position_end.assign(end.begin(), end.begin() + VBOBuilder::POSITION_END_STATES);
+
+  return instanced_surfaces_.emplace(&polyset, std::move(surface)).first->second;
+}
+
+std::shared_ptr<VertexState> VBORenderer::createInstanceState(const VertexStateFactory& factory,
+                                                              const InstancedSurface& surface,
+                                                              const Transform3d& matrix,
+                                                              const Color4f& color,
+                                                              bool positions_only) const
+{
+  const auto& shared = surface.surface_state;
+  std::shared_ptr<VertexState> vertex_state = factory.createVertexState(
+    shared->drawMode(), shared->drawSize(), shared->drawType(), shared->drawOffset(),
+    shared->elementOffset(), shared->verticesVBO(), shared->elementsVBO());
+
+  // The shared surface was built without mirroring, so mirrored instances have reversed winding
+  const bool mirrored = matrix.matrix().determinant() < 0;
+  std::array<GLdouble, 16> m;
+  std::copy(matrix.data(), matrix.data() + 16, m.begin());
+  vertex_state->glBegin().emplace_back([m, mirrored]() {
+    GL_TRACE0("glPushMatrix()");
+    GL_CHECKD(glPushMatrix());
+    GL_TRACE0("glMultMatrixd(m)");
+    GL_CHECKD(glMultMatrixd(m.data()));
+    if (mirrored) {
+      GL_TRACE0("glFrontFace(GL_CW)");
+      GL_CHECKD(glFrontFace(GL_CW));
+    }
+  });
+  if (!positions_only) {
+    vertex_state->glBegin().emplace_back([color]() {
+      GL_TRACE("glColor4f(%f, %f, %f, %f)", color.r() % color.g() % color.b() % color.a());
+      GL_CHECKD(glColor4f(color.r(), color.g(), color.b(), color.a()));
+    });
+  }
+
+  const auto& shared_begin = positions_only ? surface.position_begin : shared->glBegin();
+  const auto& shared_end = positions_only ? surface.position_end : shared->glEnd();
+  vertex_state->glBegin().insert(vertex_state->glBegin().end(), shared_begin.begin(),
+                                 shared_begin.end());
+  vertex_state->glEnd().insert(vertex_state->glEnd().end(), shared_end.begin(), shared_end.end());
+
+  vertex_state->glEnd().emplace_back([mirrored]() {
+    if (mirrored) {
+      GL_TRACE0("glFrontFace(GL_CCW)");
+      GL_CHECKD(glFrontFace(GL_CCW));
+    }
+    GL_TRACE0("glPopMatrix()");
+    GL_CHECKD(glPopMatrix());
+  });
+  return vertex_state;
+}
+
+std::shared_ptr<VertexState> VBORenderer::addInstance(std::vector<std::shared_ptr<VertexState>>& states,
+                                                      const VertexStateFactory& factory,
+                                                      const PolySet& polyset, const Transform3d& matrix,
+                                                      const Color4f& color,
+                                                      const ShaderUtils::ShaderInfo *shaderinfo)
+{
+  const auto& surface = instancedSurface(polyset, shaderinfo);
+  states.emplace_back(surface.shader_state);
+  return states.emplace_back(createInstanceState(factory, surface, matrix, color));
+}
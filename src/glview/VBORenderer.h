@@ -4,6 +4,8 @@
 #include <utility>
 #include <memory>
 #include <cstddef>
+#include <functional>
+#include <vector>
 #include "glview/Renderer.h"
 #include "glview/ShaderUtils.h"
 #include "geometry/linalg.h"
@@ -51,6 +53,40 @@ public:
       *shaderinfo);  // This could stay protected, were it not for VertexStateManager
 
 protected:
+  // Surface of a PolySet referenced by several CSG leaves. It is uploaded once,
+  // untransformed and without colors, and drawn by one instance VertexState per leaf.
+  struct InstancedSurface {
+    std::unique_ptr<VertexStateContainer> container;
+    std::shared_ptr<VertexState> shader_state;
+    std::shared_ptr<VertexState> surface_state;
+    // The begin/end states of surface_state which only enable and point to vertex positions
+    std::vector<std::function<void()>> position_begin;
+    std::vector<std::function<void()>> position_end;
+  };
+
+  // Forget the instance counts and shared surfaces of a previous prepare
+  void resetInstances();
+  // Count how many leaves of the products reference each PolySet
+  void countInstances(const CSGProducts& products);
+  // Return true if the PolySet is drawn from a shared InstancedSurface
+  [[nodiscard]] bool isInstanced(const PolySet& polyset) const;
+  // Return the shared surface of the PolySet, uploading it on first use
+  const InstancedSurface& instancedSurface(const PolySet& polyset,
+                                           const ShaderUtils::ShaderInfo *shaderinfo);
+  // Create a VertexState drawing the shared surface with the given transform and color.
+  // If positions_only is set, only vertex positions are enabled, e.g. for OpenCSG primitives.
+  [[nodiscard]] std::shared_ptr<VertexState> createInstanceState(const VertexStateFactory& factory,
+                                                                 const InstancedSurface& surface,
+                                                                 const Transform3d& matrix,
+                                                                 const Color4f& color,
+                                                                 bool positions_only = false) const;
+  // Append the barycentric shader state and an instance state of the PolySet to states.
+  // Returns the instance state.
+  std::shared_ptr<VertexState> addInstance(std::vector<std::shared_ptr<VertexState>>& states,
+                                           const VertexStateFactory& factory, const PolySet& polyset,
+                                           const Transform3d& matrix, const Color4f& color,
+                                           const ShaderUtils::ShaderInfo *shaderinfo);
+
   void add_shader_data(VBOBuilder& vbo_builder);
   void shader_attribs_enable(const ShaderUtils::ShaderInfo&) const;
   void shader_attribs_disable(const ShaderUtils::ShaderInfo&) const;
@@ -59,5 +95,8 @@ protected:
                              boost::hash<std::pair<const PolySet *, const Transform3d *>>>
     geom_visit_mark_;
 
+  std::unordered_map<const PolySet *, size_t> instance_counts_;
+  std::unordered_map<const PolySet *, InstancedSurface> instanced_surfaces_;
+
 private:
 };
@@ -1,9 +1,11 @@
 #include "glview/preview/CSGTreeNormalizer.h"
 
+#include <boost/functional/hash.hpp>
 #include <cassert>
+#include <cstddef>
 #include <utility>
 #include <memory>
-#include <stack>
+#include <vector>
 
 #include "core/CSGNode.h"
 #include "core/enums.h"
@@ -23,31 +25,15 @@ static bool validate_tree(const std::shared_ptr<CSGNode>& node)
 
 /*!
    NB! for e.g. empty intersections, this can normalize a tree to nothing and return nullptr.
+
+   Normalized subterms are remembered across calls, so normalizing e.g. highlight terms which are
+   part of an already normalized tree is cheap.
  */
 std::shared_ptr<CSGNode> CSGTreeNormalizer::normalize(const std::shared_ptr<CSGNode>& root)
 {
   this->aborted = false;
   this->nodecount = 0;
-  std::shared_ptr<CSGNode> temp = root;
-  temp = normalizePass(temp);
-  this->rootnode.reset();
-  return temp;
-}
-
-/*!
-   After aborting, a subtree might have become invalidated (nullptr child node)
-   since terms can be instantiated multiple times.
-   This will search for nullptr children an recursively repair the corresponding
-   subtree.
- */
-std::shared_ptr<CSGNode> CSGTreeNormalizer::cleanup_term(std::shared_ptr<CSGNode>& t)
-{
-  if (std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(t)) {
-    if (op->left()) op->left() = cleanup_term(op->left());
-    if (op->right()) op->right() = cleanup_term(op->right());
-    return collapse_null_terms(op);
-  }
-  return t;
+  return normalizePass(root);
 }
 
 static bool isUnion(const std::shared_ptr<CSGNode>& node)
@@ -68,7 +54,83 @@ static bool hasLeftUnion(const std::shared_ptr<CSGNode>& node)
   return op && isUnion(op->left());
 }
 
-std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizePass(std::shared_ptr<CSGNode> node)
+size_t CSGTreeNormalizer::TermKeyHash::operator()(const TermKey& key) const
+{
+  size_t seed = 0;
+  boost::hash_combine(seed, static_cast<int>(key.type));
+  boost::hash_combine(seed, key.left);
+  boost::hash_combine(seed, key.right);
+  boost::hash_combine(seed, key.flags);
+  boost::hash_combine(seed, key.pruned);
+  return seed;
+}
+
+/*!
+   Hash-consed version of createNode(): Creating the same operation on the same
+   operands twice returns the same node, so equal subterms created by different rewrites are
+   shared and only normalized once.
+ */
+std::shared_ptr<CSGNode> CSGTreeNormalizer::createNode(OpenSCADOperator type,
+                                                       const std::shared_ptr<CSGNode>& left,
+                                                       const std::shared_ptr<CSGNode>& right)
+{
+  auto& entry = this->terms[TermKey{type, left.get(), right.get(), CSGNode::FLAG_NONE, true}];
+  auto node = entry.node.lock();
+  if (!node || entry.left.lock() != left || entry.right.lock() != right) {
+    node = CSGOperation::createCSGNode(type, left, right);
+    entry = {left, right, node};
+  }
+  return node;
+}
+
+/*!
+   Returns op with one of its operands replaced by its normalized version. Unlike createNode(),
+   this keeps the flags of op and never prunes, like modifying op in place would.
+ */
+std::shared_ptr<CSGOperation> CSGTreeNormalizer::replaceOperand(const std::shared_ptr<CSGOperation>& op,
+                                                                const std::shared_ptr<CSGNode>& left,
+                                                                const std::shared_ptr<CSGNode>& right)
+{
+  assert(left && right);
+  if (left == op->left() && right == op->right()) return op;
+  auto& entry = this->terms[TermKey{op->getType(), left.get(), right.get(), op->getFlags(), false}];
+  auto node = std::static_pointer_cast<CSGOperation>(entry.node.lock());
+  if (!node || entry.left.lock() != left || entry.right.lock() != right) {
+    node.reset(new CSGOperation(op->getType(), left, right), CSGOperationDeleter());
+    node->setHighlight(op->isHighlight());
+    node->setBackground(op->isBackground());
+    entry = {left, right, node};
+  }
+  return node;
+}
+
+std::shared_ptr<CSGNode> CSGTreeNormalizer::lookupNormalized(const std::shared_ptr<CSGNode>& term) const
+{
+  const auto it = this->normalized.find(term.get());
+  if (it == this->normalized.end() || it->second.first.lock() != term) return nullptr;
+  return it->second.second.lock();
+}
+
+/*!
+   Applies the rewrite rules at the root of node until none match. Returns the resulting
+   operation, or nullptr if node became a leaf or the node limit was reached.
+ */
+std::shared_ptr<CSGOperation> CSGTreeNormalizer::rewrite(std::shared_ptr<CSGNode>& node)
+{
+  while (node && match_and_replace(node)) {
+  }
+  this->nodecount++;
+  if (nodecount > this->limit) {
+    LOG(message_group::Warning,
+        "Normalized tree is growing past %1$d elements. Aborting normalization.\n", this->limit);
+    this->aborted = true;
+    node.reset();
+    return nullptr;
+  }
+  return std::dynamic_pointer_cast<CSGOperation>(node);
+}
+
+std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizePass(const std::shared_ptr<CSGNode>& root)
 {
   // This function implements the CSG normalization
   // Reference:
@@ -79,93 +141,69 @@ std::shared_ptr<CSGNode> CSGTreeNormalizer::normalizePass(std::shared_ptr<CSGNod
   // http://www.cc.gatech.edu/~turk/my_papers/pxpl_csg.pdf
 
   // Iterative tree traversal used to workaround stack limits for very large inputs.
-  // This uses dreaded goto calls but is easily verifiable to be
-  // functionally equivalent to the original recursive function,
-  // compared to the previous attempt.
-  // See Issue #2883 for problem with previous iterative implementation
-  // See Pull Request #2343 for the initial reasons for making this not recursive.
-
-  // stores current node and bool indicating if it was a left or right call;
-  using stackframe_t = std::pair<std::shared_ptr<CSGOperation>, bool>;
-  std::stack<stackframe_t> callstack;
-
-entrypoint:
-  if (std::dynamic_pointer_cast<CSGLeaf>(node)) goto return_node;
-  do {
-    while (node && match_and_replace(node)) {
-    }
-    this->nodecount++;
-    if (nodecount > this->limit) {
-      LOG(message_group::Warning,
-          "Normalized tree is growing past %1$d elements. Aborting normalization.\n", this->limit);
-      this->aborted = true;
-      return {};
-    }
-    if (!node || std::dynamic_pointer_cast<CSGLeaf>(node)) goto return_node;
-    goto normalize_left_if_op;
-  cont_left:;
-  } while (!this->aborted && !isUnion(node) && (hasRightNonLeaf(node) || hasLeftUnion(node)));
+  // See Issue #2883 and Pull Request #2343.
+  // Terms are never modified in place, since they may be shared. Instead, each normalized
+  // term is memoized, so shared subterms are only normalized once.
 
-  if (!this->aborted) {
-    goto normalize_right;
-  cont_right:;
-  }
+  struct Frame {
+    std::shared_ptr<CSGNode> term;     // term being normalized, as passed in
+    std::shared_ptr<CSGOperation> op;  // current state of term after rewriting
+    bool left_done;                    // true while normalizing the right operand
+  };
+  std::vector<Frame> callstack;
 
-  // FIXME: Do we need to take into account any transformation of item here?
-  node = collapse_null_terms(node);
+  std::shared_ptr<CSGNode> node = root;  // term to normalize next
+  std::shared_ptr<CSGNode> result;       // normalized term to return to the top frame
+  bool returning = false;
 
-  if (this->aborted) {
-    if (node) node = cleanup_term(node);
-  }
+  const auto finish = [&](const std::shared_ptr<CSGNode>& normalized) {
+    const auto& term = callstack.back().term;
+    this->normalized[term.get()] = {term, normalized};
+    callstack.pop_back();
+    result = normalized;
+    returning = true;
+  };
 
-return_node:
-  if (callstack.empty()) {
-    return node;
-  } else {
-    stackframe_t frame = callstack.top();
-    callstack.pop();
-    if (frame.second) {  // came from a left call
-      frame.first->left() = node;
-      node = frame.first;
-      goto cont_left;
-    } else {  // came from a right call
-      frame.first->right() = node;
-      node = frame.first;
-      goto cont_right;
+  while (true) {
+    if (!returning) {
+      if (!node || std::dynamic_pointer_cast<CSGLeaf>(node)) {
+        result = node;
+        returning = true;
+      } else if (auto memo = lookupNormalized(node)) {
+        result = std::move(memo);
+        returning = true;
+      } else {
+        auto& frame = callstack.emplace_back(Frame{node, nullptr, false});
+        if ((frame.op = rewrite(node))) node = frame.op->left();
+        else if (this->aborted) return {};
+        else finish(node);
+      }
+      continue;
     }
-  }
-normalize_left_if_op:
-  if (std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node)) {
-    callstack.emplace(op, true);
-    node = op->left();
-    goto entrypoint;
-  }
-  goto cont_left;
-normalize_right:
-  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
-  assert(op);
-  callstack.emplace(op, false);
-  node = op->right();
-  goto entrypoint;
-}
 
-std::shared_ptr<CSGNode> CSGTreeNormalizer::collapse_null_terms(const std::shared_ptr<CSGNode>& node)
-{
-  std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node);
-  if (op) {
-    if (!op->right()) {
-      this->nodecount--;
-      if (op->getType() == OpenSCADOperator::UNION || op->getType() == OpenSCADOperator::DIFFERENCE)
-        return op->left();
-      else return op->right();
-    }
-    if (!op->left()) {
-      this->nodecount--;
-      if (op->getType() == OpenSCADOperator::UNION) return op->right();
-      else return op->left();
+    if (callstack.empty()) return result;
+    auto& frame = callstack.back();
+    if (!frame.left_done) {
+      frame.op = replaceOperand(frame.op, result, frame.op->right());
+      if (!isUnion(frame.op) && (hasRightNonLeaf(frame.op) || hasLeftUnion(frame.op))) {
+        node = frame.op;
+        if ((frame.op = rewrite(node))) {
+          node = frame.op->left();
+          returning = false;
+        } else if (this->aborted) {
+          return {};
+        } else {
+          finish(node);
+        }
+        continue;
+      }
+      frame.left_done = true;
+      node = frame.op->right();
+      returning = false;
+    } else {
+      finish(replaceOperand(frame.op, frame.op->left(), result));
     }
   }
-  return node;
 }
 
 bool CSGTreeNormalizer::match_and_replace(std::shared_ptr<CSGNode>& node)
@@ -184,49 +222,42 @@ bool CSGTreeNormalizer::match_and_replace(std::shared_ptr<CSGNode>& node)
 
     // 1.  x - (y + z) -> (x - y) - z
     if (op->getType() == OpenSCADOperator::DIFFERENCE && rightop->getType() == OpenSCADOperator::UNION) {
-      node =
-        CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE,
-                                    CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, x, y), z);
+      node = createNode(OpenSCADOperator::DIFFERENCE, createNode(OpenSCADOperator::DIFFERENCE, x, y), z);
       return true;
     }
     // 2.  x * (y + z) -> (x * y) + (x * z)
     else if (op->getType() == OpenSCADOperator::INTERSECTION &&
              rightop->getType() == OpenSCADOperator::UNION) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::UNION, CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, y),
-        CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, z));
+      node = createNode(OpenSCADOperator::UNION, createNode(OpenSCADOperator::INTERSECTION, x, y),
+                        createNode(OpenSCADOperator::INTERSECTION, x, z));
       return true;
     }
     // 3.  x - (y * z) -> (x - y) + (x - z)
     else if (op->getType() == OpenSCADOperator::DIFFERENCE &&
              rightop->getType() == OpenSCADOperator::INTERSECTION) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::UNION, CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, x, y),
-        CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, x, z));
+      node = createNode(OpenSCADOperator::UNION, createNode(OpenSCADOperator::DIFFERENCE, x, y),
+                        createNode(OpenSCADOperator::DIFFERENCE, x, z));
       return true;
     }
     // 4.  x * (y * z) -> (x * y) * z
     else if (op->getType() == OpenSCADOperator::INTERSECTION &&
              rightop->getType() == OpenSCADOperator::INTERSECTION) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::INTERSECTION,
-        CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, y), z);
+      node = createNode(
+        OpenSCADOperator::INTERSECTION, createNode(OpenSCADOperator::INTERSECTION, x, y), z);
       return true;
     }
     // 5.  x - (y - z) -> (x - y) + (x * z)
     else if (op->getType() == OpenSCADOperator::DIFFERENCE &&
              rightop->getType() == OpenSCADOperator::DIFFERENCE) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::UNION, CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, x, y),
-        CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, z));
+      node = createNode(OpenSCADOperator::UNION, createNode(OpenSCADOperator::DIFFERENCE, x, y),
+                        createNode(OpenSCADOperator::INTERSECTION, x, z));
       return true;
     }
     // 6.  x * (y - z) -> (x * y) - z
     else if (op->getType() == OpenSCADOperator::INTERSECTION &&
              rightop->getType() == OpenSCADOperator::DIFFERENCE) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::DIFFERENCE, CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, y),
-        z);
+      node = createNode(
+        OpenSCADOperator::DIFFERENCE, createNode(OpenSCADOperator::INTERSECTION, x, y), z);
       return true;
     }
   }
@@ -241,36 +272,24 @@ bool CSGTreeNormalizer::match_and_replace(std::shared_ptr<CSGNode>& node)
     // 7. (x - y) * z  -> (x * z) - y
     if (leftop->getType() == OpenSCADOperator::DIFFERENCE &&
         op->getType() == OpenSCADOperator::INTERSECTION) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::DIFFERENCE, CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, z),
-        y);
+      node = createNode(
+        OpenSCADOperator::DIFFERENCE, createNode(OpenSCADOperator::INTERSECTION, x, z), y);
       return true;
     }
     // 8. (x + y) - z  -> (x - z) + (y - z)
     else if (leftop->getType() == OpenSCADOperator::UNION &&
              op->getType() == OpenSCADOperator::DIFFERENCE) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::UNION, CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, x, z),
-        CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, y, z));
+      node = createNode(OpenSCADOperator::UNION, createNode(OpenSCADOperator::DIFFERENCE, x, z),
+                        createNode(OpenSCADOperator::DIFFERENCE, y, z));
       return true;
     }
     // 9. (x + y) * z  -> (x * z) + (y * z)
     else if (leftop->getType() == OpenSCADOperator::UNION &&
              op->getType() == OpenSCADOperator::INTERSECTION) {
-      node = CSGOperation::createCSGNode(
-        OpenSCADOperator::UNION, CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, x, z),
-        CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, y, z));
+      node = createNode(OpenSCADOperator::UNION, createNode(OpenSCADOperator::INTERSECTION, x, z),
+                        createNode(OpenSCADOperator::INTERSECTION, y, z));
       return true;
     }
   }
   return false;
 }
-
-// Counts all non-leaf nodes
-unsigned int CSGTreeNormalizer::count(const std::shared_ptr<CSGNode>& node) const
-{
-  if (std::shared_ptr<CSGOperation> op = std::dynamic_pointer_cast<CSGOperation>(node)) {
-    return 1 + count(op->left()) + count(op->right());
-  }
-  return 0;
-}
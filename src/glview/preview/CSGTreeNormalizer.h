@@ -2,6 +2,13 @@
 
 #include <cstddef>
 #include <memory>
+#include <unordered_map>
+#include <utility>
+
+#include "core/enums.h"
+
+class CSGNode;
+class CSGOperation;
 
 class CSGTreeNormalizer
 {
@@ -11,14 +18,50 @@ public:
   std::shared_ptr<class CSGNode> normalize(const std::shared_ptr<CSGNode>& term);
 
 private:
-  std::shared_ptr<CSGNode> normalizePass(std::shared_ptr<CSGNode> term);
+  // Identifies an operation by its operands, for hash-consing
+  struct TermKey {
+    OpenSCADOperator type;
+    const CSGNode *left;
+    const CSGNode *right;
+    unsigned int flags;
+    bool pruned;
+    bool operator==(const TermKey& other) const
+    {
+      return type == other.type && left == other.left && right == other.right &&
+             flags == other.flags && pruned == other.pruned;
+    }
+  };
+  struct TermKeyHash {
+    size_t operator()(const TermKey& key) const;
+  };
+  // A hash-consed operation. The operands are kept to detect when an address in the key was
+  // reused by another node.
+  struct Term {
+    std::weak_ptr<CSGNode> left;
+    std::weak_ptr<CSGNode> right;
+    std::weak_ptr<CSGNode> node;
+  };
+
+  std::shared_ptr<CSGNode> normalizePass(const std::shared_ptr<CSGNode>& root);
+  [[nodiscard]] std::shared_ptr<CSGNode> lookupNormalized(const std::shared_ptr<CSGNode>& term) const;
+  std::shared_ptr<CSGOperation> rewrite(std::shared_ptr<CSGNode>& node);
   bool match_and_replace(std::shared_ptr<class CSGNode>& term);
-  std::shared_ptr<CSGNode> collapse_null_terms(const std::shared_ptr<CSGNode>& term);
-  std::shared_ptr<CSGNode> cleanup_term(std::shared_ptr<CSGNode>& t);
-  [[nodiscard]] unsigned int count(const std::shared_ptr<CSGNode>& term) const;
+  std::shared_ptr<CSGNode> createNode(OpenSCADOperator type, const std::shared_ptr<CSGNode>& left,
+                                      const std::shared_ptr<CSGNode>& right);
+  std::shared_ptr<CSGOperation> replaceOperand(const std::shared_ptr<CSGOperation>& op,
+                                               const std::shared_ptr<CSGNode>& left,
+                                               const std::shared_ptr<CSGNode>& right);
 
   bool aborted{false};
   size_t limit;
   size_t nodecount{0};
-  std::shared_ptr<class CSGNode> rootnode;
+  // Operations created during normalization, keyed by their operands. Entries don't keep nodes
+  // alive, and are only used while the node and both operands still exist. The node alone isn't
+  // enough: createCSGNode() may prune an operation to one of its operands, which then doesn't
+  // keep the other operand alive.
+  std::unordered_map<TermKey, Term, TermKeyHash> terms;
+  // Normalized version of each term normalized so far. The term is kept to detect when its
+  // address was reused by another node.
+  std::unordered_map<const CSGNode *, std::pair<std::weak_ptr<CSGNode>, std::weak_ptr<CSGNode>>>
+    normalized;
 };
@@ -0,0 +1,126 @@
+#include "glview/preview/CSGTreeNormalizer.h"
+
+#include <catch2/catch_all.hpp>
+#include <functional>
+#include <memory>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "core/CSGNode.h"
+#include "core/enums.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+using Term = std::shared_ptr<CSGNode>;
+
+// Leaf with a unit cube, moved by offset. Leaves at offset 0 all overlap each other.
+Term leaf(const std::string& label, double offset = 0)
+{
+  auto ps = std::make_shared<PolySet>(3);
+  ps->vertices = {{0, 0, 0}, {1, 0, 0}, {1, 1, 0}, {0, 1, 0},
+                  {0, 0, 1}, {1, 0, 1}, {1, 1, 1}, {0, 1, 1}};
+  ps->indices = {{0, 1, 2, 3}, {4, 5, 6, 7}, {0, 1, 5, 4}, {1, 2, 6, 5}, {2, 3, 7, 6}, {3, 0, 4, 7}};
+  Transform3d matrix = Transform3d::Identity();
+  matrix.translate(Vector3d(offset, 0, 0));
+  return std::make_shared<CSGLeaf>(ps, matrix, Color4f(), label, 0);
+}
+
+Term U(const Term& left, const Term& right)
+{
+  return CSGOperation::createCSGNode(OpenSCADOperator::UNION, left, right);
+}
+Term I(const Term& left, const Term& right)
+{
+  return CSGOperation::createCSGNode(OpenSCADOperator::INTERSECTION, left, right);
+}
+Term D(const Term& left, const Term& right)
+{
+  return CSGOperation::createCSGNode(OpenSCADOperator::DIFFERENCE, left, right);
+}
+
+// The products the renderers draw, one per line
+std::string normalized(CSGTreeNormalizer& normalizer, const Term& term)
+{
+  const auto result = normalizer.normalize(term);
+  if (!result) return "<empty>";
+  CSGProducts products;
+  products.import(result);
+  return products.dump();
+}
+
+// Terms built from fresh leaves each time, with their normalized form as produced before
+// normalized subterms were shared
+const std::vector<std::pair<std::function<Term()>, std::string>>& testTerms()
+{
+  static const std::vector<std::pair<std::function<Term()>, std::string>> terms = {
+    {[] { return D(leaf("a"), U(leaf("b"), leaf("c"))); }, "+a -b -c\n"},
+    {[] { return I(leaf("a"), U(leaf("b"), leaf("c"))); }, "+a *b\n+a *c\n"},
+    {[] { return D(leaf("a"), I(leaf("b"), leaf("c"))); }, "+a -b\n+a -c\n"},
+    {[] { return D(leaf("a"), D(leaf("b"), leaf("c"))); }, "+a -b\n+a *c\n"},
+    {[] { return I(D(leaf("a"), leaf("b")), leaf("c")); }, "+a *c -b\n"},
+    {[] { return D(U(leaf("a"), leaf("b")), I(leaf("c"), leaf("d"))); }, "+a -c\n+b -c\n+a -d\n+b -d\n"},
+    {[] { return I(U(leaf("a"), leaf("b")), D(leaf("c"), leaf("d"))); }, "+a *c -d\n+b *c -d\n"},
+    {[] {
+       const auto a = leaf("a"), b = leaf("b"), c = leaf("c"), d = leaf("d");
+       return D(I(D(a, b), U(c, d)), I(a, D(b, d)));
+     },
+     "+a *c -b -a\n+a *d -b -a\n+a *c -b -b\n+a *d -b -b\n+a *c *d -b\n+a *d *d -b\n"},
+    {[] {
+       const auto x = U(leaf("a"), leaf("b"));
+       return D(x, I(x, leaf("c")));
+     },
+     "+a -a -b\n+b -a -b\n+a -c\n+b -c\n"},
+    // Operations with the far away leaf e are pruned by createCSGNode()
+    {[] { return I(U(leaf("a"), leaf("e", 10)), D(leaf("b"), leaf("e", 10))); }, "+a *b\n"},
+    {[] { return D(leaf("a"), U(leaf("e", 10), I(leaf("b"), leaf("e", 10)))); }, "+a\n"},
+  };
+  return terms;
+}
+
+}  // namespace
+
+TEST_CASE("CSGTreeNormalizer normalizes to sums of products", "[CSGTreeNormalizer]")
+{
+  for (const auto& [create, expected] : testTerms()) {
+    CSGTreeNormalizer normalizer(1000);
+    CHECK(normalized(normalizer, create()) == expected);
+  }
+}
+
+TEST_CASE("CSGTreeNormalizer can be reused for other trees", "[CSGTreeNormalizer]")
+{
+  // Nodes of earlier trees are freed, and their addresses are likely to be reused by the nodes
+  // of later trees. Subterms remembered from earlier trees must not leak into later results.
+  CSGTreeNormalizer normalizer(1000);
+  for (int round = 0; round < 20; ++round) {
+    for (const auto& [create, expected] : testTerms()) {
+      CHECK(normalized(normalizer, create()) == expected);
+    }
+  }
+}
+
+TEST_CASE("CSGTreeNormalizer shares normalized subterms", "[CSGTreeNormalizer]")
+{
+  // Highlight terms are subterms of the root term, and are normalized by the same normalizer
+  const auto a = leaf("a"), b = leaf("b"), c = leaf("c");
+  const auto highlight = D(a, U(b, c));
+  const auto root = I(highlight, leaf("d"));
+
+  CSGTreeNormalizer normalizer(1000);
+  CHECK(normalized(normalizer, root) == "+a *d -b -c\n");
+  CHECK(normalized(normalizer, highlight) == "+a -b -c\n");
+  CHECK(normalized(normalizer, root) == "+a *d -b -c\n");
+}
+
+TEST_CASE("CSGTreeNormalizer stops at the node limit", "[CSGTreeNormalizer]")
+{
+  Term term = leaf("a");
+  for (int i = 0; i < 8; ++i) {
+    term = I(term, U(leaf("b"), leaf("c")));
+  }
+  CSGTreeNormalizer normalizer(10);
+  CHECK(normalizer.normalize(term) == nullptr);
+}
@@ -47,7 +47,7 @@ class OpenCSGVBOPrim : public OpenCSG::Primitive
 {
 public:
   OpenCSGVBOPrim(OpenCSG::Operation operation, unsigned int convexity,
-                 std::unique_ptr<VertexState> vertex_state)
+                 std::shared_ptr<VertexState> vertex_state)
     : OpenCSG::Primitive(operation, convexity), vertex_state(std::move(vertex_state))
   {
   }
@@ -61,7 +61,7 @@ public:
   }
 
 private:
-  const std::unique_ptr<VertexState> vertex_state;
+  const std::shared_ptr<VertexState> vertex_state;
 };
 
 // Primitive for drawing using OpenCSG
@@ -75,12 +75,11 @@ std::unique_ptr<OpenCSGVBOPrim> createVBOPrimitive(
     vertex_state->drawMode(), vertex_state->drawSize(), vertex_state->drawType(),
     vertex_state->drawOffset(), vertex_state->elementOffset(), vertex_state->verticesVBO(),
     vertex_state->elementsVBO());
-  // First two glBegin entries are the vertex position calls
+  // The first begin/end states are the vertex position calls
   opencsg_vs->glBegin().insert(opencsg_vs->glBegin().begin(), vertex_state->glBegin().begin(),
-                               vertex_state->glBegin().begin() + 2);
-  // First glEnd entry is the disable vertex position call
+                               vertex_state->glBegin().begin() + VBOBuilder::POSITION_BEGIN_STATES);
   opencsg_vs->glEnd().insert(opencsg_vs->glEnd().begin(), vertex_state->glEnd().begin(),
-                             vertex_state->glEnd().begin() + 1);
+                             vertex_state->glEnd().begin() + VBOBuilder::POSITION_END_STATES);
 
   return std::make_unique<OpenCSGVBOPrim>(operation, convexity, std::move(opencsg_vs));
 }
@@ -102,6 +101,11 @@ OpenCSGRenderer::OpenCSGRenderer(std::shared_ptr<CSGProducts> root_products,
 void OpenCSGRenderer::prepare(const ShaderUtils::ShaderInfo *shaderinfo)
 {
   if (vertex_state_containers_.empty()) {
+    resetInstances();
+    if (root_products_) countInstances(*root_products_);
+    if (background_products_) countInstances(*background_products_);
+    if (highlights_products_) countInstances(*highlights_products_);
+
     if (root_products_) {
       createCSGVBOProducts(*root_products_, false, false, shaderinfo);
     }
@@ -184,6 +188,15 @@ void OpenCSGRenderer::createCSGVBOProducts(const CSGProducts& products, bool hig
 {
 #ifdef ENABLE_OPENCSG
   bool enable_barycentric = true;
+  const OpenCSGVertexStateFactory factory;
+  // Depth primitive of an instanced leaf, drawing the positions of its shared surface
+  const auto create_instance_primitive = [&](const CSGChainObject& csgobj, const Transform3d& matrix,
+                                             OpenCSG::Operation operation) {
+    const auto& surface = instancedSurface(*csgobj.leaf->polyset, shaderinfo);
+    return std::make_unique<OpenCSGVBOPrim>(
+      operation, csgobj.leaf->polyset->getConvexity(),
+      createInstanceState(factory, surface, matrix, Color4f(), true));
+  };
   for (const auto& product : products.products) {
     std::unique_ptr<OpenCSGVBOProduct> vertex_state_container = std::make_unique<OpenCSGVBOProduct>();
 
@@ -230,16 +243,30 @@ void OpenCSGRenderer::createCSGVBOProducts(const CSGProducts& products, bool hig
           last_color = color;
         }
 
-        add_shader_pointers(vbo_builder, shaderinfo);
+        const bool instanced = isInstanced(*csgobj.leaf->polyset);
+        const auto create_surface = [&]() {
+          if (instanced) {
+            addInstance(vertex_states, factory, *csgobj.leaf->polyset, csgobj.leaf->matrix, last_color,
+                        shaderinfo);
+          } else {
+            add_shader_pointers(vbo_builder, shaderinfo);
+            vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, last_color,
+                                       enable_barycentric, override_color);
+          }
+        };
+        const auto create_primitive = [&](const std::shared_ptr<OpenCSGVertexState>& csg_vs) {
+          if (instanced) {
+            return create_instance_primitive(csgobj, csgobj.leaf->matrix, OpenCSG::Intersection);
+          }
+          return createVBOPrimitive(csg_vs, OpenCSG::Intersection, csgobj.leaf->polyset->getConvexity());
+        };
 
         if (color.a() == 1.0f) {
           // object is opaque, draw normally
-          vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, last_color,
-                                     enable_barycentric, override_color);
+          create_surface();
           if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(vertex_states.back())) {
             csg_vs->setCsgObjectIndex(csgobj.leaf->index);
-            vertex_state_container->addPrimitive(
-              createVBOPrimitive(csg_vs, OpenCSG::Intersection, csgobj.leaf->polyset->getConvexity()));
+            vertex_state_container->addPrimitive(create_primitive(csg_vs));
           }
         } else {
           // object is transparent, so draw rear faces first.  Issue #1496
@@ -252,13 +279,11 @@ void OpenCSGRenderer::createCSGVBOProducts(const CSGProducts& products, bool hig
           });
           vertex_states.emplace_back(std::move(cull));
 
-          vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, last_color,
-                                     enable_barycentric, override_color);
+          create_surface();
           if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(vertex_states.back())) {
             csg_vs->setCsgObjectIndex(csgobj.leaf->index);
 
-            vertex_state_container->addPrimitive(
-              createVBOPrimitive(csg_vs, OpenCSG::Intersection, csgobj.leaf->polyset->getConvexity()));
+            vertex_state_container->addPrimitive(create_primitive(csg_vs));
 
             cull = std::make_shared<VertexState>();
             cull->glBegin().emplace_back([]() {
@@ -303,7 +328,8 @@ void OpenCSGRenderer::createCSGVBOProducts(const CSGProducts& products, bool hig
           last_color = color;
         }
 
-        add_shader_pointers(vbo_builder, shaderinfo);
+        const bool instanced = isInstanced(*csgobj.leaf->polyset);
+        if (!instanced) add_shader_pointers(vbo_builder, shaderinfo);
 
         // negative objects should only render rear faces
         std::shared_ptr<VertexState> cull = std::make_shared<VertexState>();
@@ -321,12 +347,18 @@ void OpenCSGRenderer::createCSGVBOProducts(const CSGProducts& products, bool hig
           // Scale 2D negative objects 10% in the Z direction to avoid z fighting
           tmp *= Eigen::Scaling(1.0, 1.0, 1.1);
         }
-        vbo_builder.create_surface(*csgobj.leaf->polyset, tmp, last_color, enable_barycentric,
-                                   override_color);
+        if (instanced) {
+          addInstance(vertex_states, factory, *csgobj.leaf->polyset, tmp, last_color, shaderinfo);
+        } else {
+          vbo_builder.create_surface(*csgobj.leaf->polyset, tmp, last_color, enable_barycentric,
+                                     override_color);
+        }
         if (const auto csg_vs = std::dynamic_pointer_cast<OpenCSGVertexState>(vertex_states.back())) {
           csg_vs->setCsgObjectIndex(csgobj.leaf->index);
           vertex_state_container->addPrimitive(
-            createVBOPrimitive(csg_vs, OpenCSG::Subtraction, csgobj.leaf->polyset->getConvexity()));
+            instanced ? create_instance_primitive(csgobj, tmp, OpenCSG::Subtraction)
+                      : createVBOPrimitive(csg_vs, OpenCSG::Subtraction,
+                                           csgobj.leaf->polyset->getConvexity()));
         } else {
           assert(false && "Subtraction surface state was nullptr");
         }
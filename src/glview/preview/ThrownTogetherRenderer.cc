@@ -90,6 +90,11 @@ void ThrownTogetherRenderer::prepare(const ShaderUtils::ShaderInfo *shaderinfo)
 {
   PRINTD("Thrown prepare");
   if (vertex_state_containers_.empty()) {
+    resetInstances();
+    if (this->root_products_) countInstances(*this->root_products_);
+    if (this->background_products_) countInstances(*this->background_products_);
+    if (this->highlight_products_) countInstances(*this->highlight_products_);
+
     VertexStateContainer& vertex_state_container = vertex_state_containers_.emplace_back();
 
     VBOBuilder vbo_builder(std::make_unique<TTRVertexStateFactory>(), vertex_state_container);
@@ -171,6 +176,19 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
   }
 
   const bool enable_barycentric = true;
+  const bool instanced = isInstanced(*csgobj.leaf->polyset);
+  const TTRVertexStateFactory factory;
+  const auto create_surface = [&](const Transform3d& matrix, const Color4f& color, bool override_color) {
+    if (instanced) {
+      addInstance(container.states(), factory, *csgobj.leaf->polyset, matrix, color, shaderinfo);
+    } else {
+      vbo_builder.create_surface(*csgobj.leaf->polyset, matrix, color, enable_barycentric,
+                                 override_color);
+    }
+    if (const auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(container.states().back())) {
+      ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
+    }
+  };
 
   const auto& leaf_color = csgobj.leaf->color;
 
@@ -183,18 +201,14 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     const ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    if (!instanced) add_shader_pointers(vbo_builder, shaderinfo);
 
-    vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, color, enable_barycentric,
-                               override_color);
-    if (const auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
-      ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
-    }
+    create_surface(csgobj.leaf->matrix, color, override_color);
   } else {  // root mode
     ColorMode colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, false, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    if (!instanced) add_shader_pointers(vbo_builder, shaderinfo);
 
     auto cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -210,17 +224,14 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
       // Scale 2D negative objects 10% in the Z direction to avoid z fighting
       mat *= Eigen::Scaling(1.0, 1.0, 1.1);
     }
-    vbo_builder.create_surface(*csgobj.leaf->polyset, mat, color, enable_barycentric, override_color);
-    if (auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
-      ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
-    }
+    create_surface(mat, color, override_color);
 
     color.setRgb(1.0f, 0.0f, 1.0f);  // override leaf color on front/back error
 
     colormode = getColorMode(csgobj.flags, highlight_mode, background_mode, true, type);
     getShaderColor(colormode, leaf_color, color);
 
-    add_shader_pointers(vbo_builder, shaderinfo);
+    if (!instanced) add_shader_pointers(vbo_builder, shaderinfo);
 
     cull = std::make_shared<VertexState>();
     cull->glBegin().emplace_back([]() {
@@ -229,11 +240,7 @@ void ThrownTogetherRenderer::createChainObject(VertexStateContainer& container,
     });
     container.states().emplace_back(std::move(cull));
 
-    vbo_builder.create_surface(*csgobj.leaf->polyset, csgobj.leaf->matrix, color, enable_barycentric,
-                               true);
-    if (auto ttr_vs = std::dynamic_pointer_cast<TTRVertexState>(vbo_builder.states().back())) {
-      ttr_vs->setCsgObjectIndex(csgobj.leaf->index);
-    }
+    create_surface(csgobj.leaf->matrix, color, true);
 
     container.states().back()->glEnd().emplace_back([]() {
       GL_TRACE0("glDisable(GL_CULL_FACE)");
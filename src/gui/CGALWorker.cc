@@ -1,8 +1,10 @@
 #include "gui/CGALWorker.h"
 
 #include <QThread>
+#include <chrono>
 #include <exception>
 #include <memory>
+#include <utility>
 
 #ifdef ENABLE_MANIFOLD
 #include "geometry/manifold/ManifoldGeometry.h"
@@ -10,7 +12,9 @@
 
 #include "core/Tree.h"
 #include "core/progress.h"
+#include "geometry/Geometry.h"
 #include "geometry/GeometryEvaluator.h"
+#include "glview/PolySetRenderer.h"
 #include "utils/exceptions.h"
 #include "utils/printutils.h"
 
@@ -34,12 +38,13 @@ CGALWorker::~CGALWorker()
   delete this->thread;
 }
 
-void CGALWorker::start(const Tree& tree)
+void CGALWorker::start(const Tree& tree, std::shared_ptr<ProgressSink> progress)
 {
 #ifdef ENABLE_PYTHON
   python_unlock();
 #endif
   this->tree = &tree;
+  this->progress = std::move(progress);
   this->thread->start();
 }
 
@@ -50,9 +55,30 @@ void CGALWorker::work()
   python_lock();
 #endif
   std::shared_ptr<const Geometry> root_geom;
+  size_t culled_operands = 0;
   try {
     GeometryEvaluator evaluator(*this->tree);
+    evaluator.setProgressSink(this->progress.get());
+
+    // Publish newly finished top-level objects, at most a few times per second. They are
+    // triangulated here, so the viewer only has to upload them.
+    Geometry::Geometries finished;
+    unsigned int dimension = 0;
+    auto last_partial = std::chrono::steady_clock::now();
+    evaluator.setPartialResultObserver(
+      [&](const std::shared_ptr<const AbstractNode>& node, const std::shared_ptr<const Geometry>& geom) {
+        if (dimension && dimension != geom->getDimension()) return;
+        dimension = geom->getDimension();
+        finished.emplace_back(node, PolySetRenderer::triangulate(geom));
+        const auto now = std::chrono::steady_clock::now();
+        if (now - last_partial < std::chrono::milliseconds(500)) return;
+        last_partial = now;
+        emit partial(std::make_shared<GeometryList>(std::move(finished)));
+        finished.clear();
+      });
+
     root_geom = evaluator.evaluateGeometry(*this->tree->root(), true);
+    culled_operands = evaluator.culledOperands();
 
 #ifdef ENABLE_MANIFOLD
     if (auto manifold = std::dynamic_pointer_cast<const ManifoldGeometry>(root_geom)) {
@@ -75,6 +101,6 @@ void CGALWorker::work()
 #ifdef ENABLE_PYTHON
   python_unlock();
 #endif
-  emit done(root_geom);
+  emit done(root_geom, culled_operands);
   thread->quit();
 }
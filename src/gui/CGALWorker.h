@@ -1,8 +1,10 @@
 #pragma once
 
 #include <QObject>
+#include <cstddef>
 #include <memory>
 
+class ProgressSink;
 class Tree;
 
 class CGALWorker : public QObject
@@ -14,15 +16,20 @@ public:
   ~CGALWorker() override;
 
 public slots:
-  void start(const Tree& tree);
+  void start(const Tree& tree, std::shared_ptr<ProgressSink> progress);
 
 protected slots:
   void work();
 
 signals:
-  void done(std::shared_ptr<const class Geometry>);
+  // Geometry of the top-level objects finished since the last emit, triangulated for
+  // PolySetRenderer. Emitted while rendering is in progress.
+  void partial(std::shared_ptr<const class Geometry>);
+  // The result, and the number of boolean operands culled by bounding box
+  void done(std::shared_ptr<const class Geometry>, size_t);
 
 protected:
   class QThread *thread;
   const class Tree *tree;
+  std::shared_ptr<ProgressSink> progress;
 };
@@ -55,6 +55,7 @@ Export3mfDialog::Export3mfDialog()
   this->labelColorsSelected->setStyleSheet(UIUtils::getBackgroundColorStyleSheet(this->color));
   this->spinBoxDecimalPrecision->setValue(S::export3mfDecimalPrecision.value());
   initComboBox(this->comboBoxMaterialType, S::export3mfMaterialType);
+  this->checkBoxStreaming->setChecked(S::export3mfStreaming.value());
 
   groupMetaData->setChecked(S::export3mfAddMetaData.value());
   initMetaData(nullptr, this->lineEditMetaDataTitle, nullptr, S::export3mfMetaDataTitle);
@@ -103,6 +104,7 @@ int Export3mfDialog::exec()
     S::export3mfColor.setValue(this->color.toRgb().name().toStdString());
     S::export3mfMaterialType.setIndex(this->comboBoxMaterialType->currentIndex());
     S::export3mfDecimalPrecision.setValue(this->spinBoxDecimalPrecision->value());
+    S::export3mfStreaming.setValue(this->checkBoxStreaming->isChecked());
     S::export3mfAddMetaData.setValue(this->groupMetaData->isChecked());
     applyMetaData(nullptr, this->lineEditMetaDataTitle, nullptr, S::export3mfMetaDataTitle);
     applyMetaData(this->checkBoxMetaDataDesigner, this->lineEditMetaDataDesigner,
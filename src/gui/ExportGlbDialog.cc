@@ -0,0 +1,60 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2026 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include "gui/ExportGlbDialog.h"
+
+#include <QApplication>
+#include <QDialog>
+
+#include "core/Settings.h"
+#include "gui/SettingsWriter.h"
+
+using S = Settings::SettingsExportGlb;
+
+ExportGlbDialog::ExportGlbDialog()
+{
+  setupUi(this);
+  this->checkBoxAlwaysShowDialog->setChecked(S::exportGlbAlwaysShowDialog.value());
+  this->checkBoxQuantize->setChecked(S::exportGlbQuantize.value());
+}
+
+int ExportGlbDialog::exec()
+{
+  bool showDialog = this->checkBoxAlwaysShowDialog->isChecked();
+  if ((QApplication::keyboardModifiers() & Qt::ShiftModifier) != 0) {
+    showDialog = true;
+  }
+
+  const auto result = showDialog ? QDialog::exec() : QDialog::Accepted;
+
+  if (result == QDialog::Accepted) {
+    S::exportGlbAlwaysShowDialog.setValue(this->checkBoxAlwaysShowDialog->isChecked());
+    S::exportGlbQuantize.setValue(this->checkBoxQuantize->isChecked());
+    Settings::Settings::visit(SettingsWriter());
+  }
+
+  return result;
+}
@@ -16,6 +16,7 @@ int Importer::init()
   knownFileExtensions["dxf"] = importStatement;
   knownFileExtensions["svg"] = importStatement;
   knownFileExtensions["amf"] = importStatement;
+  knownFileExtensions["ply"] = importStatement;
   knownFileExtensions["dat"] = surfaceStatement;
   knownFileExtensions["png"] = surfaceStatement;
   knownFileExtensions["json"] = importFunction;
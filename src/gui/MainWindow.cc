@@ -99,6 +99,7 @@
 #include "core/Context.h"
 #include "core/EvaluationSession.h"
 #include "core/Expression.h"
+#include "core/FreetypeRenderer.h"
 #include "core/RenderVariables.h"
 #include "core/ScopeContext.h"
 #include "core/Settings.h"
@@ -106,6 +107,7 @@
 #include "core/customizer/CommentParser.h"
 #include "core/node.h"
 #include "core/parsersettings.h"
+#include "core/primitives.h"
 #include "core/progress.h"
 #include "geometry/Geometry.h"
 #include "geometry/GeometryCache.h"
@@ -124,6 +126,7 @@
 #include "gui/ai/AIDock.h"
 #include "gui/Editor.h"
 #include "gui/Export3mfDialog.h"
+#include "gui/ExportGlbDialog.h"
 #include "gui/ExportPdfDialog.h"
 #include "gui/ExportSvgDialog.h"
 #include "gui/ExternalToolInterface.h"
@@ -144,6 +147,7 @@
 #include "gui/UIUtils.h"
 #include "gui/input/InputDriverEvent.h"
 #include "gui/input/InputDriverManager.h"
+#include "io/ImportCache.h"
 #include "io/dxfdim.h"
 #include "io/export.h"
 #include "io/fileutils.h"
@@ -157,6 +161,7 @@
 #include "geometry/cgal/CGALCache.h"
 #include "geometry/cgal/CGALNefGeometry.h"
 #include "geometry/cgal/cgal.h"
+#include "geometry/cgal/cgalutils.h"
 #endif  // ENABLE_CGAL
 #ifdef ENABLE_MANIFOLD
 #include "geometry/manifold/ManifoldGeometry.h"
@@ -629,7 +634,7 @@ void MainWindow::closeEvent(QCloseEvent *event)
   }
 
   isClosing = true;
-  progress_report_fin();
+  if (this->progressSink) this->progressSink->cancel();
 
   if (this->tempFile) {
     delete this->tempFile;
@@ -674,24 +679,34 @@ void MainWindow::showProgress()
   updateStatusBar(qobject_cast<ProgressWidget *>(sender()));
 }
 
-void MainWindow::report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int mark)
+std::shared_ptr<ProgressSink> MainWindow::createProgressSink()
+{
+  auto sink = std::make_shared<ProgressSink>();
+  // Reports come from the evaluating thread, possibly after this->progressSink has been replaced.
+  // The sink owns the callback, so it's captured as a plain pointer.
+  sink->setReportFunction([this, sink = sink.get()](const std::shared_ptr<const AbstractNode>&,
+                                                    int mark) { report_func(*sink, mark); });
+  sink->prepare(this->rootNode);
+  return sink;
+}
+
+void MainWindow::report_func(ProgressSink& sink, int mark)
 {
   // limit to progress bar update calls to 5 per second
   static const qint64 MIN_TIMEOUT = 200;
   if (progressThrottle->hasExpired(MIN_TIMEOUT)) {
     progressThrottle->start();
 
-    auto thisp = static_cast<MainWindow *>(vp);
-    auto v = static_cast<int>((mark * 1000.0) / progress_report_count);
+    auto v = static_cast<int>((mark * 1000.0) / std::max(sink.total(), 1));
     auto permille = v < 1000 ? v : 999;
-    if (permille > thisp->progresswidget->value()) {
-      QMetaObject::invokeMethod(thisp->progresswidget, "setValue", Qt::QueuedConnection,
+    if (permille > this->progresswidget->value()) {
+      QMetaObject::invokeMethod(this->progresswidget, "setValue", Qt::QueuedConnection,
                                 Q_ARG(int, permille));
       QApplication::processEvents();
     }
 
-    // FIXME: Check if cancel was requested by e.g. Application quit
-    if (thisp->progresswidget->wasCanceled()) throw ProgressCancelException();
+    // The sink throws ProgressCancelException on the evaluating thread after this returns
+    if (this->progresswidget->wasCanceled()) sink.cancel();
   }
 }
 
@@ -1052,9 +1067,10 @@ void MainWindow::compileCSG()
     CSGTreeEvaluator csgrenderer(this->tree, &geomevaluator);
 #endif
 
-    if (!isClosing) progress_report_prep(this->rootNode, report_func, this);
-    else return;
+    if (isClosing) return;
+    this->progressSink = createProgressSink();
     try {
+      const ProgressSink::Scope progress_scope(this->progressSink.get());
 #ifdef ENABLE_OPENCSG
       this->processEvents();
       this->csgRoot = csgrenderer.buildCSGTree(*rootNode);
@@ -1066,7 +1082,7 @@ void MainWindow::compileCSG()
     } catch (const HardWarningException&) {
       LOG("CSG generation cancelled due to hardwarning being enabled.");
     }
-    progress_report_fin();
+    this->progressSink.reset();
     updateStatusBar(nullptr);
 
     LOG("Compiling design (CSG Products normalization)...");
@@ -1995,6 +2011,7 @@ void MainWindow::cgalRender()
 
   this->qglview->setRenderer(nullptr);
   this->geomRenderer = nullptr;
+  this->partialRenderer = nullptr;
   rootGeom.reset();
 
   LOG("Rendering Polygon Mesh using %1$s...",
@@ -2003,18 +2020,35 @@ void MainWindow::cgalRender()
   this->progresswidget = new ProgressWidget(this);
   connect(this->progresswidget, &ProgressWidget::requestShow, this, &MainWindow::showProgress);
 
-  if (!isClosing) progress_report_prep(this->rootNode, report_func, this);
-  else return;
+  if (isClosing) return;
+  this->progressSink = createProgressSink();
+
+  this->cgalworker->start(this->tree, this->progressSink);
+}
 
-  this->cgalworker->start(this->tree);
+void MainWindow::actionRenderPartial(const std::shared_ptr<const Geometry>& partial_geom)
+{
+  // Show what has been rendered so far. This is replaced when rendering is done.
+  if (this->partialRenderer) {
+    this->partialRenderer->append(partial_geom);
+    this->qglview->update();
+  } else {
+    this->partialRenderer = std::make_shared<PolySetRenderer>(partial_geom);
+    this->geomRenderer = this->partialRenderer;
+    viewModeRender();
+  }
+  this->statusBar()->showMessage(_("Rendering... (showing partial result)"));
 }
 
-void MainWindow::actionRenderDone(const std::shared_ptr<const Geometry>& root_geom)
+void MainWindow::actionRenderDone(const std::shared_ptr<const Geometry>& root_geom,
+                                  size_t culled_operands)
 {
 #ifdef ENABLE_PYTHON
   python_lock();
 #endif
-  progress_report_fin();
+  this->progressSink.reset();
+  this->partialRenderer.reset();
+  this->statusBar()->clearMessage();
   if (root_geom) {
     std::vector<std::string> options;
     if (Settings::Settings::summaryCamera.value()) {
@@ -2026,6 +2060,7 @@ void MainWindow::actionRenderDone(const std::shared_ptr<const Geometry>& root_ge
     if (Settings::Settings::summaryBoundingBox.value()) {
       options.emplace_back(RenderStatistic::BOUNDING_BOX);
     }
+    renderStatistic.setCulledOperands(culled_operands);
     renderStatistic.printAll(root_geom, qglview->cam, options);
     LOG("Rendering finished.");
 
@@ -2048,6 +2083,12 @@ void MainWindow::actionRenderDone(const std::shared_ptr<const Geometry>& root_ge
     viewModeRender();
     resetMeasurementsState(true, "Click to start measuring");
   } else {
+    // Don't leave a partial result on screen
+    if (this->geomRenderer) {
+      this->geomRenderer = nullptr;
+      this->qglview->setRenderer(nullptr);
+      this->qglview->update();
+    }
     resetMeasurementsState(false, "No top level geometry; render something to enable measurements");
     LOG(message_group::UI_Warning, "No top level geometry to render");
   }
@@ -2597,6 +2638,15 @@ void MainWindow::actionExportFileFormat(int fmt)
     exportInfo.options3mf = export3mfDialog.getOptions();
     actionExport(3, exportInfo);
   } break;
+  case FileFormat::GLB: {
+    ExportGlbDialog exportGlbDialog;
+    if (exportGlbDialog.exec() == QDialog::Rejected) {
+      return;
+    }
+
+    exportInfo.optionsGlb = exportGlbDialog.getOptions();
+    actionExport(3, exportInfo);
+  } break;
   case FileFormat::CSG: {
     auto guard = scopedSetCurrentOutput();
 
@@ -2675,9 +2725,15 @@ void MainWindow::on_designActionFlushCaches_triggered()
   auto guard = scopedSetCurrentOutput();
   GeometryCache::instance()->clear();
   CGALCache::instance()->clear();
+#ifdef ENABLE_CGAL
+  CGALUtils::clearMinkowskiCache();
+#endif
   dxf_dim_cache.clear();
   dxf_cross_cache.clear();
   SourceFileCache::instance()->clear();
+  ImportCache::instance()->clear();
+  FreetypeRenderer::clear_caches();
+  clearPrimitiveCaches();
 
   LOG("Caches Flushed");
 }
@@ -3492,6 +3548,7 @@ void MainWindow::setupCoreSubsystems()
   renderCompleteSoundEffect->setSource(QUrl("qrc:/sounds/complete.wav"));
 
   this->cgalworker = new CGALWorker();
+  connect(this->cgalworker, &CGALWorker::partial, this, &MainWindow::actionRenderPartial);
   connect(this->cgalworker, &CGALWorker::done, this, &MainWindow::actionRenderDone);
 
   autoReloadTimer = new QTimer(this);
@@ -3888,6 +3945,8 @@ void MainWindow::setupMenusAndActions()
   exportMap[FileFormat::OFF] = this->fileActionExportOFF;
   exportMap[FileFormat::WRL] = this->fileActionExportWRL;
   exportMap[FileFormat::POV] = this->fileActionExportPOV;
+  exportMap[FileFormat::GLB] = this->fileActionExportGLB;
+  exportMap[FileFormat::PLY] = this->fileActionExportPLY;
   exportMap[FileFormat::AMF] = this->fileActionExportAMF;
   exportMap[FileFormat::DXF] = this->fileActionExportDXF;
   exportMap[FileFormat::SVG] = this->fileActionExportSVG;
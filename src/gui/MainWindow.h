@@ -45,11 +45,13 @@ Q_IMPORT_PLUGIN(QSvgPlugin)
 
 class BuiltinContext;
 class CGALWorker;
+class ProgressSink;
 class CSGNode;
 class CSGProducts;
 class FontListDialog;
 class LibraryInfoDialog;
 class Preferences;
+class PolySetRenderer;
 class ProgressWidget;
 class ThrownTogetherRenderer;
 class AIDock;
@@ -106,6 +108,8 @@ public:
 
   std::shared_ptr<const Geometry> rootGeom;
   std::shared_ptr<Renderer> geomRenderer;
+  // Renderer of the partial result while rendering is in progress, also held by geomRenderer
+  std::shared_ptr<PolySetRenderer> partialRenderer;
 #ifdef ENABLE_OPENCSG
   std::shared_ptr<Renderer> previewRenderer;
 #endif
@@ -350,7 +354,8 @@ private slots:
   void on_designAction3DPrint_triggered();
   void sendToExternalTool(class ExternalToolInterface& externalToolService);
   void on_designActionRender_triggered();
-  void actionRenderDone(const std::shared_ptr<const Geometry>&);
+  void actionRenderPartial(const std::shared_ptr<const Geometry>&);
+  void actionRenderDone(const std::shared_ptr<const Geometry>&, size_t culled_operands);
   void cgalRender();
   void handleMeasurementClicked(QAction *clickedAction);
   void on_designCheckValidity_triggered();
@@ -440,7 +445,8 @@ public slots:
 
 private:
   bool network_progress_func(const double permille);
-  static void report_func(const std::shared_ptr<const AbstractNode>&, void *vp, int mark);
+  void report_func(ProgressSink& sink, int mark);
+  std::shared_ptr<ProgressSink> createProgressSink();
   static bool undockMode;
   static bool reorderMode;
   static const int tabStopWidth;
@@ -460,6 +466,7 @@ private:
   QTemporaryFile *tempFile{nullptr};
   ProgressWidget *progresswidget{nullptr};
   CGALWorker *cgalworker;
+  std::shared_ptr<ProgressSink> progressSink;  // Progress and cancellation of the running evaluation
   QMutex consolemutex;
   EditorInterface *renderedEditor;  // stores pointer to editor which has been most recently rendered
   time_t includesMTime{0};          // latest include mod time
@@ -106,6 +106,18 @@ void QGLView::init()
   this->mouse_drag_active = false;
   this->statusLabel = nullptr;
 
+  this->interactionTimer = new QTimer(this);
+  this->interactionTimer->setSingleShot(true);
+  this->interactionTimer->setInterval(250);
+  connect(this->interactionTimer, &QTimer::timeout, this, [this]() {
+    setInteractive(false);
+    update();
+  });
+  connect(this, &QGLView::cameraChanged, this, [this]() {
+    setInteractive(true);
+    this->interactionTimer->start();
+  });
+
   setMouseTracking(true);
 }
 
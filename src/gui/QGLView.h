@@ -14,6 +14,7 @@
 #include <QtGlobal>
 #include <QOpenGLWidget>
 #include <QLabel>
+#include <QTimer>
 #include <string>
 #include <vector>
 
@@ -83,6 +84,8 @@ private:
   bool mouse_drag_active;
   bool mouse_drag_moved = true;
   bool mouseCentricZoom = true;
+  // Restarted on every camera change; the model is drawn at full detail again once it fires.
+  QTimer *interactionTimer;
   // Information held for each mouse action is a 3x2 rotation matrix, a 3x2 translation matrix, and a
   // zoom 2-vector.
   float mouseActions[MouseConfig::MouseAction::NUM_MOUSE_ACTIONS * MouseConfig::ACTION_DIMENSION];
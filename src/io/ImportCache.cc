@@ -0,0 +1,114 @@
+#include "io/ImportCache.h"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <system_error>
+#include <utility>
+#include <vector>
+
+#include "utils/flat_hash.h"
+#include "utils/printutils.h"
+
+namespace fs = std::filesystem;
+
+namespace {
+
+// Hashes the content of a file, eight bytes at a time. Returns false if it couldn't be read.
+bool hash_file(const fs::path& path, uint64_t& hash)
+{
+  std::ifstream stream(path, std::ios::binary);
+  if (!stream) return false;
+
+  constexpr size_t chunk_size = 1 << 20;
+  std::vector<char> chunk(chunk_size);
+  uint64_t h = 0;
+  uint64_t length = 0;
+  while (stream) {
+    stream.read(chunk.data(), chunk_size);
+    const auto n = static_cast<size_t>(stream.gcount());
+    if (n == 0) break;
+    size_t i = 0;
+    for (; i + 8 <= n; i += 8) {
+      uint64_t word;
+      std::memcpy(&word, chunk.data() + i, sizeof(word));
+      h = hash_mix(h ^ word) + i;
+    }
+    uint64_t tail = 0;
+    std::memcpy(&tail, chunk.data() + i, n - i);
+    h = hash_mix(h ^ tail);
+    length += n;
+  }
+  if (stream.bad()) return false;
+  hash = hash_mix(h ^ length);
+  return true;
+}
+
+}  // namespace
+
+ImportCache *ImportCache::inst = nullptr;
+
+std::shared_ptr<const void> ImportCache::lookup(const std::string& filename, const std::string& parser,
+                                                FileIdentity& id, std::vector<Message>& messages)
+{
+  std::error_code ec;
+  const fs::path path = fs::canonical(fs::u8path(filename), ec);
+  if (ec) return nullptr;
+  const auto size = fs::file_size(path, ec);
+  if (ec) return nullptr;
+  const auto mtime = fs::last_write_time(path, ec);
+  if (ec) return nullptr;
+
+  const std::string key = path.u8string() + "\n" + parser;
+  id = FileIdentity{key, size, mtime, std::nullopt};
+  std::unique_lock<std::mutex> lock(this->mutex);
+  auto *entry = this->cache[key];
+  if (!entry || entry->id.size != size) return nullptr;
+  if (entry->id.mtime == mtime) {
+    messages = entry->messages;
+    return entry->value;
+  }
+  lock.unlock();
+
+  // Touched, so check whether the content changed. The file isn't locked while it's hashed.
+  uint64_t hash;
+  if (!hash_file(path, hash)) return nullptr;
+  id.hash = hash;
+  lock.lock();
+  entry = this->cache[key];
+  if (entry && entry->id.size == size && entry->id.hash == hash) {
+    entry->id.mtime = mtime;
+    messages = entry->messages;
+    return entry->value;
+  }
+  return nullptr;
+}
+
+void ImportCache::insert(const FileIdentity& id, std::shared_ptr<const void> value, size_t cost,
+                         const std::vector<Message>& messages)
+{
+  if (id.key.empty()) return;
+  for (const auto& message : messages) {
+    cost += sizeof(message) + message.msg.size() + message.docPath.size();
+  }
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->cache.insert(id.key, new cache_entry{id, std::move(value), messages}, cost);
+}
+
+size_t ImportCache::size() const
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  return this->cache.size();
+}
+
+void ImportCache::clear()
+{
+  std::lock_guard<std::mutex> lock(this->mutex);
+  this->cache.clear();
+}
@@ -0,0 +1,89 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <vector>
+
+#include "Cache.h"
+#include "utils/printutils.h"
+
+/*!
+   Caches the results of parsing imported files, so that a file is only parsed again when its
+   content changes.
+
+   Results are keyed by the file's canonical path, size and modification time, together with the
+   name of the parser. When only the modification time changed, the content is hashed to tell
+   whether the file was just touched, so several import() or surface() calls of the same file
+   share one parse. The hash is taken the first time a file is seen touched rather than on every
+   parse, so a file which is never touched is never hashed.
+
+   The messages printed while parsing are stored with the result, and printed again whenever it
+   is reused, so that warnings about a file don't disappear once it's cached.
+
+   Cached results are shared and must not be modified.
+ */
+class ImportCache
+{
+public:
+  ImportCache(size_t memorylimit = 256ul * 1024ul * 1024ul) : cache(memorylimit) {}
+
+  static ImportCache *instance()
+  {
+    if (!inst) inst = new ImportCache;
+    return inst;
+  }
+
+  /*!
+     Returns the result of parse() for the given file, calling it only if there is no cached
+     result for the file's current content. T must have a memsize() method. parse() should
+     return nullptr if the file couldn't be parsed; this isn't cached, so errors are reported
+     again the next time.
+   */
+  template <typename T, typename Parse>
+  std::shared_ptr<const T> get(const std::string& filename, const std::string& parser, Parse parse)
+  {
+    FileIdentity id;
+    std::vector<Message> messages;
+    if (auto value = lookup(filename, parser, id, messages)) {
+      for (const auto& message : messages) PRINT(message);
+      return std::static_pointer_cast<const T>(value);
+    }
+    MessageRecorder recorder;
+    std::shared_ptr<const T> value = parse();
+    if (value) insert(id, value, value->memsize(), recorder.messages());
+    return value;
+  }
+
+  size_t size() const;
+  void clear();
+
+private:
+  static ImportCache *inst;
+
+  struct FileIdentity {
+    std::string key;  // empty if the file couldn't be identified
+    uintmax_t size{0};
+    std::filesystem::file_time_type mtime;
+    // Only known once the file was touched
+    std::optional<uint64_t> hash;
+  };
+
+  struct cache_entry {
+    FileIdentity id;
+    std::shared_ptr<const void> value;
+    std::vector<Message> messages;
+  };
+
+  std::shared_ptr<const void> lookup(const std::string& filename, const std::string& parser,
+                                     FileIdentity& id, std::vector<Message>& messages);
+  void insert(const FileIdentity& id, std::shared_ptr<const void> value, size_t cost,
+              const std::vector<Message>& messages);
+
+  Cache<std::string, cache_entry> cache;
+  mutable std::mutex mutex;
+};
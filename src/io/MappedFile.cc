@@ -0,0 +1,74 @@
+#include "io/MappedFile.h"
+
+#include <filesystem>
+#include <fstream>
+#include <ios>
+#include <iterator>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::MappedFile(const std::string& filename)
+{
+#ifdef _WIN32
+  HANDLE file = CreateFileW(std::filesystem::u8path(filename).wstring().c_str(), GENERIC_READ,
+                            FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+  if (file != INVALID_HANDLE_VALUE) {
+    LARGE_INTEGER size;
+    if (GetFileSizeEx(file, &size) && size.QuadPart > 0) {
+      HANDLE mapping = CreateFileMappingW(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+      if (mapping) {
+        this->mapping_ = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+        // The view keeps the mapping alive
+        CloseHandle(mapping);
+      }
+      if (this->mapping_) {
+        this->size_ = static_cast<size_t>(size.QuadPart);
+      }
+    }
+    CloseHandle(file);
+  }
+#else
+  const int fd = ::open(filename.c_str(), O_RDONLY);
+  if (fd >= 0) {
+    struct stat st;
+    if (fstat(fd, &st) == 0 && st.st_size > 0) {
+      void *addr = mmap(nullptr, st.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+      if (addr != MAP_FAILED) {
+        this->mapping_ = addr;
+        this->size_ = st.st_size;
+      }
+    }
+    ::close(fd);
+  }
+#endif
+  if (this->mapping_) {
+    this->data_ = static_cast<const char *>(this->mapping_);
+    this->open_ = true;
+    return;
+  }
+
+  std::ifstream f(std::filesystem::u8path(filename), std::ios::in | std::ios::binary);
+  if (!f.good()) return;
+  this->buffer_.assign(std::istreambuf_iterator<char>(f), std::istreambuf_iterator<char>());
+  this->data_ = this->buffer_.data();
+  this->size_ = this->buffer_.size();
+  this->open_ = true;
+}
+
+MappedFile::~MappedFile()
+{
+  if (!this->mapping_) return;
+#ifdef _WIN32
+  UnmapViewOfFile(this->mapping_);
+#else
+  munmap(this->mapping_, this->size_);
+#endif
+}
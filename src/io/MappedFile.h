@@ -0,0 +1,30 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+/*!
+   Read-only access to the contents of a file. The file is memory mapped, so the operating
+   system pages it in as it's accessed. If it can't be mapped, it's read into memory.
+ */
+class MappedFile
+{
+public:
+  explicit MappedFile(const std::string& filename);
+  ~MappedFile();
+  MappedFile(const MappedFile&) = delete;
+  MappedFile& operator=(const MappedFile&) = delete;
+
+  [[nodiscard]] bool isOpen() const { return open_; }
+  [[nodiscard]] const char *data() const { return data_; }
+  [[nodiscard]] size_t size() const { return size_; }
+
+private:
+  bool open_{false};
+  const char *data_{nullptr};
+  size_t size_{0};
+  void *mapping_{nullptr};
+  // Contents of files which couldn't be mapped
+  std::vector<char> buffer_;
+};
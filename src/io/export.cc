@@ -39,8 +39,10 @@
 #include <iostream>
 #include <map>
 #include <memory>
+#include <numeric>
 #include <string>
 #include <unordered_map>
+#include <utility>
 #include <vector>
 
 #ifdef _WIN32
@@ -55,6 +57,7 @@
 #include "glview/Camera.h"
 #include "glview/ColorMap.h"
 #include "glview/RenderSettings.h"
+#include "utils/parallel.h"
 #include "utils/printutils.h"
 
 #define QUOTE(x__) #x__
@@ -97,6 +100,8 @@ Containers& containers()
     add_item(*containers, {FileFormat::PNG, "png", "png", "PNG"});
     add_item(*containers, {FileFormat::PDF, "pdf", "pdf", "PDF"});
     add_item(*containers, {FileFormat::POV, "pov", "pov", "POV"});
+    add_item(*containers, {FileFormat::GLB, "glb", "glb", "glTF (binary)"});
+    add_item(*containers, {FileFormat::PLY, "ply", "ply", "PLY"});
 
     // Alias
     containers->identifierToInfo["stl"] = containers->identifierToInfo["asciistl"];
@@ -169,7 +174,8 @@ bool is3D(FileFormat format)
   return format == FileFormat::ASCII_STL || format == FileFormat::BINARY_STL ||
          format == FileFormat::OBJ || format == FileFormat::OFF || format == FileFormat::WRL ||
          format == FileFormat::AMF || format == FileFormat::_3MF || format == FileFormat::NEFDBG ||
-         format == FileFormat::NEF3 || format == FileFormat::POV;
+         format == FileFormat::NEF3 || format == FileFormat::POV || format == FileFormat::GLB ||
+         format == FileFormat::PLY;
 }
 
 bool is2D(FileFormat format)
@@ -200,6 +206,8 @@ ExportInfo createExportInfo(const FileFormat& format, const FileFormatInfo& info
     exportInfo.optionsPdf = ExportPdfOptions::withOptions(cmdLineOptions);
   } else if (format == FileFormat::SVG) {
     exportInfo.optionsSvg = ExportSvgOptions::withOptions(cmdLineOptions);
+  } else if (format == FileFormat::GLB) {
+    exportInfo.optionsGlb = ExportGlbOptions::withOptions(cmdLineOptions);
   }
 
   return exportInfo;
@@ -220,6 +228,8 @@ static void exportFile(const std::shared_ptr<const Geometry>& root_geom, std::os
   case FileFormat::SVG:        export_svg(root_geom, output, exportInfo); break;
   case FileFormat::PDF:        export_pdf(root_geom, output, exportInfo); break;
   case FileFormat::POV:        export_pov(root_geom, output, exportInfo); break;
+  case FileFormat::GLB:        export_glb(root_geom, output, exportInfo); break;
+  case FileFormat::PLY:        export_ply(root_geom, output, exportInfo); break;
 #ifdef ENABLE_CGAL
   case FileFormat::NEFDBG: export_nefdbg(root_geom, output); break;
   case FileFormat::NEF3:   export_nef3(root_geom, output); break;
@@ -242,7 +252,8 @@ bool exportFileByName(const std::shared_ptr<const Geometry>& root_geom, const st
 {
   std::ios::openmode mode = std::ios::out | std::ios::trunc;
   if (exportInfo.format == FileFormat::_3MF || exportInfo.format == FileFormat::BINARY_STL ||
-      exportInfo.format == FileFormat::PDF) {
+      exportInfo.format == FileFormat::PDF || exportInfo.format == FileFormat::GLB ||
+      exportInfo.format == FileFormat::PLY) {
     mode |= std::ios::binary;
   }
   const std::filesystem::path path(filename);
@@ -322,54 +333,62 @@ std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps)
   out->setTriangular(ps.isTriangular());
   out->setConvexity(ps.getConvexity());
 
-  std::map<Vector3d, int, LexographicLess> vertexMap;
-
-  for (const auto& poly : ps.indices) {
-    IndexedFace face;
-    for (const auto idx : poly) {
-      auto pos = vertexMap.emplace(remove_negative_zero(ps.vertices[idx]), vertexMap.size());
-      face.push_back(pos.first->second);
-    }
-    out->indices.push_back(face);
+  // Sort the vertices used by faces, and merge equal ones. Ties are broken by the original
+  // index, so the result doesn't depend on the sort algorithm.
+  std::vector<bool> used(ps.vertices.size(), false);
+  for (const int idx : ps.indices.indexData()) used[idx] = true;
+  std::vector<std::pair<Vector3d, int>> sorted_vertices;
+  sorted_vertices.reserve(ps.vertices.size());
+  for (size_t i = 0; i < ps.vertices.size(); ++i) {
+    if (used[i]) sorted_vertices.emplace_back(remove_negative_zero(ps.vertices[i]), i);
   }
-  out->color_indices = ps.color_indices;
-  out->colors = ps.colors;
-
-  std::vector<int> indexTranslationMap(vertexMap.size());
-  out->vertices.reserve(vertexMap.size());
-
-  for (const auto& [v, i] : vertexMap) {
-    indexTranslationMap[i] = out->vertices.size();
-    out->vertices.push_back(v);
+  const LexographicLess less;
+  parallelizable_sort(sorted_vertices.begin(), sorted_vertices.end(),
+                      [&less](const auto& a, const auto& b) {
+                        if (less(a.first, b.first)) return true;
+                        if (less(b.first, a.first)) return false;
+                        return a.second < b.second;
+                      });
+  std::vector<int> indexTranslationMap(ps.vertices.size());
+  out->vertices.reserve(sorted_vertices.size());
+  for (const auto& [v, i] : sorted_vertices) {
+    if (out->vertices.empty() || less(out->vertices.back(), v)) out->vertices.push_back(v);
+    indexTranslationMap[i] = out->vertices.size() - 1;
   }
 
-  for (auto& poly : out->indices) {
-    IndexedFace polygon;
-    for (const auto idx : poly) {
-      polygon.push_back(indexTranslationMap[idx]);
-    }
-    std::rotate(polygon.begin(), std::min_element(polygon.begin(), polygon.end()), polygon.end());
-    poly = polygon;
-  }
-  if (ps.color_indices.empty()) {
-    std::sort(out->indices.begin(), out->indices.end());
+  // Renumber the faces and start each one at its lowest index
+  PolygonIndices faces = ps.indices;
+  parallelizable_for(0, faces.size(), [&](size_t i) {
+    auto poly = faces[i];
+    for (auto& idx : poly) idx = indexTranslationMap[idx];
+    std::rotate(poly.begin(), std::min_element(poly.begin(), poly.end()), poly.end());
+  });
+
+  // Sort faces lexicographically, keeping their colors. Equal faces keep their order.
+  std::vector<size_t> order(faces.size());
+  std::iota(order.begin(), order.end(), 0);
+  parallelizable_sort(order.begin(), order.end(), [&faces](size_t a, size_t b) {
+    const auto fa = faces[a], fb = faces[b];
+    const auto [ia, ib] = std::mismatch(fa.begin(), fa.end(), fb.begin(), fb.end());
+    if (ia != fa.end() && ib != fb.end()) return *ia < *ib;
+    if (ia != fa.end() || ib != fb.end()) return ia == fa.end();
+    return a < b;
+  });
+  if (faces.allTriangles()) {
+    std::vector<int> sorted(faces.numIndices());
+    parallelizable_for(0, order.size(), [&](size_t i) {
+      const auto face = faces[order[i]];
+      std::copy(face.begin(), face.end(), sorted.begin() + 3 * i);
+    });
+    out->indices.appendTriangles(sorted.begin(), sorted.end());
   } else {
-    struct ColoredFace {
-      IndexedFace face;
-      int32_t color_index;
-    };
-    std::vector<ColoredFace> faces;
-    faces.reserve(ps.indices.size());
-    for (size_t i = 0, n = ps.indices.size(); i < n; i++) {
-      faces.push_back({out->indices[i], out->color_indices[i]});
-    }
-    std::sort(faces.begin(), faces.end(),
-              [](const ColoredFace& a, const ColoredFace& b) { return a.face < b.face; });
-    for (size_t i = 0, n = faces.size(); i < n; i++) {
-      auto& face = faces[i];
-      out->indices[i] = face.face;
-      out->color_indices[i] = face.color_index;
-    }
+    out->indices.reserve(faces.size(), faces.numIndices());
+    for (const auto i : order) out->indices.push_back(faces[i]);
+  }
+  out->colors = ps.colors;
+  if (!ps.color_indices.empty()) {
+    out->color_indices.reserve(order.size());
+    for (const auto i : order) out->color_indices.push_back(ps.color_indices[i]);
   }
   return out;
 }
@@ -44,6 +44,8 @@ enum class FileFormat {
   PNG,
   PDF,
   POV,
+  GLB,
+  PLY,
   PARAM
 };
 
@@ -184,6 +186,8 @@ struct Export3mfOptions {
   std::string color;
   Export3mfMaterialType materialType;
   int decimalPrecision;
+  // Write the file with export_3mf_stream() rather than building a lib3mf model in memory
+  bool streaming;
   bool addMetaData;
   std::string metaDataTitle;
   std::string metaDataDesigner;
@@ -206,6 +210,8 @@ struct Export3mfOptions {
                                           Settings::SettingsExport3mf::export3mfMaterialType),
       .decimalPrecision = set_cmd_line_option(cmdLineOptions, Settings::SECTION_EXPORT_3MF,
                                               Settings::SettingsExport3mf::export3mfDecimalPrecision),
+      .streaming = set_cmd_line_option(cmdLineOptions, Settings::SECTION_EXPORT_3MF,
+                                       Settings::SettingsExport3mf::export3mfStreaming),
       .addMetaData = set_cmd_line_option(cmdLineOptions, Settings::SECTION_EXPORT_3MF,
                                          Settings::SettingsExport3mf::export3mfAddMetaData),
       .metaDataTitle = set_cmd_line_option(cmdLineOptions, Settings::SECTION_EXPORT_3MF,
@@ -233,6 +239,7 @@ struct Export3mfOptions {
       .color = S3MF::export3mfColor.value(),
       .materialType = S3MF::export3mfMaterialType.value(),
       .decimalPrecision = S3MF::export3mfDecimalPrecision.value(),
+      .streaming = S3MF::export3mfStreaming.value(),
       .addMetaData = S3MF::export3mfAddMetaData.value(),
       .metaDataTitle = S3MF::export3mfMetaDataTitle.value(),
       .metaDataDesigner =
@@ -285,6 +292,26 @@ struct ExportSvgOptions {
   }
 };
 
+struct ExportGlbOptions {
+  // Store positions as 16 bit integers (KHR_mesh_quantization)
+  bool quantize = false;
+
+  static std::shared_ptr<const ExportGlbOptions> withOptions(const CmdLineExportOptions& cmdLineOptions)
+  {
+    return std::make_shared<const ExportGlbOptions>(ExportGlbOptions{
+      .quantize = set_cmd_line_option(cmdLineOptions, Settings::SECTION_EXPORT_GLB,
+                                      Settings::SettingsExportGlb::exportGlbQuantize),
+    });
+  }
+
+  static std::shared_ptr<const ExportGlbOptions> fromSettings()
+  {
+    return std::make_shared<const ExportGlbOptions>(ExportGlbOptions{
+      .quantize = Settings::SettingsExportGlb::exportGlbQuantize.value(),
+    });
+  }
+};
+
 struct ExportInfo {
   FileFormat format;
   FileFormatInfo info;
@@ -297,6 +324,7 @@ struct ExportInfo {
   std::shared_ptr<const ExportPdfOptions> optionsPdf;
   std::shared_ptr<const Export3mfOptions> options3mf;
   std::shared_ptr<const ExportSvgOptions> optionsSvg;
+  std::shared_ptr<const ExportGlbOptions> optionsGlb;
 };
 
 ExportInfo createExportInfo(const FileFormat& format, const FileFormatInfo& info,
@@ -311,8 +339,14 @@ bool exportFileStdOut(const std::shared_ptr<const class Geometry>& root_geom,
 void export_stl(const std::shared_ptr<const Geometry>& geom, std::ostream& output, bool binary = true);
 void export_3mf(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
                 const ExportInfo& exportInfo);
+void export_3mf_stream(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                       const ExportInfo& exportInfo);
 void export_obj(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
+void export_glb(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                const ExportInfo& exportInfo);
 void export_off(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
+void export_ply(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                const ExportInfo& exportInfo);
 void export_wrl(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_amf(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
 void export_dxf(const std::shared_ptr<const Geometry>& geom, std::ostream& output);
@@ -327,6 +361,7 @@ void export_nef3(const std::shared_ptr<const Geometry>& geom, std::ostream& outp
 
 enum class Previewer { OPENCSG, THROWNTOGETHER };
 enum class RenderType { GEOMETRY, BACKEND_SPECIFIC, OPENCSG, THROWNTOGETHER };
+enum class Rasterizer { OPENGL, SOFTWARE };
 
 struct ViewOption {
   const std::string name;
@@ -336,6 +371,8 @@ struct ViewOption {
 struct ViewOptions {
   Previewer previewer{Previewer::OPENCSG};
   RenderType renderer{RenderType::OPENCSG};
+  // Exporting fails without an offscreen OpenGL context, unless the software rasterizer is chosen
+  Rasterizer rasterizer{Rasterizer::OPENGL};
 
   std::map<std::string, bool> flags{
     {"axes", false},
@@ -357,6 +394,7 @@ struct ViewOptions {
 };
 
 class OffscreenView;
+class SoftwareRasterizer;
 
 std::string get_current_iso8601_date_time_utc();
 
@@ -364,6 +402,9 @@ std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& op
 bool export_png(const std::shared_ptr<const class Geometry>& root_geom, const ViewOptions& options,
                 Camera& camera, std::ostream& output);
 bool export_png(const OffscreenView& glview, std::ostream& output);
+std::unique_ptr<SoftwareRasterizer> prepare_software_preview(Tree& tree, const ViewOptions& options,
+                                                             Camera& camera);
+bool export_png(const SoftwareRasterizer& rasterizer, std::ostream& output);
 bool export_param(SourceFile *root, const fs::path& path, std::ostream& output);
 
 std::unique_ptr<PolySet> createSortedPolySet(const PolySet& ps);
@@ -0,0 +1,688 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2026 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+   A 3MF writer which doesn't build the model in memory. The model XML is formatted in chunks
+   of vertices and triangles, which are compressed independently and written to the zip
+   container as soon as they're done. Formatting and compression of the chunks of a batch
+   run in parallel.
+ */
+
+#include <double-conversion/double-conversion.h>
+
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <charconv>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#ifdef ENABLE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "Feature.h"
+#include "core/ColorUtil.h"
+#include "export_enums.h"
+#include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "geometry/linalg.h"
+#include "io/export.h"
+#include "utils/parallel.h"
+#include "utils/printutils.h"
+
+#ifdef ENABLE_CGAL
+#include "geometry/cgal/CGALNefGeometry.h"
+#include "geometry/cgal/cgalutils.h"
+#endif
+#ifdef ENABLE_MANIFOLD
+#include "geometry/manifold/ManifoldGeometry.h"
+#endif
+
+namespace {
+
+// Number of vertices or triangles per independently formatted and compressed chunk
+constexpr size_t CHUNK_SIZE = 16384;
+// Number of chunks held in memory at a time
+constexpr size_t CHUNKS_PER_BATCH = 32;
+
+uint32_t update_crc32(uint32_t crc, const std::string& data)
+{
+#ifdef ENABLE_ZLIB
+  // Chunks are far below zlib's 4 GB length limit
+  return crc32(crc, reinterpret_cast<const Bytef *>(data.data()), static_cast<uInt>(data.size()));
+#else
+  static const std::array<uint32_t, 256> table = [] {
+    std::array<uint32_t, 256> table{};
+    for (uint32_t i = 0; i < 256; ++i) {
+      uint32_t c = i;
+      for (int k = 0; k < 8; ++k) c = c & 1 ? 0xedb88320 ^ (c >> 1) : c >> 1;
+      table[i] = c;
+    }
+    return table;
+  }();
+  crc = ~crc;
+  for (const char ch : data) crc = table[(crc ^ static_cast<uint8_t>(ch)) & 0xff] ^ (crc >> 8);
+  return ~crc;
+#endif
+}
+
+#ifdef ENABLE_ZLIB
+/*
+   Compresses a chunk to raw deflate data which ends on a byte boundary without ending the
+   deflate stream, so compressed chunks can simply be concatenated.
+ */
+std::string deflate_chunk(const std::string& data)
+{
+  z_stream strm{};
+  deflateInit2(&strm, Z_DEFAULT_COMPRESSION, Z_DEFLATED, -MAX_WBITS, 8, Z_DEFAULT_STRATEGY);
+  std::string out(deflateBound(&strm, data.size()) + 16, '\0');
+  strm.next_in = reinterpret_cast<Bytef *>(const_cast<char *>(data.data()));
+  strm.avail_in = static_cast<uInt>(data.size());
+  size_t written = 0;
+  do {
+    if (written == out.size()) out.resize(out.size() * 2);
+    strm.next_out = reinterpret_cast<Bytef *>(&out[written]);
+    strm.avail_out = static_cast<uInt>(out.size() - written);
+    deflate(&strm, Z_SYNC_FLUSH);
+    written = out.size() - strm.avail_out;
+  } while (strm.avail_out == 0);
+  deflateEnd(&strm);
+  out.resize(written);
+  return out;
+}
+#endif
+
+/*
+   Writes a zip archive to a stream which doesn't need to be seekable. The CRC and sizes of
+   each entry follow its data in a data descriptor, and Zip64 extensions are used so entries
+   aren't limited to 4 GB. Without zlib, entries are stored uncompressed.
+ */
+class ZipWriter
+{
+public:
+  explicit ZipWriter(std::ostream& out) : out(out) {}
+
+  void beginFile(const std::string& name)
+  {
+    this->entries.push_back(Entry{name, this->offset});
+    put32(0x04034b50);
+    put16(45);  // version needed: Zip64
+    put16(FLAGS);
+    put16(METHOD);
+    put16(0);     // time
+    put16(0x21);  // date: 1980-01-01, for reproducible output
+    put32(0);     // CRC, in data descriptor
+    put32(0xffffffff);
+    put32(0xffffffff);
+    put16(static_cast<uint16_t>(name.size()));
+    put16(20);
+    write(name);
+    // Zip64 extra field with sizes, in data descriptor
+    put16(0x0001);
+    put16(16);
+    put64(0);
+    put64(0);
+  }
+
+  // Adds text to the current entry, to be compressed together with the next chunks
+  void append(const std::string& text) { this->pending += text; }
+
+  // Adds chunks of data to the current entry. The chunks are compressed in parallel.
+  void appendChunks(std::vector<std::string>& chunks)
+  {
+    if (!this->pending.empty()) {
+      chunks.insert(chunks.begin(), std::move(this->pending));
+      this->pending.clear();
+    }
+    Entry& entry = this->entries.back();
+#ifdef ENABLE_ZLIB
+    std::vector<uint32_t> crcs(chunks.size());
+    std::vector<size_t> sizes(chunks.size());
+    parallelizable_for(0, chunks.size(), [&](size_t i) {
+      crcs[i] = update_crc32(0, chunks[i]);
+      sizes[i] = chunks[i].size();
+      chunks[i] = deflate_chunk(chunks[i]);
+    });
+    for (size_t i = 0; i < chunks.size(); ++i) {
+      entry.crc = crc32_combine(entry.crc, crcs[i], static_cast<z_off_t>(sizes[i]));
+      entry.size += sizes[i];
+      write(chunks[i]);
+    }
+#else
+    for (const auto& chunk : chunks) {
+      entry.crc = update_crc32(entry.crc, chunk);
+      entry.size += chunk.size();
+      write(chunk);
+    }
+#endif
+  }
+
+  void endFile()
+  {
+    std::vector<std::string> last;
+    appendChunks(last);
+#ifdef ENABLE_ZLIB
+    // A final, empty block with fixed Huffman codes ends the deflate stream
+    write(std::string("\x03\x00", 2));
+#endif
+    Entry& entry = this->entries.back();
+    entry.compressed_size = this->offset - entry.offset - 30 - entry.name.size() - 20;
+    put32(0x08074b50);
+    put32(entry.crc);
+    put64(entry.compressed_size);
+    put64(entry.size);
+  }
+
+  // Writes the central directory. Must be called after the last entry.
+  void finish()
+  {
+    const uint64_t directory_offset = this->offset;
+    for (const auto& entry : this->entries) {
+      const bool zip64 = entry.size >= 0xffffffff || entry.compressed_size >= 0xffffffff ||
+                         entry.offset >= 0xffffffff;
+      put32(0x02014b50);
+      put16(45);  // version made by
+      put16(45);  // version needed
+      put16(FLAGS);
+      put16(METHOD);
+      put16(0);
+      put16(0x21);
+      put32(entry.crc);
+      put32(zip64 ? 0xffffffff : static_cast<uint32_t>(entry.compressed_size));
+      put32(zip64 ? 0xffffffff : static_cast<uint32_t>(entry.size));
+      put16(static_cast<uint16_t>(entry.name.size()));
+      put16(zip64 ? 28 : 0);
+      put16(0);  // comment length
+      put16(0);  // disk number
+      put16(0);  // internal attributes
+      put32(0);  // external attributes
+      put32(zip64 ? 0xffffffff : static_cast<uint32_t>(entry.offset));
+      write(entry.name);
+      if (zip64) {
+        put16(0x0001);
+        put16(24);
+        put64(entry.size);
+        put64(entry.compressed_size);
+        put64(entry.offset);
+      }
+    }
+    const uint64_t directory_size = this->offset - directory_offset;
+    const uint64_t count = this->entries.size();
+    if (directory_offset >= 0xffffffff || directory_size >= 0xffffffff || count >= 0xffff) {
+      const uint64_t record_offset = this->offset;
+      put32(0x06064b50);
+      put64(44);  // size of the remaining record
+      put16(45);
+      put16(45);
+      put32(0);
+      put32(0);
+      put64(count);
+      put64(count);
+      put64(directory_size);
+      put64(directory_offset);
+      // Zip64 end of central directory locator
+      put32(0x07064b50);
+      put32(0);
+      put64(record_offset);
+      put32(1);
+    }
+    put32(0x06054b50);
+    put16(0);
+    put16(0);
+    put16(static_cast<uint16_t>(std::min<uint64_t>(count, 0xffff)));
+    put16(static_cast<uint16_t>(std::min<uint64_t>(count, 0xffff)));
+    put32(static_cast<uint32_t>(std::min<uint64_t>(directory_size, 0xffffffff)));
+    put32(static_cast<uint32_t>(std::min<uint64_t>(directory_offset, 0xffffffff)));
+    put16(0);  // comment length
+  }
+
+private:
+  // Bit 3: CRC and sizes are in a data descriptor after the data
+  static constexpr uint16_t FLAGS = 0x0008;
+#ifdef ENABLE_ZLIB
+  static constexpr uint16_t METHOD = 8;  // deflate
+#else
+  static constexpr uint16_t METHOD = 0;  // stored
+#endif
+
+  struct Entry {
+    std::string name;
+    uint64_t offset;
+    uint32_t crc{0};
+    uint64_t size{0};
+    uint64_t compressed_size{0};
+  };
+
+  void write(const std::string& data)
+  {
+    this->out.write(data.data(), static_cast<std::streamsize>(data.size()));
+    this->offset += data.size();
+  }
+  void putLittleEndian(uint64_t value, int bytes)
+  {
+    char buf[8];
+    for (int i = 0; i < bytes; ++i) buf[i] = static_cast<char>(value >> (8 * i));
+    this->out.write(buf, bytes);
+    this->offset += bytes;
+  }
+  void put16(uint16_t value) { putLittleEndian(value, 2); }
+  void put32(uint32_t value) { putLittleEndian(value, 4); }
+  void put64(uint64_t value) { putLittleEndian(value, 8); }
+
+  std::ostream& out;
+  uint64_t offset{0};
+  std::vector<Entry> entries;
+  std::string pending;
+};
+
+std::string xml_escape(const std::string& str)
+{
+  std::string escaped;
+  for (const char c : str) {
+    switch (c) {
+    case '&':  escaped += "&amp;"; break;
+    case '<':  escaped += "&lt;"; break;
+    case '>':  escaped += "&gt;"; break;
+    case '"':  escaped += "&quot;"; break;
+    case '\'': escaped += "&apos;"; break;
+    default:   escaped += c; break;
+    }
+  }
+  return escaped;
+}
+
+// Formats a color as #RRGGBB, or #RRGGBBAA if it's not opaque
+std::string color_string(const Color4f& color)
+{
+  uint8_t rgba[4] = {0, 0, 0, 0};
+  if (!color.getRgba(rgba[0], rgba[1], rgba[2], rgba[3])) {
+    LOG(message_group::Warning, "Invalid color in 3MF export");
+  }
+  static constexpr char hex[] = "0123456789ABCDEF";
+  std::string str = "#";
+  for (int i = 0; i < (rgba[3] == 0xff ? 3 : 4); ++i) {
+    str += hex[rgba[i] >> 4];
+    str += hex[rgba[i] & 0xf];
+  }
+  return str;
+}
+
+void append_int(std::string& out, int64_t value)
+{
+  char buf[24];
+  const auto result = std::to_chars(buf, buf + sizeof(buf), value);
+  out.append(buf, result.ptr);
+}
+
+// Appends a coordinate with the given number of decimals, leaving out trailing zeros
+void append_coordinate(std::string& out, float value, int precision)
+{
+  static const double_conversion::DoubleToStringConverter dc(
+    double_conversion::DoubleToStringConverter::UNIQUE_ZERO, nullptr, nullptr, 'e', 0, 0, 0, 0);
+  char buf[128];
+  double_conversion::StringBuilder builder(buf, sizeof(buf));
+  if (!dc.ToFixed(value, precision, &builder)) {
+    // Out of range for fixed notation, which can't happen for finite floats
+    dc.ToShortest(value, &builder);
+  }
+  const int length = builder.position();
+  builder.Finalize();
+  std::string_view str(buf, length);
+  if (str.find('.') != std::string_view::npos) {
+    str = str.substr(0, str.find_last_not_of('0') + 1);
+    if (str.back() == '.') str.remove_suffix(1);
+  }
+  if (str == "-0") str = "0";
+  out += str;
+}
+
+struct ExportPart {
+  // A leaf of the exported geometry, converted to a PolySet only while it's written
+  std::shared_ptr<const Geometry> geom;
+  std::string name;
+  std::string partnumber;
+  // Index in the material or color group of each color of the PolySet, -1 if unused
+  std::vector<int> colorMap;
+};
+
+struct ExportContext {
+  const Export3mfOptions& options;
+  int modelcount;
+  std::vector<ExportPart> parts;
+  // Colors of the material or color group, and their names for base materials
+  std::vector<std::pair<Color4f, std::string>> groupColors;
+  std::unordered_map<Color4f, int> materialColors;
+};
+
+bool collect_parts(const std::shared_ptr<const Geometry>& geom, ExportContext& ctx)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    ctx.modelcount = geomlist->getChildren().size();
+    for (const auto& item : geomlist->getChildren()) {
+      if (!collect_parts(item.second, ctx)) return false;
+    }
+    return true;
+  }
+#ifdef ENABLE_CGAL
+  if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
+    if (!N->p3) {
+      LOG(message_group::Export_Error, "Export failed, empty geometry.");
+      return false;
+    }
+    if (!N->p3->is_simple()) {
+      LOG(message_group::Export_Warning,
+          "Exported object may not be a valid 2-manifold and may need repair");
+    }
+  }
+#endif
+  if (std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    assert(false && "Unsupported file format");
+    return true;
+  }
+  const int mesh_count = static_cast<int>(ctx.parts.size()) + 1;
+  ExportPart part;
+  part.geom = geom;
+  part.name = ctx.modelcount == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(mesh_count);
+  part.partnumber = ctx.modelcount == 1 ? "" : "Part " + std::to_string(mesh_count);
+  ctx.parts.push_back(std::move(part));
+  return true;
+}
+
+/*
+   Returns the triangles of a part. Only one part is converted at a time, so the memory needed
+   is bounded by the largest part rather than the whole model. Triangulated PolySets and the
+   PolySets of Manifold geometries are used as they are, without a copy.
+ */
+std::shared_ptr<const PolySet> part_polyset(const std::shared_ptr<const Geometry>& geom)
+{
+  std::shared_ptr<const PolySet> ps;
+  if (const auto polyset = std::dynamic_pointer_cast<const PolySet>(geom)) {
+    ps = polyset->isTriangular() ? polyset : PolySetUtils::tessellate_faces(*polyset);
+#ifdef ENABLE_CGAL
+  } else if (const auto N = std::dynamic_pointer_cast<const CGALNefGeometry>(geom)) {
+    ps = CGALUtils::createPolySetFromNefPolyhedron3(*N->p3);
+    if (!ps) LOG(message_group::Export_Error, "Error converting NEF Polyhedron.");
+#endif
+#ifdef ENABLE_MANIFOLD
+  } else if (const auto mani = std::dynamic_pointer_cast<const ManifoldGeometry>(geom)) {
+    ps = mani->toPolySet();
+#endif
+  } else {
+    assert(false && "Not implemented");
+  }
+  if (ps && Feature::ExperimentalPredictibleOutput.is_enabled()) {
+    ps = createSortedPolySet(*ps);
+  }
+  return ps;
+}
+
+// Whether a part can have colors, without converting it
+bool has_colors(const Geometry& geom)
+{
+#ifdef ENABLE_MANIFOLD
+  if (dynamic_cast<const ManifoldGeometry *>(&geom)) return true;
+#endif
+  const auto *ps = dynamic_cast<const PolySet *>(&geom);
+  return ps && !ps->colors.empty();
+}
+
+/*
+   Adds the colors of a part to the material or color group, in the order of the first
+   triangle using them. The group must be written before any object referring to it.
+ */
+void add_part_colors(ExportPart& part, ExportContext& ctx)
+{
+  if (!has_colors(*part.geom)) return;
+  const auto ps = part_polyset(part.geom);
+  if (!ps || ps->colors.empty()) return;
+  part.colorMap.assign(ps->colors.size(), -1);
+  const size_t count = std::min(ps->color_indices.size(), ps->indices.size());
+  for (size_t i = 0; i < count; ++i) {
+    const int32_t color_index = ps->color_indices[i];
+    if (color_index < 0 || part.colorMap[color_index] >= 0) continue;
+    const Color4f& color = ps->colors[color_index];
+    auto [it, inserted] = ctx.materialColors.emplace(color, ctx.groupColors.size());
+    if (inserted) {
+      ctx.groupColors.emplace_back(color, "Color " + std::to_string(ctx.groupColors.size()));
+    }
+    part.colorMap[color_index] = it->second;
+  }
+}
+
+/*
+   Formats count items with format(begin, end, out), which appends the items in [begin, end)
+   to out. Chunks of items are formatted in parallel, a batch of chunks at a time.
+ */
+template <typename Format>
+void write_chunked(ZipWriter& zip, size_t count, const Format& format)
+{
+  for (size_t batch = 0; batch < count; batch += CHUNK_SIZE * CHUNKS_PER_BATCH) {
+    const size_t batch_end = std::min(count, batch + CHUNK_SIZE * CHUNKS_PER_BATCH);
+    std::vector<std::string> chunks((batch_end - batch + CHUNK_SIZE - 1) / CHUNK_SIZE);
+    parallelizable_for(0, chunks.size(), [&](size_t i) {
+      const size_t begin = batch + i * CHUNK_SIZE;
+      format(begin, std::min(batch_end, begin + CHUNK_SIZE), chunks[i]);
+    });
+    zip.appendChunks(chunks);
+  }
+}
+
+void write_mesh(ZipWriter& zip, const ExportPart& part, const PolySet& ps, int precision)
+{
+  zip.append("<mesh>\n<vertices>\n");
+  write_chunked(zip, ps.vertices.size(), [&](size_t begin, size_t end, std::string& out) {
+    out.reserve((end - begin) * 64);
+    for (size_t i = begin; i < end; ++i) {
+      const Vector3f v = ps.vertices[i].cast<float>();
+      out += "<vertex x=\"";
+      append_coordinate(out, v[0], precision);
+      out += "\" y=\"";
+      append_coordinate(out, v[1], precision);
+      out += "\" z=\"";
+      append_coordinate(out, v[2], precision);
+      out += "\"/>\n";
+    }
+  });
+  zip.append("</vertices>\n<triangles>\n");
+  write_chunked(zip, ps.indices.size(), [&](size_t begin, size_t end, std::string& out) {
+    out.reserve((end - begin) * 64);
+    for (size_t i = begin; i < end; ++i) {
+      const auto face = ps.indices[i];
+      out += "<triangle v1=\"";
+      append_int(out, face[0]);
+      out += "\" v2=\"";
+      append_int(out, face[1]);
+      out += "\" v3=\"";
+      append_int(out, face[2]);
+      out += '"';
+      const int32_t color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+      if (color_index >= 0 && !part.colorMap.empty() && part.colorMap[color_index] >= 0) {
+        // The material or color group is always the first resource
+        out += " pid=\"1\" p1=\"";
+        append_int(out, part.colorMap[color_index]);
+        out += '"';
+      }
+      out += "/>\n";
+    }
+  });
+  zip.append("</triangles>\n</mesh>\n");
+}
+
+std::string unit_name(Export3mfUnit unit)
+{
+  switch (unit) {
+  case Export3mfUnit::micron:     return "micron";
+  case Export3mfUnit::centimeter: return "centimeter";
+  case Export3mfUnit::meter:      return "meter";
+  case Export3mfUnit::inch:       return "inch";
+  case Export3mfUnit::foot:       return "foot";
+  default:                        return "millimeter";
+  }
+}
+
+std::string meta_data(const std::string& name, const std::string& value,
+                      const std::string& value2 = "")
+{
+  const std::string v = value.empty() ? value2 : value;
+  if (v.empty()) {
+    return "";
+  }
+  return "<metadata name=\"" + name + "\" preserve=\"1\" type=\"xs:string\">" + xml_escape(v) +
+         "</metadata>\n";
+}
+
+}  // namespace
+
+/*!
+    Saves the current 3D Geometry as 3MF to the given stream, without building the whole
+    model in memory first. Colors, units and metadata follow export_3mf(), which calls this
+    when the streaming export option is set.
+ */
+void export_3mf_stream(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                       const ExportInfo& exportInfo)
+{
+  const auto& options3mf =
+    exportInfo.options3mf ? exportInfo.options3mf : std::make_shared<Export3mfOptions>();
+
+  ExportContext ctx{.options = *options3mf, .modelcount = 1, .parts = {}, .groupColors = {},
+                    .materialColors = {}};
+
+  // use default color that ultimately should come from the color scheme
+  Color4f color = exportInfo.defaultColor;
+  if (options3mf->colorMode != Export3mfColorMode::none) {
+    if (options3mf->colorMode != Export3mfColorMode::model) {
+      // use color selected in the export dialog and stored in settings (if valid)
+      color = OpenSCAD::getColor(options3mf->color, exportInfo.defaultColor);
+    }
+    if (options3mf->materialType == Export3mfMaterialType::basematerial) {
+      Color4f opaque = color;
+      opaque.setAlpha(1.0f);
+      ctx.groupColors.emplace_back(opaque, "Default");
+      ctx.materialColors.emplace(color, 0);
+    } else if (options3mf->materialType == Export3mfMaterialType::color) {
+      ctx.groupColors.emplace_back(color, "");
+    }
+  }
+
+  if (!collect_parts(geom, ctx)) {
+    return;
+  }
+  if (!ctx.groupColors.empty() && options3mf->colorMode != Export3mfColorMode::selected_only) {
+    for (auto& part : ctx.parts) add_part_colors(part, ctx);
+  }
+
+  const bool basematerials = options3mf->materialType == Export3mfMaterialType::basematerial;
+  const bool colorgroup = !ctx.groupColors.empty() && !basematerials;
+
+  ZipWriter zip(output);
+  zip.beginFile("[Content_Types].xml");
+  zip.append(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<Types xmlns=\"http://schemas.openxmlformats.org/package/2006/content-types\">"
+    "<Default Extension=\"rels\" "
+    "ContentType=\"application/vnd.openxmlformats-package.relationships+xml\"/>"
+    "<Default Extension=\"model\" "
+    "ContentType=\"application/vnd.ms-package.3dmanufacturing-3dmodel+xml\"/></Types>");
+  zip.endFile();
+  zip.beginFile("_rels/.rels");
+  zip.append(
+    "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+    "<Relationships xmlns=\"http://schemas.openxmlformats.org/package/2006/relationships\">"
+    "<Relationship Type=\"http://schemas.microsoft.com/3dmanufacturing/2013/01/3dmodel\" "
+    "Target=\"/3D/3dmodel.model\" Id=\"rel0\"/></Relationships>");
+  zip.endFile();
+
+  zip.beginFile("3D/3dmodel.model");
+  std::string header = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n<model unit=\"" +
+                       unit_name(options3mf->unit) +
+                       "\" xml:lang=\"en-US\" "
+                       "xmlns=\"http://schemas.microsoft.com/3dmanufacturing/core/2015/02\"";
+  if (colorgroup) {
+    header += " xmlns:m=\"http://schemas.microsoft.com/3dmanufacturing/material/2015/02\"";
+  }
+  header += ">\n";
+  if (options3mf->addMetaData) {
+    header += meta_data("Title", options3mf->metaDataTitle, exportInfo.title);
+    header += meta_data("Application", EXPORT_CREATOR);
+    header += meta_data("CreationDate", get_current_iso8601_date_time_utc());
+    header += meta_data("Designer", options3mf->metaDataDesigner);
+    header += meta_data("Description", options3mf->metaDataDescription);
+    header += meta_data("Copyright", options3mf->metaDataCopyright);
+    header += meta_data("LicenseTerms", options3mf->metaDataLicenseTerms);
+    header += meta_data("Rating", options3mf->metaDataRating);
+  }
+  header += "<resources>\n";
+  if (basematerials) {
+    header += "<basematerials id=\"1\">\n";
+    for (const auto& [groupcolor, name] : ctx.groupColors) {
+      header += "<base name=\"" + xml_escape(name) + "\" displaycolor=\"" +
+                color_string(groupcolor) + "\"/>\n";
+    }
+    header += "</basematerials>\n";
+  } else if (colorgroup) {
+    header += "<m:colorgroup id=\"1\">\n";
+    for (const auto& groupcolor : ctx.groupColors) {
+      header += "<m:color color=\"" + color_string(groupcolor.first) + "\"/>\n";
+    }
+    header += "</m:colorgroup>\n";
+  }
+  zip.append(header);
+
+  const int first_object_id = ctx.groupColors.empty() ? 1 : 2;
+  for (size_t i = 0; i < ctx.parts.size(); ++i) {
+    std::string object = "<object id=\"" + std::to_string(first_object_id + i) + "\" name=\"" +
+                         xml_escape(ctx.parts[i].name) + "\" type=\"model\"";
+    if (!ctx.groupColors.empty()) object += " pid=\"1\" pindex=\"0\"";
+    zip.append(object + ">\n");
+    const auto ps = part_polyset(ctx.parts[i].geom);
+    if (!ps) return;
+    write_mesh(zip, ctx.parts[i], *ps, options3mf->decimalPrecision);
+    zip.append("</object>\n");
+  }
+
+  std::string build = "</resources>\n<build>\n";
+  for (size_t i = 0; i < ctx.parts.size(); ++i) {
+    build += "<item objectid=\"" + std::to_string(first_object_id + i) + "\"";
+    if (!ctx.parts[i].partnumber.empty()) {
+      build += " partnumber=\"" + xml_escape(ctx.parts[i].partnumber) + "\"";
+    }
+    build += "/>\n";
+  }
+  build += "</build>\n</model>\n";
+  zip.append(build);
+  zip.endFile();
+  zip.finish();
+  output.flush();
+}
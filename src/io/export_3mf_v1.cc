@@ -203,7 +203,7 @@ bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx
     return lib3mf_meshobject_addvertex(mesh, &v, nullptr) == LIB3MF_OK;
   };
 
-  auto triangleFunc = [&](const IndexedFace& indices) -> bool {
+  auto triangleFunc = [&](const FaceView& indices) -> bool {
     MODELMESHTRIANGLE t{(DWORD)indices[0], (DWORD)indices[1], (DWORD)indices[2]};
     return lib3mf_meshobject_addtriangle(mesh, &t, nullptr) == LIB3MF_OK;
   };
@@ -375,6 +375,11 @@ void add_meta_data(PLib3MFModelMeshObject *& model, const std::string& name, con
 void export_3mf(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
                 const ExportInfo& exportInfo)
 {
+  if (exportInfo.options3mf && exportInfo.options3mf->streaming) {
+    export_3mf_stream(geom, output, exportInfo);
+    return;
+  }
+
   DWORD interfaceVersionMajor, interfaceVersionMinor, interfaceVersionMicro;
   HRESULT result =
     lib3mf_getinterfaceversion(&interfaceVersionMajor, &interfaceVersionMinor, &interfaceVersionMicro);
@@ -189,7 +189,7 @@ bool append_polyset(const std::shared_ptr<const PolySet>& ps, ExportContext& ctx
       return true;
     };
 
-    auto triangleFunc = [&](const IndexedFace& indices, int color_index) -> bool {
+    auto triangleFunc = [&](const FaceView& indices, int color_index) -> bool {
       try {
         const auto triangle = mesh->AddTriangle({static_cast<Lib3MF_uint32>(indices[0]),
                                                  static_cast<Lib3MF_uint32>(indices[1]),
@@ -305,6 +305,13 @@ void add_meta_data(Lib3MF::PMetaDataGroup& metadatagroup, const std::string& nam
 void export_3mf(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
                 const ExportInfo& exportInfo)
 {
+  // lib3mf holds the complete model and its serialized XML in memory, which doesn't scale to
+  // very large meshes
+  if (exportInfo.options3mf && exportInfo.options3mf->streaming) {
+    export_3mf_stream(geom, output, exportInfo);
+    return;
+  }
+
   Lib3MF_uint32 interfaceVersionMajor, interfaceVersionMinor, interfaceVersionMicro;
   Lib3MF::PWrapper wrapper;
 
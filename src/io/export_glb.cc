@@ -0,0 +1,431 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2026 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+/*
+   Binary glTF 2.0 export. Each object becomes a mesh with one indexed triangle primitive per
+   color, all sharing the object's vertex positions. Positions are stored as floats, or with
+   the quantize option as 16 bit integers (KHR_mesh_quantization) which the object's node
+   transform maps back to model coordinates. Binary data is written straight from the mesh,
+   after the JSON which describes it.
+ */
+
+#include <double-conversion/double-conversion.h>
+
+#include <algorithm>
+#include <array>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <ostream>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include "Feature.h"
+#include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "geometry/linalg.h"
+#include "io/export.h"
+#include "utils/byte_order.h"
+
+namespace {
+
+// glTF accessor component types and buffer view targets
+constexpr int UNSIGNED_SHORT = 5123;
+constexpr int UNSIGNED_INT = 5125;
+constexpr int FLOAT = 5126;
+constexpr int ARRAY_BUFFER = 34962;
+constexpr int ELEMENT_ARRAY_BUFFER = 34963;
+
+// Number of values converted at a time when writing the binary buffer
+constexpr size_t BLOCK_SIZE = 4096;
+
+void write_uint32(std::ostream& output, uint32_t value) { write_little_endian(output, &value, 1); }
+
+size_t padded(size_t size) { return (size + 3) & ~size_t(3); }
+
+std::string json_number(double value)
+{
+  static const double_conversion::DoubleToStringConverter dc(
+    double_conversion::DoubleToStringConverter::UNIQUE_ZERO, nullptr, nullptr, 'e', -6, 21, 0, 0);
+  char buf[64];
+  double_conversion::StringBuilder builder(buf, sizeof(buf));
+  dc.ToShortest(value, &builder);
+  return builder.Finalize();
+}
+
+// The shortest representation which reads back as the same float
+std::string json_number(float value)
+{
+  static const double_conversion::DoubleToStringConverter dc(
+    double_conversion::DoubleToStringConverter::UNIQUE_ZERO, nullptr, nullptr, 'e', -6, 21, 0, 0);
+  char buf[64];
+  double_conversion::StringBuilder builder(buf, sizeof(buf));
+  dc.ToShortestSingle(value, &builder);
+  return builder.Finalize();
+}
+
+template <typename T, size_t N>
+std::string json_array(const std::array<T, N>& values)
+{
+  std::string json = "[";
+  for (size_t i = 0; i < N; ++i) {
+    if (i > 0) json += ",";
+    json += json_number(values[i]);
+  }
+  return json + "]";
+}
+
+std::string json_string(const std::string& str)
+{
+  std::string json = "\"";
+  for (const char c : str) {
+    if (c == '"' || c == '\\') {
+      json += '\\';
+      json += c;
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      char buf[8];
+      snprintf(buf, sizeof(buf), "\\u%04x", c);
+      json += buf;
+    } else {
+      json += c;
+    }
+  }
+  return json + "\"";
+}
+
+// glTF colors are linear, OpenSCAD colors are sRGB
+float srgb_to_linear(float c)
+{
+  return c <= 0.04045f ? c / 12.92f : std::pow((c + 0.055f) / 1.055f, 2.4f);
+}
+
+struct GlbPrimitive {
+  int32_t color_index;  // into the PolySet colors, -1 for the default color
+  size_t count{0};      // number of indices
+  size_t byte_offset{0};
+  int material{0};
+};
+
+struct GlbMesh {
+  std::shared_ptr<const PolySet> ps;
+  std::vector<GlbPrimitive> primitives;
+  bool short_indices;
+  // Quantized positions are scaled and offset back to model coordinates by the node transform
+  Vector3d translation;
+  Vector3d scale;
+  std::array<float, 3> min;
+  std::array<float, 3> max;
+  size_t positions_offset{0};
+  size_t positions_length{0};
+  size_t indices_offset{0};
+  size_t indices_length{0};
+};
+
+void collect_polysets(const std::shared_ptr<const Geometry>& geom,
+                      std::vector<std::shared_ptr<const PolySet>>& polysets)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) {
+      collect_polysets(item.second, polysets);
+    }
+  } else if (std::shared_ptr<const PolySet> ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+    if (!ps->isTriangular()) {
+      ps = PolySetUtils::tessellate_faces(*ps);
+    }
+    if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
+      ps = createSortedPolySet(*ps);
+    }
+    if (!ps->vertices.empty() && !ps->indices.empty()) {
+      polysets.push_back(std::move(ps));
+    }
+  }
+}
+
+// Groups the triangles of a mesh by color and lays out its data in the binary buffer
+void layout_mesh(GlbMesh& mesh, bool quantize, size_t& buffer_length)
+{
+  const PolySet& ps = *mesh.ps;
+  const size_t num_colors = ps.colors.size();
+  std::vector<size_t> counts(num_colors + 1);
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    const int32_t color_index = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+    counts[color_index < 0 ? 0 : color_index + 1] += 3;
+  }
+
+  // Indices must be less than the largest value of their type, which is reserved
+  mesh.short_indices = ps.vertices.size() < 0xffff;
+  const size_t index_size = mesh.short_indices ? sizeof(uint16_t) : sizeof(uint32_t);
+  size_t offset = 0;
+  for (size_t c = 0; c <= num_colors; ++c) {
+    if (counts[c] == 0) continue;
+    mesh.primitives.push_back(GlbPrimitive{.color_index = static_cast<int32_t>(c) - 1,
+                                           .count = counts[c],
+                                           .byte_offset = offset});
+    offset += counts[c] * index_size;
+  }
+
+  BoundingBox bbox;
+  for (const auto& v : ps.vertices) bbox.extend(v);
+  if (quantize) {
+    mesh.translation = bbox.min();
+    const Vector3d extent = bbox.sizes();
+    for (int i = 0; i < 3; ++i) {
+      mesh.scale[i] = extent[i] > 0 ? extent[i] / 65535.0 : 1.0;
+      mesh.min[i] = 0;
+      mesh.max[i] = extent[i] > 0 ? 65535 : 0;
+    }
+  } else {
+    for (int i = 0; i < 3; ++i) {
+      mesh.min[i] = static_cast<float>(bbox.min()[i]);
+      mesh.max[i] = static_cast<float>(bbox.max()[i]);
+    }
+  }
+
+  // Quantized positions are padded to 8 bytes, as vertex attributes must be 4 byte aligned
+  mesh.positions_offset = buffer_length;
+  mesh.positions_length = ps.vertices.size() * (quantize ? 4 * sizeof(uint16_t) : 3 * sizeof(float));
+  mesh.indices_offset = padded(mesh.positions_offset + mesh.positions_length);
+  mesh.indices_length = offset;
+  buffer_length = padded(mesh.indices_offset + mesh.indices_length);
+}
+
+void write_positions(std::ostream& output, const GlbMesh& mesh, bool quantize)
+{
+  const auto& vertices = mesh.ps->vertices;
+  if (quantize) {
+    std::vector<uint16_t> block;
+    block.reserve(BLOCK_SIZE * 4);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      for (int j = 0; j < 3; ++j) {
+        const double q = std::round((vertices[i][j] - mesh.translation[j]) / mesh.scale[j]);
+        block.push_back(static_cast<uint16_t>(std::clamp(q, 0.0, 65535.0)));
+      }
+      block.push_back(0);
+      if (block.size() == BLOCK_SIZE * 4 || i + 1 == vertices.size()) {
+        write_little_endian(output, block.data(), block.size());
+        block.clear();
+      }
+    }
+  } else {
+    std::vector<float> block;
+    block.reserve(BLOCK_SIZE * 3);
+    for (size_t i = 0; i < vertices.size(); ++i) {
+      for (int j = 0; j < 3; ++j) block.push_back(static_cast<float>(vertices[i][j]));
+      if (block.size() == BLOCK_SIZE * 3 || i + 1 == vertices.size()) {
+        write_little_endian(output, block.data(), block.size());
+        block.clear();
+      }
+    }
+  }
+}
+
+// Writes the indices of the triangles of the given color, or of all triangles if single_primitive
+template <typename Index>
+void write_primitive_indices(std::ostream& output, const PolySet& ps, int32_t color_index,
+                             bool single_primitive)
+{
+  if constexpr (sizeof(Index) == sizeof(int)) {
+    if (single_primitive) {
+      // The face indices are already laid out as needed
+      const auto& indices = ps.indices.indexData();
+      write_little_endian(output, reinterpret_cast<const Index *>(indices.data()), indices.size());
+      return;
+    }
+  }
+  std::vector<Index> block;
+  block.reserve(BLOCK_SIZE * 3);
+  for (size_t i = 0; i < ps.indices.size(); ++i) {
+    const int32_t c = i < ps.color_indices.size() ? ps.color_indices[i] : -1;
+    if (!single_primitive && std::max(c, -1) != color_index) continue;
+    for (const int index : ps.indices[i]) block.push_back(static_cast<Index>(index));
+    if (block.size() >= BLOCK_SIZE * 3) {
+      write_little_endian(output, block.data(), block.size());
+      block.clear();
+    }
+  }
+  write_little_endian(output, block.data(), block.size());
+}
+
+void write_padding(std::ostream& output, size_t written, char c = '\0')
+{
+  for (size_t i = written; i < padded(written); ++i) output.put(c);
+}
+
+}  // namespace
+
+void export_glb(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                const ExportInfo& exportInfo)
+{
+  const bool quantize = exportInfo.optionsGlb && exportInfo.optionsGlb->quantize;
+
+  std::vector<std::shared_ptr<const PolySet>> polysets;
+  collect_polysets(geom, polysets);
+
+  std::vector<GlbMesh> meshes(polysets.size());
+  size_t buffer_length = 0;
+  for (size_t i = 0; i < polysets.size(); ++i) {
+    meshes[i].ps = std::move(polysets[i]);
+    layout_mesh(meshes[i], quantize, buffer_length);
+  }
+
+  // Materials are shared by all primitives with the same color
+  std::vector<Color4f> materialColors;
+  std::unordered_map<Color4f, int> materialIndex;
+  for (auto& mesh : meshes) {
+    for (auto& primitive : mesh.primitives) {
+      Color4f color = exportInfo.defaultColor;
+      if (primitive.color_index >= 0 && mesh.ps->colors[primitive.color_index].isValid()) {
+        color = mesh.ps->colors[primitive.color_index];
+      }
+      const auto [it, inserted] = materialIndex.emplace(color, materialColors.size());
+      if (inserted) materialColors.push_back(color);
+      primitive.material = it->second;
+    }
+  }
+
+  std::string nodes;
+  std::string json_meshes;
+  std::string accessors;
+  std::string bufferViews;
+  int num_accessors = 0;
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    const GlbMesh& mesh = meshes[i];
+    const std::string sep = i > 0 ? "," : "";
+    const std::string name =
+      meshes.size() == 1 ? "OpenSCAD Model" : "OpenSCAD Model " + std::to_string(i + 1);
+    nodes += ",{\"mesh\":" + std::to_string(i);
+    if (quantize) {
+      nodes += ",\"translation\":" + json_array(std::array<double, 3>{
+                                       mesh.translation[0], mesh.translation[1], mesh.translation[2]});
+      nodes += ",\"scale\":" +
+               json_array(std::array<double, 3>{mesh.scale[0], mesh.scale[1], mesh.scale[2]});
+    }
+    nodes += "}";
+
+    const size_t positions_view = 2 * i;
+    const size_t indices_view = 2 * i + 1;
+    bufferViews += sep + "{\"buffer\":0,\"byteOffset\":" + std::to_string(mesh.positions_offset) +
+                   ",\"byteLength\":" + std::to_string(mesh.positions_length) +
+                   (quantize ? ",\"byteStride\":8" : "") +
+                   ",\"target\":" + std::to_string(ARRAY_BUFFER) + "}";
+    bufferViews += ",{\"buffer\":0,\"byteOffset\":" + std::to_string(mesh.indices_offset) +
+                   ",\"byteLength\":" + std::to_string(mesh.indices_length) +
+                   ",\"target\":" + std::to_string(ELEMENT_ARRAY_BUFFER) + "}";
+
+    const int positions_accessor = num_accessors++;
+    accessors += sep + "{\"bufferView\":" + std::to_string(positions_view) +
+                 ",\"componentType\":" + std::to_string(quantize ? UNSIGNED_SHORT : FLOAT) +
+                 ",\"count\":" + std::to_string(mesh.ps->vertices.size()) +
+                 ",\"type\":\"VEC3\",\"min\":" + json_array(mesh.min) +
+                 ",\"max\":" + json_array(mesh.max) + "}";
+
+    json_meshes += sep + "{\"name\":" + json_string(name) + ",\"primitives\":[";
+    for (size_t p = 0; p < mesh.primitives.size(); ++p) {
+      const GlbPrimitive& primitive = mesh.primitives[p];
+      accessors += ",{\"bufferView\":" + std::to_string(indices_view) +
+                   ",\"byteOffset\":" + std::to_string(primitive.byte_offset) +
+                   ",\"componentType\":" +
+                   std::to_string(mesh.short_indices ? UNSIGNED_SHORT : UNSIGNED_INT) +
+                   ",\"count\":" + std::to_string(primitive.count) + ",\"type\":\"SCALAR\"}";
+      json_meshes += std::string(p > 0 ? "," : "") + "{\"attributes\":{\"POSITION\":" +
+                     std::to_string(positions_accessor) +
+                     "},\"indices\":" + std::to_string(num_accessors++) +
+                     ",\"material\":" + std::to_string(primitive.material) + "}";
+    }
+    json_meshes += "]}";
+  }
+
+  std::string materials;
+  for (size_t i = 0; i < materialColors.size(); ++i) {
+    const Vector4f rgba = materialColors[i].toVector4f();
+    const std::array<float, 4> factor{srgb_to_linear(rgba[0]), srgb_to_linear(rgba[1]),
+                                      srgb_to_linear(rgba[2]), rgba[3]};
+    materials += std::string(i > 0 ? "," : "") +
+                 "{\"pbrMetallicRoughness\":{\"baseColorFactor\":" + json_array(factor) +
+                 ",\"metallicFactor\":0}" + (rgba[3] < 1.0f ? ",\"alphaMode\":\"BLEND\"" : "") +
+                 "}";
+  }
+
+  // The root node turns OpenSCAD's Z up millimeters into glTF's Y up meters
+  std::string children;
+  for (size_t i = 0; i < meshes.size(); ++i) {
+    children += (i > 0 ? "," : "") + std::to_string(i + 1);
+  }
+  std::string json =
+    "{\"asset\":{\"version\":\"2.0\",\"generator\":" + json_string(EXPORT_CREATOR) + "}";
+  if (quantize) {
+    json +=
+      ",\"extensionsUsed\":[\"KHR_mesh_quantization\"],"
+      "\"extensionsRequired\":[\"KHR_mesh_quantization\"]";
+  }
+  json += ",\"scene\":0,\"scenes\":[{\"nodes\":[0]}]";
+  json += ",\"nodes\":[{\"name\":" + json_string(exportInfo.title) +
+          ",\"rotation\":[-0.7071067811865476,0,0,0.7071067811865476],\"scale\":[0.001,0.001,0.001]";
+  if (!meshes.empty()) json += ",\"children\":[" + children + "]";
+  json += "}" + nodes + "]";
+  if (!meshes.empty()) {
+    json += ",\"meshes\":[" + json_meshes + "]";
+    json += ",\"materials\":[" + materials + "]";
+    json += ",\"accessors\":[" + accessors + "]";
+    json += ",\"bufferViews\":[" + bufferViews + "]";
+    json += ",\"buffers\":[{\"byteLength\":" + std::to_string(buffer_length) + "}]";
+  }
+  json += "}";
+
+  const size_t json_length = padded(json.size());
+  const size_t total_length = 12 + 8 + json_length + (buffer_length > 0 ? 8 + buffer_length : 0);
+  write_uint32(output, 0x46546c67);  // "glTF"
+  write_uint32(output, 2);
+  write_uint32(output, static_cast<uint32_t>(total_length));
+  write_uint32(output, static_cast<uint32_t>(json_length));
+  write_uint32(output, 0x4e4f534a);  // "JSON"
+  output << json;
+  write_padding(output, json.size(), ' ');
+
+  if (buffer_length > 0) {
+    write_uint32(output, static_cast<uint32_t>(buffer_length));
+    write_uint32(output, 0x004e4942);  // "BIN"
+    for (const auto& mesh : meshes) {
+      write_positions(output, mesh, quantize);
+      write_padding(output, mesh.positions_length);
+      const bool single_primitive = mesh.primitives.size() == 1;
+      for (const auto& primitive : mesh.primitives) {
+        if (mesh.short_indices) {
+          write_primitive_indices<uint16_t>(output, *mesh.ps, primitive.color_index, single_primitive);
+        } else {
+          write_primitive_indices<uint32_t>(output, *mesh.ps, primitive.color_index, single_primitive);
+        }
+      }
+      write_padding(output, mesh.indices_length);
+    }
+  }
+  output.flush();
+}
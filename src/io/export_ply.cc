@@ -0,0 +1,145 @@
+/*
+ *  OpenSCAD (www.openscad.org)
+ *  Copyright (C) 2009-2026 Clifford Wolf <clifford@clifford.at> and
+ *                          Marius Kintel <marius@kintel.net>
+ *
+ *  This program is free software; you can redistribute it and/or modify
+ *  it under the terms of the GNU General Public License as published by
+ *  the Free Software Foundation; either version 2 of the License, or
+ *  (at your option) any later version.
+ *
+ *  As a special exception, you have permission to link this program
+ *  with the CGAL library and distribute executables, as long as you
+ *  follow the requirements of the GNU GPL in regard to all of the
+ *  software in the executable aside from CGAL.
+ *
+ *  This program is distributed in the hope that it will be useful,
+ *  but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *  MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *  GNU General Public License for more details.
+ *
+ *  You should have received a copy of the GNU General Public License
+ *  along with this program; if not, write to the Free Software
+ *  Foundation, Inc., 59 Temple Place, Suite 330, Boston, MA  02111-1307  USA
+ *
+ */
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <vector>
+
+#include "Feature.h"
+#include "geometry/Geometry.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
+#include "geometry/linalg.h"
+#include "io/export.h"
+#include "utils/byte_order.h"
+#include "utils/printutils.h"
+
+// http://paulbourke.net/dataformats/ply/
+//
+// Binary little endian PLY, with double vertex coordinates so that meshes round trip exactly,
+// and an optional per face color. Data is written in blocks rather than value by value.
+
+namespace {
+
+constexpr size_t BLOCK_SIZE = 4096;
+// Face sizes are stored as uchar
+constexpr size_t MAX_FACE_SIZE = 255;
+
+}  // namespace
+
+void export_ply(const std::shared_ptr<const Geometry>& geom, std::ostream& output,
+                const ExportInfo& exportInfo)
+{
+  auto ps = PolySetUtils::getGeometryAsPolySet(geom);
+  if (!ps) return;
+  for (const auto& face : ps->indices) {
+    if (face.size() > MAX_FACE_SIZE) {
+      ps = PolySetUtils::tessellate_faces(*ps);
+      break;
+    }
+  }
+  if (Feature::ExperimentalPredictibleOutput.is_enabled()) {
+    ps = createSortedPolySet(*ps);
+  }
+  const bool has_color = !ps->color_indices.empty();
+
+  output << "ply\n"
+         << "format binary_little_endian 1.0\n"
+         << "comment Generated by OpenSCAD\n"
+         << "element vertex " << ps->vertices.size() << "\n"
+         << "property double x\n"
+         << "property double y\n"
+         << "property double z\n"
+         << "element face " << ps->indices.size() << "\n"
+         << "property list uchar int vertex_indices\n";
+  if (has_color) {
+    output << "property uchar red\n"
+           << "property uchar green\n"
+           << "property uchar blue\n"
+           << "property uchar alpha\n";
+  }
+  output << "end_header\n";
+
+  std::vector<double> coords;
+  coords.reserve(3 * BLOCK_SIZE);
+  for (size_t start = 0; start < ps->vertices.size(); start += BLOCK_SIZE) {
+    const size_t stop = std::min(start + BLOCK_SIZE, ps->vertices.size());
+    coords.clear();
+    for (size_t i = start; i < stop; ++i) {
+      const auto& v = ps->vertices[i];
+      coords.insert(coords.end(), {v[0], v[1], v[2]});
+    }
+    write_little_endian(output, coords.data(), coords.size());
+  }
+
+  // Rows mix byte and int fields, so they're assembled as bytes
+  std::vector<uint8_t> colors(ps->colors.size() * 4);
+  for (size_t i = 0; i < ps->colors.size(); ++i) {
+    int r = 0, g = 0, b = 0, a = 255;
+    if (!ps->colors[i].getRgba(r, g, b, a)) {
+      exportInfo.defaultColor.getRgba(r, g, b, a);
+    }
+    colors[4 * i] = r;
+    colors[4 * i + 1] = g;
+    colors[4 * i + 2] = b;
+    colors[4 * i + 3] = a;
+  }
+  uint8_t default_color[4] = {0, 0, 0, 0};
+  if (has_color) {
+    int r = 0, g = 0, b = 0, a = 255;
+    if (!exportInfo.defaultColor.getRgba(r, g, b, a)) {
+      LOG(message_group::Warning, "Invalid default color in PLY export");
+    }
+    default_color[0] = r;
+    default_color[1] = g;
+    default_color[2] = b;
+    default_color[3] = a;
+  }
+
+  std::vector<char> block;
+  block.reserve(BLOCK_SIZE * 20);
+  for (size_t start = 0; start < ps->indices.size(); start += BLOCK_SIZE) {
+    const size_t stop = std::min(start + BLOCK_SIZE, ps->indices.size());
+    block.clear();
+    for (size_t i = start; i < stop; ++i) {
+      const auto face = ps->indices[i];
+      block.push_back(static_cast<char>(face.size()));
+      for (const int index : face) {
+        const auto value = static_cast<int32_t>(index);
+        for (int b = 0; b < 4; ++b) block.push_back(static_cast<char>(value >> (8 * b)));
+      }
+      if (has_color) {
+        const int32_t color_index = ps->color_indices[i];
+        const uint8_t *rgba = color_index >= 0 ? &colors[4 * color_index] : default_color;
+        block.insert(block.end(), rgba, rgba + 4);
+      }
+    }
+    output.write(block.data(), block.size());
+  }
+}
@@ -1,19 +1,213 @@
 #include <cassert>
-#include <cstdio>
 #include <memory>
+#include <optional>
 #include <ostream>
+#include <set>
+#include <utility>
+#include <vector>
 
+#include <Eigen/Geometry>
+
+#include "core/CSGNode.h"
+#include "core/enums.h"
 #include "core/Tree.h"
 #include "geometry/Geometry.h"
 #include "geometry/linalg.h"
+#include "geometry/Polygon2d.h"
+#include "geometry/PolySet.h"
+#include "geometry/PolySetUtils.h"
 #include "glview/Camera.h"
+#include "glview/ColorMap.h"
 #include "glview/CsgInfo.h"
 #include "glview/OffscreenView.h"
 #include "glview/RenderSettings.h"
 #include "glview/Renderer.h"
+#include "glview/SoftwareRasterizer.h"
 #include "io/export.h"
 #include "utils/printutils.h"
 
+namespace {
+
+void setupCamera(Camera& cam, const BoundingBox& bbox)
+{
+  if (cam.viewall) cam.viewAll(bbox);
+}
+
+const ColorScheme& colorScheme()
+{
+  const auto *cs = ColorMap::instance().findColorScheme(RenderSettings::inst()->colorscheme);
+  return cs ? *cs : ColorMap::instance().defaultColorScheme();
+}
+
+// Renderer::getShaderColor() without a Renderer, which needs OpenGL.
+// scheme_color is the colorscheme color of the color mode, if it has one.
+Color4f shaderColor(Color4f color, const Color4f& object_color,
+                    const std::optional<Color4f>& scheme_color, bool highlight)
+{
+  if (!highlight) {
+    if (object_color.hasRgb()) color.setRgb(object_color.r(), object_color.g(), object_color.b());
+    if (object_color.hasAlpha()) color.setAlpha(object_color.a());
+    if (color.isValid()) return color;
+  }
+  if (scheme_color) {
+    if (!color.hasRgb()) color.setRgb(scheme_color->r(), scheme_color->g(), scheme_color->b());
+    if (!color.hasAlpha()) color.setAlpha(scheme_color->a());
+  }
+  return color;
+}
+
+void collectGeometry(const std::shared_ptr<const Geometry>& geom,
+                     std::vector<std::shared_ptr<const PolySet>>& polysets,
+                     std::vector<std::shared_ptr<const Polygon2d>>& polygons)
+{
+  if (const auto geomlist = std::dynamic_pointer_cast<const GeometryList>(geom)) {
+    for (const auto& item : geomlist->getChildren()) {
+      collectGeometry(item.second, polysets, polygons);
+    }
+  } else if (const auto poly = std::dynamic_pointer_cast<const Polygon2d>(geom)) {
+    polygons.push_back(poly);
+  } else if (const auto ps = PolySetUtils::getGeometryAsPolySet(geom)) {
+    // Concave faces need tessellation, see PolySetRenderer::addGeometry()
+    polysets.push_back(PolySetUtils::tessellate_faces(*ps));
+  }
+}
+
+// Same scene as PolySetRenderer
+bool export_png_software(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
+                         Camera& camera, std::ostream& output)
+{
+  PRINTD("export_png software");
+  std::vector<std::shared_ptr<const PolySet>> polysets;
+  std::vector<std::shared_ptr<const Polygon2d>> polygons;
+  collectGeometry(root_geom, polysets, polygons);
+
+  setupCamera(camera, root_geom->getBoundingBox());
+  const ColorScheme& cs = colorScheme();
+  SoftwareRasterizer rasterizer(camera, cs);
+  rasterizer.setShowEdges(options["edges"]);
+  if (options["crosshairs"]) rasterizer.addCrosshairs();
+  if (options["axes"]) rasterizer.addAxes();
+
+  const Color4f material = ColorMap::getColor(cs, RenderColor::OPENCSG_FACE_FRONT_COLOR);
+  for (const auto& ps : polysets) {
+    Color4f color;
+    if (!ps->colors.empty()) color = ps->colors[0];
+    color = shaderColor(color, color, material, false);
+    rasterizer.addSurface(*ps, Transform3d::Identity(), color, false);
+  }
+
+  const Color4f face_2d = ColorMap::getColor(cs, RenderColor::CGAL_FACE_2D_COLOR);
+  for (const auto& poly : polygons) {
+    if (const auto ps = poly->tessellate()) {
+      rasterizer.addSurface(*ps, Transform3d::Identity(), face_2d, true,
+                            SoftwareRasterizer::CullFace::NONE, false);
+    }
+  }
+  const Color4f edge_2d = ColorMap::getColor(cs, RenderColor::CGAL_EDGE_2D_COLOR);
+  for (const auto& poly : polygons) {
+    rasterizer.addOutlines(*poly, edge_2d);
+  }
+
+  rasterizer.render();
+  return rasterizer.save(output);
+}
+
+// Same scene as ThrownTogetherRenderer::createCSGProducts()
+void addThrownTogetherProducts(SoftwareRasterizer& rasterizer, const CSGProducts& products,
+                               bool highlight_mode, bool background_mode, const ColorScheme& cs)
+{
+  const Color4f material = ColorMap::getColor(cs, RenderColor::OPENCSG_FACE_FRONT_COLOR);
+  const Color4f cutout = ColorMap::getColor(cs, RenderColor::OPENCSG_FACE_BACK_COLOR);
+  const Color4f highlight(255, 81, 81, 128);
+  const Color4f background(180, 180, 180, 128);
+
+  std::set<std::pair<const PolySet *, const Transform3d *>> visited;
+  const auto add_chain_object = [&](const CSGChainObject& csgobj, OpenSCADOperator type) {
+    const auto& leaf = csgobj.leaf;
+    if (!leaf->polyset || !visited.emplace(leaf->polyset.get(), &leaf->matrix).second) return;
+
+    const bool highlighted = csgobj.flags & CSGNode::FLAG_HIGHLIGHT;
+    const bool override_color =
+      highlight_mode || background_mode || type == OpenSCADOperator::DIFFERENCE || leaf->color.isValid();
+    if (highlight_mode || background_mode) {
+      const bool use_highlight = highlight_mode || highlighted;
+      const Color4f color =
+        shaderColor(Color4f(), leaf->color, use_highlight ? highlight : background, use_highlight);
+      rasterizer.addSurface(*leaf->polyset, leaf->matrix, color, override_color);
+    } else {
+      const Color4f& scheme_color = highlighted                             ? highlight
+                                    : type == OpenSCADOperator::DIFFERENCE ? cutout
+                                                                            : material;
+      Color4f color = shaderColor(Color4f(), leaf->color, scheme_color, highlighted);
+      Transform3d mat = leaf->matrix;
+      if (leaf->polyset->getDimension() == 2 && type == OpenSCADOperator::DIFFERENCE) {
+        // Scale 2D negative objects 10% in the Z direction to avoid z fighting
+        mat *= Eigen::Scaling(1.0, 1.0, 1.1);
+      }
+      rasterizer.addSurface(*leaf->polyset, mat, color, override_color,
+                            SoftwareRasterizer::CullFace::BACK);
+
+      // Back faces show up in magenta, unless the object has a color
+      color.setRgb(1.0f, 0.0f, 1.0f);
+      color = shaderColor(color, leaf->color, std::nullopt, false);
+      rasterizer.addSurface(*leaf->polyset, leaf->matrix, color, true,
+                            SoftwareRasterizer::CullFace::FRONT);
+    }
+  };
+
+  for (const auto& product : products.products) {
+    for (const auto& csgobj : product.intersections) {
+      add_chain_object(csgobj, OpenSCADOperator::INTERSECTION);
+    }
+    for (const auto& csgobj : product.subtractions) {
+      add_chain_object(csgobj, OpenSCADOperator::DIFFERENCE);
+    }
+  }
+}
+
+}  // namespace
+
+std::unique_ptr<SoftwareRasterizer> prepare_software_preview(Tree& tree, const ViewOptions& options,
+                                                             Camera& camera)
+{
+  PRINTD("prepare_software_preview");
+  CsgInfo csgInfo = CsgInfo();
+  csgInfo.compile_products(tree);
+
+  if (options.previewer == Previewer::OPENCSG) {
+    LOG("The software rasterizer draws OpenCSG previews as thrown together.");
+  }
+
+  BoundingBox bbox;
+  if (csgInfo.root_products) bbox = csgInfo.root_products->getBoundingBox(true);
+  if (csgInfo.highlights_products) bbox.extend(csgInfo.highlights_products->getBoundingBox(true));
+  if (csgInfo.background_products) bbox.extend(csgInfo.background_products->getBoundingBox(true));
+  setupCamera(camera, bbox);
+
+  const ColorScheme& cs = colorScheme();
+  auto rasterizer = std::make_unique<SoftwareRasterizer>(camera, cs);
+  rasterizer->setShowEdges(options["edges"]);
+  if (options["crosshairs"]) rasterizer->addCrosshairs();
+  if (options["axes"]) rasterizer->addAxes();
+  if (csgInfo.root_products) {
+    addThrownTogetherProducts(*rasterizer, *csgInfo.root_products, false, false, cs);
+  }
+  if (csgInfo.background_products) {
+    addThrownTogetherProducts(*rasterizer, *csgInfo.background_products, false, true, cs);
+  }
+  if (csgInfo.highlights_products) {
+    addThrownTogetherProducts(*rasterizer, *csgInfo.highlights_products, true, false, cs);
+  }
+  rasterizer->render();
+  return rasterizer;
+}
+
+bool export_png(const SoftwareRasterizer& rasterizer, std::ostream& output)
+{
+  PRINTD("export_png_software_preview");
+  return rasterizer.save(output);
+}
+
 #ifndef NULLGL
 #include "glview/PolySetRenderer.h"
 #if not defined(USE_POLYSET_FOR_CGAL)
@@ -28,25 +222,21 @@
 
 #include "glview/preview/ThrownTogetherRenderer.h"
 
-namespace {
-
-void setupCamera(Camera& cam, const BoundingBox& bbox)
-{
-  if (cam.viewall) cam.viewAll(bbox);
-}
-
-}  // namespace
-
 bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
                 Camera& camera, std::ostream& output)
 {
   assert(root_geom != nullptr);
+  if (options.rasterizer == Rasterizer::SOFTWARE) {
+    return export_png_software(root_geom, options, camera, output);
+  }
   PRINTD("export_png geom");
   std::unique_ptr<OffscreenView> glview;
   try {
     glview = std::make_unique<OffscreenView>(camera.pixel_width, camera.pixel_height);
   } catch (const OffscreenViewException& ex) {
-    fprintf(stderr, "Can't create OffscreenView: %s.\n", ex.what());
+    LOG(message_group::Error,
+        "Can't create OffscreenView: %1$s. Use --rasterizer=software to draw without OpenGL.",
+        ex.what());
     return false;
   }
   std::shared_ptr<Renderer> geomRenderer;
@@ -88,7 +278,9 @@ std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& op
   try {
     glview = std::make_unique<OffscreenView>(camera.pixel_width, camera.pixel_height);
   } catch (const OffscreenViewException& ex) {
-    LOG("Can't create OffscreenView: %1$s.", ex.what());
+    LOG(message_group::Error,
+        "Can't create OffscreenView: %1$s. Use --rasterizer=software to draw without OpenGL.",
+        ex.what());
     return nullptr;
   }
 
@@ -99,8 +291,10 @@ std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& op
     renderer = std::make_shared<OpenCSGRenderer>(csgInfo.root_products, csgInfo.highlights_products,
                                                  csgInfo.background_products);
 #else
-    fprintf(stderr, "This openscad was built without OpenCSG support\n");
-    return 0;
+    LOG(message_group::Error,
+        "This openscad was built without OpenCSG support. Use --preview=throwntogether or "
+        "--rasterizer=software.");
+    return nullptr;
 #endif
   } else {
     PRINTD("Initializing ThrownTogetherRenderer");
@@ -138,10 +332,15 @@ bool export_png(const OffscreenView& glview, std::ostream& output)
 bool export_png(const std::shared_ptr<const Geometry>& root_geom, const ViewOptions& options,
                 Camera& camera, std::ostream& output)
 {
+  if (options.rasterizer == Rasterizer::SOFTWARE) {
+    return export_png_software(root_geom, options, camera, output);
+  }
+  LOG(message_group::Error, "This openscad was built without OpenGL. Use --rasterizer=software.");
   return false;
 }
 std::unique_ptr<OffscreenView> prepare_preview(Tree& tree, const ViewOptions& options, Camera& camera)
 {
+  LOG(message_group::Error, "This openscad was built without OpenGL. Use --rasterizer=software.");
   return nullptr;
 }
 bool export_png(const OffscreenView& glview, std::ostream& output)
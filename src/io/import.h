@@ -12,6 +12,7 @@ std::unique_ptr<class PolySet> import_obj(const std::string& filename, const Loc
 std::unique_ptr<class PolySet> import_off(const std::string& filename, const Location& loc);
 std::unique_ptr<class PolySet> import_amf(const std::string&, const Location& loc);
 std::unique_ptr<class PolySet> import_3mf(const std::string&, const Location& loc);
+std::unique_ptr<class PolySet> import_ply(const std::string& filename, const Location& loc);
 
 std::unique_ptr<class Polygon2d> import_svg(CurveDiscretizer discretizer, const std::string& filename,
                                             const boost::optional<std::string>& id,
@@ -227,6 +227,7 @@ std::unique_ptr<PolySet> import_off(const std::string& filename, const Location&
     }
   }
 
+  IndexedFace face_indices;
   while (!f.eof() && (face++ < faces_count)) {
     if (!getline_clean("reading faces: end of file")) {
       return PolySet::createEmpty();
@@ -247,17 +248,19 @@ std::unique_ptr<PolySet> import_off(const std::string& filename, const Location&
         return PolySet::createEmpty();
       }
       const size_t face_idx = ps->indices.size();
-      ps->indices.emplace_back().reserve(face_size);
+      face_indices.clear();
+      face_indices.reserve(face_size);
       // PRINTDB("Index[%d] [%d] = { ", face % n);
       for (i = 0; i < face_size; i++) {
         size_t ind = boost::lexical_cast<int>(words[i + 1]);
         // PRINTDB("%d, ", ind);
         if (ind >= 0 && ind < vertices_count) {
-          ps->indices.back().push_back(ind);
+          face_indices.push_back(ind);
         } else {
           AsciiError((boost::format("ignored bad face vertex index: %d") % ind).str().c_str());
         }
       }
+      ps->indices.push_back(face_indices);
       // PRINTD("}");
       if (words.size() >= face_size + 4) {
         i = face_size + 1;
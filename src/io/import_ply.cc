@@ -0,0 +1,372 @@
+#include "io/import.h"
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <limits>
+#include <map>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+#include "core/AST.h"
+#include "geometry/PolySet.h"
+#include "geometry/linalg.h"
+#include "io/MappedFile.h"
+#include "utils/byte_order.h"
+#include "utils/printutils.h"
+
+// References:
+// http://paulbourke.net/dataformats/ply/
+//
+// Binary files are supported in either byte order, ASCII files aren't. The file is memory mapped
+// and parsed in place. Elements are read in the order of the header, so faces may come before
+// the vertices they refer to; their indices are checked once all elements are read.
+
+namespace {
+
+enum class PlyType { Char, UChar, Short, UShort, Int, UInt, Float, Double, Invalid };
+
+PlyType parse_type(const std::string& name)
+{
+  if (name == "char" || name == "int8") return PlyType::Char;
+  if (name == "uchar" || name == "uint8") return PlyType::UChar;
+  if (name == "short" || name == "int16") return PlyType::Short;
+  if (name == "ushort" || name == "uint16") return PlyType::UShort;
+  if (name == "int" || name == "int32") return PlyType::Int;
+  if (name == "uint" || name == "uint32") return PlyType::UInt;
+  if (name == "float" || name == "float32") return PlyType::Float;
+  if (name == "double" || name == "float64") return PlyType::Double;
+  return PlyType::Invalid;
+}
+
+size_t type_size(PlyType type)
+{
+  switch (type) {
+  case PlyType::Char:
+  case PlyType::UChar:  return 1;
+  case PlyType::Short:
+  case PlyType::UShort: return 2;
+  case PlyType::Int:
+  case PlyType::UInt:
+  case PlyType::Float:  return 4;
+  case PlyType::Double: return 8;
+  default:              return 0;
+  }
+}
+
+bool is_integer(PlyType type) { return type != PlyType::Float && type != PlyType::Double; }
+
+template <typename T>
+T read(const char *p, bool big_endian)
+{
+  return big_endian ? read_big_endian<T>(p) : read_little_endian<T>(p);
+}
+
+double read_value(PlyType type, const char *p, bool big_endian)
+{
+  switch (type) {
+  case PlyType::Char:   return read<int8_t>(p, big_endian);
+  case PlyType::UChar:  return read<uint8_t>(p, big_endian);
+  case PlyType::Short:  return read<int16_t>(p, big_endian);
+  case PlyType::UShort: return read<uint16_t>(p, big_endian);
+  case PlyType::Int:    return read<int32_t>(p, big_endian);
+  case PlyType::UInt:   return read<uint32_t>(p, big_endian);
+  case PlyType::Float:  return read<float>(p, big_endian);
+  case PlyType::Double: return read<double>(p, big_endian);
+  default:              return 0;
+  }
+}
+
+int64_t read_integer(PlyType type, const char *p, bool big_endian)
+{
+  switch (type) {
+  case PlyType::Char:   return read<int8_t>(p, big_endian);
+  case PlyType::UChar:  return read<uint8_t>(p, big_endian);
+  case PlyType::Short:  return read<int16_t>(p, big_endian);
+  case PlyType::UShort: return read<uint16_t>(p, big_endian);
+  case PlyType::Int:    return read<int32_t>(p, big_endian);
+  case PlyType::UInt:   return read<uint32_t>(p, big_endian);
+  default:              return static_cast<int64_t>(read_value(type, p, big_endian));
+  }
+}
+
+struct PlyProperty {
+  std::string name;
+  PlyType type;
+  // For list properties, the type of the item count
+  PlyType count_type{PlyType::Invalid};
+  [[nodiscard]] bool isList() const { return count_type != PlyType::Invalid; }
+};
+
+struct PlyElement {
+  std::string name;
+  size_t count;
+  std::vector<PlyProperty> properties;
+
+  // Size of each item, or 0 if it contains lists and has to be walked
+  [[nodiscard]] size_t stride() const
+  {
+    size_t size = 0;
+    for (const auto& property : properties) {
+      if (property.isList()) return 0;
+      size += type_size(property.type);
+    }
+    return size;
+  }
+  [[nodiscard]] int find(const std::string& property_name) const
+  {
+    for (size_t i = 0; i < properties.size(); ++i) {
+      if (properties[i].name == property_name) return static_cast<int>(i);
+    }
+    return -1;
+  }
+};
+
+// Returns the size of one item of an element which may contain lists, or 0 if it's truncated
+size_t item_size(const PlyElement& element, const char *p, const char *end, bool big_endian)
+{
+  const char *start = p;
+  for (const auto& property : element.properties) {
+    if (property.isList()) {
+      const size_t count_size = type_size(property.count_type);
+      if (end - p < static_cast<ptrdiff_t>(count_size)) return 0;
+      const int64_t n = read_integer(property.count_type, p, big_endian);
+      if (n < 0) return 0;
+      p += count_size;
+      if (static_cast<uint64_t>(end - p) / type_size(property.type) < static_cast<uint64_t>(n)) return 0;
+      p += n * type_size(property.type);
+    } else {
+      if (end - p < static_cast<ptrdiff_t>(type_size(property.type))) return 0;
+      p += type_size(property.type);
+    }
+  }
+  return p - start;
+}
+
+int color_component(PlyType type, const char *p, bool big_endian)
+{
+  if (is_integer(type)) return static_cast<int>(read_integer(type, p, big_endian));
+  return static_cast<int>(read_value(type, p, big_endian) * 255 + 0.5);
+}
+
+}  // namespace
+
+std::unique_ptr<PolySet> import_ply(const std::string& filename, const Location& loc)
+{
+  auto PlyError = [&](const auto& errstr) {
+    LOG(message_group::Error, loc, "", "Can't import PLY file '%1$s': %2$s", filename, errstr);
+  };
+
+  const MappedFile file(filename);
+  if (!file.isOpen()) {
+    PlyError("file error");
+    return PolySet::createEmpty();
+  }
+  const char *const data = file.data();
+  const char *const end = data + file.size();
+
+  // The header is ASCII text, terminated by the end_header line
+  const char *p = data;
+  std::vector<PlyElement> elements;
+  bool magic = false;
+  bool format = false;
+  bool big_endian = false;
+  bool header_done = false;
+  while (p < end && !header_done) {
+    const char *eol = static_cast<const char *>(std::memchr(p, '\n', end - p));
+    if (!eol) break;
+    std::string line(p, eol);
+    p = eol + 1;
+    if (!line.empty() && line.back() == '\r') line.pop_back();
+
+    std::istringstream words(line);
+    std::string keyword;
+    words >> keyword;
+    if (!magic) {
+      if (keyword != "ply") break;
+      magic = true;
+    } else if (keyword == "format") {
+      std::string encoding, version;
+      words >> encoding >> version;
+      if (encoding != "binary_little_endian" && encoding != "binary_big_endian") {
+        PlyError("format '" + encoding +
+                 "' not supported, only binary_little_endian and binary_big_endian");
+        return PolySet::createEmpty();
+      }
+      big_endian = encoding == "binary_big_endian";
+      format = true;
+    } else if (keyword == "element") {
+      PlyElement element;
+      if (!(words >> element.name >> element.count)) {
+        PlyError("bad header: can't parse element '" + line + "'");
+        return PolySet::createEmpty();
+      }
+      elements.push_back(element);
+    } else if (keyword == "property") {
+      PlyProperty property;
+      std::string type;
+      words >> type;
+      if (type == "list") {
+        std::string count_type;
+        words >> count_type >> type;
+        property.count_type = parse_type(count_type);
+        if (property.count_type == PlyType::Invalid || !is_integer(property.count_type)) {
+          PlyError("bad header: bad list count type '" + count_type + "'");
+          return PolySet::createEmpty();
+        }
+      }
+      property.type = parse_type(type);
+      if (property.type == PlyType::Invalid || !(words >> property.name) || elements.empty()) {
+        PlyError("bad header: can't parse property '" + line + "'");
+        return PolySet::createEmpty();
+      }
+      elements.back().properties.push_back(property);
+    } else if (keyword == "end_header") {
+      header_done = true;
+    }
+    // comment and obj_info lines are ignored
+  }
+  if (!magic || !header_done) {
+    PlyError(magic ? "bad header: missing end_header" : "bad header: not a PLY file");
+    return PolySet::createEmpty();
+  }
+  if (!format) {
+    PlyError("bad header: missing format");
+    return PolySet::createEmpty();
+  }
+
+  auto ps = PolySet::createEmpty();
+  bool has_vertices = false;
+  for (const auto& element : elements) {
+    const size_t stride = element.stride();
+    if (stride && static_cast<size_t>(end - p) / stride < element.count) {
+      PlyError("unexpected end of file reading '" + element.name + "'");
+      return PolySet::createEmpty();
+    }
+
+    if (element.name == "vertex") {
+      const int x = element.find("x"), y = element.find("y"), z = element.find("z");
+      if (!stride || x < 0 || y < 0 || z < 0) {
+        PlyError("vertex element needs x, y and z and no lists");
+        return PolySet::createEmpty();
+      }
+      size_t offset[3] = {0, 0, 0};
+      PlyType type[3];
+      const int xyz[3] = {x, y, z};
+      for (int i = 0; i < 3; ++i) {
+        for (int j = 0; j < xyz[i]; ++j) offset[i] += type_size(element.properties[j].type);
+        type[i] = element.properties[xyz[i]].type;
+      }
+      ps->vertices.resize(element.count);
+      if (stride == 3 * sizeof(float) && offset[1] == 4 && offset[2] == 8 && type[0] == PlyType::Float &&
+          type[1] == PlyType::Float && type[2] == PlyType::Float && big_endian != is_little_endian()) {
+        // Packed float vertices in the byte order of this machine, the most common layout
+        for (size_t i = 0; i < element.count; ++i, p += stride) {
+          float v[3];
+          std::memcpy(v, p, sizeof(v));
+          ps->vertices[i] = Vector3d(v[0], v[1], v[2]);
+        }
+      } else {
+        for (size_t i = 0; i < element.count; ++i, p += stride) {
+          ps->vertices[i] = Vector3d(read_value(type[0], p + offset[0], big_endian),
+                                     read_value(type[1], p + offset[1], big_endian),
+                                     read_value(type[2], p + offset[2], big_endian));
+        }
+      }
+      has_vertices = true;
+    } else if (element.name == "face") {
+      int indices = element.find("vertex_indices");
+      if (indices < 0) indices = element.find("vertex_index");
+      if (indices < 0 || !element.properties[indices].isList() ||
+          !is_integer(element.properties[indices].type)) {
+        PlyError("face element needs a vertex_indices list");
+        return PolySet::createEmpty();
+      }
+      const int rgba[4] = {element.find("red"), element.find("green"), element.find("blue"),
+                           element.find("alpha")};
+      const bool has_color = rgba[0] >= 0 && rgba[1] >= 0 && rgba[2] >= 0;
+
+      std::map<Color4f, int32_t> color_map;
+      IndexedFace face;
+      // Every face takes at least one byte, which bounds the count of a broken file
+      const size_t max_faces = std::min(element.count, static_cast<size_t>(end - p));
+      ps->indices.reserve(max_faces);
+      if (has_color) ps->color_indices.reserve(max_faces);
+      for (size_t i = 0; i < element.count; ++i) {
+        const size_t size = item_size(element, p, end, big_endian);
+        if (!size) {
+          PlyError("unexpected end of file reading faces");
+          return PolySet::createEmpty();
+        }
+        int color[4] = {255, 255, 255, 255};
+        for (size_t n = 0; n < element.properties.size(); ++n) {
+          const auto& property = element.properties[n];
+          if (property.isList()) {
+            const int64_t count = read_integer(property.count_type, p, big_endian);
+            p += type_size(property.count_type);
+            const size_t item = type_size(property.type);
+            if (static_cast<int>(n) == indices) {
+              face.clear();
+              for (int64_t j = 0; j < count; ++j, p += item) {
+                // Checked against the vertex count at the end, as the vertices may come later
+                const int64_t index = read_integer(property.type, p, big_endian);
+                if (index < 0 || index > std::numeric_limits<int>::max()) {
+                  PlyError("bad face vertex index " + std::to_string(index));
+                  return PolySet::createEmpty();
+                }
+                face.push_back(static_cast<int>(index));
+              }
+            } else {
+              p += count * item;
+            }
+          } else {
+            for (int c = 0; c < 4; ++c) {
+              if (static_cast<int>(n) == rgba[c]) {
+                color[c] = color_component(property.type, p, big_endian);
+              }
+            }
+            p += type_size(property.type);
+          }
+        }
+        ps->indices.push_back(face);
+        if (has_color) {
+          const Color4f c(color[0], color[1], color[2], color[3]);
+          auto iter_pair = color_map.emplace(c, ps->colors.size());
+          if (iter_pair.second) ps->colors.push_back(c);  // inserted
+          ps->color_indices.push_back(iter_pair.first->second);
+        }
+      }
+    } else if (stride || element.properties.empty()) {
+      p += element.count * stride;
+    } else {
+      for (size_t i = 0; i < element.count; ++i) {
+        const size_t size = item_size(element, p, end, big_endian);
+        if (!size) {
+          PlyError("unexpected end of file reading '" + element.name + "'");
+          return PolySet::createEmpty();
+        }
+        p += size;
+      }
+    }
+  }
+  if (!has_vertices) {
+    PlyError("missing vertex element");
+    return PolySet::createEmpty();
+  }
+  const auto num_vertices = static_cast<int>(ps->vertices.size());
+  for (const auto& face : ps->indices) {
+    for (const int index : face) {
+      if (index >= num_vertices) {
+        PlyError("bad face vertex index " + std::to_string(index));
+        return PolySet::createEmpty();
+      }
+    }
+  }
+  if (ps->indices.allTriangles()) ps->setTriangular(true);
+
+  PRINTDB("PLY: %ld vertices, %ld faces", ps->vertices.size() % ps->indices.size());
+  return ps;
+}
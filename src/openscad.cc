@@ -36,6 +36,7 @@
 #endif
 #include <libintl.h>
 
+#include <algorithm>
 #include <array>
 #include <boost/algorithm/string/case_conv.hpp>
 #include <boost/algorithm/string/classification.hpp>
@@ -53,8 +54,11 @@
 #include <boost/program_options/variables_map.hpp>
 #include <boost/range/adaptor/transformed.hpp>
 #include <boost/range/iterator_range_core.hpp>
+#include <chrono>
 #include <clocale>
+#include <cmath>
 #include <cstddef>
+#include <cstdint>
 #include <cstdlib>
 #include <exception>
 #include <filesystem>
@@ -96,6 +100,7 @@
 #include "core/customizer/ParameterSet.h"
 #include "core/node.h"
 #include "core/parsersettings.h"
+#include "core/progress.h"
 #include "geometry/Geometry.h"
 #include "geometry/GeometryEvaluator.h"
 #include "geometry/GeometryUtils.h"
@@ -104,6 +109,7 @@
 #include "glview/ColorMap.h"
 #include "glview/OffscreenView.h"
 #include "glview/RenderSettings.h"
+#include "glview/SoftwareRasterizer.h"
 #include "handle_dep.h"
 #include "io/export.h"
 #include "openscad_gui.h"
@@ -126,6 +132,8 @@ std::string arg_colorscheme;
 namespace {
 
 bool arg_info = false;
+// Longest --timeout, in seconds
+constexpr double MAX_TIMEOUT = 1e9;
 
 }  // namespace
 
@@ -178,6 +186,7 @@ struct CommandLine {
   const AnimateArgs animate;
   const std::vector<std::string> summaryOptions;
   const std::string summaryFile;
+  const double timeout;  // seconds, 0 for no limit
 };
 
 namespace {
@@ -245,6 +254,7 @@ void help_export()
   help_export(Settings::SettingsExportPdf::cmdline);
   help_export(Settings::SettingsExport3mf::cmdline);
   help_export(Settings::SettingsExportSvg::cmdline);
+  help_export(Settings::SettingsExportGlb::cmdline);
   exit(0);
 }
 
@@ -387,8 +397,8 @@ Camera get_camera(const po::variables_map& vm)
   return camera;
 }
 
-int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format,
-              SourceFile *root_file)
+int export_with_progress(const CommandLine& cmd, const RenderVariables& render_variables,
+                         FileFormat export_format, SourceFile *root_file, ProgressSink& progress)
 {
   auto filename_str = fs::path(cmd.output_file).generic_string();
   // Avoid possibility of fs::absolute throwing when passed an empty path
@@ -476,13 +486,23 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
     RenderStatistic renderStatistic;
     GeometryEvaluator geomevaluator(tree);
     std::unique_ptr<OffscreenView> glview;
+    std::unique_ptr<SoftwareRasterizer> rasterizer;
     std::shared_ptr<const Geometry> root_geom;
+
+    // The root node may be below absolute_root_node if the ! modifier is used,
+    // so number the whole tree for progress reporting.
+    progress.prepare(absolute_root_node);
     if ((export_format == FileFormat::ECHO || export_format == FileFormat::PNG) &&
         (cmd.viewOptions.renderer == RenderType::OPENCSG ||
          cmd.viewOptions.renderer == RenderType::THROWNTOGETHER)) {
       // OpenCSG or throwntogether png -> just render a preview
-      glview = prepare_preview(tree, cmd.viewOptions, camera);
-      if (!glview) return 1;
+      if (cmd.viewOptions.rasterizer == Rasterizer::OPENGL) {
+        glview = prepare_preview(tree, cmd.viewOptions, camera);
+        if (!glview) return 1;
+      } else {
+        rasterizer = prepare_software_preview(tree, cmd.viewOptions, camera);
+        if (!rasterizer) return 1;
+      }
     } else {
       // Force creation of concrete geometry (mostly for testing)
       // FIXME: Consider adding MANIFOLD as a valid --render argument and ViewOption, to be able to
@@ -520,12 +540,14 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       bool success = true;
       bool const wrote = with_output(
         cmd.is_stdout, filename_str,
-        [&success, &root_geom, &cmd, &camera, &glview](std::ostream& stream) {
+        [&success, &root_geom, &cmd, &camera, &glview, &rasterizer](std::ostream& stream) {
           if (cmd.viewOptions.renderer == RenderType::BACKEND_SPECIFIC ||
               cmd.viewOptions.renderer == RenderType::GEOMETRY) {
             success = export_png(root_geom, cmd.viewOptions, camera, stream);
-          } else {
+          } else if (glview) {
             success = export_png(*glview, stream);
+          } else {
+            success = export_png(*rasterizer, stream);
           }
         },
         std::ios::out | std::ios::binary);
@@ -534,11 +556,39 @@ int do_export(const CommandLine& cmd, const RenderVariables& render_variables, F
       }
     }
 
+    renderStatistic.setCulledOperands(geomevaluator.culledOperands());
     renderStatistic.printAll(root_geom, camera, cmd.summaryOptions, cmd.summaryFile);
   }
   return 0;
 }
 
+int do_export(const CommandLine& cmd, const RenderVariables& render_variables, FileFormat export_format,
+              SourceFile *root_file)
+{
+  // The time limit covers instantiation, evaluation and writing the output
+  ProgressSink progress;
+  // Limits shorter than the clock resolution round up to 1 ms rather than to no limit
+  const auto timeout_ms = static_cast<int64_t>(std::ceil(cmd.timeout * 1000));
+  progress.setTimeLimit(std::chrono::milliseconds(timeout_ms));
+  try {
+    const ProgressSink::Scope progress_scope(&progress);
+    return export_with_progress(cmd, render_variables, export_format, root_file, progress);
+  } catch (const ProgressCancelException&) {
+    // Instantiation may have been cancelled before restoring the CWD
+    fs::current_path(cmd.original_path);
+    if (progress.total() == 0) {
+      LOG(message_group::Error,
+          "Instantiation cancelled after exceeding the time limit of %1$g s", cmd.timeout);
+    } else {
+      LOG(message_group::Error,
+          "Rendering cancelled after exceeding the time limit of %1$g s, at node %2$d of %3$d (%4$d%%)",
+          cmd.timeout, progress.current_mark(), progress.total(),
+          progress.current_mark() * 100 / progress.total());
+    }
+    return 1;
+  }
+}
+
 int cmdline(const CommandLine& cmd)
 {
   FileFormat export_format;
@@ -857,8 +907,8 @@ int openscad_main(int argc, char **argv)
       "default so asciistl should be explicitly specified in scripts when needed.\n")
     ("o,o", po::value<std::vector<std::string>>(),
       "output specified file instead of running the GUI. The file extension specifies the type: stl, "
-      "off, wrl, amf, 3mf, csg, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg, param, pov. May be "
-      "used multiple times for different exports. Use '-' for stdout.\n")
+      "off, wrl, amf, 3mf, csg, dxf, svg, pdf, png, echo, ast, term, nef3, nefdbg, param, pov, glb, ply. "
+      "May be used multiple times for different exports. Use '-' for stdout.\n")
     ("O,O", po::value<std::vector<std::string>>(),
       "pass settings value to the file export using the format section/key=value, e.g "
       "export-pdf/paper-size=a3. Use --help-export to list all available settings.")
@@ -888,6 +938,8 @@ int openscad_main(int argc, char **argv)
       "for full geometry evaluation when exporting png")
     ("preview", po::value<std::string>()->implicit_value(""),
       "[=throwntogether] -for ThrownTogether preview png")
+    ("rasterizer", po::value<std::string>(),
+      "=opengl | software -renderer for png export, software needs no OpenGL context")
     ("animate", po::value<unsigned>(), "export N animated frames")
     ("animate_sharding", po::value<std::string>(),
       "Parameter <shard>/<num_shards> - Divide work into <num_shards> and only output frames for "
@@ -899,7 +951,7 @@ int openscad_main(int argc, char **argv)
     ("csglimit", po::value<unsigned int>(), "=n -stop rendering at n CSG elements when exporting png")
     ("summary", po::value<std::vector<std::string>>(),
       "enable additional render summary and statistics: all | cache | time | camera | geometry | "
-      "bounding-box | area")
+      "bounding-box | area | culling")
     ("summary-file", po::value<std::string>(),
       "output summary information in JSON format to the given file, using '-' outputs to stdout")
     ("colorscheme", po::value<std::string>(),
@@ -916,6 +968,7 @@ int openscad_main(int argc, char **argv)
     ("quiet,q", "quiet mode (don't print anything *except* errors)")
     ("reset-window-settings", "Reset GUI settings for window placement and fonts.")
     ("hardwarnings", "Stop on the first warning")
+    ("timeout", po::value<double>(), "=seconds -abort rendering after the given time")
     ("trace-depth", po::value<unsigned int>(), "=n, maximum number of trace messages")
     ("trace-usermodule-parameters", po::value<std::string>(),
       "=true/false, configure the output of user module parameters in a trace")
@@ -995,6 +1048,16 @@ int openscad_main(int argc, char **argv)
     OpenSCAD::hardwarnings = true;
   }
 
+  double timeout = 0.0;
+  if (vm.count("timeout")) {
+    timeout = vm["timeout"].as<double>();
+    // Also rejects NaN. The upper bound keeps the deadline within the range of the clock.
+    if (!(timeout > 0 && timeout <= MAX_TIMEOUT)) {
+      LOG("--timeout needs to be a positive number of seconds, up to %1$g\n", MAX_TIMEOUT);
+      return 1;
+    }
+  }
+
   if (vm.count("traceDepth")) {
     OpenSCAD::traceDepth = vm["traceDepth"].as<unsigned int>();
   }
@@ -1043,6 +1106,17 @@ int openscad_main(int argc, char **argv)
   viewOptions.previewer = (viewOptions.renderer == RenderType::THROWNTOGETHER)
                             ? Previewer::THROWNTOGETHER
                             : Previewer::OPENCSG;
+  if (vm.count("rasterizer")) {
+    const auto& rasterizer = vm["rasterizer"].as<std::string>();
+    if (rasterizer == "opengl") {
+      viewOptions.rasterizer = Rasterizer::OPENGL;
+    } else if (rasterizer == "software") {
+      viewOptions.rasterizer = Rasterizer::SOFTWARE;
+    } else {
+      LOG("rasterizer needs to be 'opengl' or 'software'\n");
+      return 1;
+    }
+  }
   if (vm.count("view")) {
     const auto& viewOptionValues = vm["view"].as<CommaSeparatedVector>();
 
@@ -1175,7 +1249,8 @@ int openscad_main(int argc, char **argv)
                                 animate,
                                 vm.count("summary") ? vm["summary"].as<std::vector<std::string>>()
                                                     : std::vector<std::string>{},
-                                vm.count("summary-file") ? vm["summary-file"].as<std::string>() : ""};
+                                vm.count("summary-file") ? vm["summary-file"].as<std::string>() : "",
+                                timeout};
           rc |= cmdline(cmd);
         }
       }
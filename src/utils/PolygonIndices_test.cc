@@ -0,0 +1,163 @@
+#include "geometry/PolygonIndices.h"
+
+#include <catch2/catch_all.hpp>
+#include <iterator>
+#include <utility>
+#include <vector>
+
+namespace {
+
+std::vector<IndexedFace> toFaces(const PolygonIndices& indices)
+{
+  return {indices.begin(), indices.end()};
+}
+
+}  // namespace
+
+TEST_CASE("PolygonIndices stores triangles without offsets", "[PolygonIndices]")
+{
+  PolygonIndices indices;
+  CHECK(indices.empty());
+  CHECK(indices.allTriangles());
+
+  indices.push_back({0, 1, 2});
+  indices.push_back(IndexedFace{2, 3, 0});
+  CHECK(indices.size() == 2);
+  CHECK(indices.allTriangles());
+  CHECK(indices.indexData() == std::vector<int>{0, 1, 2, 2, 3, 0});
+  CHECK(indices[1] == IndexedFace{2, 3, 0});
+  CHECK(indices.back() == IndexedFace{2, 3, 0});
+}
+
+TEST_CASE("PolygonIndices switches to offsets for other faces", "[PolygonIndices]")
+{
+  PolygonIndices indices{{0, 1, 2}, {2, 3, 0}};
+  indices.push_back({4, 5, 6, 7});
+  indices.push_back({8, 9});
+  indices.push_back({10, 11, 12});
+  CHECK_FALSE(indices.allTriangles());
+  CHECK(indices.size() == 5);
+  CHECK(indices.numIndices() == 15);
+  CHECK(toFaces(indices) ==
+        std::vector<IndexedFace>{{0, 1, 2}, {2, 3, 0}, {4, 5, 6, 7}, {8, 9}, {10, 11, 12}});
+  CHECK(indices[2].size() == 4);
+  CHECK(indices[3].size() == 2);
+}
+
+TEST_CASE("PolygonIndices pop_back", "[PolygonIndices]")
+{
+  SECTION("Triangles only")
+  {
+    PolygonIndices indices{{0, 1, 2}, {3, 4, 5}};
+    indices.pop_back();
+    CHECK(indices.size() == 1);
+    CHECK(indices.numIndices() == 3);
+    indices.pop_back();
+    CHECK(indices.empty());
+  }
+  SECTION("Back to triangles only")
+  {
+    PolygonIndices indices{{0, 1, 2}, {3, 4, 5, 6}};
+    indices.pop_back();
+    CHECK(indices.allTriangles());
+    CHECK(indices == PolygonIndices{{0, 1, 2}});
+    // Appending after the pop continues from the remaining faces
+    indices.push_back({7, 8, 9});
+    CHECK(indices.allTriangles());
+    CHECK(indices.indexData() == std::vector<int>{0, 1, 2, 7, 8, 9});
+  }
+  SECTION("Other faces remain")
+  {
+    PolygonIndices indices{{0, 1, 2, 3}, {4, 5, 6}, {7, 8}};
+    indices.pop_back();
+    CHECK_FALSE(indices.allTriangles());
+    CHECK(toFaces(indices) == std::vector<IndexedFace>{{0, 1, 2, 3}, {4, 5, 6}});
+    indices.pop_back();
+    indices.push_back({9, 10, 11, 12, 13});
+    CHECK(toFaces(indices) == std::vector<IndexedFace>{{0, 1, 2, 3}, {9, 10, 11, 12, 13}});
+    indices.pop_back();
+    indices.pop_back();
+    CHECK(indices.empty());
+    CHECK(indices.allTriangles());
+  }
+  SECTION("Degenerate face")
+  {
+    PolygonIndices indices;
+    indices.push_back(IndexedFace{});
+    CHECK(indices.size() == 1);
+    CHECK(indices[0].empty());
+    indices.pop_back();
+    CHECK(indices.empty());
+    CHECK(indices.allTriangles());
+  }
+}
+
+TEST_CASE("PolygonIndices appendTriangles", "[PolygonIndices]")
+{
+  const std::vector<int> triangles = {0, 1, 2, 3, 4, 5};
+  SECTION("Triangles only")
+  {
+    PolygonIndices indices{{6, 7, 8}};
+    indices.appendTriangles(triangles.begin(), triangles.end());
+    CHECK(indices.allTriangles());
+    CHECK(toFaces(indices) == std::vector<IndexedFace>{{6, 7, 8}, {0, 1, 2}, {3, 4, 5}});
+  }
+  SECTION("After other faces")
+  {
+    PolygonIndices indices{{6, 7, 8, 9}};
+    indices.appendTriangles(triangles.begin(), triangles.end());
+    CHECK(toFaces(indices) == std::vector<IndexedFace>{{6, 7, 8, 9}, {0, 1, 2}, {3, 4, 5}});
+    indices.pop_back();
+    indices.pop_back();
+    indices.pop_back();
+    CHECK(indices.empty());
+  }
+}
+
+TEST_CASE("PolygonIndices views", "[PolygonIndices]")
+{
+  PolygonIndices indices{{0, 1, 2}, {3, 4, 5, 6}};
+
+  SECTION("Mutable views write through")
+  {
+    for (auto&& face : indices) {
+      for (auto& i : face) i += 10;
+    }
+    indices.back().front() = 0;
+    CHECK(toFaces(indices) == std::vector<IndexedFace>{{10, 11, 12}, {0, 14, 15, 16}});
+  }
+  SECTION("Read-only views")
+  {
+    const PolygonIndices& const_indices = indices;
+    const FaceView face = const_indices[1];
+    CHECK(face.size() == 4);
+    CHECK(face.at(3) == 6);
+    CHECK_THROWS_AS(face.at(4), std::out_of_range);
+    CHECK(std::vector<int>(face.rbegin(), face.rend()) == std::vector<int>{6, 5, 4, 3});
+    // A mutable view converts to a read-only one, and to a face which can be kept
+    const FaceView converted = indices[0];
+    IndexedFace copy = converted;
+    copy.push_back(7);
+    CHECK(indices[0] == IndexedFace{0, 1, 2});
+    CHECK(copy == IndexedFace{0, 1, 2, 7});
+  }
+  SECTION("Iterators")
+  {
+    CHECK(std::distance(indices.cbegin(), indices.cend()) == 2);
+    PolygonIndices::const_iterator it = indices.begin();
+    CHECK((*(it + 1)).size() == 4);
+    CHECK(it[1] == IndexedFace{3, 4, 5, 6});
+  }
+}
+
+TEST_CASE("PolygonIndices remove_if and comparison", "[PolygonIndices]")
+{
+  PolygonIndices indices{{0, 1, 2}, {3, 4, 5, 6}, {7, 8, 9}};
+  CHECK(indices.remove_if([](const FaceView& face) { return face.size() != 3; }) == 1);
+  CHECK(indices.allTriangles());
+  CHECK(indices == PolygonIndices{{0, 1, 2}, {7, 8, 9}});
+  CHECK(indices != PolygonIndices{{0, 1, 2}});
+
+  PolygonIndices moved = std::move(indices);
+  CHECK(moved.size() == 2);
+}
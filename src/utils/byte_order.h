@@ -0,0 +1,57 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <ostream>
+#include <type_traits>
+
+inline bool is_little_endian()
+{
+  static constexpr uint16_t test = 0x0001;
+  return *reinterpret_cast<const char *>(&test) == 1;
+}
+
+// Reads a value stored in little endian byte order from unaligned memory
+template <typename T>
+T read_little_endian(const char *data)
+{
+  static_assert(std::is_arithmetic_v<T>, "Only numbers can be read");
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  if (!is_little_endian()) std::reverse(bytes, bytes + sizeof(T));
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+// Reads a value stored in big endian byte order from unaligned memory
+template <typename T>
+T read_big_endian(const char *data)
+{
+  static_assert(std::is_arithmetic_v<T>, "Only numbers can be read");
+  char bytes[sizeof(T)];
+  std::memcpy(bytes, data, sizeof(T));
+  if (is_little_endian()) std::reverse(bytes, bytes + sizeof(T));
+  T value;
+  std::memcpy(&value, bytes, sizeof(T));
+  return value;
+}
+
+// Writes count values in little endian byte order
+template <typename T>
+void write_little_endian(std::ostream& output, const T *values, size_t count)
+{
+  static_assert(std::is_arithmetic_v<T>, "Only numbers can be written");
+  if (is_little_endian()) {
+    output.write(reinterpret_cast<const char *>(values), count * sizeof(T));
+    return;
+  }
+  for (size_t i = 0; i < count; ++i) {
+    char bytes[sizeof(T)];
+    std::memcpy(bytes, &values[i], sizeof(T));
+    std::reverse(bytes, bytes + sizeof(T));
+    output.write(bytes, sizeof(T));
+  }
+}
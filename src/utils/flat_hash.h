@@ -0,0 +1,181 @@
+#pragma once
+
+#include <Eigen/Core>
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+/*!
+   Finalizer of MurmurHash3. Spreads the bits of a hash value over all 64 bits, so
+   that similar keys end up in different slots of an open-addressing table.
+ */
+inline uint64_t hash_mix(uint64_t h)
+{
+  h ^= h >> 33;
+  h *= 0xff51afd7ed558ccdULL;
+  h ^= h >> 33;
+  h *= 0xc4ceb9fe1a85ec53ULL;
+  h ^= h >> 33;
+  return h;
+}
+
+template <typename Key>
+struct FlatHash {
+  uint64_t operator()(const Key& key) const { return hash_mix(std::hash<Key>()(key)); }
+};
+
+// Fixed size Eigen vectors are hashed directly from the bits of their coefficients. This is
+// branch free, so the compiler can vectorize loops hashing many keys.
+template <typename Scalar, int N>
+struct FlatHash<Eigen::Matrix<Scalar, N, 1>> {
+  static_assert(N >= 1 && N <= 4, "FlatHash supports vectors of 1 to 4 coefficients");
+
+  uint64_t operator()(const Eigen::Matrix<Scalar, N, 1>& v) const
+  {
+    constexpr uint64_t factors[4] = {0x9e3779b97f4a7c15ULL, 0xc2b2ae3d27d4eb4fULL,
+                                     0x165667b19e3779f9ULL, 0x27d4eb2f165667c5ULL};
+    uint64_t h = 0;
+    for (int i = 0; i < N; ++i) h += bits(v[i]) * factors[i];
+    return hash_mix(h);
+  }
+
+  static uint64_t bits(Scalar s)
+  {
+    if constexpr (std::is_floating_point_v<Scalar>) {
+      s += Scalar(0);  // -0 compares equal to 0, so it must hash the same
+      if constexpr (sizeof(Scalar) == sizeof(uint64_t)) {
+        uint64_t b;
+        std::memcpy(&b, &s, sizeof(b));
+        return b;
+      } else {
+        uint32_t b;
+        std::memcpy(&b, &s, sizeof(b));
+        return b;
+      }
+    } else {
+      return static_cast<uint64_t>(s);
+    }
+  }
+};
+
+/*!
+   Assigns consecutive indices to distinct keys, in insertion order.
+
+   This is an open-addressing hash table with linear probing. Keys are stored densely in
+   insertion order, and the table itself is a flat array of slots holding 32 bits of the
+   key's hash next to its index. Probing thus stays within a few cache lines, and keys
+   are only compared when their hash bits match. Keys can't be removed.
+ */
+template <typename Key, typename Hash = FlatHash<Key>>
+class FlatHashIndex
+{
+public:
+  static constexpr uint32_t npos = std::numeric_limits<uint32_t>::max();
+
+  [[nodiscard]] size_t size() const { return this->keys_.size(); }
+  [[nodiscard]] bool empty() const { return this->keys_.empty(); }
+  // The distinct keys, by index
+  [[nodiscard]] const std::vector<Key>& keys() const { return this->keys_; }
+  [[nodiscard]] const Key& key(uint32_t index) const { return this->keys_[index]; }
+
+  void reserve(size_t n)
+  {
+    this->keys_.reserve(n);
+    if (n * 2 > this->slots_.size()) rehash(n);
+  }
+
+  void clear()
+  {
+    this->keys_.clear();
+    std::fill(this->slots_.begin(), this->slots_.end(), Slot{});
+  }
+
+  // Moves the keys out, leaving the index empty
+  std::vector<Key> release()
+  {
+    std::vector<Key> keys = std::move(this->keys_);
+    this->keys_.clear();
+    this->slots_.clear();
+    this->mask_ = 0;
+    return keys;
+  }
+
+  // Returns the index of key, or npos if it's not present
+  [[nodiscard]] uint32_t find(const Key& key) const
+  {
+    if (this->slots_.empty()) return npos;
+    const uint64_t h = this->hash_(key);
+    for (size_t pos = h & this->mask_;; pos = (pos + 1) & this->mask_) {
+      const Slot& slot = this->slots_[pos];
+      if (slot.index == 0) return npos;
+      if (slot.tag == tag(h) && this->keys_[slot.index - 1] == key) return slot.index - 1;
+    }
+  }
+
+  // Returns the index of key, adding it if it's not present. The bool is true if key was added.
+  std::pair<uint32_t, bool> insert(const Key& key) { return insertHashed(key, this->hash_(key)); }
+
+  /*!
+     Inserts a range of keys and writes their indices to out.
+     All keys are hashed before any is inserted, so hashing runs as a tight loop.
+   */
+  template <typename ForwardIterator, typename OutputIterator>
+  OutputIterator insert(ForwardIterator begin, ForwardIterator end, OutputIterator out)
+  {
+    std::vector<uint64_t> hashes(std::distance(begin, end));
+    std::transform(begin, end, hashes.begin(), this->hash_);
+    reserve(size() + hashes.size());
+    for (const uint64_t h : hashes) *out++ = insertHashed(*begin++, h).first;
+    return out;
+  }
+
+private:
+  struct Slot {
+    uint32_t tag{0};
+    uint32_t index{0};  // index + 1 of the key, 0 for an empty slot
+  };
+
+  static uint32_t tag(uint64_t h) { return static_cast<uint32_t>(h >> 32); }
+
+  std::pair<uint32_t, bool> insertHashed(const Key& key, uint64_t h)
+  {
+    // Keep the load factor at or below 1/2
+    if ((this->keys_.size() + 1) * 2 > this->slots_.size()) rehash(this->keys_.size() + 1);
+    for (size_t pos = h & this->mask_;; pos = (pos + 1) & this->mask_) {
+      Slot& slot = this->slots_[pos];
+      if (slot.index == 0) {
+        this->keys_.push_back(key);
+        slot = Slot{tag(h), static_cast<uint32_t>(this->keys_.size())};
+        return {slot.index - 1, true};
+      }
+      if (slot.tag == tag(h) && this->keys_[slot.index - 1] == key) return {slot.index - 1, false};
+    }
+  }
+
+  // Resizes the table for at least n keys
+  void rehash(size_t n)
+  {
+    size_t capacity = std::max<size_t>(16, this->slots_.size());
+    while (capacity < n * 2) capacity *= 2;
+    this->slots_.assign(capacity, Slot{});
+    this->mask_ = capacity - 1;
+    for (size_t i = 0; i < this->keys_.size(); ++i) {
+      const uint64_t h = this->hash_(this->keys_[i]);
+      size_t pos = h & this->mask_;
+      while (this->slots_[pos].index != 0) pos = (pos + 1) & this->mask_;
+      this->slots_[pos] = Slot{tag(h), static_cast<uint32_t>(i + 1)};
+    }
+  }
+
+  Hash hash_;
+  std::vector<Key> keys_;
+  std::vector<Slot> slots_;
+  size_t mask_{0};
+};
@@ -0,0 +1,118 @@
+#include "utils/flat_hash.h"
+
+#include <catch2/catch_all.hpp>
+#include <cstdint>
+#include <iterator>
+#include <string>
+#include <vector>
+
+#include "geometry/Grid.h"
+#include "geometry/linalg.h"
+
+namespace {
+
+// All keys share one hash, so every lookup has to probe past the others
+struct ConstantHash {
+  uint64_t operator()(int) const { return 42; }
+};
+
+// Keys with the same low bits share a slot position, but have different tags
+struct LowBitsHash {
+  uint64_t operator()(int key) const { return (static_cast<uint64_t>(key) << 32) | 7; }
+};
+
+}  // namespace
+
+TEST_CASE("FlatHashIndex assigns consecutive indices to distinct keys", "[flat_hash]")
+{
+  FlatHashIndex<std::string> index;
+  CHECK(index.empty());
+  CHECK(index.find("a") == FlatHashIndex<std::string>::npos);
+
+  CHECK(index.insert("a") == std::make_pair(0u, true));
+  CHECK(index.insert("b") == std::make_pair(1u, true));
+  CHECK(index.insert("a") == std::make_pair(0u, false));
+  CHECK(index.insert("c") == std::make_pair(2u, true));
+
+  CHECK(index.size() == 3);
+  CHECK(index.find("b") == 1);
+  CHECK(index.find("d") == FlatHashIndex<std::string>::npos);
+  CHECK(index.keys() == std::vector<std::string>{"a", "b", "c"});
+  CHECK(index.key(2) == "c");
+
+  index.clear();
+  CHECK(index.empty());
+  CHECK(index.find("a") == FlatHashIndex<std::string>::npos);
+  CHECK(index.insert("c") == std::make_pair(0u, true));
+}
+
+TEST_CASE("FlatHashIndex keeps indices while growing", "[flat_hash]")
+{
+  FlatHashIndex<int> index;
+  constexpr int count = 10000;
+  for (int i = 0; i < count; ++i) {
+    REQUIRE(index.insert(i * 7919).first == static_cast<uint32_t>(i));
+  }
+  CHECK(index.size() == count);
+  for (int i = 0; i < count; ++i) {
+    REQUIRE(index.find(i * 7919) == static_cast<uint32_t>(i));
+  }
+  CHECK(index.find(1) == FlatHashIndex<int>::npos);
+
+  const auto keys = index.release();
+  CHECK(keys.size() == count);
+  CHECK(keys.back() == (count - 1) * 7919);
+  CHECK(index.empty());
+  CHECK(index.find(0) == FlatHashIndex<int>::npos);
+  CHECK(index.insert(5) == std::make_pair(0u, true));
+}
+
+TEST_CASE("FlatHashIndex handles hash collisions", "[flat_hash]")
+{
+  SECTION("Same hash")
+  {
+    FlatHashIndex<int, ConstantHash> index;
+    for (int i = 0; i < 100; ++i) REQUIRE(index.insert(i).first == static_cast<uint32_t>(i));
+    for (int i = 0; i < 100; ++i) REQUIRE(index.find(i) == static_cast<uint32_t>(i));
+    CHECK(index.insert(50) == std::make_pair(50u, false));
+    CHECK(index.find(100) == FlatHashIndex<int, ConstantHash>::npos);
+  }
+  SECTION("Same slot, different tags")
+  {
+    FlatHashIndex<int, LowBitsHash> index;
+    for (int i = 0; i < 100; ++i) REQUIRE(index.insert(i).first == static_cast<uint32_t>(i));
+    for (int i = 0; i < 100; ++i) REQUIRE(index.find(i) == static_cast<uint32_t>(i));
+    CHECK(index.find(100) == FlatHashIndex<int, LowBitsHash>::npos);
+  }
+}
+
+TEST_CASE("FlatHashIndex bulk insert matches single inserts", "[flat_hash]")
+{
+  const std::vector<Vector3d> keys = {{0, 0, 0}, {1, 2, 3}, {-0.0, 0, 0}, {1, 2, 3}, {3, 2, 1}};
+  FlatHashIndex<Vector3d> bulk;
+  std::vector<uint32_t> indices;
+  bulk.insert(keys.begin(), keys.end(), std::back_inserter(indices));
+  // -0 equals 0, so it has to find the same key
+  CHECK(indices == std::vector<uint32_t>{0, 1, 0, 1, 2});
+
+  FlatHashIndex<Vector3d> single;
+  for (const auto& key : keys) single.insert(key);
+  CHECK(bulk.keys() == single.keys());
+}
+
+TEST_CASE("Grid3d::has() returns the first occupied neighbor", "[flat_hash]")
+{
+  Grid3d<int> grid(1.0);
+  Vector3d closest(2.5, 0.5, 0.5);
+  Vector3d first(0.5, 1.5, 1.5);
+  CHECK(grid.align(closest) == 0);
+  CHECK(grid.align(first) == 1);
+
+  // Both cells neighbor the cell of v. align() snaps to the closest, has() reports the first.
+  Vector3d v(1.5, 0.5, 0.5);
+  int data = -1;
+  CHECK(grid.has(v, &data));
+  CHECK(data == 1);
+  CHECK(grid.align(v) == 0);
+  CHECK_FALSE(grid.has(Vector3d(10.5, 0.5, 0.5)));
+}
@@ -7,6 +7,7 @@
 #if ENABLE_TBB
 #include <tbb/parallel_for.h>
 #include <tbb/parallel_for_each.h>
+#include <tbb/parallel_sort.h>
 #endif
 
 template <class InputIterator, class OutputIterator, class Operation>
@@ -25,6 +26,34 @@ void parallelizable_transform(const InputIterator begin1, const InputIterator en
   std::transform(begin1, end1, out, op);
 }
 
+// Call op(i) for each i in [begin, end), in parallel if enabled.
+template <class Operation>
+void parallelizable_for(size_t begin, size_t end, const Operation& op)
+{
+#if ENABLE_TBB
+  if (!getenv("OPENSCAD_NO_PARALLEL")) {
+    tbb::parallel_for(tbb::blocked_range<size_t>(begin, end), [&](const auto& range) {
+      for (size_t i = range.begin(); i != range.end(); ++i) op(i);
+    });
+    return;
+  }
+#endif
+  for (size_t i = begin; i < end; ++i) op(i);
+}
+
+// Sorts [begin, end) by comp, in parallel if enabled. Like std::sort, the sort isn't stable.
+template <class RandomAccessIterator, class Compare>
+void parallelizable_sort(RandomAccessIterator begin, RandomAccessIterator end, const Compare& comp)
+{
+#if ENABLE_TBB
+  if (!getenv("OPENSCAD_NO_PARALLEL")) {
+    tbb::parallel_sort(begin, end, comp);
+    return;
+  }
+#endif
+  std::sort(begin, end, comp);
+}
+
 template <class Container1, class Container2, class OutputIterator, class Operation>
 void parallelizable_cross_product_transform(const Container1& cont1, const Container2& cont2,
                                             OutputIterator out, const Operation& op)
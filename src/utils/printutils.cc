@@ -11,6 +11,7 @@
 #include <list>
 #include <set>
 #include <string>
+#include <vector>
 
 #include "utils/exceptions.h"
 
@@ -35,6 +36,8 @@ OutputHandlerFunc2 *outputhandler2 = nullptr;
 boost::circular_buffer<std::string> lastmessages(5);
 boost::circular_buffer<struct Message> lastlogmessages(5);
 
+thread_local MessageRecorder *message_recorder = nullptr;
+
 bool no_throw;
 bool deferred;
 
@@ -78,10 +81,20 @@ void print_messages_pop()
   }
 }
 
+MessageRecorder::MessageRecorder() : outer_(message_recorder) { message_recorder = this; }
+
+MessageRecorder::~MessageRecorder()
+{
+  message_recorder = outer_;
+  if (outer_) outer_->messages_.insert(outer_->messages_.end(), messages_.begin(), messages_.end());
+}
+
 void PRINT(const Message& msgObj)
 {
   if (msgObj.msg.empty() && msgObj.group != message_group::Echo) return;
 
+  if (message_recorder) message_recorder->messages_.push_back(msgObj);
+
   if (print_messages_stack.size() > 0) {
     if (!print_messages_stack.back().empty()) {
       print_messages_stack.back() += "\n";
@@ -13,6 +13,7 @@
 #include <string>
 #include <tuple>
 #include <utility>
+#include <vector>
 // Undefine some defines from libintl.h to presolve
 // some collisions in boost headers later
 #if defined snprintf
@@ -123,6 +124,28 @@ void print_messages_push();
 void print_messages_pop();
 void resetSuppressedMessages();
 
+/*!
+   Records the messages printed by the current thread while it exists, so they can be printed
+   again when a cached result is reused. Recorders can be nested; an outer recorder gets the
+   messages of inner ones when they're destroyed.
+ */
+class MessageRecorder
+{
+public:
+  MessageRecorder();
+  ~MessageRecorder();
+  MessageRecorder(const MessageRecorder&) = delete;
+  MessageRecorder& operator=(const MessageRecorder&) = delete;
+
+  [[nodiscard]] const std::vector<Message>& messages() const { return messages_; }
+
+private:
+  friend void PRINT(const Message& msgObj);
+
+  std::vector<Message> messages_;
+  MessageRecorder *outer_;
+};
+
 /* PRINT statements come out in same window as ECHO.
    usage: PRINTB("Var1: %s Var2: %i", var1 % var2 ); */
 void PRINT(const Message& msgObj);
@@ -55,7 +55,7 @@ def createImport(inputfile, scadfile):
 #
 # Parse arguments
 #
-formats = ["csg", "asciistl", "binstl", "stl", "off", "amf", "3mf", "obj", "dxf", "svg"]
+formats = ["csg", "asciistl", "binstl", "stl", "off", "amf", "3mf", "obj", "ply", "dxf", "svg"]
 parser = argparse.ArgumentParser()
 parser.add_argument(
     "--openscad",
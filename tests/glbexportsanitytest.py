@@ -0,0 +1,120 @@
+#!/usr/bin/env python3
+
+# GLB sanity checker
+#
+# Exports a model to binary glTF and checks the container layout: the header, the alignment
+# of the chunks and of the buffer data, and that the accessor bounds match the data.
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [<openscad args>] tmpfilebasename
+
+import sys, subprocess, os, argparse, json, struct
+
+GLB_MAGIC = 0x46546C67
+CHUNK_JSON = 0x4E4F534A
+CHUNK_BIN = 0x004E4942
+COMPONENTS = {5121: ('B', 1), 5123: ('H', 2), 5125: ('I', 4), 5126: ('f', 4)}
+TYPE_SIZES = {'SCALAR': 1, 'VEC3': 3}
+
+
+def failquit(*args):
+    print('glbexportsanitytest:', *args, file=sys.stderr)
+    sys.exit(1)
+
+
+def check(condition, *args):
+    if not condition:
+        failquit(*args)
+
+
+def as_component(accessor, value):
+    # Bounds are written as the shortest decimal which reads back as the same component value
+    fmt, size = COMPONENTS[accessor['componentType']]
+    return struct.unpack('<' + fmt, struct.pack('<' + fmt, value))[0]
+
+
+def read_accessor(gltf, binary, accessor):
+    view = gltf['bufferViews'][accessor['bufferView']]
+    fmt, size = COMPONENTS[accessor['componentType']]
+    components = TYPE_SIZES[accessor['type']]
+    stride = view.get('byteStride', size * components)
+    offset = view.get('byteOffset', 0) + accessor.get('byteOffset', 0)
+    check(offset % size == 0, 'accessor data not aligned to its component size')
+    end = offset + stride * (accessor['count'] - 1) + size * components
+    check(accessor['count'] == 0 or end <= view.get('byteOffset', 0) + view['byteLength'],
+          'accessor exceeds its buffer view')
+    return [struct.unpack_from('<%d%s' % (components, fmt), binary, offset + i * stride)
+            for i in range(accessor['count'])]
+
+
+def validate_glb(filename):
+    with open(filename, 'rb') as f:
+        data = f.read()
+    check(len(data) >= 20, 'file too short')
+    magic, version, length = struct.unpack_from('<III', data, 0)
+    check(magic == GLB_MAGIC, 'bad magic')
+    check(version == 2, 'bad version', version)
+    check(length == len(data), 'header length', length, 'but file size', len(data))
+
+    json_length, json_type = struct.unpack_from('<II', data, 12)
+    check(json_type == CHUNK_JSON, 'first chunk is not JSON')
+    check(json_length % 4 == 0, 'JSON chunk length not a multiple of 4')
+    gltf = json.loads(data[20:20 + json_length].decode('utf-8'))
+    binary = b''
+    offset = 20 + json_length
+    if offset < len(data):
+        bin_length, bin_type = struct.unpack_from('<II', data, offset)
+        check(bin_type == CHUNK_BIN, 'second chunk is not BIN')
+        check(bin_length % 4 == 0, 'BIN chunk length not a multiple of 4')
+        check(offset + 8 + bin_length == len(data), 'BIN chunk length doesn\'t match the file')
+        binary = data[offset + 8:]
+    check(gltf['asset']['version'] == '2.0', 'bad asset version')
+
+    for buffer in gltf.get('buffers', []):
+        check(buffer['byteLength'] <= len(binary), 'buffer larger than the BIN chunk')
+    for view in gltf.get('bufferViews', []):
+        check(view.get('byteOffset', 0) % 4 == 0, 'buffer view not 4 byte aligned')
+        check(view.get('byteOffset', 0) + view['byteLength'] <= len(binary),
+              'buffer view exceeds the buffer')
+        check(view.get('byteStride', 4) % 4 == 0, 'vertex stride not a multiple of 4')
+
+    accessors = gltf.get('accessors', [])
+    for mesh in gltf.get('meshes', []):
+        for primitive in mesh['primitives']:
+            positions = accessors[primitive['attributes']['POSITION']]
+            values = read_accessor(gltf, binary, positions)
+            check('min' in positions and 'max' in positions, 'POSITION accessor without bounds')
+            if values:
+                for i in range(3):
+                    low = min(v[i] for v in values)
+                    high = max(v[i] for v in values)
+                    check(as_component(positions, positions['min'][i]) == low and
+                          as_component(positions, positions['max'][i]) == high,
+                          'POSITION bounds', positions['min'], positions['max'],
+                          'don\'t match the data in component', i, (low, high))
+            indices = read_accessor(gltf, binary, accessors[primitive['indices']])
+            check(len(indices) % 3 == 0, 'index count not a multiple of 3')
+            check(all(index[0] < positions['count'] for index in indices),
+                  'vertex index out of range')
+    return True
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable.")
+args, remaining_args = parser.parse_known_args()
+inputfile = remaining_args[0]
+glbfile = remaining_args[-1] + ".glb"
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+if not os.path.exists(inputfile):
+    failquit("cant find input file named: " + inputfile)
+if not os.path.exists(args.openscad):
+    failquit("cant find openscad executable named: " + args.openscad)
+
+export_cmd = [args.openscad, inputfile, "-o", glbfile] + remaining_args
+print("Running OpenSCAD:", file=sys.stderr)
+print(" ".join(export_cmd), file=sys.stderr)
+sys.stderr.flush()
+subprocess.check_call(export_cmd)
+
+validate_glb(glbfile)
+os.unlink(glbfile)
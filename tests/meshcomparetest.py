@@ -0,0 +1,141 @@
+#!/usr/bin/env python3
+
+# Mesh comparison between backends
+#
+# Exports a model to OFF with the CGAL and with the Manifold backend, and checks that both
+# meshes are closed and consistently oriented, and that they have the same volume, surface
+# area and bounding box. The triangulation may differ.
+#
+# With --reference, the model is compared to the reference model instead, both exported with
+# the given arguments. While exporting the model, --culled checks the number of boolean operands
+# culled by bounding box, --cache-entries the number of geometries cached, and --warnings the
+# number of warnings printed.
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> [--reference=<file>] [--culled=<count>]
+#        [--cache-entries=<count>] [--warnings=<count>] [<openscad args>] tmpfilebasename
+
+import sys, subprocess, os, argparse, math, json
+from collections import Counter
+
+BACKENDS = ["cgal", "manifold"]
+TOLERANCE = 1e-6
+
+
+def failquit(*args):
+    print('meshcomparetest:', *args, file=sys.stderr)
+    sys.exit(1)
+
+
+def read_off(filename):
+    with open(filename) as f:
+        lines = [line.split('#')[0].split() for line in f]
+    lines = [line for line in lines if line]
+    if not lines or lines[0] != ['OFF']:
+        failquit(filename, 'is not an OFF file')
+    num_vertices, num_faces = int(lines[1][0]), int(lines[1][1])
+    vertices = [tuple(float(t) for t in line[:3]) for line in lines[2:2 + num_vertices]]
+    # Faces may be followed by a color on the same line
+    faces = [[int(t) for t in line[1:1 + int(line[0])]]
+             for line in lines[2 + num_vertices:2 + num_vertices + num_faces]]
+    return vertices, faces
+
+
+def measure(filename):
+    vertices, faces = read_off(filename)
+    edges = Counter()
+    volume = 0
+    area = 0
+    for face in faces:
+        for i in range(len(face)):
+            edges[(face[i], face[(i + 1) % len(face)])] += 1
+        # Faces may be non-convex polygons, so the area is taken from the sum of the fan normals
+        a = vertices[face[0]]
+        normal = [0, 0, 0]
+        for i in range(1, len(face) - 1):
+            b, c = vertices[face[i]], vertices[face[i + 1]]
+            u = [b[k] - a[k] for k in range(3)]
+            v = [c[k] - a[k] for k in range(3)]
+            n = [u[1] * v[2] - u[2] * v[1], u[2] * v[0] - u[0] * v[2], u[0] * v[1] - u[1] * v[0]]
+            normal = [normal[k] + n[k] for k in range(3)]
+            volume += sum(a[k] * n[k] for k in range(3)) / 6
+        area += math.sqrt(sum(x * x for x in normal)) / 2
+    for (a, b), count in edges.items():
+        if count != 1 or edges[(b, a)] != 1:
+            failquit(filename, 'is not closed and consistently oriented at edge', (a, b))
+    used = [vertices[i] for face in faces for i in face]
+    if not used:
+        failquit(filename, 'is empty')
+    bbox = [min(v[k] for v in used) for k in range(3)] + [max(v[k] for v in used) for k in range(3)]
+    return {'volume': volume, 'area': area, 'bounding box': bbox}
+
+
+def same(a, b):
+    return abs(a - b) <= TOLERANCE * max(1, abs(a), abs(b))
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable.")
+parser.add_argument("--reference", help="Compare to this model instead of the other backend.")
+parser.add_argument("--culled", type=int, help="Expected number of culled boolean operands.")
+parser.add_argument("--cache-entries", type=int, help="Expected number of cached geometries.")
+parser.add_argument("--warnings", type=int, help="Expected number of warnings.")
+args, remaining_args = parser.parse_known_args()
+inputfile = remaining_args[0]
+basename = remaining_args[-1]
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+for filename in [inputfile, args.reference]:
+    if filename and not os.path.exists(filename):
+        failquit("cant find input file named: " + filename)
+if not os.path.exists(args.openscad):
+    failquit("cant find openscad executable named: " + args.openscad)
+
+if args.reference:
+    runs = [("model", inputfile, []), ("reference", args.reference, [])]
+else:
+    runs = [(backend, inputfile, ["--backend=" + backend]) for backend in BACKENDS]
+
+results = []
+for name, filename, run_args in runs:
+    offfile = basename + "-" + name + ".off"
+    summaryfile = basename + "-" + name + "-summary.json"
+    export_cmd = [args.openscad, filename, "-o", offfile] + run_args + remaining_args
+    summaries = []
+    if args.culled is not None:
+        summaries += ["--summary", "culling"]
+    if args.cache_entries is not None:
+        summaries += ["--summary", "cache"]
+    if summaries:
+        export_cmd += summaries + ["--summary-file", summaryfile]
+    print("Running OpenSCAD:", file=sys.stderr)
+    print(" ".join(export_cmd), file=sys.stderr)
+    sys.stderr.flush()
+    proc = subprocess.run(export_cmd, stderr=subprocess.PIPE, universal_newlines=True)
+    sys.stderr.write(proc.stderr)
+    if proc.returncode != 0:
+        failquit(name, 'export failed with return code', proc.returncode)
+    results.append(measure(offfile))
+    os.unlink(offfile)
+    summary = {}
+    if summaries:
+        with open(summaryfile) as f:
+            summary = json.load(f)
+        os.unlink(summaryfile)
+    if filename != inputfile:
+        continue
+    if args.culled is not None and summary["culling"]["operands"] != args.culled:
+        failquit(name, 'culled', summary["culling"]["operands"], 'operands, expected', args.culled)
+    if args.cache_entries is not None:
+        cached = sum(cache["entries"] for cache in summary["cache"].values())
+        if cached != args.cache_entries:
+            failquit(name, 'cached', cached, 'geometries, expected', args.cache_entries)
+    if args.warnings is not None:
+        warnings = [line for line in proc.stderr.splitlines() if line.startswith("WARNING:")]
+        if len(warnings) != args.warnings:
+            failquit(name, 'printed', len(warnings), 'warnings, expected', args.warnings)
+
+for key in results[0]:
+    first, second = results[0][key], results[1][key]
+    values = zip(first, second) if isinstance(first, list) else [(first, second)]
+    if not all(same(a, b) for a, b in values):
+        failquit(key, 'differs:', runs[0][0], first, runs[1][0], second)
@@ -0,0 +1,55 @@
+#!/usr/bin/env python3
+
+# Preview comparison against a reference model
+#
+# Renders the model and the reference model to PNG with the given arguments, and checks that
+# both images match, using image_compare.py run by the given Python interpreter.
+#
+# Usage: <script> <inputfile> --openscad=<executable-path> --reference=<file>
+#        --image-compare=<python-path> [<openscad args>] tmpfilebasename
+
+import sys, subprocess, os, argparse
+
+
+def failquit(*args):
+    print('pngcomparetest:', *args, file=sys.stderr)
+    sys.exit(1)
+
+
+parser = argparse.ArgumentParser()
+parser.add_argument("--openscad", required=True, help="Specify OpenSCAD executable.")
+parser.add_argument("--reference", required=True, help="Compare to this model.")
+parser.add_argument("--image-compare", required=True, help="Python executable for image_compare.py.")
+args, remaining_args = parser.parse_known_args()
+inputfile = remaining_args[0]
+basename = remaining_args[-1]
+remaining_args = remaining_args[1:-1]  # Passed on to the OpenSCAD executable
+
+for filename in [inputfile, args.reference]:
+    if not os.path.exists(filename):
+        failquit("cant find input file named: " + filename)
+if not os.path.exists(args.openscad):
+    failquit("cant find openscad executable named: " + args.openscad)
+
+pngfiles = []
+for name, filename in [("model", inputfile), ("reference", args.reference)]:
+    pngfile = basename + "-" + name + ".png"
+    export_cmd = [args.openscad, filename, "-o", pngfile] + remaining_args
+    print("Running OpenSCAD:", file=sys.stderr)
+    print(" ".join(export_cmd), file=sys.stderr)
+    sys.stderr.flush()
+    result = subprocess.call(export_cmd)
+    if result != 0:
+        failquit(name, 'export failed with return code', result)
+    pngfiles.append(pngfile)
+
+compare_script = os.path.join(os.path.dirname(os.path.abspath(__file__)), "image_compare.py")
+compare_cmd = [args.image_compare, "-Xutf8=1", compare_script] + pngfiles
+print("Running image comparison:", file=sys.stderr)
+print(" ".join(compare_cmd), file=sys.stderr)
+sys.stderr.flush()
+result = subprocess.call(compare_cmd, stdout=sys.stderr)
+if result != 0:
+    failquit('model and reference images differ')
+for pngfile in pngfiles:
+    os.unlink(pngfile)